@@ -190,6 +190,18 @@ class RTC_EXPORT DataChannelInterface : public rtc::RefCountInterface {
   // buffer.
   virtual bool Send(const DataBuffer& buffer) = 0;
 
+  // Like Send(), but may be called on any thread and doesn't wait for the
+  // data to be handed to the transport. The data is queued and sent from the
+  // network thread, and is accounted for in buffered_amount() until then.
+  // Suitable for applications sending many small messages at a high rate.
+  //
+  // Messages sent using SendAsync() are delivered in the order they were
+  // queued, but are not ordered with respect to messages sent using Send().
+  // Returns false if the data channel isn't open, or if the data couldn't be
+  // queued, in which case the data channel will be closed abruptly.
+  // The default implementation doesn't support sending this way.
+  virtual bool SendAsync(const DataBuffer& buffer) { return false; }
+
  protected:
   ~DataChannelInterface() override = default;
 };
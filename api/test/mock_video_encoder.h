@@ -65,6 +65,7 @@ class MockVideoEncoder : public VideoEncoder {
               OnLossNotification,
               (const LossNotification& loss_notification),
               (override));
+  MOCK_METHOD(void, SetComplexityReduction, (int steps), (override));
   MOCK_METHOD(EncoderInfo, GetEncoderInfo, (), (const, override));
 };
 
@@ -115,6 +115,10 @@ class VideoCodecTestFixture {
     // Force the encoder and decoder to use a single core for processing.
     bool use_single_core = false;
 
+    // Number of cores given to the encoder and decoder. Overrides
+    // `use_single_core` when set.
+    absl::optional<size_t> num_cores;
+
     // Should cpu usage be measured?
     // If set to true, the encoding will run in real-time.
     bool measure_cpu = false;
@@ -87,6 +87,130 @@ bool LengthValid(int type, int length) {
   return true;
 }
 
+// Computes the HMAC-SHA1 of `data` up to the MESSAGE-INTEGRITY attribute at
+// `mi_pos`, with the length in the header covering the attribute, as RFC 5389
+// section 15.4 requires. Only the header is copied to patch the length; the
+// rest of the message is hashed in place.
+bool ComputeMessageIntegrity(absl::string_view password,
+                             const char* data,
+                             size_t mi_pos,
+                             size_t mi_attr_size,
+                             char hmac[kStunMessageIntegritySize]) {
+  std::unique_ptr<rtc::MessageDigest> digest(
+      rtc::MessageDigestFactory::Create(rtc::DIGEST_SHA_1));
+  if (!digest) {
+    return false;
+  }
+  char header[kStunHeaderSize];
+  memcpy(header, data, kStunHeaderSize);
+  rtc::SetBE16(header + 2,
+               static_cast<uint16_t>(mi_pos + kStunAttributeHeaderSize +
+                                     mi_attr_size - kStunHeaderSize));
+  rtc::Hmac message_hmac(digest.get(), password.data(), password.size());
+  message_hmac.Update(header, sizeof(header));
+  message_hmac.Update(data + kStunHeaderSize, mi_pos - kStunHeaderSize);
+  return message_hmac.Finish(hmac, kStunMessageIntegritySize) ==
+         kStunMessageIntegritySize;
+}
+
+// Reads the value of an address attribute, which for the XOR variants is
+// still XORed with the magic cookie and `transaction_id`.
+bool ReadAddressValue(const char* value,
+                      size_t length,
+                      bool xored,
+                      absl::string_view transaction_id,
+                      rtc::SocketAddress* address) {
+  if (length < 4) {
+    return false;
+  }
+  uint16_t port = rtc::GetBE16(value + 2);
+  if (xored) {
+    port ^= kStunMagicCookie >> 16;
+  }
+  uint8_t family = static_cast<uint8_t>(value[1]);
+  if (family == STUN_ADDRESS_IPV4) {
+    if (length != StunAddressAttribute::SIZE_IP4) {
+      return false;
+    }
+    in_addr v4addr;
+    memcpy(&v4addr, value + 4, sizeof(v4addr));
+    if (xored) {
+      v4addr.s_addr ^= rtc::HostToNetwork32(kStunMagicCookie);
+    }
+    *address = rtc::SocketAddress(rtc::IPAddress(v4addr), port);
+    return true;
+  }
+  if (family == STUN_ADDRESS_IPV6) {
+    if (length != StunAddressAttribute::SIZE_IP6) {
+      return false;
+    }
+    uint8_t v6bytes[16];
+    memcpy(v6bytes, value + 4, sizeof(v6bytes));
+    if (xored) {
+      uint8_t mask[16];
+      rtc::SetBE32(mask, kStunMagicCookie);
+      memcpy(mask + 4, transaction_id.data(), kStunTransactionIdLength);
+      for (size_t i = 0; i < sizeof(v6bytes); ++i) {
+        v6bytes[i] ^= mask[i];
+      }
+    }
+    in6_addr v6addr;
+    memcpy(&v6addr, v6bytes, sizeof(v6addr));
+    *address = rtc::SocketAddress(rtc::IPAddress(v6addr), port);
+    return true;
+  }
+  return false;
+}
+
+bool AddressValueLength(const rtc::SocketAddress& address, size_t* length) {
+  switch (address.family()) {
+    case AF_INET:
+      *length = StunAddressAttribute::SIZE_IP4;
+      return true;
+    case AF_INET6:
+      *length = StunAddressAttribute::SIZE_IP6;
+      return true;
+  }
+  return false;
+}
+
+// The counterpart of ReadAddressValue(). `value` must have room for
+// AddressValueLength() bytes.
+void WriteAddressValue(const rtc::SocketAddress& address,
+                       bool xored,
+                       absl::string_view transaction_id,
+                       char* value) {
+  uint16_t port = address.port();
+  if (xored) {
+    port ^= kStunMagicCookie >> 16;
+  }
+  value[0] = 0;
+  rtc::SetBE16(value + 2, port);
+  if (address.family() == AF_INET) {
+    value[1] = STUN_ADDRESS_IPV4;
+    in_addr v4addr = address.ipaddr().ipv4_address();
+    if (xored) {
+      v4addr.s_addr ^= rtc::HostToNetwork32(kStunMagicCookie);
+    }
+    memcpy(value + 4, &v4addr, sizeof(v4addr));
+    return;
+  }
+  RTC_DCHECK_EQ(address.family(), AF_INET6);
+  value[1] = STUN_ADDRESS_IPV6;
+  in6_addr v6addr = address.ipaddr().ipv6_address();
+  uint8_t v6bytes[16];
+  memcpy(v6bytes, &v6addr, sizeof(v6bytes));
+  if (xored) {
+    uint8_t mask[16];
+    rtc::SetBE32(mask, kStunMagicCookie);
+    memcpy(mask + 4, transaction_id.data(), kStunTransactionIdLength);
+    for (size_t i = 0; i < sizeof(v6bytes); ++i) {
+      v6bytes[i] ^= mask[i];
+    }
+  }
+  memcpy(value + 4, v6bytes, sizeof(v6bytes));
+}
+
 }  // namespace
 
 const char STUN_ERROR_REASON_TRY_ALTERNATE_SERVER[] = "Try Alternate Server";
@@ -337,32 +461,9 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + mi_attr_size) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + mi_attr_size);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
   char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  if (!ComputeMessageIntegrity(password, data, current_pos, mi_attr_size,
+                               hmac)) {
     return false;
   }
 
@@ -1325,6 +1426,338 @@ std::unique_ptr<StunAttribute> CopyStunAttribute(
   return copy;
 }
 
+// StunMessageView
+
+bool StunMessageView::Parse(const char* data, size_t size) {
+  data_ = nullptr;
+  size_ = 0;
+  if (size < kStunHeaderSize) {
+    return false;
+  }
+  // RTP and RTCP set the MSB of the first byte, see StunMessage::Read().
+  if ((rtc::GetBE16(data) & 0x8000) ||
+      rtc::GetBE16(data + 2) != size - kStunHeaderSize ||
+      rtc::GetBE32(data + kStunTransactionIdOffset - kStunMagicCookieLength) !=
+          kStunMagicCookie) {
+    return false;
+  }
+  // The attributes, with their padding, must add up to the message.
+  size_t pos = kStunHeaderSize;
+  while (pos < size) {
+    if (pos + kStunAttributeHeaderSize > size) {
+      return false;
+    }
+    size_t length = rtc::GetBE16(data + pos + 2);
+    pos += kStunAttributeHeaderSize + ((length + 3) & ~size_t{3});
+  }
+  if (pos != size) {
+    return false;
+  }
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+int StunMessageView::type() const {
+  RTC_DCHECK(!empty());
+  return rtc::GetBE16(data_);
+}
+
+size_t StunMessageView::length() const {
+  RTC_DCHECK(!empty());
+  return size_ - kStunHeaderSize;
+}
+
+absl::string_view StunMessageView::transaction_id() const {
+  RTC_DCHECK(!empty());
+  return absl::string_view(data_ + kStunTransactionIdOffset,
+                           kStunTransactionIdLength);
+}
+
+uint32_t StunMessageView::reduced_transaction_id() const {
+  RTC_DCHECK(!empty());
+  const char* transaction_id = data_ + kStunTransactionIdOffset;
+  return rtc::GetBE32(transaction_id) ^ rtc::GetBE32(transaction_id + 4) ^
+         rtc::GetBE32(transaction_id + 8);
+}
+
+const char* StunMessageView::FindAttribute(int type, size_t* length) const {
+  size_t pos = kStunHeaderSize;
+  while (pos < size_) {
+    size_t attr_length = rtc::GetBE16(data_ + pos + 2);
+    if (rtc::GetBE16(data_ + pos) == type) {
+      *length = attr_length;
+      return data_ + pos + kStunAttributeHeaderSize;
+    }
+    pos += kStunAttributeHeaderSize + ((attr_length + 3) & ~size_t{3});
+  }
+  return nullptr;
+}
+
+bool StunMessageView::HasAttribute(int type) const {
+  size_t length;
+  return FindAttribute(type, &length) != nullptr;
+}
+
+bool StunMessageView::GetAttribute(
+    int type,
+    rtc::ArrayView<const uint8_t>* value) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  if (!attr) {
+    return false;
+  }
+  *value = rtc::ArrayView<const uint8_t>(
+      reinterpret_cast<const uint8_t*>(attr), length);
+  return true;
+}
+
+bool StunMessageView::GetByteString(int type, absl::string_view* value) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  if (!attr) {
+    return false;
+  }
+  *value = absl::string_view(attr, length);
+  return true;
+}
+
+bool StunMessageView::GetUInt32(int type, uint32_t* value) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  if (!attr || length != StunUInt32Attribute::SIZE) {
+    return false;
+  }
+  *value = rtc::GetBE32(attr);
+  return true;
+}
+
+bool StunMessageView::GetUInt64(int type, uint64_t* value) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  if (!attr || length != StunUInt64Attribute::SIZE) {
+    return false;
+  }
+  *value = rtc::GetBE64(attr);
+  return true;
+}
+
+bool StunMessageView::GetAddress(int type, rtc::SocketAddress* address) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  return attr && ReadAddressValue(attr, length, /*xored=*/false,
+                                  transaction_id(), address);
+}
+
+bool StunMessageView::GetXorAddress(int type,
+                                    rtc::SocketAddress* address) const {
+  size_t length;
+  const char* attr = FindAttribute(type, &length);
+  return attr && ReadAddressValue(attr, length, /*xored=*/true,
+                                  transaction_id(), address);
+}
+
+int StunMessageView::GetErrorCodeValue() const {
+  size_t length;
+  const char* attr = FindAttribute(STUN_ATTR_ERROR_CODE, &length);
+  if (!attr || length < StunErrorCodeAttribute::MIN_SIZE) {
+    return STUN_ERROR_GLOBAL_FAILURE;
+  }
+  uint32_t value = rtc::GetBE32(attr);
+  return ((value >> 8) & 0x7) * 100 + (value & 0xff);
+}
+
+StunMessage::IntegrityStatus StunMessageView::ValidateMessageIntegrity(
+    absl::string_view password) const {
+  int mi_attr_type = STUN_ATTR_MESSAGE_INTEGRITY;
+  size_t mi_attr_size = kStunMessageIntegritySize;
+  size_t length;
+  const char* mi = FindAttribute(mi_attr_type, &length);
+  if (!mi) {
+    mi_attr_type = STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32;
+    mi_attr_size = kStunMessageIntegrity32Size;
+    mi = FindAttribute(mi_attr_type, &length);
+    if (!mi) {
+      return StunMessage::IntegrityStatus::kNoIntegrity;
+    }
+  }
+  char hmac[kStunMessageIntegritySize];
+  if (length != mi_attr_size ||
+      !ComputeMessageIntegrity(password, data_,
+                               mi - kStunAttributeHeaderSize - data_,
+                               mi_attr_size, hmac) ||
+      memcmp(mi, hmac, mi_attr_size) != 0) {
+    return StunMessage::IntegrityStatus::kIntegrityBad;
+  }
+  return StunMessage::IntegrityStatus::kIntegrityOk;
+}
+
+// StunMessageWriter
+
+StunMessageWriter::StunMessageWriter(rtc::ArrayView<char> buffer,
+                                     int type,
+                                     absl::string_view transaction_id)
+    : buffer_(buffer) {
+  RTC_DCHECK_EQ(transaction_id.size(), kStunTransactionIdLength);
+  if (buffer_.size() < kStunHeaderSize) {
+    return;
+  }
+  rtc::SetBE16(buffer_.data(), static_cast<uint16_t>(type));
+  rtc::SetBE16(buffer_.data() + 2, 0);
+  rtc::SetBE32(buffer_.data() + kStunTransactionIdOffset -
+                   kStunMagicCookieLength,
+               kStunMagicCookie);
+  memcpy(buffer_.data() + kStunTransactionIdOffset, transaction_id.data(),
+         kStunTransactionIdLength);
+  size_ = kStunHeaderSize;
+}
+
+char* StunMessageWriter::AppendAttribute(int type, size_t length) {
+  size_t padded_length = (length + 3) & ~size_t{3};
+  size_t new_size = size_ + kStunAttributeHeaderSize + padded_length;
+  if (size_ == 0 || new_size > buffer_.size() ||
+      new_size - kStunHeaderSize > 0xFFFF) {
+    return nullptr;
+  }
+  char* attr = buffer_.data() + size_;
+  rtc::SetBE16(attr, static_cast<uint16_t>(type));
+  rtc::SetBE16(attr + 2, static_cast<uint16_t>(length));
+  char* value = attr + kStunAttributeHeaderSize;
+  memset(value + length, 0, padded_length - length);
+  size_ = new_size;
+  rtc::SetBE16(buffer_.data() + 2,
+               static_cast<uint16_t>(size_ - kStunHeaderSize));
+  return value;
+}
+
+bool StunMessageWriter::AddByteString(int type, absl::string_view value) {
+  if (!LengthValid(type, static_cast<int>(value.size()))) {
+    return false;
+  }
+  char* attr = AppendAttribute(type, value.size());
+  if (!attr) {
+    return false;
+  }
+  memcpy(attr, value.data(), value.size());
+  return true;
+}
+
+bool StunMessageWriter::AddUInt32(int type, uint32_t value) {
+  char* attr = AppendAttribute(type, StunUInt32Attribute::SIZE);
+  if (!attr) {
+    return false;
+  }
+  rtc::SetBE32(attr, value);
+  return true;
+}
+
+bool StunMessageWriter::AddUInt64(int type, uint64_t value) {
+  char* attr = AppendAttribute(type, StunUInt64Attribute::SIZE);
+  if (!attr) {
+    return false;
+  }
+  rtc::SetBE64(attr, value);
+  return true;
+}
+
+bool StunMessageWriter::AddUInt16List(int type,
+                                      rtc::ArrayView<const uint16_t> values) {
+  char* attr = AppendAttribute(type, values.size() * 2);
+  if (!attr) {
+    return false;
+  }
+  for (uint16_t value : values) {
+    rtc::SetBE16(attr, value);
+    attr += 2;
+  }
+  return true;
+}
+
+bool StunMessageWriter::AddAddress(int type,
+                                   const rtc::SocketAddress& address) {
+  size_t length;
+  if (!AddressValueLength(address, &length)) {
+    return false;
+  }
+  char* attr = AppendAttribute(type, length);
+  if (!attr) {
+    return false;
+  }
+  WriteAddressValue(address, /*xored=*/false, absl::string_view(), attr);
+  return true;
+}
+
+bool StunMessageWriter::AddXorAddress(int type,
+                                      const rtc::SocketAddress& address) {
+  size_t length;
+  if (!AddressValueLength(address, &length)) {
+    return false;
+  }
+  char* attr = AppendAttribute(type, length);
+  if (!attr) {
+    return false;
+  }
+  WriteAddressValue(address, /*xored=*/true,
+                    absl::string_view(buffer_.data() + kStunTransactionIdOffset,
+                                      kStunTransactionIdLength),
+                    attr);
+  return true;
+}
+
+bool StunMessageWriter::AddErrorCode(int code, absl::string_view reason) {
+  char* attr = AppendAttribute(
+      STUN_ATTR_ERROR_CODE, StunErrorCodeAttribute::MIN_SIZE + reason.size());
+  if (!attr) {
+    return false;
+  }
+  rtc::SetBE32(attr, ((code / 100) << 8) | (code % 100));
+  memcpy(attr + StunErrorCodeAttribute::MIN_SIZE, reason.data(),
+         reason.size());
+  return true;
+}
+
+bool StunMessageWriter::AddMessageIntegrity(absl::string_view password) {
+  return AddMessageIntegrityOfType(STUN_ATTR_MESSAGE_INTEGRITY,
+                                   kStunMessageIntegritySize, password);
+}
+
+bool StunMessageWriter::AddMessageIntegrity32(absl::string_view password) {
+  return AddMessageIntegrityOfType(STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32,
+                                   kStunMessageIntegrity32Size, password);
+}
+
+bool StunMessageWriter::AddMessageIntegrityOfType(int type,
+                                                  size_t size,
+                                                  absl::string_view password) {
+  size_t mi_pos = size_;
+  char* attr = AppendAttribute(type, size);
+  if (!attr) {
+    return false;
+  }
+  char hmac[kStunMessageIntegritySize];
+  if (!ComputeMessageIntegrity(password, buffer_.data(), mi_pos, size, hmac)) {
+    RTC_LOG(LS_ERROR) << "HMAC computation failed.";
+    size_ = mi_pos;
+    rtc::SetBE16(buffer_.data() + 2,
+                 static_cast<uint16_t>(size_ - kStunHeaderSize));
+    return false;
+  }
+  memcpy(attr, hmac, size);
+  return true;
+}
+
+bool StunMessageWriter::AddFingerprint() {
+  size_t fingerprint_pos = size_;
+  char* attr =
+      AppendAttribute(STUN_ATTR_FINGERPRINT, StunUInt32Attribute::SIZE);
+  if (!attr) {
+    return false;
+  }
+  rtc::SetBE32(attr, rtc::ComputeCrc32(buffer_.data(), fingerprint_pos) ^
+                         STUN_FINGERPRINT_XOR_VALUE);
+  return true;
+}
+
 StunAttributeValueType RelayMessage::GetAttributeValueType(int type) const {
   switch (type) {
     case STUN_ATTR_LIFETIME:
@@ -605,6 +605,107 @@ std::unique_ptr<StunAttribute> CopyStunAttribute(
     const StunAttribute& attribute,
     rtc::ByteBufferWriter* tmp_buffer_ptr = 0);
 
+// Reads a STUN message in place, for the hot path of connectivity checks.
+// Unlike StunMessage, nothing is copied and no attribute objects are created:
+// Parse() validates the framing of the message once, and the Get* methods
+// then look the attributes up in the caller's buffer, which must outlive the
+// view. Only RFC 5389 messages are supported; legacy RFC 3489 messages, which
+// lack the magic cookie, must be parsed with StunMessage.
+class StunMessageView {
+ public:
+  StunMessageView() = default;
+
+  // Returns true if `data` holds exactly one well-formed STUN message. The
+  // view is left empty otherwise.
+  bool Parse(const char* data, size_t size);
+
+  bool empty() const { return data_ == nullptr; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  int type() const;
+  // The length of the attributes, as in the header of the message.
+  size_t length() const;
+  absl::string_view transaction_id() const;
+  uint32_t reduced_transaction_id() const;
+
+  // Each of these reads the first attribute of `type`, like the Get* methods
+  // of StunMessage, and returns false if there is none or if it is malformed.
+  bool HasAttribute(int type) const;
+  bool GetAttribute(int type, rtc::ArrayView<const uint8_t>* value) const;
+  bool GetByteString(int type, absl::string_view* value) const;
+  bool GetUInt32(int type, uint32_t* value) const;
+  bool GetUInt64(int type, uint64_t* value) const;
+  bool GetAddress(int type, rtc::SocketAddress* address) const;
+  bool GetXorAddress(int type, rtc::SocketAddress* address) const;
+
+  // Returns the code inside the error code attribute, if present, and
+  // STUN_ERROR_GLOBAL_FAILURE otherwise.
+  int GetErrorCodeValue() const;
+
+  // Validates the MESSAGE-INTEGRITY, or failing that the
+  // GOOG-MESSAGE-INTEGRITY-32, attribute like
+  // StunMessage::ValidateMessageIntegrity, but hashes the message in place.
+  StunMessage::IntegrityStatus ValidateMessageIntegrity(
+      absl::string_view password) const;
+
+  bool ValidateFingerprint() const {
+    return StunMessage::ValidateFingerprint(data_, size_);
+  }
+
+ private:
+  // Returns the value of the first attribute of `type` and sets `length` to
+  // its unpadded length, or returns null if there is none.
+  const char* FindAttribute(int type, size_t* length) const;
+
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Writes a STUN message into a caller-provided buffer, without building a
+// StunMessage. The length in the header is updated by each Add* method, so
+// the first size() bytes of the buffer always hold a complete message. Each
+// Add* method returns false, and leaves the message unchanged, if the
+// attribute does not fit in the buffer.
+class StunMessageWriter {
+ public:
+  // `transaction_id` must be kStunTransactionIdLength bytes long.
+  StunMessageWriter(rtc::ArrayView<char> buffer,
+                    int type,
+                    absl::string_view transaction_id);
+
+  // The size of the message written so far, or 0 if not even the header fits
+  // in the buffer.
+  size_t size() const { return size_; }
+  const char* data() const { return buffer_.data(); }
+
+  bool AddByteString(int type, absl::string_view value);
+  bool AddUInt32(int type, uint32_t value);
+  bool AddUInt64(int type, uint64_t value);
+  bool AddUInt16List(int type, rtc::ArrayView<const uint16_t> values);
+  bool AddAddress(int type, const rtc::SocketAddress& address);
+  bool AddXorAddress(int type, const rtc::SocketAddress& address);
+  bool AddErrorCode(int code, absl::string_view reason);
+
+  // Like the methods of StunMessage, these hash the message written so far,
+  // so they must follow all attributes but the FINGERPRINT.
+  bool AddMessageIntegrity(absl::string_view password);
+  bool AddMessageIntegrity32(absl::string_view password);
+  bool AddFingerprint();
+
+ private:
+  // Appends the header of an attribute with room for `length` bytes of value,
+  // zeroing the padding, and returns where to write the value. Returns null
+  // if the attribute does not fit.
+  char* AppendAttribute(int type, size_t length);
+  bool AddMessageIntegrityOfType(int type,
+                                 size_t size,
+                                 absl::string_view password);
+
+  const rtc::ArrayView<char> buffer_;
+  size_t size_ = 0;
+};
+
 // TODO(?): Move the TURN/ICE stuff below out to separate files.
 extern const char TURN_MAGIC_COOKIE_VALUE[4];
 
@@ -10,6 +10,7 @@
 
 #include "api/transport/stun.h"
 
+#include <stdio.h>
 #include <string.h>
 
 #include <memory>
@@ -20,6 +21,7 @@
 #include "rtc_base/byte_buffer.h"
 #include "rtc_base/byte_order.h"
 #include "rtc_base/socket_address.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 namespace cricket {
@@ -1915,4 +1917,282 @@ TEST_F(StunTest, SizeRestrictionOnAttributes) {
   ASSERT_FALSE(msg.Write(&out));
 }
 
+TEST_F(StunTest, StunMessageViewMatchesStunMessage) {
+  const rtc::ArrayView<const unsigned char> messages[] = {
+      kRfc5769SampleRequest,
+      kRfc5769SampleResponse,
+      kRfc5769SampleResponseIPv6,
+      kRfc5769SampleRequestLongTermAuth,
+      kSampleRequestMI32,
+      kStunMessageWithIPv4XorMappedAddress,
+      kStunMessageWithIPv6XorMappedAddress,
+      kStunMessageWithPaddedByteStringAttribute,
+      kStunMessageWithUnknownAttribute,
+      kStunMessageWithErrorAttribute};
+  for (rtc::ArrayView<const unsigned char> message : messages) {
+    const char* data = reinterpret_cast<const char*>(message.data());
+    StunMessage msg;
+    rtc::ByteBufferReader buf(data, message.size());
+    ASSERT_TRUE(msg.Read(&buf));
+    StunMessageView view;
+    ASSERT_TRUE(view.Parse(data, message.size()));
+    EXPECT_EQ(msg.type(), view.type());
+    EXPECT_EQ(msg.length(), view.length());
+    EXPECT_EQ(msg.transaction_id(), view.transaction_id());
+    EXPECT_EQ(msg.reduced_transaction_id(), view.reduced_transaction_id());
+    EXPECT_EQ(msg.GetErrorCodeValue(), view.GetErrorCodeValue());
+  }
+}
+
+TEST_F(StunTest, StunMessageViewReadsRfc5769Request) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_EQ(STUN_BINDING_REQUEST, view.type());
+
+  absl::string_view username;
+  ASSERT_TRUE(view.GetByteString(STUN_ATTR_USERNAME, &username));
+  EXPECT_EQ(kRfc5769SampleMsgUsername, username);
+  absl::string_view software;
+  ASSERT_TRUE(view.GetByteString(STUN_ATTR_SOFTWARE, &software));
+  EXPECT_EQ(kRfc5769SampleMsgClientSoftware, software);
+  uint32_t priority;
+  ASSERT_TRUE(view.GetUInt32(STUN_ATTR_PRIORITY, &priority));
+  EXPECT_EQ(0x6E0001FFu, priority);
+  uint64_t tie_breaker;
+  ASSERT_TRUE(view.GetUInt64(STUN_ATTR_ICE_CONTROLLED, &tie_breaker));
+  EXPECT_EQ(0x932FF9B151263B36u, tie_breaker);
+  EXPECT_FALSE(view.HasAttribute(STUN_ATTR_USE_CANDIDATE));
+  // Wrong sizes are rejected.
+  EXPECT_FALSE(view.GetUInt32(STUN_ATTR_ICE_CONTROLLED, &priority));
+
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityBad,
+            view.ValidateMessageIntegrity("InvalidPassword"));
+  EXPECT_TRUE(view.ValidateFingerprint());
+}
+
+TEST_F(StunTest, StunMessageViewValidatesMessageIntegrity32) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kSampleRequestMI32),
+                         sizeof(kSampleRequestMI32)));
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityBad,
+            view.ValidateMessageIntegrity("InvalidPassword"));
+
+  ASSERT_TRUE(view.Parse(
+      reinterpret_cast<const char*>(kRfc5769SampleRequestWithoutMI),
+      sizeof(kRfc5769SampleRequestWithoutMI)));
+  EXPECT_EQ(StunMessage::IntegrityStatus::kNoIntegrity,
+            view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+}
+
+TEST_F(StunTest, StunMessageViewReadsXorAddresses) {
+  StunMessageView view;
+  rtc::SocketAddress address;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleResponse),
+                         sizeof(kRfc5769SampleResponse)));
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(kRfc5769SampleMsgMappedAddress, address);
+
+  ASSERT_TRUE(
+      view.Parse(reinterpret_cast<const char*>(kRfc5769SampleResponseIPv6),
+                 sizeof(kRfc5769SampleResponseIPv6)));
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(kRfc5769SampleMsgIPv6MappedAddress, address);
+
+  ASSERT_TRUE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithIPv4MappedAddress),
+      sizeof(kStunMessageWithIPv4MappedAddress)));
+  ASSERT_TRUE(view.GetAddress(STUN_ATTR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(rtc::SocketAddress(rtc::IPAddress(kIPv4TestAddress1),
+                               kTestMessagePort4),
+            address);
+}
+
+TEST_F(StunTest, StunMessageViewRejectsInvalidMessages) {
+  StunMessageView view;
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithZeroLength),
+      kRealLengthOfInvalidLengthTestCases));
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+      kRealLengthOfInvalidLengthTestCases));
+  EXPECT_FALSE(view.Parse(
+      reinterpret_cast<const char*>(kStunMessageWithSmallLength),
+      kRealLengthOfInvalidLengthTestCases));
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRtcpPacket),
+                          sizeof(kRtcpPacket)));
+  // Truncated in the middle of the last attribute.
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                          sizeof(kRfc5769SampleRequest) - 4));
+  EXPECT_TRUE(view.empty());
+}
+
+TEST_F(StunTest, StunMessageWriterMatchesStunMessage) {
+  const std::string transaction_id(
+      reinterpret_cast<const char*>(kTestTransactionId1),
+      kStunTransactionIdLength);
+  const rtc::SocketAddress v4_address(rtc::IPAddress(kIPv4TestAddress1),
+                                      kTestMessagePort1);
+  const rtc::SocketAddress v6_address(rtc::IPAddress(kIPv6TestAddress1),
+                                      kTestMessagePort2);
+  const uint16_t misc_info[] = {0x1, 0xAB0C, 0x1000};
+
+  IceMessage msg;
+  msg.SetType(STUN_BINDING_REQUEST);
+  msg.SetTransactionID(transaction_id);
+  msg.AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, kRfc5769SampleMsgUsername));
+  msg.AddAttribute(
+      std::make_unique<StunUInt32Attribute>(STUN_ATTR_PRIORITY, 0x6E0001FF));
+  msg.AddAttribute(std::make_unique<StunUInt64Attribute>(
+      STUN_ATTR_ICE_CONTROLLING, 0x932FF9B151263B36));
+  msg.AddAttribute(
+      std::make_unique<StunByteStringAttribute>(STUN_ATTR_USE_CANDIDATE));
+  msg.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_MAPPED_ADDRESS, v4_address));
+  // A message may repeat an attribute; only the first one is read.
+  msg.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+      STUN_ATTR_XOR_MAPPED_ADDRESS, v6_address));
+  msg.AddAttribute(std::make_unique<StunAddressAttribute>(
+      STUN_ATTR_MAPPED_ADDRESS, v6_address));
+  auto list =
+      StunAttribute::CreateUInt16ListAttribute(STUN_ATTR_GOOG_MISC_INFO);
+  for (uint16_t value : misc_info)
+    list->AddType(value);
+  msg.AddAttribute(std::move(list));
+  ASSERT_TRUE(msg.AddMessageIntegrity(kRfc5769SampleMsgPassword));
+  ASSERT_TRUE(msg.AddFingerprint());
+  rtc::ByteBufferWriter expected;
+  ASSERT_TRUE(msg.Write(&expected));
+
+  char buffer[1200];
+  StunMessageWriter writer(buffer, STUN_BINDING_REQUEST, transaction_id);
+  EXPECT_TRUE(
+      writer.AddByteString(STUN_ATTR_USERNAME, kRfc5769SampleMsgUsername));
+  EXPECT_TRUE(writer.AddUInt32(STUN_ATTR_PRIORITY, 0x6E0001FF));
+  EXPECT_TRUE(writer.AddUInt64(STUN_ATTR_ICE_CONTROLLING, 0x932FF9B151263B36));
+  EXPECT_TRUE(writer.AddByteString(STUN_ATTR_USE_CANDIDATE, ""));
+  EXPECT_TRUE(writer.AddXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, v4_address));
+  EXPECT_TRUE(writer.AddXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, v6_address));
+  EXPECT_TRUE(writer.AddAddress(STUN_ATTR_MAPPED_ADDRESS, v6_address));
+  EXPECT_TRUE(writer.AddUInt16List(STUN_ATTR_GOOG_MISC_INFO, misc_info));
+  EXPECT_TRUE(writer.AddMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_TRUE(writer.AddFingerprint());
+  ASSERT_EQ(expected.Length(), writer.size());
+  EXPECT_EQ(0, memcmp(expected.Data(), writer.data(), writer.size()));
+
+  // And the view reads back what was written.
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(writer.data(), writer.size()));
+  rtc::SocketAddress address;
+  ASSERT_TRUE(view.GetXorAddress(STUN_ATTR_XOR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(v4_address, address);
+  ASSERT_TRUE(view.GetAddress(STUN_ATTR_MAPPED_ADDRESS, &address));
+  EXPECT_EQ(v6_address, address);
+  EXPECT_EQ(StunMessage::IntegrityStatus::kIntegrityOk,
+            view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_TRUE(view.ValidateFingerprint());
+}
+
+TEST_F(StunTest, StunMessageWriterMatchesStunMessageWithIntegrity32) {
+  const std::string transaction_id(
+      reinterpret_cast<const char*>(kTestTransactionId2),
+      kStunTransactionIdLength);
+  StunMessage msg;
+  msg.SetType(STUN_BINDING_ERROR_RESPONSE);
+  msg.SetTransactionID(transaction_id);
+  auto error_code = StunAttribute::CreateErrorCode();
+  error_code->SetCode(kTestErrorCode);
+  error_code->SetReason(kTestErrorReason);
+  msg.AddAttribute(std::move(error_code));
+  ASSERT_TRUE(msg.AddMessageIntegrity32(kRfc5769SampleMsgPassword));
+  rtc::ByteBufferWriter expected;
+  ASSERT_TRUE(msg.Write(&expected));
+
+  char buffer[1200];
+  StunMessageWriter writer(buffer, STUN_BINDING_ERROR_RESPONSE,
+                           transaction_id);
+  EXPECT_TRUE(writer.AddErrorCode(kTestErrorCode, kTestErrorReason));
+  EXPECT_TRUE(writer.AddMessageIntegrity32(kRfc5769SampleMsgPassword));
+  ASSERT_EQ(expected.Length(), writer.size());
+  EXPECT_EQ(0, memcmp(expected.Data(), writer.data(), writer.size()));
+}
+
+TEST_F(StunTest, StunMessageWriterKeepsMessageIfAttributeDoesNotFit) {
+  const std::string transaction_id(
+      reinterpret_cast<const char*>(kTestTransactionId1),
+      kStunTransactionIdLength);
+  char buffer[kStunHeaderSize + 8];
+  StunMessageWriter writer(buffer, STUN_BINDING_REQUEST, transaction_id);
+  EXPECT_TRUE(writer.AddUInt32(STUN_ATTR_PRIORITY, 1));
+  EXPECT_FALSE(writer.AddUInt32(STUN_ATTR_NOMINATION, 1));
+  EXPECT_FALSE(writer.AddMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_EQ(kStunHeaderSize + 8, writer.size());
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(writer.data(), writer.size()));
+  EXPECT_TRUE(view.HasAttribute(STUN_ATTR_PRIORITY));
+  EXPECT_FALSE(view.HasAttribute(STUN_ATTR_NOMINATION));
+
+  // Attributes that StunMessage refuses to write are refused too.
+  char large_buffer[1200];
+  StunMessageWriter large_writer(large_buffer, STUN_BINDING_REQUEST,
+                                 transaction_id);
+  EXPECT_FALSE(
+      large_writer.AddByteString(STUN_ATTR_USERNAME, std::string(509, 'x')));
+  EXPECT_EQ(kStunHeaderSize, large_writer.size());
+}
+
+// Compares the cost of reading an incoming connectivity check the way
+// Port::GetStunMessage does, with a StunMessage, to reading it with a
+// StunMessageView. Disabled by default; run with
+// --gtest_also_run_disabled_tests.
+TEST_F(StunTest, DISABLED_ConnectivityCheckParsingPerformance) {
+  constexpr int kNumIterations = 200000;
+  const char* data = reinterpret_cast<const char*>(kRfc5769SampleRequest);
+  const size_t size = sizeof(kRfc5769SampleRequest);
+
+  int64_t start_ns = rtc::TimeNanos();
+  int num_ok = 0;
+  for (int i = 0; i < kNumIterations; ++i) {
+    if (!StunMessage::ValidateFingerprint(data, size))
+      continue;
+    IceMessage msg;
+    rtc::ByteBufferReader buf(data, size);
+    if (!msg.Read(&buf) || !msg.GetByteString(STUN_ATTR_USERNAME) ||
+        !msg.GetUInt32(STUN_ATTR_PRIORITY))
+      continue;
+    if (msg.ValidateMessageIntegrity(kRfc5769SampleMsgPassword) ==
+        StunMessage::IntegrityStatus::kIntegrityOk)
+      ++num_ok;
+  }
+  const int64_t message_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(kNumIterations, num_ok);
+
+  start_ns = rtc::TimeNanos();
+  num_ok = 0;
+  for (int i = 0; i < kNumIterations; ++i) {
+    StunMessageView view;
+    absl::string_view username;
+    uint32_t priority;
+    if (!view.Parse(data, size) || !view.ValidateFingerprint() ||
+        !view.GetByteString(STUN_ATTR_USERNAME, &username) ||
+        !view.GetUInt32(STUN_ATTR_PRIORITY, &priority))
+      continue;
+    if (view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword) ==
+        StunMessage::IntegrityStatus::kIntegrityOk)
+      ++num_ok;
+  }
+  const int64_t view_ns = rtc::TimeNanos() - start_ns;
+  EXPECT_EQ(kNumIterations, num_ok);
+
+  printf("StunMessage:     %.0f ns per check\n",
+         static_cast<double>(message_ns) / kNumIterations);
+  printf("StunMessageView: %.0f ns per check\n",
+         static_cast<double>(view_ns) / kNumIterations);
+}
+
 }  // namespace cricket
@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef API_VIDEO_VIDEO_ENCODE_SCHEDULER_H_
+#define API_VIDEO_VIDEO_ENCODE_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+
+namespace webrtc {
+
+// Shares the cores of a host between the encoders of many video streams, e.g.,
+// on a server transcoding a large number of outgoing streams. The scheduler
+// limits how many frames are encoded at the same time and how many threads
+// each encoder may use, so that the encoders together do not oversubscribe
+// the cores.
+//
+// Implementations must be thread-safe.
+class VideoEncodeScheduler {
+ public:
+  // Order in which waiting frames get to encode, highest priority first.
+  enum class Priority { kKeyFrame, kLowLatency, kNormal };
+
+  struct Metrics {
+    int registered_streams = 0;
+    // Frames being encoded, and frames waiting for their turn.
+    int running_encodes = 0;
+    int queued_encodes = 0;
+    int max_queued_encodes = 0;
+    // Frames encoded, and how many of them had to wait.
+    int64_t encodes = 0;
+    int64_t delayed_encodes = 0;
+    int64_t total_wait_time_us = 0;
+    int64_t max_wait_time_us = 0;
+  };
+
+  // Receives the decisions of the scheduler for a stream. Its methods are
+  // called on the task queue given to RegisterStream().
+  class StreamObserver {
+   public:
+    // The frame queued by Stream::BeginEncode() may now be encoded.
+    virtual void OnEncodeAllowed() = 0;
+    // Stream::NumberOfCores() changed. Initializing the encoder again costs a
+    // key frame, so the new number is best applied when the encoder is
+    // initialized anyway or a key frame is sent.
+    virtual void OnNumberOfCoresChanged() = 0;
+
+   protected:
+    virtual ~StreamObserver() = default;
+  };
+
+  // Handle of a stream registered with the scheduler. Unregisters the stream
+  // when destroyed, which also gives back the encodes it was allowed.
+  class Stream {
+   public:
+    virtual ~Stream() = default;
+
+    // Number of threads the encoder of the stream may use, to be passed in
+    // VideoEncoder::Settings. May change as streams come and go.
+    virtual int NumberOfCores() const = 0;
+
+    // Returns true if the stream may encode a frame right away. Otherwise the
+    // frame is queued, and StreamObserver::OnEncodeAllowed() is called once
+    // it may be encoded. Either way, EndEncode() must be called once the frame
+    // is encoded. A stream may only have one frame queued at a time.
+    virtual bool BeginEncode(Priority priority) = 0;
+    virtual void EndEncode() = 0;
+  };
+
+  virtual ~VideoEncodeScheduler() = default;
+
+  // `observer` must outlive the returned stream, and is called on
+  // `task_queue`.
+  virtual std::unique_ptr<Stream> RegisterStream(
+      TaskQueueBase* task_queue,
+      StreamObserver* observer) = 0;
+
+  virtual Metrics GetMetrics() const = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // API_VIDEO_VIDEO_ENCODE_SCHEDULER_H_
@@ -14,6 +14,7 @@
 #include <string>
 
 #include "api/video/video_bitrate_allocator_factory.h"
+#include "api/video/video_encode_scheduler.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
 
@@ -56,6 +57,11 @@ struct VideoStreamEncoderSettings {
   // Ownership stays with WebrtcVideoEngine (delegated from PeerConnection).
   VideoBitrateAllocatorFactory* bitrate_allocator_factory = nullptr;
 
+  // Optional scheduler shared with the other streams of the process. When set,
+  // it decides how many cores the encoder uses and when frames are encoded.
+  // Must outlive the VideoStreamEncoder.
+  VideoEncodeScheduler* encode_scheduler = nullptr;
+
   // Negotiated capabilities which the VideoEncoder may expect the other
   // side to use.
   VideoEncoder::Capabilities capabilities;
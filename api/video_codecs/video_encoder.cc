@@ -104,7 +104,8 @@ VideoEncoder::EncoderInfo::EncoderInfo()
           1,
           kMaxFramerateFraction)},
       supports_simulcast(false),
-      preferred_pixel_formats{VideoFrameBuffer::Type::kI420} {}
+      preferred_pixel_formats{VideoFrameBuffer::Type::kI420},
+      max_complexity_reduction(0) {}
 
 VideoEncoder::EncoderInfo::EncoderInfo(const EncoderInfo&) = default;
 
@@ -190,6 +191,7 @@ std::string VideoEncoder::EncoderInfo::ToString() const {
   if (is_qp_trusted.has_value()) {
     oss << ", is_qp_trusted = " << is_qp_trusted.value();
   }
+  oss << ", max_complexity_reduction = " << max_complexity_reduction;
   oss << "}";
   return oss.str();
 }
@@ -226,7 +228,8 @@ bool VideoEncoder::EncoderInfo::operator==(const EncoderInfo& rhs) const {
   }
 
   if (resolution_bitrate_limits != rhs.resolution_bitrate_limits ||
-      supports_simulcast != rhs.supports_simulcast) {
+      supports_simulcast != rhs.supports_simulcast ||
+      max_complexity_reduction != rhs.max_complexity_reduction) {
     return false;
   }
 
@@ -335,6 +338,8 @@ void VideoEncoder::OnRttUpdate(int64_t rtt_ms) {}
 void VideoEncoder::OnLossNotification(
     const LossNotification& loss_notification) {}
 
+void VideoEncoder::SetComplexityReduction(int steps) {}
+
 // TODO(webrtc:9722): Remove and make pure virtual.
 VideoEncoder::EncoderInfo VideoEncoder::GetEncoderInfo() const {
   return EncoderInfo();
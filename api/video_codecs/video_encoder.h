@@ -264,6 +264,11 @@ class RTC_EXPORT VideoEncoder {
     // Indicates whether or not QP value encoder writes into frame/slice/tile
     // header can be interpreted as average frame/slice/tile QP.
     absl::optional<bool> is_qp_trusted;
+
+    // The number of steps by which SetComplexityReduction() can make the
+    // encoder faster than the speed it was configured with, or 0 if the
+    // encoder can't change its speed at runtime.
+    int max_complexity_reduction;
   };
 
   struct RTC_EXPORT RateControlParameters {
@@ -421,6 +426,13 @@ class RTC_EXPORT VideoEncoder {
   // Called when a loss notification is received.
   virtual void OnLossNotification(const LossNotification& loss_notification);
 
+  // Asks the encoder to spend less CPU per frame, at the cost of compression
+  // efficiency, e.g., by raising the libvpx cpu-used setting. `steps` is the
+  // number of steps, up to `EncoderInfo::max_complexity_reduction`, above the
+  // speed the encoder was configured with; 0 restores that speed.
+  // InitEncode() resets it to 0.
+  virtual void SetComplexityReduction(int steps);
+
   // Returns meta-data about the encoder, such as implementation name.
   // The output of this method may change during runtime. For instance if a
   // hardware encoder fails, it may fall back to doing software encoding using
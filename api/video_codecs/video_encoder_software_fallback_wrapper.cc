@@ -140,6 +140,8 @@ class VideoEncoderSoftwareFallbackWrapper final : public VideoEncoder {
 
   void OnLossNotification(const LossNotification& loss_notification) override;
 
+  void SetComplexityReduction(int steps) override;
+
   void SetRates(const RateControlParameters& parameters) override;
 
   EncoderInfo GetEncoderInfo() const override;
@@ -182,6 +184,7 @@ class VideoEncoderSoftwareFallbackWrapper final : public VideoEncoder {
   absl::optional<int64_t> rtt_;
   FecControllerOverride* fec_controller_override_;
   absl::optional<LossNotification> loss_notification_;
+  int complexity_reduction_ = 0;
 
   enum class EncoderState {
     kUninitialized,
@@ -240,6 +243,9 @@ void VideoEncoderSoftwareFallbackWrapper::PrimeEncoder(
   if (loss_notification_.has_value()) {
     encoder->OnLossNotification(loss_notification_.value());
   }
+  if (complexity_reduction_ > 0) {
+    encoder->SetComplexityReduction(complexity_reduction_);
+  }
 }
 
 bool VideoEncoderSoftwareFallbackWrapper::InitFallbackEncoder(bool is_forced) {
@@ -290,6 +296,7 @@ int32_t VideoEncoderSoftwareFallbackWrapper::InitEncode(
   encoder_settings_ = settings;
   // Clear stored rate/channel parameters.
   rate_control_parameters_ = absl::nullopt;
+  complexity_reduction_ = 0;
 
   RTC_DCHECK_EQ(encoder_state_, EncoderState::kUninitialized)
       << "InitEncode() should never be called on an active instance!";
@@ -410,6 +417,11 @@ void VideoEncoderSoftwareFallbackWrapper::OnLossNotification(
   current_encoder()->OnLossNotification(loss_notification);
 }
 
+void VideoEncoderSoftwareFallbackWrapper::SetComplexityReduction(int steps) {
+  complexity_reduction_ = steps;
+  current_encoder()->SetComplexityReduction(steps);
+}
+
 VideoEncoder::EncoderInfo VideoEncoderSoftwareFallbackWrapper::GetEncoderInfo()
     const {
   EncoderInfo fallback_encoder_info = fallback_encoder_->GetEncoderInfo();
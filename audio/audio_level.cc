@@ -60,7 +60,10 @@ void AudioLevel::ComputeLevel(const AudioFrame& audioFrame, double duration) {
           : WebRtcSpl_MaxAbsValueW16(
                 audioFrame.data(),
                 audioFrame.samples_per_channel_ * audioFrame.num_channels_);
+  ComputeLevel(abs_value, duration);
+}
 
+void AudioLevel::ComputeLevel(int16_t abs_value, double duration) {
   // Protect member access using a lock since this method is called on a
   // dedicated audio thread in the RecordedDataIsAvailable() callback.
   MutexLock lock(&mutex_);
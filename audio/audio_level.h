@@ -56,6 +56,12 @@ class AudioLevel {
   // In Chrome, this method is called on the AudioInputDevice thread.
   void ComputeLevel(const AudioFrame& audioFrame, double duration);
 
+  // Same as ComputeLevel() for audio whose maximum absolute sample value over
+  // `duration` is already known. An RMS level, e.g., from the audio level RTP
+  // header extension, may be passed instead; see
+  // ChannelReceive::OnPassthroughPayloadData().
+  void ComputeLevel(int16_t abs_max, double duration);
+
  private:
   enum { kUpdateFrequency = 10 };
 
@@ -58,6 +58,9 @@ std::string AudioReceiveStream::Config::ToString() const {
   ss << "{rtp: " << rtp.ToString();
   ss << ", rtcp_send_transport: "
      << (rtcp_send_transport ? "(Transport)" : "null");
+  if (passthrough) {
+    ss << ", passthrough: on";
+  }
   if (!sync_group.empty()) {
     ss << ", sync_group: " << sync_group;
   }
@@ -142,6 +145,9 @@ AudioReceiveStream::AudioReceiveStream(
   channel_receive_->SetReceiveCodecs(config.decoder_map);
   // `frame_transformer` and `frame_decryptor` have been given to
   // `channel_receive_` already.
+  if (config.passthrough) {
+    channel_receive_->SetPassthrough(true);
+  }
 }
 
 AudioReceiveStream::~AudioReceiveStream() {
@@ -178,6 +184,7 @@ void AudioReceiveStream::ReconfigureForTesting(
   // Decoder factory cannot be changed because it is configured at
   // voe::Channel construction time.
   RTC_DCHECK_EQ(config_.decoder_factory, config.decoder_factory);
+  RTC_DCHECK_EQ(config_.passthrough, config.passthrough);
 
   // TODO(solenberg): Config NACK history window (which is a packet count),
   // using the actual packet size for the configured codec.
@@ -364,6 +371,10 @@ webrtc::AudioReceiveStream::Stats AudioReceiveStream::GetStats(
 void AudioReceiveStream::SetSink(AudioSinkInterface* sink) {
   RTC_DCHECK_RUN_ON(&worker_thread_checker_);
   channel_receive_->SetSink(sink);
+  if (config_.passthrough) {
+    // A sink needs decoded audio; decode for as long as one is set.
+    channel_receive_->SetPassthrough(sink == nullptr);
+  }
 }
 
 void AudioReceiveStream::SetGain(float gain) {
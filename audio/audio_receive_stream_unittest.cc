@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "api/call/audio_sink.h"
 #include "api/test/mock_audio_mixer.h"
 #include "api/test/mock_frame_decryptor.h"
 #include "audio/conversion.h"
@@ -335,6 +336,31 @@ TEST(AudioReceiveStreamTest, SetGain) {
   }
 }
 
+TEST(AudioReceiveStreamTest, PassthroughDecodesOnlyWhileSinkIsSet) {
+  class NullAudioSink : public AudioSinkInterface {
+   public:
+    void OnData(const Data& audio) override {}
+  };
+
+  for (bool use_null_audio_processing : {false, true}) {
+    ConfigHelper helper(use_null_audio_processing);
+    helper.config().passthrough = true;
+    MockChannelReceive& channel_receive = *helper.channel_receive();
+    EXPECT_CALL(channel_receive, SetPassthrough(true));
+    auto recv_stream = helper.CreateAudioReceiveStream();
+
+    NullAudioSink sink;
+    ::testing::InSequence s;
+    EXPECT_CALL(channel_receive, SetSink(&sink));
+    EXPECT_CALL(channel_receive, SetPassthrough(false));
+    EXPECT_CALL(channel_receive, SetSink(nullptr));
+    EXPECT_CALL(channel_receive, SetPassthrough(true));
+    recv_stream->SetSink(&sink);
+    recv_stream->SetSink(nullptr);
+    recv_stream->UnregisterFromTransport();
+  }
+}
+
 TEST(AudioReceiveStreamTest, StreamsShouldBeAddedToMixerOnceOnStart) {
   for (bool use_null_audio_processing : {false, true}) {
     ConfigHelper helper1(use_null_audio_processing);
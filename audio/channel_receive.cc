@@ -10,7 +10,11 @@
 
 #include "audio/channel_receive.h"
 
+#include <math.h>
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
@@ -40,6 +44,7 @@
 #include "modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl2.h"
 #include "modules/utility/include/process_thread.h"
+#include "rtc_base/buffer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/format_macros.h"
 #include "rtc_base/location.h"
@@ -64,6 +69,10 @@ constexpr double kAudioSampleDurationSeconds = 0.01;
 constexpr int kVoiceEngineMinMinPlayoutDelayMs = 0;
 constexpr int kVoiceEngineMaxMinPlayoutDelayMs = 10000;
 
+// Number of most recent payloads kept in pass-through mode, used to warm up
+// the decoder when decoding resumes.
+constexpr size_t kPassthroughHistorySize = 5;
+
 AudioCodingModule::Config AcmConfig(
     NetEqFactory* neteq_factory,
     rtc::scoped_refptr<AudioDecoderFactory> decoder_factory,
@@ -113,6 +122,7 @@ class ChannelReceive : public ChannelReceiveInterface,
 
   void StartPlayout() override;
   void StopPlayout() override;
+  void SetPassthrough(bool passthrough) override;
 
   // Codecs
   absl::optional<std::pair<int, SdpAudioFormat>> GetReceiveCodec()
@@ -209,6 +219,12 @@ class ChannelReceive : public ChannelReceiveInterface,
       rtc::scoped_refptr<webrtc::FrameTransformerInterface> frame_transformer)
       RTC_RUN_ON(worker_thread_checker_);
 
+  // Keeps `payload` for later decoding and updates the output audio level from
+  // the audio level header extension, if present.
+  void OnPassthroughPayloadData(rtc::ArrayView<const uint8_t> payload,
+                                const RTPHeader& rtpHeader)
+      RTC_RUN_ON(worker_thread_checker_);
+
   // Thread checkers document and lock usage of some methods to specific threads
   // we know about. The goal is to eventually split up voe::ChannelReceive into
   // parts with single-threaded semantics, and thereby reduce the need for
@@ -229,10 +245,27 @@ class ChannelReceive : public ChannelReceiveInterface,
 
   bool playing_ RTC_GUARDED_BY(worker_thread_checker_) = false;
 
+  // Only written on the worker thread, but also read on the audio thread so
+  // that no audio is pulled from the jitter buffer in pass-through mode.
+  std::atomic<bool> passthrough_{false};
+
+  struct PassthroughPacket {
+    RTPHeader header;
+    rtc::Buffer payload;
+  };
+  // Ring buffer with the most recent payloads received in pass-through mode.
+  // The payload buffers are reused to avoid per-packet allocations.
+  std::array<PassthroughPacket, kPassthroughHistorySize> passthrough_packets_
+      RTC_GUARDED_BY(worker_thread_checker_);
+  size_t num_passthrough_packets_ RTC_GUARDED_BY(worker_thread_checker_) = 0;
+  size_t next_passthrough_packet_ RTC_GUARDED_BY(worker_thread_checker_) = 0;
+
   RtcEventLog* const event_log_;
 
   // Indexed by payload type.
   std::map<uint8_t, int> payload_type_frequencies_;
+  std::map<int, SdpAudioFormat> receive_codecs_
+      RTC_GUARDED_BY(worker_thread_checker_);
 
   std::unique_ptr<ReceiveStatistics> rtp_receive_statistics_;
   std::unique_ptr<ModuleRtpRtcpImpl2> rtp_rtcp_;
@@ -315,9 +348,14 @@ class ChannelReceive : public ChannelReceiveInterface,
 void ChannelReceive::OnReceivedPayloadData(
     rtc::ArrayView<const uint8_t> payload,
     const RTPHeader& rtpHeader) {
-  if (!playing_) {
-    // Avoid inserting into NetEQ when we are not playing. Count the
-    // packet as discarded.
+  const bool passthrough = passthrough_.load(std::memory_order_relaxed);
+  if (playing_ && passthrough) {
+    OnPassthroughPayloadData(payload, rtpHeader);
+  }
+
+  if (!playing_ || passthrough) {
+    // Avoid inserting into NetEQ when we are not playing or not decoding.
+    // Count the packet as discarded.
 
     // If we have a source_tracker_, tell it that the frame has been
     // "delivered". Normally, this happens in AudioReceiveStream when audio
@@ -354,6 +392,39 @@ void ChannelReceive::OnReceivedPayloadData(
   }
 }
 
+void ChannelReceive::OnPassthroughPayloadData(
+    rtc::ArrayView<const uint8_t> payload,
+    const RTPHeader& rtpHeader) {
+  PassthroughPacket& packet = passthrough_packets_[next_passthrough_packet_];
+  if (num_passthrough_packets_ > 0) {
+    // Derive the duration of the previous packet from the RTP timestamps.
+    const PassthroughPacket& previous = passthrough_packets_
+        [(next_passthrough_packet_ + kPassthroughHistorySize - 1) %
+         kPassthroughHistorySize];
+    const auto it = payload_type_frequencies_.find(rtpHeader.payloadType);
+    const uint32_t elapsed = rtpHeader.timestamp - previous.header.timestamp;
+    if (previous.header.extension.hasAudioLevel &&
+        it != payload_type_frequencies_.end() && elapsed > 0 &&
+        elapsed <= static_cast<uint32_t>(it->second)) {
+      // The extension carries the RMS level in -dBov (RFC 6464), which is
+      // mapped onto the linear [0, 32767] range and used in place of the peak
+      // sample that decoded audio is measured by. The output level is thus
+      // lower than for decoded audio, by 3 dB for a sine wave, while the
+      // total energy follows the RMS level as the stats spec intends.
+      const int16_t level = static_cast<int16_t>(
+          32767 * pow(10.0, -previous.header.extension.audioLevel / 20.0));
+      _outputAudioLevel.ComputeLevel(
+          level, static_cast<double>(elapsed) / it->second);
+    }
+  }
+  packet.header = rtpHeader;
+  packet.payload.SetData(payload.data(), payload.size());
+  next_passthrough_packet_ =
+      (next_passthrough_packet_ + 1) % kPassthroughHistorySize;
+  num_passthrough_packets_ =
+      std::min(num_passthrough_packets_ + 1, kPassthroughHistorySize);
+}
+
 void ChannelReceive::InitFrameTransformerDelegate(
     rtc::scoped_refptr<webrtc::FrameTransformerInterface> frame_transformer) {
   RTC_DCHECK(frame_transformer);
@@ -381,6 +452,14 @@ AudioMixer::Source::AudioFrameInfo ChannelReceive::GetAudioFrameWithInfo(
   RTC_DCHECK_RUNS_SERIALIZED(&audio_thread_race_checker_);
   audio_frame->sample_rate_hz_ = sample_rate_hz;
 
+  if (passthrough_.load(std::memory_order_relaxed)) {
+    // Nothing is decoded in pass-through mode.
+    audio_frame->samples_per_channel_ = sample_rate_hz / 100;
+    audio_frame->num_channels_ = 1;
+    audio_frame->Mute();
+    return AudioMixer::Source::AudioFrameInfo::kMuted;
+  }
+
   event_log_->Log(std::make_unique<RtcEventAudioPlayout>(remote_ssrc_));
 
   // Get 10ms raw PCM data from the ACM (mixer limits output frequency)
@@ -616,9 +695,51 @@ void ChannelReceive::StopPlayout() {
   _outputAudioLevel.ResetLevelFullRange();
 }
 
+void ChannelReceive::SetPassthrough(bool passthrough) {
+  RTC_DCHECK_RUN_ON(&worker_thread_checker_);
+  if (passthrough == passthrough_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  passthrough_.store(passthrough, std::memory_order_relaxed);
+
+  if (passthrough) {
+    // The jitter buffer content will not be played out anymore.
+    acm_receiver_.FlushBuffers();
+    return;
+  }
+
+  // Hand the kept payloads, oldest first, to the jitter buffer so that the
+  // decoder state is rebuilt before audio is pulled again.
+  const size_t first =
+      (next_passthrough_packet_ + kPassthroughHistorySize -
+       num_passthrough_packets_) %
+      kPassthroughHistorySize;
+  for (size_t i = 0; i < num_passthrough_packets_; ++i) {
+    const PassthroughPacket& packet =
+        passthrough_packets_[(first + i) % kPassthroughHistorySize];
+    if (acm_receiver_.InsertPacket(packet.header, packet.payload) != 0) {
+      RTC_DLOG(LS_ERROR) << "ChannelReceive::SetPassthrough() unable to push "
+                            "data to the ACM";
+    }
+  }
+  num_passthrough_packets_ = 0;
+  next_passthrough_packet_ = 0;
+}
+
 absl::optional<std::pair<int, SdpAudioFormat>> ChannelReceive::GetReceiveCodec()
     const {
   RTC_DCHECK_RUN_ON(&worker_thread_checker_);
+  if (passthrough_.load(std::memory_order_relaxed) &&
+      num_passthrough_packets_ > 0) {
+    // Nothing has been decoded; report the format of the last kept payload.
+    const PassthroughPacket& last = passthrough_packets_
+        [(next_passthrough_packet_ + kPassthroughHistorySize - 1) %
+         kPassthroughHistorySize];
+    const auto it = receive_codecs_.find(last.header.payloadType);
+    if (it != receive_codecs_.end()) {
+      return std::make_pair(it->first, it->second);
+    }
+  }
   return acm_receiver_.LastDecoder();
 }
 
@@ -629,6 +750,7 @@ void ChannelReceive::SetReceiveCodecs(
     RTC_DCHECK_GE(kv.second.clockrate_hz, 1000);
     payload_type_frequencies_[kv.first] = kv.second.clockrate_hz;
   }
+  receive_codecs_ = codecs;
   acm_receiver_.SetCodecs(codecs);
 }
 
@@ -98,6 +98,13 @@ class ChannelReceiveInterface : public RtpPacketSinkInterface {
   virtual void StartPlayout() = 0;
   virtual void StopPlayout() = 0;
 
+  // In pass-through mode, received packets are not decoded; they only update
+  // the RTP receive statistics and the audio level from the RTP header
+  // extension, and the last few payloads are kept. When pass-through mode is
+  // left, the kept payloads are handed to the jitter buffer so that decoding
+  // resumes with a warmed-up decoder state.
+  virtual void SetPassthrough(bool passthrough) = 0;
+
   // Payload type and format of last received RTP packet, if any.
   virtual absl::optional<std::pair<int, SdpAudioFormat>> GetReceiveCodec()
       const = 0;
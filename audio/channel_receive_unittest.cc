@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "audio/channel_receive.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "api/audio/audio_frame.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/crypto/crypto_options.h"
+#include "api/crypto/frame_decryptor_interface.h"
+#include "api/rtc_event_log/rtc_event_log.h"
+#include "modules/audio_device/include/mock_audio_device.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/mock_transport.h"
+#include "test/run_loop.h"
+
+namespace webrtc {
+namespace voe {
+namespace {
+
+using ::testing::NiceMock;
+
+constexpr uint32_t kLocalSsrc = 1111;
+constexpr uint32_t kRemoteSsrc = 2222;
+constexpr int kPayloadType = 0;
+constexpr int kAudioLevelId = 1;
+// 20 ms of PCMU at 8 kHz.
+constexpr uint32_t kSamplesPerPacket = 160;
+// Number of payloads kept in pass-through mode.
+constexpr size_t kPassthroughHistorySize = 5;
+
+class ChannelReceiveTest : public ::testing::Test {
+ protected:
+  ChannelReceiveTest()
+      : clock_(1000),
+        audio_device_module_(
+            rtc::make_ref_counted<NiceMock<test::MockAudioDeviceModule>>()) {
+    extensions_.Register<AudioLevel>(kAudioLevelId);
+    channel_ = CreateChannelReceive(
+        &clock_, /*neteq_factory=*/nullptr, audio_device_module_.get(),
+        &transport_, &event_log_, kLocalSsrc, kRemoteSsrc,
+        /*jitter_buffer_max_packets=*/200,
+        /*jitter_buffer_fast_playout=*/false,
+        /*jitter_buffer_min_delay_ms=*/0,
+        /*jitter_buffer_enable_rtx_handling=*/false,
+        /*enable_non_sender_rtt=*/false, CreateBuiltinAudioDecoderFactory(),
+        /*codec_pair_id=*/absl::nullopt, /*frame_decryptor=*/nullptr,
+        CryptoOptions(), /*frame_transformer=*/nullptr);
+    channel_->SetReceiveCodecs({{kPayloadType, {"PCMU", 8000, 1}}});
+    channel_->StartPlayout();
+  }
+
+  // Receives a PCMU packet with the audio level extension set to
+  // `level_dbov`, whose samples all decode to a loud value.
+  void ReceivePacket(uint8_t level_dbov) {
+    RtpPacketReceived packet(&extensions_);
+    packet.SetPayloadType(kPayloadType);
+    packet.SetSequenceNumber(sequence_number_++);
+    packet.SetTimestamp(rtp_timestamp_);
+    packet.SetSsrc(kRemoteSsrc);
+    packet.SetExtension<AudioLevel>(/*voice_activity=*/true, level_dbov);
+    uint8_t* payload = packet.AllocatePayload(kSamplesPerPacket);
+    // In mu-law, 0x80 is the largest positive sample.
+    memset(payload, 0x80, kSamplesPerPacket);
+    packet.set_arrival_time_ms(clock_.TimeInMilliseconds());
+    channel_->OnRtpPacket(packet);
+    rtp_timestamp_ += kSamplesPerPacket;
+    clock_.AdvanceTimeMilliseconds(20);
+  }
+
+  test::RunLoop loop_;
+  SimulatedClock clock_;
+  rtc::scoped_refptr<test::MockAudioDeviceModule> audio_device_module_;
+  NiceMock<MockTransport> transport_;
+  RtcEventLogNull event_log_;
+  RtpHeaderExtensionMap extensions_;
+  std::unique_ptr<ChannelReceiveInterface> channel_;
+  uint16_t sequence_number_ = 1;
+  uint32_t rtp_timestamp_ = 1234;
+};
+
+TEST_F(ChannelReceiveTest, PassthroughOutputIsMuted) {
+  channel_->SetPassthrough(true);
+  for (int i = 0; i < 3; ++i) {
+    ReceivePacket(/*level_dbov=*/0);
+  }
+
+  AudioFrame frame;
+  EXPECT_EQ(AudioMixer::Source::AudioFrameInfo::kMuted,
+            channel_->GetAudioFrameWithInfo(48000, &frame));
+  EXPECT_TRUE(frame.muted());
+  EXPECT_EQ(480u, frame.samples_per_channel_);
+  // Nothing reached the jitter buffer.
+  EXPECT_EQ(0, channel_->GetNetworkStatistics(false).currentBufferSize);
+  EXPECT_EQ(kPayloadType, channel_->GetReceiveCodec()->first);
+}
+
+TEST_F(ChannelReceiveTest, PassthroughLevelAndEnergyFromAudioLevelExtension) {
+  channel_->SetPassthrough(true);
+  // The level of a packet is accounted for when the next one tells its
+  // duration, and AudioLevel publishes a new level every 11th update.
+  constexpr int kUpdates = 11;
+  for (int i = 0; i < kUpdates + 1; ++i) {
+    // -20 dBov is a tenth of full scale.
+    ReceivePacket(/*level_dbov=*/20);
+  }
+
+  EXPECT_EQ(3276, channel_->GetSpeechOutputLevelFullRange());
+  EXPECT_NEAR(kUpdates * 0.02, channel_->GetTotalOutputDuration(), 1e-9);
+  // Only the last update saw the published level.
+  const double level = 3276.0 / 32767;
+  EXPECT_NEAR(level * level * 0.02, channel_->GetTotalOutputEnergy(), 1e-9);
+}
+
+TEST_F(ChannelReceiveTest, LeavingPassthroughDecodesKeptPackets) {
+  channel_->SetPassthrough(true);
+  for (size_t i = 0; i < kPassthroughHistorySize + 2; ++i) {
+    ReceivePacket(/*level_dbov=*/0);
+  }
+
+  // The last packets kept are handed to the jitter buffer, with no packet
+  // received after pass-through mode is left.
+  channel_->SetPassthrough(false);
+  EXPECT_GT(channel_->GetNetworkStatistics(false).currentBufferSize, 0);
+
+  bool decoded_audio = false;
+  for (int i = 0; i < 10 && !decoded_audio; ++i) {
+    AudioFrame frame;
+    if (channel_->GetAudioFrameWithInfo(8000, &frame) !=
+            AudioMixer::Source::AudioFrameInfo::kNormal ||
+        frame.muted()) {
+      continue;
+    }
+    const int16_t* data = frame.data();
+    decoded_audio = std::any_of(data, data + frame.samples_per_channel_,
+                                [](int16_t sample) { return sample > 0; });
+  }
+  EXPECT_TRUE(decoded_audio);
+}
+
+}  // namespace
+}  // namespace voe
+}  // namespace webrtc
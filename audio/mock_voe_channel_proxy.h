@@ -95,6 +95,7 @@ class MockChannelReceive : public voe::ChannelReceiveInterface {
               (override));
   MOCK_METHOD(void, StartPlayout, (), (override));
   MOCK_METHOD(void, StopPlayout, (), (override));
+  MOCK_METHOD(void, SetPassthrough, (bool passthrough), (override));
   MOCK_METHOD(
       void,
       SetDepacketizerToDecoderFrameTransformer,
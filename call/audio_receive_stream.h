@@ -129,6 +129,14 @@ class AudioReceiveStream : public MediaReceiveStream {
     int jitter_buffer_min_delay_ms = 0;
     bool jitter_buffer_enable_rtx_handling = false;
 
+    // When true, received audio is only decoded while it is needed. Until
+    // then, packets only update the RTP receive statistics (e.g., jitter) and
+    // the audio level signaled in the RFC 6464 header extension, which makes
+    // streams that are forwarded rather than played out, e.g., by a relay
+    // server, cheap to receive. Decoding starts when a sink is set with
+    // SetSink() and stops again when the sink is cleared.
+    bool passthrough = false;
+
     // Identifier for an A/V synchronization group. Empty string to disable.
     // TODO(pbos): Synchronize streams in a sync group, not just one video
     // stream to one audio stream. Tracked by issue webrtc:4762.
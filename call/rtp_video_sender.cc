@@ -30,6 +30,7 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/location.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/ref_counted_object.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/trace_event.h"
 
@@ -192,6 +193,7 @@ std::vector<RtpStreamSender> CreateRtpStreamSenders(
     Transport* send_transport,
     RtcpBandwidthObserver* bandwidth_callback,
     RtpTransportControllerSendInterface* transport,
+    RtpPacketSender* packet_sender,
     const std::map<uint32_t, RtpState>& suspended_ssrcs,
     RtcEventLog* event_log,
     RateLimiter* retransmission_rate_limiter,
@@ -219,7 +221,7 @@ std::vector<RtpStreamSender> CreateRtpStreamSenders(
       observers.rtcp_type_observer;
   configuration.report_block_data_observer =
       observers.report_block_data_observer;
-  configuration.paced_sender = transport->packet_sender();
+  configuration.paced_sender = packet_sender;
   configuration.send_bitrate_observer = observers.bitrate_observer;
   configuration.send_side_delay_observer = observers.send_delay_observer;
   configuration.send_packet_observer = observers.send_packet_observer;
@@ -345,6 +347,136 @@ bool IsFirstFrameOfACodedVideoSequence(
 
 }  // namespace
 
+class RtpVideoSender::FanOutPacketSender : public RtpPacketSender,
+                                           public rtc::RefCountInterface {
+ public:
+  FanOutPacketSender(RtpVideoSender* owner,
+                     const std::vector<uint32_t>& ssrcs,
+                     RtpPacketSender* pacer)
+      : owner_(owner), ssrcs_(ssrcs), pacer_(pacer) {}
+
+  // Called by the rtp modules of `owner_`.
+  void EnqueuePackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) override {
+    // The destinations take their own locks, so they are called on a copy of
+    // the list rather than under `mutex_`.
+    std::vector<rtc::scoped_refptr<FanOutPacketSender>> destinations =
+        Destinations();
+    if (!destinations.empty()) {
+      absl::optional<size_t> stream_index = MediaStreamIndex(packets);
+      if (stream_index) {
+        for (const auto& destination : destinations) {
+          destination->OnFannedOutPackets(*owner_, *stream_index, packets);
+        }
+      }
+    }
+    pacer_->EnqueuePackets(std::move(packets));
+  }
+
+  // Enqueues packets fanned out to `owner_` from another sender. They are not
+  // fanned out again.
+  void EnqueueFannedOutPackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) {
+    pacer_->EnqueuePackets(std::move(packets));
+  }
+
+  // Returns false, and adds nothing, if `destination` is this sender or
+  // already fans out to it, directly or through other senders.
+  bool AddDestination(rtc::scoped_refptr<FanOutPacketSender> destination) {
+    if (destination.get() == this || destination->FansOutTo(this)) {
+      return false;
+    }
+    MutexLock lock(&mutex_);
+    if (!absl::c_linear_search(destinations_, destination)) {
+      destinations_.push_back(std::move(destination));
+    }
+    return true;
+  }
+
+  void RemoveDestination(const FanOutPacketSender* destination) {
+    MutexLock lock(&mutex_);
+    destinations_.erase(
+        std::remove_if(destinations_.begin(), destinations_.end(),
+                       [destination](const auto& d) {
+                         return d.get() == destination;
+                       }),
+        destinations_.end());
+  }
+
+  // Called when `owner_` is destroyed. Packets fanned out to it after this
+  // are dropped.
+  void Detach() {
+    MutexLock lock(&owner_mutex_);
+    detached_ = true;
+  }
+
+ private:
+  std::vector<rtc::scoped_refptr<FanOutPacketSender>> Destinations() {
+    MutexLock lock(&mutex_);
+    return destinations_;
+  }
+
+  bool FansOutTo(const FanOutPacketSender* sender) {
+    std::vector<rtc::scoped_refptr<FanOutPacketSender>> pending =
+        Destinations();
+    std::vector<const FanOutPacketSender*> visited;
+    while (!pending.empty()) {
+      rtc::scoped_refptr<FanOutPacketSender> destination =
+          std::move(pending.back());
+      pending.pop_back();
+      if (destination.get() == sender) {
+        return true;
+      }
+      if (absl::c_linear_search(visited, destination.get())) {
+        continue;
+      }
+      visited.push_back(destination.get());
+      for (auto& next : destination->Destinations()) {
+        pending.push_back(std::move(next));
+      }
+    }
+    return false;
+  }
+
+  void OnFannedOutPackets(
+      const RtpVideoSender& source,
+      size_t stream_index,
+      const std::vector<std::unique_ptr<RtpPacketToSend>>& packets) {
+    MutexLock lock(&owner_mutex_);
+    if (!detached_) {
+      owner_->SendFannedOutPackets(source, stream_index, packets);
+    }
+  }
+
+  // Returns the index of the stream the media packets in `packets` belong to,
+  // if there are any. Each rtp module enqueues its own packets, so they all
+  // belong to the same stream.
+  absl::optional<size_t> MediaStreamIndex(
+      const std::vector<std::unique_ptr<RtpPacketToSend>>& packets) const {
+    for (const auto& packet : packets) {
+      if (packet->packet_type() == RtpPacketMediaType::kVideo) {
+        auto it = absl::c_find(ssrcs_, packet->Ssrc());
+        if (it == ssrcs_.end()) {
+          return absl::nullopt;
+        }
+        return it - ssrcs_.begin();
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Only used on the send path of `owner_`, or with `owner_mutex_` held while
+  // not `detached_`.
+  RtpVideoSender* const owner_;
+  const std::vector<uint32_t> ssrcs_;
+  RtpPacketSender* const pacer_;
+  Mutex owner_mutex_;
+  bool detached_ RTC_GUARDED_BY(owner_mutex_) = false;
+  Mutex mutex_;
+  std::vector<rtc::scoped_refptr<FanOutPacketSender>> destinations_
+      RTC_GUARDED_BY(mutex_);
+};
+
 RtpVideoSender::RtpVideoSender(
     Clock* clock,
     std::map<uint32_t, RtpState> suspended_ssrcs,
@@ -377,6 +509,9 @@ RtpVideoSender::RtpVideoSender(
       suspended_ssrcs_(std::move(suspended_ssrcs)),
       fec_controller_(std::move(fec_controller)),
       fec_allowed_(true),
+      fan_out_packet_sender_(
+          rtc::make_ref_counted<FanOutPacketSender>(
+              this, rtp_config.ssrcs, transport->packet_sender())),
       rtp_streams_(CreateRtpStreamSenders(clock,
                                           rtp_config,
                                           observers,
@@ -384,6 +519,7 @@ RtpVideoSender::RtpVideoSender(
                                           send_transport,
                                           transport->GetBandwidthObserver(),
                                           transport,
+                                          fan_out_packet_sender_.get(),
                                           suspended_ssrcs_,
                                           event_log,
                                           retransmission_limiter,
@@ -464,6 +600,7 @@ RtpVideoSender::RtpVideoSender(
 }
 
 RtpVideoSender::~RtpVideoSender() {
+  fan_out_packet_sender_->Detach();
   SetActiveModulesLocked(
       std::vector<bool>(rtp_streams_.size(), /*active=*/false));
   transport_->GetStreamFeedbackProvider()->DeRegisterStreamFeedbackObserver(
@@ -1004,4 +1141,75 @@ DataRate RtpVideoSender::CalculateOverheadRate(DataRate data_rate,
   return packet_rate.RoundUpTo(Frequency::Hertz(1)) * overhead_per_packet;
 }
 
+bool RtpVideoSender::AddFanOutDestination(RtpVideoSender* destination) {
+  RTC_DCHECK(destination);
+  const RtpConfig& config = destination->rtp_config_;
+  if (config.ssrcs.size() != rtp_config_.ssrcs.size() ||
+      config.payload_type != rtp_config_.payload_type ||
+      config.raw_payload != rtp_config_.raw_payload ||
+      config.ulpfec.red_payload_type != rtp_config_.ulpfec.red_payload_type ||
+      config.extensions != rtp_config_.extensions ||
+      config.extmap_allow_mixed != rtp_config_.extmap_allow_mixed ||
+      config.mid != rtp_config_.mid || config.rids != rtp_config_.rids) {
+    RTC_LOG(LS_WARNING) << "Can not fan out packets of SSRC "
+                        << rtp_config_.ssrcs[0] << " to SSRC "
+                        << config.ssrcs[0] << ", configurations differ.";
+    return false;
+  }
+  if (!fan_out_packet_sender_->AddDestination(
+          destination->fan_out_packet_sender_)) {
+    RTC_LOG(LS_WARNING) << "Can not fan out packets of SSRC "
+                        << rtp_config_.ssrcs[0] << " to SSRC "
+                        << config.ssrcs[0] << ", it would form a cycle.";
+    return false;
+  }
+  return true;
+}
+
+void RtpVideoSender::RemoveFanOutDestination(RtpVideoSender* destination) {
+  fan_out_packet_sender_->RemoveDestination(
+      destination->fan_out_packet_sender_.get());
+}
+
+void RtpVideoSender::SendFannedOutPackets(
+    const RtpVideoSender& source,
+    size_t stream_index,
+    const std::vector<std::unique_ptr<RtpPacketToSend>>& packets) {
+  // Each sender has its own random RTP timestamp offset.
+  const uint32_t source_timestamp_offset =
+      source.rtp_streams_[stream_index].rtp_rtcp->StartTimestamp();
+  MutexLock lock(&mutex_);
+  if (!active_)
+    return;
+  ModuleRtpRtcpImpl2& rtp_rtcp = *rtp_streams_[stream_index].rtp_rtcp;
+  const uint32_t ssrc = rtp_config_.ssrcs[stream_index];
+  const uint32_t timestamp_offset = rtp_rtcp.StartTimestamp();
+  bool sending_frame = rtp_rtcp.SendingMedia();
+  std::vector<std::unique_ptr<RtpPacketToSend>> fanned_out_packets;
+  fanned_out_packets.reserve(packets.size());
+  for (const auto& packet : packets) {
+    // Retransmissions, padding and FEC are generated by each sender.
+    if (packet->packet_type() != RtpPacketMediaType::kVideo)
+      continue;
+    const uint32_t rtp_timestamp =
+        packet->Timestamp() - source_timestamp_offset;
+    if (packet->is_first_packet_of_frame()) {
+      sending_frame = rtp_rtcp.OnSendingRtpFrame(
+          rtp_timestamp, packet->capture_time_ms(), rtp_config_.payload_type,
+          packet->is_key_frame());
+    }
+    if (!sending_frame)
+      continue;
+    // The copy shares the buffer of `packet` until the header is rewritten.
+    auto fanned_out_packet = std::make_unique<RtpPacketToSend>(*packet);
+    fanned_out_packet->SetSsrc(ssrc);
+    fanned_out_packet->SetTimestamp(rtp_timestamp + timestamp_offset);
+    fanned_out_packets.push_back(std::move(fanned_out_packet));
+  }
+  if (!fanned_out_packets.empty()) {
+    fan_out_packet_sender_->EnqueueFannedOutPackets(
+        std::move(fanned_out_packets));
+  }
+}
+
 }  // namespace webrtc
@@ -22,6 +22,7 @@
 #include "api/fec_controller.h"
 #include "api/fec_controller_override.h"
 #include "api/rtc_event_log/rtc_event_log.h"
+#include "api/scoped_refptr.h"
 #include "api/sequence_checker.h"
 #include "api/transport/field_trial_based_config.h"
 #include "api/video_codecs/video_encoder.h"
@@ -30,6 +31,8 @@
 #include "call/rtp_transport_controller_send_interface.h"
 #include "call/rtp_video_sender_interface.h"
 #include "modules/rtp_rtcp/include/flexfec_sender.h"
+#include "modules/rtp_rtcp/include/rtp_packet_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "modules/rtp_rtcp/source/rtp_rtcp_impl2.h"
 #include "modules/rtp_rtcp/source/rtp_sender.h"
 #include "modules/rtp_rtcp/source/rtp_sender_video.h"
@@ -149,6 +152,28 @@ class RtpVideoSender : public RtpVideoSenderInterface,
       std::vector<StreamPacketInfo> packet_feedback_vector)
       RTC_LOCKS_EXCLUDED(mutex_) override;
 
+  // Encoded-frame fan-out, e.g., for an SFU forwarding one encoded stream to
+  // many receivers with one RtpVideoSender each. The media packets of frames
+  // given to this sender's OnEncodedImage() are also sent by `destination`,
+  // without packetizing the frames again. A forwarded packet shares its buffer
+  // with the original until its SSRC and RTP timestamp are rewritten for
+  // `destination`. Its sequence number and transport-wide extensions are set
+  // when `destination` sends it, and SRTP is applied by the transport of
+  // `destination` into separate buffers, as for any other packet. The packets
+  // go straight to the pacer of `destination`; they are not fanned out again
+  // to its own destinations.
+  //
+  // Returns false, and adds nothing, if the packets of this sender can not be
+  // sent as is by `destination`, i.e., if the two senders do not use the same
+  // number of streams, payload types, header extensions, MID and RIDs. Frames
+  // must then be given to the OnEncodedImage() of `destination` instead. Also
+  // returns false if `destination` is this sender or already fans out to it,
+  // directly or through other senders. Destinations must be added on one
+  // thread. A destination that is destroyed stops receiving packets.
+  bool AddFanOutDestination(RtpVideoSender* destination)
+      RTC_LOCKS_EXCLUDED(mutex_);
+  void RemoveFanOutDestination(RtpVideoSender* destination);
+
  private:
   bool IsActiveLocked() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void SetActiveModulesLocked(const std::vector<bool> active_modules)
@@ -156,6 +181,13 @@ class RtpVideoSender : public RtpVideoSenderInterface,
   void UpdateModuleSendingState() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   void ConfigureProtection();
   void ConfigureSsrcs();
+  // Sends copies of the media packets in `packets`, packetized by `source` for
+  // stream `stream_index`, on the same stream of this sender.
+  void SendFannedOutPackets(
+      const RtpVideoSender& source,
+      size_t stream_index,
+      const std::vector<std::unique_ptr<RtpPacketToSend>>& packets)
+      RTC_LOCKS_EXCLUDED(mutex_);
   void ConfigureRids();
   bool NackEnabled() const;
   uint32_t GetPacketizationOverheadRate() const;
@@ -181,6 +213,11 @@ class RtpVideoSender : public RtpVideoSenderInterface,
   const std::unique_ptr<FecController> fec_controller_;
   bool fec_allowed_ RTC_GUARDED_BY(mutex_);
 
+  // Sits between the rtp modules and the pacer, to hand the packets of this
+  // sender to the fan-out destinations.
+  class FanOutPacketSender;
+  const rtc::scoped_refptr<FanOutPacketSender> fan_out_packet_sender_;
+
   // Rtp modules are assumed to be sorted in simulcast index order.
   const std::vector<webrtc_internal_rtp_video_sender::RtpStreamSender>
       rtp_streams_;
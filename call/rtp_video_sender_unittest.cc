@@ -37,6 +37,7 @@ using ::testing::_;
 using ::testing::NiceMock;
 using ::testing::SaveArg;
 using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
 
 namespace webrtc {
 namespace {
@@ -179,6 +180,26 @@ class RtpVideoSenderTestFixture {
 
   RtpVideoSender* router() { return router_.get(); }
   MockTransport& transport() { return transport_; }
+
+  // Creates another sender on the same transport, e.g., to forward the packets
+  // of `router()` to.
+  std::unique_ptr<RtpVideoSender> CreateRouter(
+      const std::vector<uint32_t>& ssrcs,
+      const std::vector<uint32_t>& rtx_ssrcs,
+      int payload_type) {
+    VideoSendStream::Config config = CreateVideoSendStreamConfig(
+        &transport_, ssrcs, rtx_ssrcs, payload_type);
+    return std::make_unique<RtpVideoSender>(
+        time_controller_.GetClock(), std::map<uint32_t, RtpState>(),
+        std::map<uint32_t, RtpPayloadState>(), config.rtp,
+        config.rtcp_report_interval_ms, &transport_,
+        CreateObservers(nullptr, &encoder_feedback_, &stats_proxy_,
+                        &stats_proxy_, &stats_proxy_, nullptr, &stats_proxy_,
+                        &stats_proxy_, &send_delay_stats_),
+        &transport_controller_, &event_log_, &retransmission_rate_limiter_,
+        std::make_unique<FecControllerDefault>(time_controller_.GetClock()),
+        nullptr, CryptoOptions{}, nullptr);
+  }
   void AdvanceTime(TimeDelta delta) { time_controller_.AdvanceTime(delta); }
 
  private:
@@ -230,6 +251,113 @@ TEST(RtpVideoSenderTest, SendOnOneModule) {
             test.router()->OnEncodedImage(encoded_image, nullptr).error);
 }
 
+TEST(RtpVideoSenderTest, FansOutMediaPacketsToDestination) {
+  constexpr uint8_t kPayload = 'a';
+  EncodedImage encoded_image;
+  encoded_image.SetTimestamp(1);
+  encoded_image.capture_time_ms_ = 2;
+  encoded_image._frameType = VideoFrameType::kVideoFrameKey;
+  encoded_image.SetEncodedData(EncodedImageBuffer::Create(&kPayload, 1));
+
+  RtpVideoSenderTestFixture test({kSsrc1}, {kRtxSsrc1}, kPayloadType, {});
+  {
+    std::unique_ptr<RtpVideoSender> incompatible_destination =
+        test.CreateRouter({kSsrc2}, {kRtxSsrc2}, kPayloadType + 1);
+    EXPECT_FALSE(
+        test.router()->AddFanOutDestination(incompatible_destination.get()));
+  }
+  std::unique_ptr<RtpVideoSender> destination =
+      test.CreateRouter({kSsrc2}, {kRtxSsrc2}, kPayloadType);
+  ASSERT_TRUE(test.router()->AddFanOutDestination(destination.get()));
+  test.router()->SetActive(true);
+  destination->SetActive(true);
+
+  std::map<uint32_t, std::vector<uint8_t>> sent_payloads;
+  EXPECT_CALL(test.transport(), SendRtp)
+      .Times(2)
+      .WillRepeatedly([&sent_payloads](const uint8_t* packet, size_t length,
+                                       const PacketOptions& options) {
+        RtpPacket rtp_packet;
+        EXPECT_TRUE(rtp_packet.Parse(packet, length));
+        EXPECT_EQ(rtp_packet.PayloadType(), kPayloadType);
+        sent_payloads[rtp_packet.Ssrc()].assign(rtp_packet.payload().begin(),
+                                                rtp_packet.payload().end());
+        return true;
+      });
+  EXPECT_EQ(EncodedImageCallback::Result::OK,
+            test.router()->OnEncodedImage(encoded_image, nullptr).error);
+  test.AdvanceTime(TimeDelta::Millis(33));
+
+  ASSERT_EQ(sent_payloads.size(), 2u);
+  EXPECT_EQ(sent_payloads[kSsrc1], sent_payloads[kSsrc2]);
+
+  // Nothing is forwarded once the destination is removed.
+  test.router()->RemoveFanOutDestination(destination.get());
+  EXPECT_CALL(test.transport(), SendRtp)
+      .WillOnce([](const uint8_t* packet, size_t length,
+                   const PacketOptions& options) {
+        RtpPacket rtp_packet;
+        EXPECT_TRUE(rtp_packet.Parse(packet, length));
+        EXPECT_EQ(rtp_packet.Ssrc(), kSsrc1);
+        return true;
+      });
+  encoded_image.SetTimestamp(2);
+  encoded_image.capture_time_ms_ = 3;
+  EXPECT_EQ(EncodedImageCallback::Result::OK,
+            test.router()->OnEncodedImage(encoded_image, nullptr).error);
+  test.AdvanceTime(TimeDelta::Millis(33));
+}
+
+TEST(RtpVideoSenderTest, FansOutToDirectDestinationsWithoutCycles) {
+  constexpr uint32_t kSsrc3 = 56789;
+  constexpr uint32_t kRtxSsrc3 = 67890;
+  constexpr uint8_t kPayload = 'a';
+  EncodedImage encoded_image;
+  encoded_image.SetTimestamp(1);
+  encoded_image.capture_time_ms_ = 2;
+  encoded_image._frameType = VideoFrameType::kVideoFrameKey;
+  encoded_image.SetEncodedData(EncodedImageBuffer::Create(&kPayload, 1));
+
+  RtpVideoSenderTestFixture test({kSsrc1}, {kRtxSsrc1}, kPayloadType, {});
+  std::unique_ptr<RtpVideoSender> second =
+      test.CreateRouter({kSsrc2}, {kRtxSsrc2}, kPayloadType);
+  std::unique_ptr<RtpVideoSender> third =
+      test.CreateRouter({kSsrc3}, {kRtxSsrc3}, kPayloadType);
+  EXPECT_FALSE(test.router()->AddFanOutDestination(test.router()));
+  ASSERT_TRUE(test.router()->AddFanOutDestination(second.get()));
+  ASSERT_TRUE(second->AddFanOutDestination(third.get()));
+  EXPECT_FALSE(second->AddFanOutDestination(test.router()));
+  EXPECT_FALSE(third->AddFanOutDestination(test.router()));
+  test.router()->SetActive(true);
+  second->SetActive(true);
+  third->SetActive(true);
+
+  // The packets of the first sender are not fanned out again by the second.
+  std::vector<uint32_t> sent_ssrcs;
+  EXPECT_CALL(test.transport(), SendRtp)
+      .WillRepeatedly([&sent_ssrcs](const uint8_t* packet, size_t length,
+                                    const PacketOptions& options) {
+        RtpPacket rtp_packet;
+        EXPECT_TRUE(rtp_packet.Parse(packet, length));
+        sent_ssrcs.push_back(rtp_packet.Ssrc());
+        return true;
+      });
+  EXPECT_EQ(EncodedImageCallback::Result::OK,
+            test.router()->OnEncodedImage(encoded_image, nullptr).error);
+  test.AdvanceTime(TimeDelta::Millis(33));
+  EXPECT_THAT(sent_ssrcs, UnorderedElementsAre(kSsrc1, kSsrc2));
+
+  // A destroyed destination is skipped.
+  sent_ssrcs.clear();
+  second.reset();
+  encoded_image.SetTimestamp(2);
+  encoded_image.capture_time_ms_ = 3;
+  EXPECT_EQ(EncodedImageCallback::Result::OK,
+            test.router()->OnEncodedImage(encoded_image, nullptr).error);
+  test.AdvanceTime(TimeDelta::Millis(33));
+  EXPECT_THAT(sent_ssrcs, UnorderedElementsAre(kSsrc1));
+}
+
 TEST(RtpVideoSenderTest, SendSimulcastSetActive) {
   constexpr uint8_t kPayload = 'a';
   EncodedImage encoded_image_1;
@@ -119,6 +119,13 @@ int PushResampler<T>::Resample(const T* src,
     return static_cast<int>(src_length);
   }
 
+  if (num_channels_ == 1) {
+    // Mono needs no (de)interleaving; resample directly between the caller's
+    // buffers and skip the two intermediate copies.
+    return static_cast<int>(channel_resamplers_[0].resampler->Resample(
+        src, src_length, dst, dst_capacity));
+  }
+
   const size_t src_length_mono = src_length / num_channels_;
   const size_t dst_capacity_mono = dst_capacity / num_channels_;
 
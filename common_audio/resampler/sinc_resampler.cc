@@ -94,7 +94,9 @@
 #include <limits>
 
 #include "rtc_base/checks.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/system/arch.h"
+#include "rtc_base/thread_annotations.h"
 #include "system_wrappers/include/cpu_features_wrapper.h"  // kSSE2, WebRtc_G...
 
 namespace webrtc {
@@ -117,8 +119,116 @@ double SincScaleFactor(double io_ratio) {
   return sinc_scale_factor;
 }
 
+// Parts of the windowed sinc kernels which do not depend on the sample rate
+// ratio. Computed once and never modified afterwards.
+struct RatioIndependentKernelParts {
+  RatioIndependentKernelParts() {
+    // Blackman window parameters.
+    static const double kAlpha = 0.16;
+    static const double kA0 = 0.5 * (1.0 - kAlpha);
+    static const double kA1 = 0.5;
+    static const double kA2 = 0.5 * kAlpha;
+
+    // We generate a range of sub-sample offsets from 0.0 to 1.0.
+    constexpr size_t kKernelSize = SincResampler::kKernelSize;
+    constexpr size_t kKernelOffsetCount = SincResampler::kKernelOffsetCount;
+    for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount;
+         ++offset_idx) {
+      const float subsample_offset =
+          static_cast<float>(offset_idx) / kKernelOffsetCount;
+
+      for (size_t i = 0; i < kKernelSize; ++i) {
+        const size_t idx = i + offset_idx * kKernelSize;
+        pre_sinc[idx] = static_cast<float>(
+            M_PI * (static_cast<int>(i) - static_cast<int>(kKernelSize / 2) -
+                    subsample_offset));
+
+        // Compute Blackman window, matching the offset of the sinc().
+        const float x = (i - subsample_offset) / kKernelSize;
+        window[idx] = static_cast<float>(kA0 - kA1 * cos(2.0 * M_PI * x) +
+                                         kA2 * cos(4.0 * M_PI * x));
+      }
+    }
+  }
+
+  float pre_sinc[SincResampler::kKernelStorageSize];
+  float window[SincResampler::kKernelStorageSize];
+};
+
+const RatioIndependentKernelParts& GetRatioIndependentKernelParts() {
+  static const RatioIndependentKernelParts* const kParts =
+      new RatioIndependentKernelParts();
+  return *kParts;
+}
+
+// Generates the set of windowed sinc() kernels for `io_sample_rate_ratio`.
+void ComputeKernel(double io_sample_rate_ratio, float* kernel) {
+  const RatioIndependentKernelParts& parts = GetRatioIndependentKernelParts();
+  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio);
+  for (size_t idx = 0; idx < SincResampler::kKernelStorageSize; ++idx) {
+    const float window = parts.window[idx];
+    const float pre_sinc = parts.pre_sinc[idx];
+
+    // Compute the sinc with offset, then window the sinc() function.
+    kernel[idx] = static_cast<float>(
+        window * ((pre_sinc == 0)
+                      ? sinc_scale_factor
+                      : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
+  }
+}
+
 }  // namespace
 
+SincResamplerKernelCache::SincResamplerKernelCache() = default;
+SincResamplerKernelCache::~SincResamplerKernelCache() = default;
+
+// static
+SincResamplerKernelCache* SincResamplerKernelCache::GetDefault() {
+  static SincResamplerKernelCache* const kCache =
+      new SincResamplerKernelCache();
+  return kCache;
+}
+
+std::shared_ptr<const float> SincResamplerKernelCache::GetKernel(
+    double io_sample_rate_ratio) {
+  MutexLock lock(&mutex_);
+  auto it = kernels_.find(io_sample_rate_ratio);
+  if (it != kernels_.end()) {
+    if (std::shared_ptr<const float> kernel = it->second.lock()) {
+      return kernel;
+    }
+  }
+
+  // Forget the ratios which are no longer in use, whose kernels have already
+  // been freed.
+  for (auto entry = kernels_.begin(); entry != kernels_.end();) {
+    if (entry->second.expired()) {
+      entry = kernels_.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+
+  std::shared_ptr<float> kernel(
+      static_cast<float*>(AlignedMalloc(
+          sizeof(float) * SincResampler::kKernelStorageSize, 32)),
+      AlignedFreeDeleter());
+  ComputeKernel(io_sample_rate_ratio, kernel.get());
+  kernels_[io_sample_rate_ratio] = kernel;
+  return kernel;
+}
+
+size_t SincResamplerKernelCache::NumKernelsInUse() {
+  MutexLock lock(&mutex_);
+  size_t num_kernels = 0;
+  for (const auto& entry : kernels_) {
+    if (!entry.second.expired()) {
+      ++num_kernels;
+    }
+  }
+  return num_kernels;
+}
+
 const size_t SincResampler::kKernelSize;
 
 // If we know the minimum architecture at compile time, avoid CPU detection.
@@ -142,17 +252,25 @@ void SincResampler::InitializeCPUSpecificFeatures() {
 SincResampler::SincResampler(double io_sample_rate_ratio,
                              size_t request_frames,
                              SincResamplerCallback* read_cb)
+    : SincResampler(io_sample_rate_ratio,
+                    request_frames,
+                    read_cb,
+                    SincResamplerKernelCache::GetDefault()) {}
+
+SincResampler::SincResampler(double io_sample_rate_ratio,
+                             size_t request_frames,
+                             SincResamplerCallback* read_cb,
+                             SincResamplerKernelCache* kernel_cache)
     : io_sample_rate_ratio_(io_sample_rate_ratio),
       read_cb_(read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
-      // Create input buffers with a 32-byte alignment for SIMD optimizations.
-      kernel_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
-      kernel_pre_sinc_storage_(static_cast<float*>(
-          AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
-      kernel_window_storage_(static_cast<float*>(
+      shared_kernel_ratio_(io_sample_rate_ratio),
+      shared_kernel_(kernel_cache->GetKernel(io_sample_rate_ratio)),
+      owned_kernel_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * kKernelStorageSize, 32))),
+      kernel_(shared_kernel_.get()),
+      // Create input buffers with a 32-byte alignment for SIMD optimizations.
       input_buffer_(static_cast<float*>(
           AlignedMalloc(sizeof(float) * input_buffer_size_, 32))),
       convolve_proc_(nullptr),
@@ -163,15 +281,6 @@ SincResampler::SincResampler(double io_sample_rate_ratio,
   RTC_DCHECK_GT(request_frames_, 0);
   Flush();
   RTC_DCHECK_GT(block_size_, kKernelSize);
-
-  memset(kernel_storage_.get(), 0,
-         sizeof(*kernel_storage_.get()) * kKernelStorageSize);
-  memset(kernel_pre_sinc_storage_.get(), 0,
-         sizeof(*kernel_pre_sinc_storage_.get()) * kKernelStorageSize);
-  memset(kernel_window_storage_.get(), 0,
-         sizeof(*kernel_window_storage_.get()) * kKernelStorageSize);
-
-  InitializeKernel();
 }
 
 SincResampler::~SincResampler() {}
@@ -192,43 +301,6 @@ void SincResampler::UpdateRegions(bool second_load) {
   RTC_DCHECK_LT(r2_, r3_);
 }
 
-void SincResampler::InitializeKernel() {
-  // Blackman window parameters.
-  static const double kAlpha = 0.16;
-  static const double kA0 = 0.5 * (1.0 - kAlpha);
-  static const double kA1 = 0.5;
-  static const double kA2 = 0.5 * kAlpha;
-
-  // Generates a set of windowed sinc() kernels.
-  // We generate a range of sub-sample offsets from 0.0 to 1.0.
-  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    const float subsample_offset =
-        static_cast<float>(offset_idx) / kKernelOffsetCount;
-
-    for (size_t i = 0; i < kKernelSize; ++i) {
-      const size_t idx = i + offset_idx * kKernelSize;
-      const float pre_sinc = static_cast<float>(
-          M_PI * (static_cast<int>(i) - static_cast<int>(kKernelSize / 2) -
-                  subsample_offset));
-      kernel_pre_sinc_storage_[idx] = pre_sinc;
-
-      // Compute Blackman window, matching the offset of the sinc().
-      const float x = (i - subsample_offset) / kKernelSize;
-      const float window = static_cast<float>(kA0 - kA1 * cos(2.0 * M_PI * x) +
-                                              kA2 * cos(4.0 * M_PI * x));
-      kernel_window_storage_[idx] = window;
-
-      // Compute the sinc with offset, then window the sinc() function and store
-      // at the correct offset.
-      kernel_storage_[idx] = static_cast<float>(
-          window * ((pre_sinc == 0)
-                        ? sinc_scale_factor
-                        : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
-    }
-  }
-}
-
 void SincResampler::SetRatio(double io_sample_rate_ratio) {
   if (fabs(io_sample_rate_ratio_ - io_sample_rate_ratio) <
       std::numeric_limits<double>::epsilon()) {
@@ -237,21 +309,15 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
 
   io_sample_rate_ratio_ = io_sample_rate_ratio;
 
-  // Optimize reinitialization by reusing values which are independent of
-  // `sinc_scale_factor`.  Provides a 3x speedup.
-  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (size_t offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    for (size_t i = 0; i < kKernelSize; ++i) {
-      const size_t idx = i + offset_idx * kKernelSize;
-      const float window = kernel_window_storage_[idx];
-      const float pre_sinc = kernel_pre_sinc_storage_[idx];
-
-      kernel_storage_[idx] = static_cast<float>(
-          window * ((pre_sinc == 0)
-                        ? sinc_scale_factor
-                        : (sin(sinc_scale_factor * pre_sinc) / pre_sinc)));
-    }
+  // This may run on a real-time thread, so the kernel cache, whose lookups
+  // lock and may allocate or free, is not used. Only the ratio-dependent part
+  // of the kernels is recomputed.
+  if (io_sample_rate_ratio_ == shared_kernel_ratio_) {
+    kernel_ = shared_kernel_.get();
+    return;
   }
+  ComputeKernel(io_sample_rate_ratio_, owned_kernel_.get());
+  kernel_ = owned_kernel_.get();
 }
 
 void SincResampler::Resample(size_t frames, float* destination) {
@@ -266,7 +332,7 @@ void SincResampler::Resample(size_t frames, float* destination) {
   // Step (2) -- Resample!  const what we can outside of the loop for speed.  It
   // actually has an impact on ARM performance.  See inner loop comment below.
   const double current_io_ratio = io_sample_rate_ratio_;
-  const float* const kernel_ptr = kernel_storage_.get();
+  const float* const kernel_ptr = kernel_;
   while (remaining_frames) {
     // `i` may be negative if the last Resample() call ended on an iteration
     // that put `virtual_source_idx_` over the limit.
@@ -16,12 +16,15 @@
 
 #include <stddef.h>
 
+#include <map>
 #include <memory>
 
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/gtest_prod_util.h"
 #include "rtc_base/memory/aligned_malloc.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/system/arch.h"
+#include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
 
@@ -34,6 +37,32 @@ class SincResamplerCallback {
   virtual void Run(size_t frames, float* destination) = 0;
 };
 
+// Immutable windowed sinc kernels, shared by the resamplers that use the same
+// sample rate ratio. The kernels of a ratio are computed when the first
+// resampler needs them and freed when the last one using them goes away.
+// Thread-safe.
+class SincResamplerKernelCache {
+ public:
+  SincResamplerKernelCache();
+  ~SincResamplerKernelCache();
+
+  // The cache used by resamplers which aren't given one.
+  static SincResamplerKernelCache* GetDefault();
+
+  // Returns the kernels for `io_sample_rate_ratio`, computing them if they are
+  // not currently in use.
+  std::shared_ptr<const float> GetKernel(double io_sample_rate_ratio);
+
+  // Returns the number of ratios whose kernels are currently in use.
+  size_t NumKernelsInUse();
+
+ private:
+  Mutex mutex_;
+  std::map<double, std::weak_ptr<const float>> kernels_ RTC_GUARDED_BY(mutex_);
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(SincResamplerKernelCache);
+};
+
 // SincResampler is a high-quality single-channel sample-rate converter.
 class SincResampler {
  public:
@@ -62,6 +91,12 @@ class SincResampler {
   SincResampler(double io_sample_rate_ratio,
                 size_t request_frames,
                 SincResamplerCallback* read_cb);
+  // Same as above, but gets its kernels from `kernel_cache`, which must outlive
+  // the resampler, rather than from the default cache.
+  SincResampler(double io_sample_rate_ratio,
+                size_t request_frames,
+                SincResamplerCallback* read_cb,
+                SincResamplerKernelCache* kernel_cache);
   virtual ~SincResampler();
 
   // Resample `frames` of data from `read_cb_` into `destination`.
@@ -78,20 +113,20 @@ class SincResampler {
   void Flush();
 
   // Update `io_sample_rate_ratio_`.  SetRatio() will cause a reconstruction of
-  // the kernels used for resampling.  Not thread safe, do not call while
-  // Resample() is in progress.
+  // the kernels used for resampling, into storage owned by the resampler: it
+  // neither allocates nor uses the kernel cache.  Not thread safe, do not call
+  // while Resample() is in progress.
   //
   // TODO(ajm): Use this in PushSincResampler rather than reconstructing
   // SincResampler.  We would also need a way to update `request_frames_`.
   void SetRatio(double io_sample_rate_ratio);
 
-  float* get_kernel_for_testing() { return kernel_storage_.get(); }
+  const float* get_kernel_for_testing() const { return kernel_; }
 
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, ConvolveBenchmark);
 
-  void InitializeKernel();
   void UpdateRegions(bool second_load);
 
   // Selects runtime specific CPU features like SSE.  Must be called before
@@ -147,10 +182,15 @@ class SincResampler {
 
   // Contains kKernelOffsetCount kernels back-to-back, each of size kKernelSize.
   // The kernel offsets are sub-sample shifts of a windowed sinc shifted from
-  // 0.0 to 1.0 sample.
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_storage_;
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_pre_sinc_storage_;
-  std::unique_ptr<float[], AlignedFreeDeleter> kernel_window_storage_;
+  // 0.0 to 1.0 sample. The kernels only depend on `io_sample_rate_ratio_`, so
+  // the kernels of the construction ratio, `shared_kernel_ratio_`, are shared
+  // with the other resamplers using it through the kernel cache. SetRatio()
+  // computes the kernels of other ratios into `owned_kernel_`. `kernel_`
+  // points to the kernels in use.
+  const double shared_kernel_ratio_;
+  const std::shared_ptr<const float> shared_kernel_;
+  std::unique_ptr<float[], AlignedFreeDeleter> owned_kernel_;
+  const float* kernel_;
 
   // Data from the source is copied into this buffer for each processing pass.
   std::unique_ptr<float[], AlignedFreeDeleter> input_buffer_;
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 #include "common_audio/resampler/sinusoidal_linear_chirp_source.h"
 #include "rtc_base/system/arch.h"
@@ -115,6 +116,75 @@ TEST(SincResamplerTest, DISABLED_SetRatioBench) {
   printf("SetRatio() took %.2fms.\n", total_time_c_us / 1000);
 }
 
+// Resamplers with the same ratio share their kernels, and the kernels shared
+// for a ratio are the same as the ones a resampler switching to it computes,
+// without using the kernel cache.
+TEST(SincResamplerTest, SharesKernelsForSameRatio) {
+  MockSource mock_source;
+  SincResamplerKernelCache kernel_cache;
+  SincResampler resampler1(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                           &mock_source, &kernel_cache);
+  SincResampler resampler2(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                           &mock_source, &kernel_cache);
+  EXPECT_EQ(resampler1.get_kernel_for_testing(),
+            resampler2.get_kernel_for_testing());
+  EXPECT_EQ(1u, kernel_cache.NumKernelsInUse());
+
+  SincResampler resampler3(1.0 / kSampleRateRatio,
+                           SincResampler::kDefaultRequestSize, &mock_source,
+                           &kernel_cache);
+  EXPECT_NE(resampler1.get_kernel_for_testing(),
+            resampler3.get_kernel_for_testing());
+  EXPECT_EQ(2u, kernel_cache.NumKernelsInUse());
+  const float* shared_kernel = resampler3.get_kernel_for_testing();
+  resampler3.SetRatio(kSampleRateRatio);
+  EXPECT_NE(resampler1.get_kernel_for_testing(),
+            resampler3.get_kernel_for_testing());
+  EXPECT_EQ(0, memcmp(resampler1.get_kernel_for_testing(),
+                      resampler3.get_kernel_for_testing(),
+                      sizeof(float) * SincResampler::kKernelStorageSize));
+  EXPECT_EQ(2u, kernel_cache.NumKernelsInUse());
+
+  // Going back to the construction ratio uses the shared kernels again.
+  resampler3.SetRatio(1.0 / kSampleRateRatio);
+  EXPECT_EQ(shared_kernel, resampler3.get_kernel_for_testing());
+  EXPECT_EQ(2u, kernel_cache.NumKernelsInUse());
+}
+
+// The kernels of a ratio are freed when no resampler uses them any more, and
+// computed again, identically, when needed.
+TEST(SincResamplerTest, ReleasesKernelsWhenUnused) {
+  MockSource mock_source;
+  SincResamplerKernelCache kernel_cache;
+  auto resampler = std::make_unique<SincResampler>(
+      kSampleRateRatio, SincResampler::kDefaultRequestSize, &mock_source,
+      &kernel_cache);
+  std::vector<float> kernel(resampler->get_kernel_for_testing(),
+                            resampler->get_kernel_for_testing() +
+                                SincResampler::kKernelStorageSize);
+  resampler.reset();
+  EXPECT_EQ(0u, kernel_cache.NumKernelsInUse());
+
+  // Many distinct ratios don't prevent sharing the kernels of another one.
+  std::vector<std::unique_ptr<SincResampler>> resamplers;
+  for (int i = 0; i < 32; ++i) {
+    resamplers.push_back(std::make_unique<SincResampler>(
+        1.0 + i / 100.0, SincResampler::kDefaultRequestSize, &mock_source,
+        &kernel_cache));
+  }
+  EXPECT_EQ(32u, kernel_cache.NumKernelsInUse());
+  resamplers.clear();
+  SincResampler resampler1(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                           &mock_source, &kernel_cache);
+  SincResampler resampler2(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                           &mock_source, &kernel_cache);
+  EXPECT_EQ(resampler1.get_kernel_for_testing(),
+            resampler2.get_kernel_for_testing());
+  EXPECT_EQ(1u, kernel_cache.NumKernelsInUse());
+  EXPECT_EQ(0, memcmp(kernel.data(), resampler1.get_kernel_for_testing(),
+                      sizeof(float) * SincResampler::kKernelStorageSize));
+}
+
 // Ensure various optimized Convolve() methods return the same value.  Only run
 // this test if other optimized methods exist, otherwise the default Convolve()
 // will be tested by the parameterized SincResampler tests below.
@@ -137,20 +207,20 @@ TEST(SincResamplerTest, Convolve) {
   // Use a kernel from SincResampler as input and kernel data, this has the
   // benefit of already being properly sized and aligned for Convolve_SSE().
   double result = resampler.Convolve_C(
-      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.kernel_, resampler.kernel_,
+      resampler.kernel_, kKernelInterpolationFactor);
   double result2 = resampler.convolve_proc_(
-      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.kernel_, resampler.kernel_,
+      resampler.kernel_, kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
 
   // Test Convolve() w/ unaligned input pointer.
   result = resampler.Convolve_C(
-      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.kernel_ + 1, resampler.kernel_,
+      resampler.kernel_, kKernelInterpolationFactor);
   result2 = resampler.convolve_proc_(
-      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.kernel_ + 1, resampler.kernel_,
+      resampler.kernel_, kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
 }
 
@@ -173,12 +243,13 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
   int64_t start = rtc::TimeNanos();
   for (int i = 0; i < kConvolveIterations; ++i) {
     resampler.Convolve_C(
-        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+        resampler.kernel_, resampler.kernel_,
+        resampler.kernel_, kKernelInterpolationFactor);
   }
   double total_time_c_us =
       (rtc::TimeNanos() - start) / rtc::kNumNanosecsPerMicrosec;
-  printf("Convolve_C took %.2fms.\n", total_time_c_us / 1000);
+  printf("Convolve_C took %.2fms (%.2f MSamples/sec).\n",
+         total_time_c_us / 1000, kConvolveIterations / total_time_c_us);
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
   ASSERT_TRUE(GetCPUInfo(kSSE2));
@@ -190,31 +261,33 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
   start = rtc::TimeNanos();
   for (int j = 0; j < kConvolveIterations; ++j) {
     resampler.convolve_proc_(
-        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
-        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+        resampler.kernel_ + 1, resampler.kernel_,
+        resampler.kernel_, kKernelInterpolationFactor);
   }
   double total_time_optimized_unaligned_us =
       (rtc::TimeNanos() - start) / rtc::kNumNanosecsPerMicrosec;
   printf(
-      "convolve_proc_(unaligned) took %.2fms; which is %.2fx "
-      "faster than Convolve_C.\n",
+      "convolve_proc_(unaligned) took %.2fms (%.2f MSamples/sec); which is "
+      "%.2fx faster than Convolve_C.\n",
       total_time_optimized_unaligned_us / 1000,
+      kConvolveIterations / total_time_optimized_unaligned_us,
       total_time_c_us / total_time_optimized_unaligned_us);
 
   // Benchmark with aligned input pointer.
   start = rtc::TimeNanos();
   for (int j = 0; j < kConvolveIterations; ++j) {
     resampler.convolve_proc_(
-        resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+        resampler.kernel_, resampler.kernel_,
+        resampler.kernel_, kKernelInterpolationFactor);
   }
   double total_time_optimized_aligned_us =
       (rtc::TimeNanos() - start) / rtc::kNumNanosecsPerMicrosec;
   printf(
-      "convolve_proc_ (aligned) took %.2fms; which is %.2fx "
-      "faster than Convolve_C and %.2fx faster than "
+      "convolve_proc_ (aligned) took %.2fms (%.2f MSamples/sec); which is "
+      "%.2fx faster than Convolve_C and %.2fx faster than "
       "convolve_proc_ (unaligned).\n",
       total_time_optimized_aligned_us / 1000,
+      kConvolveIterations / total_time_optimized_aligned_us,
       total_time_c_us / total_time_optimized_aligned_us,
       total_time_optimized_unaligned_us / total_time_optimized_aligned_us);
 }
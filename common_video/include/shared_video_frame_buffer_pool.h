@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INCLUDE_SHARED_VIDEO_FRAME_BUFFER_POOL_H_
+#define COMMON_VIDEO_INCLUDE_SHARED_VIDEO_FRAME_BUFFER_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "api/scoped_refptr.h"
+#include "api/video/i010_buffer.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+
+namespace webrtc {
+
+// Buffer pool meant to be shared by many decoders (or other producers of
+// frames) running on different threads, e.g., in a server decoding many
+// streams at varying resolutions. Unlike `VideoFrameBufferPool`, which belongs
+// to a single decoder and drops all its buffers when the resolution changes,
+// this pool keeps a free list per (pixel format, resolution). A buffer goes
+// back to its free list as soon as its last reference is released, so finding
+// a free buffer does not require scanning the buffers in use.
+//
+// The memory held by idle buffers is capped; when the cap is exceeded, the
+// buffers that have been idle the longest are freed first. Buffers in use do
+// not count towards the cap.
+//
+// This class is thread-safe. Buffers may outlive the pool; once the pool is
+// destroyed they are freed when released.
+class SharedVideoFrameBufferPool {
+ public:
+  static constexpr size_t kDefaultMaxIdleBytes = 64 * 1024 * 1024;
+
+  struct Stats {
+    // Number of buffers handed out from a free list and newly allocated.
+    int64_t buffers_reused = 0;
+    int64_t buffers_created = 0;
+    // Buffers currently in the free lists, and the memory they hold.
+    size_t idle_buffers = 0;
+    size_t idle_bytes = 0;
+    // Memory held by all the buffers of the pool, idle or in use.
+    size_t allocated_bytes = 0;
+
+    // Fraction of the requests that were served from a free list.
+    double HitRate() const;
+  };
+
+  // Returns the pool shared by the whole process.
+  static SharedVideoFrameBufferPool& Get();
+
+  explicit SharedVideoFrameBufferPool(
+      size_t max_idle_bytes = kDefaultMaxIdleBytes);
+  SharedVideoFrameBufferPool(const SharedVideoFrameBufferPool&) = delete;
+  SharedVideoFrameBufferPool& operator=(const SharedVideoFrameBufferPool&) =
+      delete;
+  ~SharedVideoFrameBufferPool();
+
+  // Return a buffer of the given resolution, reused if possible. The content
+  // of a reused buffer is unspecified.
+  rtc::scoped_refptr<I420Buffer> CreateI420Buffer(int width, int height);
+  rtc::scoped_refptr<NV12Buffer> CreateNV12Buffer(int width, int height);
+  rtc::scoped_refptr<I010Buffer> CreateI010Buffer(int width, int height);
+
+  // Changes the cap on the memory held by idle buffers, freeing the least
+  // recently used ones if needed.
+  void SetMaxIdleBytes(size_t max_idle_bytes);
+
+  // Frees all idle buffers.
+  void Clear();
+
+  Stats GetStats() const;
+
+ private:
+  class Core;
+
+  const rtc::scoped_refptr<Core> core_;
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INCLUDE_SHARED_VIDEO_FRAME_BUFFER_POOL_H_
@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/shared_video_frame_buffer_pool.h"
+
+#include <deque>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "api/video/video_frame_buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/ref_counter.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+namespace {
+
+size_t BufferBytes(const I420Buffer& buffer) {
+  return static_cast<size_t>(buffer.StrideY()) * buffer.height() +
+         static_cast<size_t>(buffer.StrideU() + buffer.StrideV()) *
+             buffer.ChromaHeight();
+}
+
+size_t BufferBytes(const NV12Buffer& buffer) {
+  return static_cast<size_t>(buffer.StrideY()) * buffer.height() +
+         static_cast<size_t>(buffer.StrideUV()) * buffer.ChromaHeight();
+}
+
+size_t BufferBytes(const I010Buffer& buffer) {
+  return sizeof(uint16_t) *
+         (static_cast<size_t>(buffer.StrideY()) * buffer.height() +
+          static_cast<size_t>(buffer.StrideU() + buffer.StrideV()) *
+              buffer.ChromaHeight());
+}
+
+}  // namespace
+
+// Owns the free lists. Buffers handed out keep a reference to the core, so
+// that they can be given back after the `SharedVideoFrameBufferPool` itself
+// is gone.
+class SharedVideoFrameBufferPool::Core : public rtc::RefCountInterface {
+ public:
+  explicit Core(size_t max_idle_bytes) : max_idle_bytes_(max_idle_bytes) {}
+  ~Core() override { RTC_DCHECK_EQ(stats_.idle_buffers, 0u); }
+
+  template <typename BufferT, typename... Args>
+  rtc::scoped_refptr<BufferT> Acquire(VideoFrameBuffer::Type type,
+                                      int width,
+                                      int height,
+                                      Args... args) {
+    const Key key(type, width, height);
+    {
+      MutexLock lock(&mutex_);
+      auto it = free_lists_.find(key);
+      if (it != free_lists_.end() && !it->second.empty()) {
+        // Take the most recently released buffer, which is the most likely to
+        // still be in the cache.
+        PooledBufferBase* buffer = it->second.back();
+        it->second.pop_back();
+        --stats_.idle_buffers;
+        stats_.idle_bytes -= buffer->bytes;
+        ++stats_.buffers_reused;
+        // The key includes the type, so the buffer is a `BufferT`.
+        return rtc::scoped_refptr<BufferT>(
+            static_cast<PooledBuffer<BufferT>*>(buffer));
+      }
+      ++stats_.buffers_created;
+    }
+
+    PooledBuffer<BufferT>* buffer =
+        new PooledBuffer<BufferT>(rtc::scoped_refptr<Core>(this), args...);
+    buffer->key = key;
+    buffer->bytes = BufferBytes(*buffer);
+    MutexLock lock(&mutex_);
+    stats_.allocated_bytes += buffer->bytes;
+    return rtc::scoped_refptr<BufferT>(buffer);
+  }
+
+  void SetMaxIdleBytes(size_t max_idle_bytes) {
+    std::vector<PooledBufferBase*> to_destroy;
+    {
+      MutexLock lock(&mutex_);
+      max_idle_bytes_ = max_idle_bytes;
+      TrimIdleBuffers(&to_destroy);
+    }
+    Destroy(to_destroy);
+  }
+
+  void Clear() {
+    std::vector<PooledBufferBase*> to_destroy;
+    {
+      MutexLock lock(&mutex_);
+      for (auto& kv : free_lists_) {
+        for (PooledBufferBase* buffer : kv.second) {
+          stats_.allocated_bytes -= buffer->bytes;
+          to_destroy.push_back(buffer);
+        }
+      }
+      free_lists_.clear();
+      stats_.idle_buffers = 0;
+      stats_.idle_bytes = 0;
+    }
+    Destroy(to_destroy);
+  }
+
+  Stats GetStats() const {
+    MutexLock lock(&mutex_);
+    return stats_;
+  }
+
+ private:
+  // (pixel format, width, height).
+  using Key = std::tuple<VideoFrameBuffer::Type, int, int>;
+
+  // Pool bookkeeping of a buffer, independent of its pixel format.
+  class PooledBufferBase {
+   public:
+    virtual void Destroy() = 0;
+
+    Key key;
+    size_t bytes = 0;
+    // Value of `release_count_` when the buffer was last given back.
+    uint64_t idle_since = 0;
+
+   protected:
+    virtual ~PooledBufferBase() = default;
+  };
+
+  // A `BufferT` whose memory goes back to the pool when its last reference is
+  // released, instead of being freed.
+  template <typename BufferT>
+  class PooledBuffer final : public BufferT, public PooledBufferBase {
+   public:
+    template <typename... Args>
+    PooledBuffer(rtc::scoped_refptr<Core> core, Args... args)
+        : BufferT(args...), core_(std::move(core)) {}
+
+    void AddRef() const override { ref_count_.IncRef(); }
+    rtc::RefCountReleaseStatus Release() const override {
+      const rtc::RefCountReleaseStatus status = ref_count_.DecRef();
+      if (status == rtc::RefCountReleaseStatus::kDroppedLastRef) {
+        core_->Recycle(const_cast<PooledBuffer*>(this));
+      }
+      return status;
+    }
+
+    void Destroy() override { delete this; }
+
+   private:
+    const rtc::scoped_refptr<Core> core_;
+    mutable webrtc_impl::RefCounter ref_count_{0};
+  };
+
+  void Recycle(PooledBufferBase* buffer) {
+    std::vector<PooledBufferBase*> to_destroy;
+    {
+      MutexLock lock(&mutex_);
+      if (buffer->bytes > max_idle_bytes_) {
+        stats_.allocated_bytes -= buffer->bytes;
+        to_destroy.push_back(buffer);
+      } else {
+        buffer->idle_since = ++release_count_;
+        free_lists_[buffer->key].push_back(buffer);
+        ++stats_.idle_buffers;
+        stats_.idle_bytes += buffer->bytes;
+        TrimIdleBuffers(&to_destroy);
+      }
+    }
+    if (!to_destroy.empty()) {
+      // The destroyed buffers may hold the last references to `this`.
+      rtc::scoped_refptr<Core> self(this);
+      Destroy(to_destroy);
+    }
+  }
+
+  // Moves the least recently released buffers to `to_destroy` until the idle
+  // buffers fit within `max_idle_bytes_`. Within a free list buffers are in
+  // release order, so the oldest idle buffer is at the front of one of them.
+  void TrimIdleBuffers(std::vector<PooledBufferBase*>* to_destroy)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    while (stats_.idle_bytes > max_idle_bytes_) {
+      auto oldest = free_lists_.end();
+      for (auto it = free_lists_.begin(); it != free_lists_.end(); ++it) {
+        if (!it->second.empty() &&
+            (oldest == free_lists_.end() ||
+             it->second.front()->idle_since <
+                 oldest->second.front()->idle_since)) {
+          oldest = it;
+        }
+      }
+      RTC_DCHECK(oldest != free_lists_.end());
+      PooledBufferBase* buffer = oldest->second.front();
+      oldest->second.pop_front();
+      if (oldest->second.empty()) {
+        free_lists_.erase(oldest);
+      }
+      --stats_.idle_buffers;
+      stats_.idle_bytes -= buffer->bytes;
+      stats_.allocated_bytes -= buffer->bytes;
+      to_destroy->push_back(buffer);
+    }
+  }
+
+  static void Destroy(const std::vector<PooledBufferBase*>& buffers) {
+    for (PooledBufferBase* buffer : buffers) {
+      buffer->Destroy();
+    }
+  }
+
+  mutable Mutex mutex_;
+  size_t max_idle_bytes_ RTC_GUARDED_BY(mutex_);
+  uint64_t release_count_ RTC_GUARDED_BY(mutex_) = 0;
+  std::map<Key, std::deque<PooledBufferBase*>> free_lists_
+      RTC_GUARDED_BY(mutex_);
+  Stats stats_ RTC_GUARDED_BY(mutex_);
+};
+
+double SharedVideoFrameBufferPool::Stats::HitRate() const {
+  const int64_t requests = buffers_reused + buffers_created;
+  return requests > 0 ? static_cast<double>(buffers_reused) / requests : 0.0;
+}
+
+SharedVideoFrameBufferPool& SharedVideoFrameBufferPool::Get() {
+  static SharedVideoFrameBufferPool* const pool =
+      new SharedVideoFrameBufferPool();
+  return *pool;
+}
+
+SharedVideoFrameBufferPool::SharedVideoFrameBufferPool(size_t max_idle_bytes)
+    : core_(rtc::make_ref_counted<Core>(max_idle_bytes)) {}
+
+SharedVideoFrameBufferPool::~SharedVideoFrameBufferPool() {
+  // Buffers still in use are freed when released.
+  core_->SetMaxIdleBytes(0);
+}
+
+rtc::scoped_refptr<I420Buffer> SharedVideoFrameBufferPool::CreateI420Buffer(
+    int width,
+    int height) {
+  return core_->Acquire<I420Buffer>(VideoFrameBuffer::Type::kI420, width,
+                                    height, width, height);
+}
+
+rtc::scoped_refptr<NV12Buffer> SharedVideoFrameBufferPool::CreateNV12Buffer(
+    int width,
+    int height) {
+  return core_->Acquire<NV12Buffer>(VideoFrameBuffer::Type::kNV12, width,
+                                    height, width, height);
+}
+
+rtc::scoped_refptr<I010Buffer> SharedVideoFrameBufferPool::CreateI010Buffer(
+    int width,
+    int height) {
+  // Same layout as I010Buffer::Create().
+  return core_->Acquire<I010Buffer>(VideoFrameBuffer::Type::kI010, width,
+                                    height, width, height, width,
+                                    (width + 1) / 2, (width + 1) / 2);
+}
+
+void SharedVideoFrameBufferPool::SetMaxIdleBytes(size_t max_idle_bytes) {
+  core_->SetMaxIdleBytes(max_idle_bytes);
+}
+
+void SharedVideoFrameBufferPool::Clear() {
+  core_->Clear();
+}
+
+SharedVideoFrameBufferPool::Stats SharedVideoFrameBufferPool::GetStats()
+    const {
+  return core_->GetStats();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/shared_video_frame_buffer_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/video/video_frame_buffer.h"
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+// Size of a 16x16 I420 buffer.
+constexpr size_t kI420Bytes16x16 = 16 * 16 + 2 * 8 * 8;
+
+}  // namespace
+
+TEST(SharedVideoFrameBufferPoolTest, ReusesReleasedBufferOfSameResolution) {
+  SharedVideoFrameBufferPool pool;
+  rtc::scoped_refptr<I420Buffer> buffer = pool.CreateI420Buffer(16, 16);
+  const uint8_t* y_ptr = buffer->DataY();
+  buffer = nullptr;
+
+  buffer = pool.CreateI420Buffer(16, 16);
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  EXPECT_EQ(y_ptr, buffer->DataY());
+  const SharedVideoFrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.buffers_created, 1);
+  EXPECT_EQ(stats.buffers_reused, 1);
+  EXPECT_DOUBLE_EQ(stats.HitRate(), 0.5);
+}
+
+TEST(SharedVideoFrameBufferPoolTest, KeepsFreeListPerResolutionAndFormat) {
+  SharedVideoFrameBufferPool pool;
+  rtc::scoped_refptr<I420Buffer> small = pool.CreateI420Buffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> large = pool.CreateI420Buffer(32, 32);
+  rtc::scoped_refptr<NV12Buffer> nv12 = pool.CreateNV12Buffer(16, 16);
+  rtc::scoped_refptr<I010Buffer> i010 = pool.CreateI010Buffer(16, 16);
+  const uint8_t* small_ptr = small->DataY();
+  const uint8_t* large_ptr = large->DataY();
+  const uint8_t* nv12_ptr = nv12->DataY();
+  const uint16_t* i010_ptr = i010->DataY();
+  small = nullptr;
+  large = nullptr;
+  nv12 = nullptr;
+  i010 = nullptr;
+  EXPECT_EQ(pool.GetStats().idle_buffers, 4u);
+
+  // Unlike VideoFrameBufferPool, asking for another resolution does not drop
+  // the buffers of the previous one.
+  large = pool.CreateI420Buffer(32, 32);
+  small = pool.CreateI420Buffer(16, 16);
+  nv12 = pool.CreateNV12Buffer(16, 16);
+  i010 = pool.CreateI010Buffer(16, 16);
+  EXPECT_EQ(large_ptr, large->DataY());
+  EXPECT_EQ(small_ptr, small->DataY());
+  EXPECT_EQ(nv12_ptr, nv12->DataY());
+  EXPECT_EQ(i010_ptr, i010->DataY());
+  EXPECT_EQ(VideoFrameBuffer::Type::kNV12, nv12->type());
+  EXPECT_EQ(VideoFrameBuffer::Type::kI010, i010->type());
+  EXPECT_EQ(pool.GetStats().buffers_reused, 4);
+}
+
+TEST(SharedVideoFrameBufferPoolTest, TracksIdleAndAllocatedBytes) {
+  SharedVideoFrameBufferPool pool;
+  rtc::scoped_refptr<I420Buffer> first = pool.CreateI420Buffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> second = pool.CreateI420Buffer(16, 16);
+  SharedVideoFrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.allocated_bytes, 2 * kI420Bytes16x16);
+  EXPECT_EQ(stats.idle_bytes, 0u);
+
+  first = nullptr;
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.allocated_bytes, 2 * kI420Bytes16x16);
+  EXPECT_EQ(stats.idle_bytes, kI420Bytes16x16);
+
+  pool.Clear();
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.allocated_bytes, kI420Bytes16x16);
+  EXPECT_EQ(stats.idle_bytes, 0u);
+  EXPECT_EQ(stats.idle_buffers, 0u);
+}
+
+TEST(SharedVideoFrameBufferPoolTest, TrimsLeastRecentlyReleasedBuffers) {
+  SharedVideoFrameBufferPool pool(/*max_idle_bytes=*/2 * kI420Bytes16x16);
+  rtc::scoped_refptr<I420Buffer> a = pool.CreateI420Buffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> b = pool.CreateI420Buffer(16, 16);
+  rtc::scoped_refptr<I420Buffer> c = pool.CreateI420Buffer(16, 16);
+  const uint8_t* b_ptr = b->DataY();
+  const uint8_t* c_ptr = c->DataY();
+  a = nullptr;
+  b = nullptr;
+  c = nullptr;
+  // `a` was the least recently released one.
+  SharedVideoFrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.idle_buffers, 2u);
+  EXPECT_EQ(stats.allocated_bytes, 2 * kI420Bytes16x16);
+  b = pool.CreateI420Buffer(16, 16);
+  c = pool.CreateI420Buffer(16, 16);
+  EXPECT_EQ(c_ptr, b->DataY());
+  EXPECT_EQ(b_ptr, c->DataY());
+  b = nullptr;
+  c = nullptr;
+
+  pool.SetMaxIdleBytes(kI420Bytes16x16);
+  stats = pool.GetStats();
+  EXPECT_EQ(stats.idle_buffers, 1u);
+  EXPECT_EQ(stats.idle_bytes, kI420Bytes16x16);
+}
+
+TEST(SharedVideoFrameBufferPoolTest, DoesNotKeepBuffersLargerThanCap) {
+  SharedVideoFrameBufferPool pool(/*max_idle_bytes=*/kI420Bytes16x16);
+  rtc::scoped_refptr<I420Buffer> buffer = pool.CreateI420Buffer(32, 32);
+  buffer = nullptr;
+  const SharedVideoFrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.idle_buffers, 0u);
+  EXPECT_EQ(stats.allocated_bytes, 0u);
+}
+
+TEST(SharedVideoFrameBufferPoolTest, BufferValidAfterPoolDestruction) {
+  rtc::scoped_refptr<I420Buffer> buffer;
+  {
+    SharedVideoFrameBufferPool pool;
+    buffer = pool.CreateI420Buffer(16, 16);
+  }
+  EXPECT_EQ(16, buffer->width());
+  EXPECT_EQ(16, buffer->height());
+  // Try to trigger use-after-free errors by writing to y-plane.
+  memset(buffer->MutableDataY(), 0xa5, 16 * buffer->StrideY());
+}
+
+TEST(SharedVideoFrameBufferPoolTest, BuffersCanBeReleasedOnOtherThreads) {
+  constexpr int kNumIterations = 1000;
+  SharedVideoFrameBufferPool pool;
+  std::vector<rtc::PlatformThread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.push_back(rtc::PlatformThread::SpawnJoinable(
+        [&pool, t] {
+          for (int i = 0; i < kNumIterations; ++i) {
+            rtc::scoped_refptr<I420Buffer> buffer =
+                pool.CreateI420Buffer(16 * (1 + t % 2), 16);
+            buffer->MutableDataY()[0] = static_cast<uint8_t>(i);
+          }
+        },
+        "PoolThread"));
+  }
+  threads.clear();
+  const SharedVideoFrameBufferPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.buffers_created + stats.buffers_reused, 4 * kNumIterations);
+  EXPECT_EQ(stats.allocated_bytes, stats.idle_bytes);
+  EXPECT_LE(stats.buffers_created, 4);
+}
+
+}  // namespace webrtc
@@ -76,6 +76,10 @@ void EncoderSimulcastProxy::OnLossNotification(
   encoder_->OnLossNotification(loss_notification);
 }
 
+void EncoderSimulcastProxy::SetComplexityReduction(int steps) {
+  encoder_->SetComplexityReduction(steps);
+}
+
 VideoEncoder::EncoderInfo EncoderSimulcastProxy::GetEncoderInfo() const {
   return encoder_->GetEncoderInfo();
 }
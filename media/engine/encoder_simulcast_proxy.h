@@ -50,6 +50,7 @@ class RTC_EXPORT EncoderSimulcastProxy : public VideoEncoder {
   void OnPacketLossRateUpdate(float packet_loss_rate) override;
   void OnRttUpdate(int64_t rtt_ms) override;
   void OnLossNotification(const LossNotification& loss_notification) override;
+  void SetComplexityReduction(int steps) override;
   EncoderInfo GetEncoderInfo() const override;
 
  private:
@@ -175,6 +175,7 @@ SimulcastEncoderAdapter::StreamContext::StreamContext(
     : parent_(parent),
       encoder_context_(std::move(encoder_context)),
       framerate_controller_(std::move(framerate_controller)),
+      scaled_buffer_pool_(std::make_unique<VideoFrameBufferPool>()),
       stream_idx_(stream_idx),
       width_(width),
       height_(height),
@@ -189,6 +190,7 @@ SimulcastEncoderAdapter::StreamContext::StreamContext(StreamContext&& rhs)
     : parent_(rhs.parent_),
       encoder_context_(std::move(rhs.encoder_context_)),
       framerate_controller_(std::move(rhs.framerate_controller_)),
+      scaled_buffer_pool_(std::move(rhs.scaled_buffer_pool_)),
       stream_idx_(rhs.stream_idx_),
       width_(rhs.width_),
       height_(rhs.height_),
@@ -483,12 +485,17 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
-  // Temporary thay may hold the result of texture to i420 buffer conversion.
-  rtc::scoped_refptr<VideoFrameBuffer> src_buffer;
-  int src_width = input_image.width();
-  int src_height = input_image.height();
+  const int src_width = input_image.width();
+  const int src_height = input_image.height();
 
-  for (auto& layer : stream_contexts_) {
+  // Decide first which layers are encoded, and with which frame types, so that
+  // only the layers that are actually encoded get scaled. An empty entry in
+  // `layer_frame_types` means that the layer is not encoded.
+  std::vector<std::vector<VideoFrameType>> layer_frame_types(
+      stream_contexts_.size());
+  std::vector<size_t> layers_to_scale;
+  for (size_t i = 0; i < stream_contexts_.size(); ++i) {
+    StreamContext& layer = stream_contexts_[i];
     // Don't encode frames in resolutions that we don't intend to send.
     if (layer.is_paused()) {
       continue;
@@ -514,6 +521,7 @@ int SimulcastEncoderAdapter::Encode(
       std::fill(stream_frame_types.begin(), stream_frame_types.end(),
                 VideoFrameType::kVideoFrameDelta);
     }
+    layer_frame_types[i] = std::move(stream_frame_types);
 
     // If scaling isn't required, because the input resolution
     // matches the destination or the input image is empty (e.g.
@@ -529,36 +537,108 @@ int SimulcastEncoderAdapter::Encode(
         (input_image.video_frame_buffer()->type() ==
              VideoFrameBuffer::Type::kNative &&
          layer.encoder().GetEncoderInfo().supports_native_handle)) {
-      int ret = layer.encoder().Encode(input_image, &stream_frame_types);
+      continue;
+    }
+    layers_to_scale.push_back(i);
+  }
+
+  std::vector<rtc::scoped_refptr<VideoFrameBuffer>> scaled_buffers(
+      stream_contexts_.size());
+  if (!layers_to_scale.empty() &&
+      !ScaleToLayers(input_image.video_frame_buffer(), layers_to_scale,
+                     &scaled_buffers)) {
+    RTC_LOG(LS_ERROR) << "Failed to scale video frame";
+    return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
+  }
+
+  for (size_t i = 0; i < stream_contexts_.size(); ++i) {
+    if (layer_frame_types[i].empty()) {
+      continue;
+    }
+    StreamContext& layer = stream_contexts_[i];
+    if (!scaled_buffers[i]) {
+      int ret = layer.encoder().Encode(input_image, &layer_frame_types[i]);
       if (ret != WEBRTC_VIDEO_CODEC_OK) {
         return ret;
       }
-    } else {
-      if (src_buffer == nullptr) {
-        src_buffer = input_image.video_frame_buffer();
+      continue;
+    }
+
+    // UpdateRect is not propagated to lower simulcast layers currently.
+    // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
+    VideoFrame frame(input_image);
+    frame.set_video_frame_buffer(scaled_buffers[i]);
+    frame.set_rotation(webrtc::kVideoRotation_0);
+    frame.set_update_rect(
+        VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
+    int ret = layer.encoder().Encode(frame, &layer_frame_types[i]);
+    if (ret != WEBRTC_VIDEO_CODEC_OK) {
+      return ret;
+    }
+  }
+
+  return WEBRTC_VIDEO_CODEC_OK;
+}
+
+bool SimulcastEncoderAdapter::ScaleToLayers(
+    const rtc::scoped_refptr<VideoFrameBuffer>& input,
+    const std::vector<size_t>& layer_indices,
+    std::vector<rtc::scoped_refptr<VideoFrameBuffer>>* scaled_buffers) {
+  RTC_DCHECK_EQ(scaled_buffers->size(), stream_contexts_.size());
+  if (input->type() != VideoFrameBuffer::Type::kI420) {
+    // Let the buffer scale itself; e.g., a native buffer may be able to do it
+    // without a conversion to I420.
+    for (size_t i : layer_indices) {
+      StreamContext& layer = stream_contexts_[i];
+      (*scaled_buffers)[i] = input->Scale(layer.width(), layer.height());
+      if (!(*scaled_buffers)[i]) {
+        return false;
       }
-      rtc::scoped_refptr<VideoFrameBuffer> dst_buffer =
-          src_buffer->Scale(layer.width(), layer.height());
-      if (!dst_buffer) {
-        RTC_LOG(LS_ERROR) << "Failed to scale video frame";
-        return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
+    }
+    return true;
+  }
+
+  // Build a pyramid from the largest layer downwards, where each level is
+  // scaled from the smallest level already built that is at least as large,
+  // instead of from the input. With the usual factor of two between layers,
+  // the full resolution input is then read once rather than once per layer.
+  std::vector<size_t> order = layer_indices;
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return int64_t{stream_contexts_[a].width()} * stream_contexts_[a].height() >
+           int64_t{stream_contexts_[b].width()} * stream_contexts_[b].height();
+  });
+  for (size_t k = 0; k < order.size(); ++k) {
+    StreamContext& layer = stream_contexts_[order[k]];
+    rtc::scoped_refptr<VideoFrameBuffer> source = input;
+    for (size_t j = 0; j < k; ++j) {
+      const rtc::scoped_refptr<VideoFrameBuffer>& level =
+          (*scaled_buffers)[order[j]];
+      if (level->width() >= layer.width() &&
+          level->height() >= layer.height()) {
+        source = level;
       }
+    }
+    if (source->width() == layer.width() &&
+        source->height() == layer.height()) {
+      (*scaled_buffers)[order[k]] = source;
+      continue;
+    }
 
-      // UpdateRect is not propagated to lower simulcast layers currently.
-      // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
-      VideoFrame frame(input_image);
-      frame.set_video_frame_buffer(dst_buffer);
-      frame.set_rotation(webrtc::kVideoRotation_0);
-      frame.set_update_rect(
-          VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
-      int ret = layer.encoder().Encode(frame, &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
+    rtc::scoped_refptr<I420Buffer> buffer =
+        layer.scaled_buffer_pool().CreateI420Buffer(layer.width(),
+                                                    layer.height());
+    if (!buffer) {
+      (*scaled_buffers)[order[k]] =
+          source->Scale(layer.width(), layer.height());
+      if (!(*scaled_buffers)[order[k]]) {
+        return false;
       }
+      continue;
     }
+    buffer->ScaleFrom(*source->GetI420());
+    (*scaled_buffers)[order[k]] = buffer;
   }
-
-  return WEBRTC_VIDEO_CODEC_OK;
+  return true;
 }
 
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
@@ -658,6 +738,13 @@ void SimulcastEncoderAdapter::OnLossNotification(
   }
 }
 
+void SimulcastEncoderAdapter::SetComplexityReduction(int steps) {
+  for (auto& c : stream_contexts_) {
+    c.encoder().SetComplexityReduction(
+        std::min(steps, c.encoder().GetEncoderInfo().max_complexity_reduction));
+  }
+}
+
 // TODO(brandtr): Add task checker to this member function, when all encoder
 // callbacks are coming in on the encoder queue.
 EncodedImageCallback::Result SimulcastEncoderAdapter::OnEncodedImage(
@@ -898,6 +985,8 @@ VideoEncoder::EncoderInfo SimulcastEncoderAdapter::GetEncoderInfo() const {
           encoder_impl_info.is_hardware_accelerated;
       encoder_info.has_internal_source = encoder_impl_info.has_internal_source;
       encoder_info.is_qp_trusted = encoder_impl_info.is_qp_trusted;
+      encoder_info.max_complexity_reduction =
+          encoder_impl_info.max_complexity_reduction;
     } else {
       encoder_info.implementation_name += ", ";
       encoder_info.implementation_name += encoder_impl_info.implementation_name;
@@ -925,6 +1014,11 @@ VideoEncoder::EncoderInfo SimulcastEncoderAdapter::GetEncoderInfo() const {
       encoder_info.is_qp_trusted =
           encoder_info.is_qp_trusted.value_or(true) &
           encoder_impl_info.is_qp_trusted.value_or(true);
+
+      // The layers can be made faster by as many steps as the fastest one.
+      encoder_info.max_complexity_reduction =
+          std::max(encoder_info.max_complexity_reduction,
+                   encoder_impl_info.max_complexity_reduction);
     }
     encoder_info.fps_allocation[i] = encoder_impl_info.fps_allocation[0];
     encoder_info.requested_resolution_alignment = cricket::LeastCommonMultiple(
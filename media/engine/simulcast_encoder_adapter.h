@@ -21,11 +21,14 @@
 
 #include "absl/types/optional.h"
 #include "api/fec_controller_override.h"
+#include "api/scoped_refptr.h"
 #include "api/sequence_checker.h"
+#include "api/video/video_frame_buffer.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
 #include "common_video/framerate_controller.h"
+#include "common_video/include/video_frame_buffer_pool.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "rtc_base/atomic_ops.h"
 #include "rtc_base/experiments/encoder_info_settings.h"
@@ -64,6 +67,7 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
   void OnPacketLossRateUpdate(float packet_loss_rate) override;
   void OnRttUpdate(int64_t rtt_ms) override;
   void OnLossNotification(const LossNotification& loss_notification) override;
+  void SetComplexityReduction(int steps) override;
 
   EncoderInfo GetEncoderInfo() const override;
 
@@ -120,6 +124,8 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     void set_is_keyframe_needed() { is_keyframe_needed_ = true; }
     bool is_paused() const { return is_paused_; }
     void set_is_paused(bool is_paused) { is_paused_ = is_paused; }
+    // Pool of the buffers that the input frame is scaled into for this layer.
+    VideoFrameBufferPool& scaled_buffer_pool() { return *scaled_buffer_pool_; }
     absl::optional<double> target_fps() const {
       return framerate_controller_ == nullptr
                  ? absl::nullopt
@@ -135,6 +141,7 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     SimulcastEncoderAdapter* const parent_;
     std::unique_ptr<EncoderContext> encoder_context_;
     std::unique_ptr<FramerateController> framerate_controller_;
+    std::unique_ptr<VideoFrameBufferPool> scaled_buffer_pool_;
     const int stream_idx_;
     const uint16_t width_;
     const uint16_t height_;
@@ -165,6 +172,14 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   void OnDroppedFrame(size_t stream_idx);
 
+  // Scales `input` to the resolution of each of the `stream_contexts_` with
+  // index in `layer_indices` and stores the result in `scaled_buffers`, which
+  // is indexed like `stream_contexts_`. Returns false if scaling failed.
+  bool ScaleToLayers(
+      const rtc::scoped_refptr<VideoFrameBuffer>& input,
+      const std::vector<size_t>& layer_indices,
+      std::vector<rtc::scoped_refptr<VideoFrameBuffer>>* scaled_buffers);
+
   void OverrideFromFieldTrial(VideoEncoder::EncoderInfo* info) const;
 
   volatile int inited_;  // Accessed atomically.
@@ -18,6 +18,7 @@
 #include "api/test/simulcast_test_fixture.h"
 #include "api/test/video/function_video_decoder_factory.h"
 #include "api/test/video/function_video_encoder_factory.h"
+#include "api/video/i420_buffer.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
@@ -1082,6 +1083,82 @@ TEST_F(TestSimulcastEncoderAdapterFake, NativeHandleForwardingOnlyIfSupported) {
   EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake, ScalesLowerLayersFromPooledPyramid) {
+  SimulcastTestFixtureImpl::DefaultSettings(
+      &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
+      kVideoCodecVP8);
+  codec_.numberOfSimulcastStreams = 3;
+  // High start bitrate, so all streams are enabled.
+  codec_.startBitrate = 3000;
+  EXPECT_EQ(0, adapter_->InitEncode(&codec_, kSettings));
+  adapter_->RegisterEncodeCompleteCallback(this);
+  auto& encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+
+  // A smooth gradient, so that scaling in steps and scaling directly give
+  // almost the same result.
+  rtc::scoped_refptr<I420Buffer> input_buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  for (int y = 0; y < kDefaultHeight; ++y) {
+    for (int x = 0; x < kDefaultWidth; ++x) {
+      input_buffer->MutableDataY()[y * input_buffer->StrideY() + x] =
+          (x + y) * 255 / (kDefaultWidth + kDefaultHeight);
+    }
+  }
+  for (int y = 0; y < input_buffer->ChromaHeight(); ++y) {
+    for (int x = 0; x < input_buffer->ChromaWidth(); ++x) {
+      input_buffer->MutableDataU()[y * input_buffer->StrideU() + x] =
+          x * 255 / input_buffer->ChromaWidth();
+      input_buffer->MutableDataV()[y * input_buffer->StrideV() + x] =
+          y * 255 / input_buffer->ChromaHeight();
+    }
+  }
+  VideoFrame input_frame = VideoFrame::Builder()
+                               .set_video_frame_buffer(input_buffer)
+                               .set_timestamp_rtp(100)
+                               .set_timestamp_ms(1000)
+                               .set_rotation(kVideoRotation_0)
+                               .build();
+
+  // The top layer gets the input frame as is.
+  EXPECT_CALL(*encoders[2], Encode(::testing::Ref(input_frame), _)).Times(2);
+  // The lower layers get pooled I420 buffers that are reused from one frame
+  // to the next and match direct scaling of the input.
+  std::array<const uint8_t*, 2> first_frame_data = {nullptr, nullptr};
+  for (size_t i = 0; i < 2; ++i) {
+    EXPECT_CALL(*encoders[i], Encode)
+        .Times(2)
+        .WillRepeatedly([&, i](const VideoFrame& frame,
+                               const std::vector<VideoFrameType>* frame_types) {
+          EXPECT_EQ(frame.width(), codec_.simulcastStream[i].width);
+          EXPECT_EQ(frame.height(), codec_.simulcastStream[i].height);
+          EXPECT_EQ(frame.video_frame_buffer()->type(),
+                    VideoFrameBuffer::Type::kI420);
+          const I420BufferInterface* scaled =
+              frame.video_frame_buffer()->GetI420();
+          if (first_frame_data[i] == nullptr) {
+            first_frame_data[i] = scaled->DataY();
+          } else {
+            EXPECT_EQ(first_frame_data[i], scaled->DataY());
+          }
+
+          rtc::scoped_refptr<I420BufferInterface> expected =
+              input_buffer->Scale(frame.width(), frame.height())->ToI420();
+          for (int y = 0; y < frame.height(); ++y) {
+            for (int x = 0; x < frame.width(); ++x) {
+              EXPECT_NEAR(scaled->DataY()[y * scaled->StrideY() + x],
+                          expected->DataY()[y * expected->StrideY() + x], 2);
+            }
+          }
+          return 0;
+        });
+  }
+
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+  EXPECT_EQ(0, adapter_->Encode(input_frame, &frame_types));
+}
+
 TEST_F(TestSimulcastEncoderAdapterFake, TestFailureReturnCodesFromEncodeCalls) {
   SimulcastTestFixtureImpl::DefaultSettings(
       &codec_, static_cast<const int*>(kTestTemporalLayerProfile),
@@ -16,6 +16,7 @@
 #include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "modules/audio_coding/codecs/opus/audio_coder_opus_common.h"
+#include "modules/audio_coding/codecs/opus/opus_instance_pool.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -25,14 +26,14 @@ AudioDecoderOpusImpl::AudioDecoderOpusImpl(size_t num_channels,
     : channels_{num_channels}, sample_rate_hz_{sample_rate_hz} {
   RTC_DCHECK(num_channels == 1 || num_channels == 2);
   RTC_DCHECK(sample_rate_hz == 16000 || sample_rate_hz == 48000);
-  const int error =
-      WebRtcOpus_DecoderCreate(&dec_state_, channels_, sample_rate_hz_);
-  RTC_DCHECK(error == 0);
+  dec_state_ =
+      OpusInstancePool::Get().AcquireDecoder(channels_, sample_rate_hz_);
+  RTC_DCHECK(dec_state_);
   WebRtcOpus_DecoderInit(dec_state_);
 }
 
 AudioDecoderOpusImpl::~AudioDecoderOpusImpl() {
-  WebRtcOpus_DecoderFree(dec_state_);
+  OpusInstancePool::Get().ReleaseDecoder(dec_state_);
 }
 
 std::vector<AudioDecoder::ParseResult> AudioDecoderOpusImpl::ParsePayload(
@@ -20,6 +20,7 @@
 #include "modules/audio_coding/audio_network_adaptor/audio_network_adaptor_impl.h"
 #include "modules/audio_coding/audio_network_adaptor/controller_manager.h"
 #include "modules/audio_coding/codecs/opus/audio_coder_opus_common.h"
+#include "modules/audio_coding/codecs/opus/opus_instance_pool.h"
 #include "modules/audio_coding/codecs/opus/opus_interface.h"
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
@@ -384,7 +385,7 @@ AudioEncoderOpusImpl::AudioEncoderOpusImpl(int payload_type,
     : AudioEncoderOpusImpl(*SdpToConfig(format), payload_type) {}
 
 AudioEncoderOpusImpl::~AudioEncoderOpusImpl() {
-  RTC_CHECK_EQ(0, WebRtcOpus_EncoderFree(inst_));
+  OpusInstancePool::Get().ReleaseEncoder(inst_);
 }
 
 int AudioEncoderOpusImpl::SampleRateHz() const {
@@ -660,16 +661,18 @@ bool AudioEncoderOpusImpl::RecreateEncoderInstance(
     return false;
   config_ = config;
   if (inst_)
-    RTC_CHECK_EQ(0, WebRtcOpus_EncoderFree(inst_));
+    OpusInstancePool::Get().ReleaseEncoder(inst_);
   input_buffer_.clear();
   input_buffer_.reserve(Num10msFramesPerPacket() * SamplesPer10msFrame());
-  RTC_CHECK_EQ(0, WebRtcOpus_EncoderCreate(
-                      &inst_, config.num_channels,
-                      config.application ==
-                              AudioEncoderOpusConfig::ApplicationMode::kVoip
-                          ? 0
-                          : 1,
-                      config.sample_rate_hz));
+  // Encoder states are recycled through a process-wide pool to keep codec
+  // setup off the critical path of joins and renegotiations.
+  inst_ = OpusInstancePool::Get().AcquireEncoder(
+      config.num_channels,
+      config.application == AudioEncoderOpusConfig::ApplicationMode::kVoip
+          ? 0
+          : 1,
+      config.sample_rate_hz);
+  RTC_CHECK(inst_);
   const int bitrate = GetBitrateBps(config);
   RTC_CHECK_EQ(0, WebRtcOpus_SetBitRate(inst_, bitrate));
   RTC_LOG(LS_VERBOSE) << "Set Opus bitrate to " << bitrate << " bps.";
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/codecs/opus/opus_instance_pool.h"
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+constexpr size_t OpusInstancePool::kMaxIdleInstancesPerKey;
+
+OpusInstancePool& OpusInstancePool::Get() {
+  static OpusInstancePool* const pool = new OpusInstancePool();
+  return *pool;
+}
+
+OpusInstancePool::OpusInstancePool() = default;
+
+OpusInstancePool::~OpusInstancePool() {
+  for (auto& kv : idle_encoders_) {
+    for (OpusEncInst* inst : kv.second) {
+      WebRtcOpus_EncoderFree(inst);
+    }
+  }
+  for (auto& kv : idle_decoders_) {
+    for (OpusDecInst* inst : kv.second) {
+      WebRtcOpus_DecoderFree(inst);
+    }
+  }
+}
+
+OpusEncInst* OpusInstancePool::AcquireEncoder(size_t channels,
+                                              int32_t application,
+                                              int sample_rate_hz) {
+  {
+    MutexLock lock(&mutex_);
+    auto it = idle_encoders_.find(Key(sample_rate_hz, channels, application));
+    if (it != idle_encoders_.end() && !it->second.empty()) {
+      OpusEncInst* inst = it->second.back();
+      it->second.pop_back();
+      ++stats_.encoders_reused;
+      return inst;
+    }
+    ++stats_.encoders_created;
+  }
+  OpusEncInst* inst = nullptr;
+  if (WebRtcOpus_EncoderCreate(&inst, channels, application, sample_rate_hz) !=
+      0) {
+    return nullptr;
+  }
+  return inst;
+}
+
+void OpusInstancePool::ReleaseEncoder(OpusEncInst* inst) {
+  if (!inst) {
+    return;
+  }
+  // Reinitialize outside of the lock; this is what makes reuse safe.
+  const int32_t application = WebRtcOpus_EncoderApplication(inst);
+  if (application < 0 || WebRtcOpus_EncoderReinit(inst) != 0) {
+    WebRtcOpus_EncoderFree(inst);
+    return;
+  }
+  {
+    MutexLock lock(&mutex_);
+    std::vector<OpusEncInst*>& idle = idle_encoders_[Key(
+        inst->sample_rate_hz, inst->channels, application)];
+    if (idle.size() < kMaxIdleInstancesPerKey) {
+      idle.push_back(inst);
+      return;
+    }
+  }
+  WebRtcOpus_EncoderFree(inst);
+}
+
+OpusDecInst* OpusInstancePool::AcquireDecoder(size_t channels,
+                                              int sample_rate_hz) {
+  {
+    MutexLock lock(&mutex_);
+    auto it = idle_decoders_.find(Key(sample_rate_hz, channels, -1));
+    if (it != idle_decoders_.end() && !it->second.empty()) {
+      OpusDecInst* inst = it->second.back();
+      it->second.pop_back();
+      ++stats_.decoders_reused;
+      return inst;
+    }
+    ++stats_.decoders_created;
+  }
+  OpusDecInst* inst = nullptr;
+  if (WebRtcOpus_DecoderCreate(&inst, channels, sample_rate_hz) != 0) {
+    return nullptr;
+  }
+  return inst;
+}
+
+void OpusInstancePool::ReleaseDecoder(OpusDecInst* inst) {
+  if (!inst) {
+    return;
+  }
+  if (WebRtcOpus_DecoderReinit(inst) != 0) {
+    WebRtcOpus_DecoderFree(inst);
+    return;
+  }
+  {
+    MutexLock lock(&mutex_);
+    std::vector<OpusDecInst*>& idle =
+        idle_decoders_[Key(inst->sample_rate_hz, inst->channels, -1)];
+    if (idle.size() < kMaxIdleInstancesPerKey) {
+      idle.push_back(inst);
+      return;
+    }
+  }
+  WebRtcOpus_DecoderFree(inst);
+}
+
+void OpusInstancePool::Prewarm(size_t channels,
+                               int32_t application,
+                               int sample_rate_hz,
+                               size_t num_encoders,
+                               size_t num_decoders) {
+  RTC_DCHECK_LE(num_encoders, kMaxIdleInstancesPerKey);
+  RTC_DCHECK_LE(num_decoders, kMaxIdleInstancesPerKey);
+  size_t encoders_to_create = 0;
+  size_t decoders_to_create = 0;
+  {
+    MutexLock lock(&mutex_);
+    const size_t idle_encoders =
+        idle_encoders_[Key(sample_rate_hz, channels, application)].size();
+    const size_t idle_decoders =
+        idle_decoders_[Key(sample_rate_hz, channels, -1)].size();
+    encoders_to_create =
+        num_encoders > idle_encoders ? num_encoders - idle_encoders : 0;
+    decoders_to_create =
+        num_decoders > idle_decoders ? num_decoders - idle_decoders : 0;
+  }
+
+  // Create the instances outside of the lock and hand them over as if they
+  // had been used. A freshly created instance needs no reinitialization.
+  std::vector<OpusEncInst*> encoders;
+  for (size_t i = 0; i < encoders_to_create; ++i) {
+    OpusEncInst* inst = nullptr;
+    if (WebRtcOpus_EncoderCreate(&inst, channels, application,
+                                 sample_rate_hz) == 0) {
+      encoders.push_back(inst);
+    }
+  }
+  std::vector<OpusDecInst*> decoders;
+  for (size_t i = 0; i < decoders_to_create; ++i) {
+    OpusDecInst* inst = nullptr;
+    if (WebRtcOpus_DecoderCreate(&inst, channels, sample_rate_hz) == 0) {
+      decoders.push_back(inst);
+    }
+  }
+
+  MutexLock lock(&mutex_);
+  stats_.encoders_created += static_cast<int>(encoders.size());
+  stats_.decoders_created += static_cast<int>(decoders.size());
+  std::vector<OpusEncInst*>& idle_encoders =
+      idle_encoders_[Key(sample_rate_hz, channels, application)];
+  for (OpusEncInst* inst : encoders) {
+    if (idle_encoders.size() < kMaxIdleInstancesPerKey) {
+      idle_encoders.push_back(inst);
+    } else {
+      WebRtcOpus_EncoderFree(inst);
+    }
+  }
+  std::vector<OpusDecInst*>& idle_decoders =
+      idle_decoders_[Key(sample_rate_hz, channels, -1)];
+  for (OpusDecInst* inst : decoders) {
+    if (idle_decoders.size() < kMaxIdleInstancesPerKey) {
+      idle_decoders.push_back(inst);
+    } else {
+      WebRtcOpus_DecoderFree(inst);
+    }
+  }
+}
+
+OpusInstancePool::Stats OpusInstancePool::GetStats() const {
+  MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace webrtc
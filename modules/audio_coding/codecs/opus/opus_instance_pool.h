@@ -0,0 +1,93 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_CODING_CODECS_OPUS_OPUS_INSTANCE_POOL_H_
+#define MODULES_AUDIO_CODING_CODECS_OPUS_OPUS_INSTANCE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "modules/audio_coding/codecs/opus/opus_interface.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Process-wide pool of single-stream Opus encoder and decoder states, so that
+// creating a codec (e.g., when a participant joins or a call is renegotiated)
+// does not need to allocate and set up the libopus state. Encoders are keyed
+// by (sample rate, channels, application) and decoders by (sample rate,
+// channels). Instances are reinitialized when they are returned to the pool,
+// so an acquired instance always behaves exactly like a newly created one.
+//
+// This class is thread-safe.
+class OpusInstancePool {
+ public:
+  // Maximum number of idle instances kept per key; instances released beyond
+  // that are freed.
+  static constexpr size_t kMaxIdleInstancesPerKey = 16;
+
+  struct Stats {
+    int encoders_created = 0;
+    int encoders_reused = 0;
+    int decoders_created = 0;
+    int decoders_reused = 0;
+  };
+
+  // Returns the pool shared by the whole process.
+  static OpusInstancePool& Get();
+
+  OpusInstancePool();
+  OpusInstancePool(const OpusInstancePool&) = delete;
+  OpusInstancePool& operator=(const OpusInstancePool&) = delete;
+  ~OpusInstancePool();
+
+  // Same arguments and semantics as WebRtcOpus_EncoderCreate(); returns null
+  // on error. The encoder must be given back with ReleaseEncoder().
+  OpusEncInst* AcquireEncoder(size_t channels,
+                              int32_t application,
+                              int sample_rate_hz);
+  void ReleaseEncoder(OpusEncInst* inst);
+
+  // Same arguments and semantics as WebRtcOpus_DecoderCreate(); returns null
+  // on error. The decoder must be given back with ReleaseDecoder().
+  OpusDecInst* AcquireDecoder(size_t channels, int sample_rate_hz);
+  void ReleaseDecoder(OpusDecInst* inst);
+
+  // Creates idle instances ahead of time so that up to `num_encoders`
+  // encoders and `num_decoders` decoders with the given parameters can be
+  // acquired without any setup cost.
+  void Prewarm(size_t channels,
+               int32_t application,
+               int sample_rate_hz,
+               size_t num_encoders,
+               size_t num_decoders);
+
+  Stats GetStats() const;
+
+ private:
+  // (sample rate, channels, application). The application is -1 for decoders.
+  using Key = std::tuple<int, size_t, int32_t>;
+
+  mutable Mutex mutex_;
+  std::map<Key, std::vector<OpusEncInst*>> idle_encoders_
+      RTC_GUARDED_BY(mutex_);
+  std::map<Key, std::vector<OpusDecInst*>> idle_decoders_
+      RTC_GUARDED_BY(mutex_);
+  Stats stats_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_CODING_CODECS_OPUS_OPUS_INSTANCE_POOL_H_
@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_coding/codecs/opus/opus_instance_pool.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr size_t kChannels = 2;
+constexpr int32_t kVoip = 0;
+constexpr int32_t kAudio = 1;
+constexpr size_t kSamplesPer20Ms = kSampleRateHz / 50;
+constexpr size_t kMaxBytes = 1500;
+
+std::vector<int16_t> CreateNoise(size_t num_samples) {
+  Random random(/*seed=*/1234);
+  std::vector<int16_t> samples(num_samples);
+  for (int16_t& sample : samples) {
+    sample = static_cast<int16_t>(random.Rand(-8000, 8000));
+  }
+  return samples;
+}
+
+// Configures `inst` as a non-default encoder and encodes `num_frames` frames
+// of `audio`, returning the concatenated payloads.
+std::vector<uint8_t> ConfigureAndEncode(OpusEncInst* inst,
+                                        const std::vector<int16_t>& audio,
+                                        int num_frames) {
+  EXPECT_EQ(0, WebRtcOpus_SetBitRate(inst, 48000));
+  EXPECT_EQ(0, WebRtcOpus_SetComplexity(inst, 5));
+  EXPECT_EQ(0, WebRtcOpus_EnableFec(inst));
+  std::vector<uint8_t> encoded;
+  uint8_t payload[kMaxBytes];
+  for (int i = 0; i < num_frames; ++i) {
+    const int size = WebRtcOpus_Encode(
+        inst, &audio[i * kSamplesPer20Ms * kChannels], kSamplesPer20Ms,
+        kMaxBytes, payload);
+    EXPECT_GT(size, 0);
+    encoded.insert(encoded.end(), payload, payload + size);
+  }
+  return encoded;
+}
+
+}  // namespace
+
+TEST(OpusInstancePoolTest, ReusesReleasedInstancesWithSameKey) {
+  OpusInstancePool pool;
+  OpusEncInst* encoder = pool.AcquireEncoder(kChannels, kVoip, kSampleRateHz);
+  OpusDecInst* decoder = pool.AcquireDecoder(kChannels, kSampleRateHz);
+  ASSERT_TRUE(encoder);
+  ASSERT_TRUE(decoder);
+  pool.ReleaseEncoder(encoder);
+  pool.ReleaseDecoder(decoder);
+
+  // A different application or channel count does not match.
+  OpusEncInst* audio_encoder =
+      pool.AcquireEncoder(kChannels, kAudio, kSampleRateHz);
+  OpusDecInst* mono_decoder = pool.AcquireDecoder(1, kSampleRateHz);
+  EXPECT_NE(audio_encoder, encoder);
+  EXPECT_NE(mono_decoder, decoder);
+
+  EXPECT_EQ(encoder, pool.AcquireEncoder(kChannels, kVoip, kSampleRateHz));
+  EXPECT_EQ(decoder, pool.AcquireDecoder(kChannels, kSampleRateHz));
+
+  const OpusInstancePool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.encoders_created, 2);
+  EXPECT_EQ(stats.encoders_reused, 1);
+  EXPECT_EQ(stats.decoders_created, 2);
+  EXPECT_EQ(stats.decoders_reused, 1);
+
+  pool.ReleaseEncoder(encoder);
+  pool.ReleaseEncoder(audio_encoder);
+  pool.ReleaseDecoder(decoder);
+  pool.ReleaseDecoder(mono_decoder);
+}
+
+TEST(OpusInstancePoolTest, ReusedEncoderBehavesAsNewEncoder) {
+  constexpr int kNumFrames = 50;
+  const std::vector<int16_t> audio =
+      CreateNoise(kNumFrames * kSamplesPer20Ms * kChannels);
+
+  OpusInstancePool pool;
+  OpusEncInst* encoder = pool.AcquireEncoder(kChannels, kVoip, kSampleRateHz);
+  ASSERT_TRUE(encoder);
+  // Leave non-default settings and state behind.
+  ConfigureAndEncode(encoder, audio, kNumFrames / 2);
+  EXPECT_EQ(0, WebRtcOpus_SetBandwidth(encoder, OPUS_BANDWIDTH_NARROWBAND));
+  EXPECT_EQ(0, WebRtcOpus_EnableDtx(encoder));
+  pool.ReleaseEncoder(encoder);
+
+  OpusEncInst* reused = pool.AcquireEncoder(kChannels, kVoip, kSampleRateHz);
+  ASSERT_EQ(reused, encoder);
+  OpusEncInst* fresh = nullptr;
+  ASSERT_EQ(0, WebRtcOpus_EncoderCreate(&fresh, kChannels, kVoip,
+                                        kSampleRateHz));
+
+  EXPECT_EQ(ConfigureAndEncode(fresh, audio, kNumFrames),
+            ConfigureAndEncode(reused, audio, kNumFrames));
+
+  WebRtcOpus_EncoderFree(fresh);
+  pool.ReleaseEncoder(reused);
+}
+
+TEST(OpusInstancePoolTest, ReusedDecoderBehavesAsNewDecoder) {
+  constexpr int kNumFrames = 50;
+  const std::vector<int16_t> audio =
+      CreateNoise(kNumFrames * kSamplesPer20Ms * kChannels);
+  OpusEncInst* encoder = nullptr;
+  ASSERT_EQ(0, WebRtcOpus_EncoderCreate(&encoder, kChannels, kVoip,
+                                        kSampleRateHz));
+  std::vector<std::vector<uint8_t>> packets;
+  uint8_t payload[kMaxBytes];
+  for (int i = 0; i < kNumFrames; ++i) {
+    const int size = WebRtcOpus_Encode(
+        encoder, &audio[i * kSamplesPer20Ms * kChannels], kSamplesPer20Ms,
+        kMaxBytes, payload);
+    ASSERT_GT(size, 0);
+    packets.emplace_back(payload, payload + size);
+  }
+  WebRtcOpus_EncoderFree(encoder);
+
+  auto decode = [&](OpusDecInst* decoder) {
+    std::vector<int16_t> output;
+    std::vector<int16_t> decoded(kSamplesPer20Ms * kChannels);
+    int16_t audio_type;
+    for (const auto& packet : packets) {
+      const int samples =
+          WebRtcOpus_Decode(decoder, packet.data(), packet.size(),
+                            decoded.data(), &audio_type);
+      EXPECT_EQ(samples, static_cast<int>(kSamplesPer20Ms));
+      output.insert(output.end(), decoded.begin(), decoded.end());
+    }
+    return output;
+  };
+
+  OpusInstancePool pool;
+  OpusDecInst* decoder = pool.AcquireDecoder(kChannels, kSampleRateHz);
+  ASSERT_TRUE(decoder);
+  decode(decoder);
+  pool.ReleaseDecoder(decoder);
+
+  OpusDecInst* reused = pool.AcquireDecoder(kChannels, kSampleRateHz);
+  ASSERT_EQ(reused, decoder);
+  OpusDecInst* fresh = nullptr;
+  ASSERT_EQ(0, WebRtcOpus_DecoderCreate(&fresh, kChannels, kSampleRateHz));
+
+  EXPECT_EQ(decode(fresh), decode(reused));
+
+  WebRtcOpus_DecoderFree(fresh);
+  pool.ReleaseDecoder(reused);
+}
+
+TEST(OpusInstancePoolTest, PrewarmedInstancesAreReused) {
+  OpusInstancePool pool;
+  pool.Prewarm(kChannels, kVoip, kSampleRateHz, /*num_encoders=*/3,
+               /*num_decoders=*/2);
+  std::vector<OpusEncInst*> encoders;
+  for (int i = 0; i < 3; ++i) {
+    encoders.push_back(pool.AcquireEncoder(kChannels, kVoip, kSampleRateHz));
+  }
+  OpusDecInst* decoder = pool.AcquireDecoder(kChannels, kSampleRateHz);
+
+  const OpusInstancePool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.encoders_created, 3);
+  EXPECT_EQ(stats.encoders_reused, 3);
+  EXPECT_EQ(stats.decoders_created, 2);
+  EXPECT_EQ(stats.decoders_reused, 1);
+
+  for (OpusEncInst* encoder : encoders) {
+    pool.ReleaseEncoder(encoder);
+  }
+  pool.ReleaseDecoder(decoder);
+}
+
+TEST(OpusInstancePoolTest, KeepsBoundedNumberOfIdleInstances) {
+  OpusInstancePool pool;
+  std::vector<OpusDecInst*> decoders;
+  for (size_t i = 0; i < OpusInstancePool::kMaxIdleInstancesPerKey + 4; ++i) {
+    decoders.push_back(pool.AcquireDecoder(kChannels, kSampleRateHz));
+  }
+  for (OpusDecInst* decoder : decoders) {
+    pool.ReleaseDecoder(decoder);
+  }
+  for (size_t i = 0; i < OpusInstancePool::kMaxIdleInstancesPerKey + 4; ++i) {
+    decoders[i] = pool.AcquireDecoder(kChannels, kSampleRateHz);
+  }
+  const OpusInstancePool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.decoders_reused,
+            static_cast<int>(OpusInstancePool::kMaxIdleInstancesPerKey));
+  for (OpusDecInst* decoder : decoders) {
+    pool.ReleaseDecoder(decoder);
+  }
+}
+
+// Measures the codec setup cost of a participant joining a call, i.e., the
+// creation of a stereo fullband encoder and decoder, with and without the
+// pool. Participants join and leave one after the other, so that in the pooled
+// case the instances given back by the previous participant are reused.
+TEST(OpusInstancePoolTest, DISABLED_JoinTimeCodecSetupBenchmark) {
+  constexpr int kNumJoins = 10000;
+  OpusInstancePool pool;
+  int64_t create_ns = 0;
+  int64_t acquire_ns = 0;
+  int64_t release_ns = 0;
+  for (int i = 0; i < kNumJoins; ++i) {
+    OpusEncInst* encoder = nullptr;
+    OpusDecInst* decoder = nullptr;
+    int64_t start = rtc::TimeNanos();
+    WebRtcOpus_EncoderCreate(&encoder, kChannels, kAudio, kSampleRateHz);
+    WebRtcOpus_DecoderCreate(&decoder, kChannels, kSampleRateHz);
+    create_ns += rtc::TimeNanos() - start;
+    WebRtcOpus_EncoderFree(encoder);
+    WebRtcOpus_DecoderFree(decoder);
+
+    start = rtc::TimeNanos();
+    encoder = pool.AcquireEncoder(kChannels, kAudio, kSampleRateHz);
+    decoder = pool.AcquireDecoder(kChannels, kSampleRateHz);
+    acquire_ns += rtc::TimeNanos() - start;
+    start = rtc::TimeNanos();
+    pool.ReleaseEncoder(encoder);
+    pool.ReleaseDecoder(decoder);
+    release_ns += rtc::TimeNanos() - start;
+  }
+  printf(
+      "Codec setup per join: %.2f us when created, %.2f us from the pool "
+      "(plus %.2f us to reset the instances on leave).\n",
+      static_cast<double>(create_ns) / kNumJoins / rtc::kNumNanosecsPerMicrosec,
+      static_cast<double>(acquire_ns) / kNumJoins /
+          rtc::kNumNanosecsPerMicrosec,
+      static_cast<double>(release_ns) / kNumJoins /
+          rtc::kNumNanosecsPerMicrosec);
+}
+
+}  // namespace webrtc
@@ -204,6 +204,43 @@ int16_t WebRtcOpus_EncoderFree(OpusEncInst* inst) {
   }
 }
 
+int16_t WebRtcOpus_EncoderReinit(OpusEncInst* inst) {
+  if (!inst || !inst->encoder) {
+    return -1;
+  }
+  opus_int32 opus_app;
+  if (opus_encoder_ctl(inst->encoder, OPUS_GET_APPLICATION(&opus_app)) !=
+          OPUS_OK ||
+      opus_encoder_init(inst->encoder, inst->sample_rate_hz,
+                        static_cast<int>(inst->channels),
+                        opus_app) != OPUS_OK) {
+    return -1;
+  }
+
+  inst->in_dtx_mode = 0;
+  inst->smooth_energy_non_active_frames = 0.0f;
+  inst->avoid_noise_pumping_during_dtx =
+      webrtc::field_trial::IsEnabled(kAvoidNoisePumpingDuringDtxFieldTrial);
+  return 0;
+}
+
+int32_t WebRtcOpus_EncoderApplication(OpusEncInst* inst) {
+  opus_int32 opus_app;
+  if (!inst || !inst->encoder ||
+      opus_encoder_ctl(inst->encoder, OPUS_GET_APPLICATION(&opus_app)) !=
+          OPUS_OK) {
+    return -1;
+  }
+  switch (opus_app) {
+    case OPUS_APPLICATION_VOIP:
+      return 0;
+    case OPUS_APPLICATION_AUDIO:
+      return 1;
+    default:
+      return -1;
+  }
+}
+
 int WebRtcOpus_Encode(OpusEncInst* inst,
                       const int16_t* audio_in,
                       size_t samples,
@@ -572,6 +609,23 @@ void WebRtcOpus_DecoderInit(OpusDecInst* inst) {
   inst->in_dtx_mode = 0;
 }
 
+int16_t WebRtcOpus_DecoderReinit(OpusDecInst* inst) {
+  if (!inst || !inst->decoder ||
+      opus_decoder_init(inst->decoder, inst->sample_rate_hz,
+                        static_cast<int>(inst->channels)) != OPUS_OK) {
+    return -1;
+  }
+
+  inst->plc_use_prev_decoded_samples =
+      webrtc::field_trial::IsEnabled(kPlcUsePrevDecodedSamplesFieldTrial);
+  inst->prev_decoded_samples =
+      inst->plc_use_prev_decoded_samples
+          ? DefaultFrameSizePerChannel(inst->sample_rate_hz)
+          : 0;
+  inst->in_dtx_mode = 0;
+  return 0;
+}
+
 /* For decoder to determine if it is to output speech or comfort noise. */
 static int16_t DetermineAudioType(OpusDecInst* inst, size_t encoded_bytes) {
   // Audio type becomes comfort noise if `encoded_byte` is 1 and keeps
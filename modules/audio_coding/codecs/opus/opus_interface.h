@@ -83,6 +83,30 @@ int16_t WebRtcOpus_MultistreamEncoderCreate(
 
 int16_t WebRtcOpus_EncoderFree(OpusEncInst* inst);
 
+/****************************************************************************
+ * WebRtcOpus_EncoderReinit(...)
+ *
+ * This function reinitializes a single-stream encoder in place, making it
+ * equivalent to a newly created encoder with the same number of channels,
+ * application and sample rate. All the settings are restored to their
+ * defaults.
+ *
+ * Input:
+ *      - inst               : Encoder context
+ *
+ * Return value              : 0 - Success
+ *                            -1 - Error
+ */
+int16_t WebRtcOpus_EncoderReinit(OpusEncInst* inst);
+
+/****************************************************************************
+ * WebRtcOpus_EncoderApplication(...)
+ *
+ * This function returns the application the encoder was created with; 0 for
+ * VOIP and 1 for audio applications, or -1 on error.
+ */
+int32_t WebRtcOpus_EncoderApplication(OpusEncInst* inst);
+
 /****************************************************************************
  * WebRtcOpus_Encode(...)
  *
@@ -408,6 +432,21 @@ size_t WebRtcOpus_DecoderChannels(OpusDecInst* inst);
  */
 void WebRtcOpus_DecoderInit(OpusDecInst* inst);
 
+/****************************************************************************
+ * WebRtcOpus_DecoderReinit(...)
+ *
+ * This function reinitializes a single-stream decoder in place, making it
+ * equivalent to a newly created decoder with the same number of channels and
+ * sample rate.
+ *
+ * Input:
+ *      - inst               : Decoder context
+ *
+ * Return value              : 0 - Success
+ *                            -1 - Error
+ */
+int16_t WebRtcOpus_DecoderReinit(OpusDecInst* inst);
+
 /****************************************************************************
  * WebRtcOpus_Decode(...)
  *
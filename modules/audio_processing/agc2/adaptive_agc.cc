@@ -42,7 +42,9 @@ AdaptiveAgc::AdaptiveAgc(
     ApmDataDumper* apm_data_dumper,
     const AudioProcessing::Config::GainController2::AdaptiveDigital& config)
     : speech_level_estimator_(apm_data_dumper, config),
-      vad_(config.vad_reset_period_ms, GetAllowedCpuFeatures()),
+      vad_(config.vad_reset_period_ms,
+           GetAllowedCpuFeatures(),
+           config.vad_int8_weights),
       gain_controller_(apm_data_dumper, config),
       apm_data_dumper_(apm_data_dumper),
       noise_level_estimator_(CreateNoiseFloorEstimator(apm_data_dumper)),
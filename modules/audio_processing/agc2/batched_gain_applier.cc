@@ -0,0 +1,89 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/batched_gain_applier.h"
+
+#include "modules/audio_processing/agc2/agc2_common.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/numerics/safe_minmax.h"
+
+namespace webrtc {
+namespace {
+
+// Returns true when the gain factor is so close to 1 that it would
+// not affect int16 samples.
+bool GainCloseToOne(float gain_factor) {
+  return 1.f - 1.f / kMaxFloatS16Value <= gain_factor &&
+         gain_factor <= 1.f + 1.f / kMaxFloatS16Value;
+}
+
+}  // namespace
+
+BatchedGainApplier::BatchedGainApplier(size_t num_streams,
+                                       bool hard_clip_samples,
+                                       float initial_gain_factor)
+    : num_streams_(num_streams),
+      hard_clip_samples_(hard_clip_samples),
+      last_gain_factors_(num_streams, initial_gain_factor),
+      current_gain_factors_(num_streams, initial_gain_factor),
+      gains_(num_streams),
+      increments_(num_streams) {
+  RTC_DCHECK_GT(num_streams, 0);
+}
+
+void BatchedGainApplier::ApplyGain(rtc::ArrayView<float> signal) {
+  RTC_DCHECK_EQ(signal.size() % num_streams_, 0);
+  const size_t samples_per_channel = signal.size() / num_streams_;
+  if (samples_per_channel == 0) {
+    return;
+  }
+  const float inverse_samples_per_channel =
+      1.f / static_cast<int>(samples_per_channel);
+
+  // Turn the per-stream decisions of `GainApplier` into a ramp: a stream left
+  // untouched gets an exact unit gain and a constant gain a zero increment.
+  for (size_t s = 0; s < num_streams_; ++s) {
+    const float last_gain = last_gain_factors_[s];
+    const float gain_at_end_of_frame = current_gain_factors_[s];
+    if (last_gain == gain_at_end_of_frame) {
+      gains_[s] = GainCloseToOne(gain_at_end_of_frame) ? 1.f : last_gain;
+      increments_[s] = 0.f;
+    } else {
+      gains_[s] = last_gain;
+      increments_[s] =
+          (gain_at_end_of_frame - last_gain) * inverse_samples_per_channel;
+    }
+    last_gain_factors_[s] = gain_at_end_of_frame;
+  }
+
+  float* gains = gains_.data();
+  const float* increments = increments_.data();
+  for (size_t i = 0; i < samples_per_channel; ++i) {
+    float* samples = &signal[i * num_streams_];
+    for (size_t s = 0; s < num_streams_; ++s) {
+      samples[s] *= gains[s];
+      gains[s] += increments[s];
+    }
+  }
+
+  if (hard_clip_samples_) {
+    for (float& sample : signal) {
+      sample = rtc::SafeClamp(sample, kMinFloatS16Value, kMaxFloatS16Value);
+    }
+  }
+}
+
+void BatchedGainApplier::SetGainFactor(size_t stream, float gain_factor) {
+  RTC_DCHECK_LT(stream, num_streams_);
+  RTC_DCHECK_GT(gain_factor, 0.f);
+  current_gain_factors_[stream] = gain_factor;
+}
+
+}  // namespace webrtc
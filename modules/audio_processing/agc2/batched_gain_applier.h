@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_AGC2_BATCHED_GAIN_APPLIER_H_
+#define MODULES_AUDIO_PROCESSING_AGC2_BATCHED_GAIN_APPLIER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "api/array_view.h"
+
+namespace webrtc {
+
+// Applies the gains of `GainApplier` to many independent mono streams at once.
+// Frames are stored sample-major, i.e., element
+// `sample * num_streams + stream` holds `sample` of `stream`, so that each
+// sample is scaled across all the streams with contiguous, branch-free code
+// while every stream keeps its own gain ramp. The output is bit-exact with
+// that of one `GainApplier` per stream.
+class BatchedGainApplier {
+ public:
+  BatchedGainApplier(size_t num_streams,
+                     bool hard_clip_samples,
+                     float initial_gain_factor);
+  BatchedGainApplier(const BatchedGainApplier&) = delete;
+  BatchedGainApplier& operator=(const BatchedGainApplier&) = delete;
+
+  // Applies the gains to a frame of `signal.size() / num_streams()` samples
+  // per stream.
+  void ApplyGain(rtc::ArrayView<float> signal);
+  void SetGainFactor(size_t stream, float gain_factor);
+  float GetGainFactor(size_t stream) const {
+    return current_gain_factors_[stream];
+  }
+
+  size_t num_streams() const { return num_streams_; }
+
+ private:
+  const size_t num_streams_;
+  // Whether to clip samples after gain is applied. If 'true', result
+  // will fit in FloatS16 range.
+  const bool hard_clip_samples_;
+  std::vector<float> last_gain_factors_;
+  std::vector<float> current_gain_factors_;
+  // Per-stream gain and increment of the ramp applied to the current frame.
+  std::vector<float> gains_;
+  std::vector<float> increments_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_AGC2_BATCHED_GAIN_APPLIER_H_
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/batched_gain_applier.h"
+
+#include <memory>
+#include <vector>
+
+#include "modules/audio_processing/agc2/gain_applier.h"
+#include "modules/audio_processing/agc2/vector_float_frame.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/random.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kNumStreams = 7;
+constexpr int kSamplesPerChannel = 480;
+
+// Verifies that the batched gains are bit-exact with one `GainApplier` per
+// stream, with gains that stay at one, stay constant or ramp.
+void TestBitExactWithGainApplierPerStream(bool hard_clip_samples) {
+  std::vector<std::unique_ptr<GainApplier>> gain_appliers;
+  std::vector<std::unique_ptr<VectorFloatFrame>> frames;
+  for (size_t s = 0; s < kNumStreams; ++s) {
+    gain_appliers.push_back(std::make_unique<GainApplier>(hard_clip_samples,
+                                                          /*gain_factor=*/1.f));
+    frames.push_back(std::make_unique<VectorFloatFrame>(
+        /*num_channels=*/1, kSamplesPerChannel, /*start_value=*/0.f));
+  }
+  BatchedGainApplier batched_gain_applier(kNumStreams, hard_clip_samples,
+                                          /*initial_gain_factor=*/1.f);
+  ASSERT_EQ(kNumStreams, batched_gain_applier.num_streams());
+
+  Random random_generator(42);
+  std::vector<float> signal(kNumStreams * kSamplesPerChannel);
+  for (int frame = 0; frame < 20; ++frame) {
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      // Change the gain of about half of the streams, to a large value once in
+      // a while so that clipping occurs.
+      if (random_generator.Rand<bool>()) {
+        const float gain = random_generator.Rand(0, 9) == 0
+                               ? 20.f
+                               : 0.1f + 1.9f * random_generator.Rand<float>();
+        gain_appliers[s]->SetGainFactor(gain);
+        batched_gain_applier.SetGainFactor(s, gain);
+      }
+      AudioFrameView<float> frame_view = frames[s]->float_frame_view();
+      rtc::ArrayView<float> channel = frame_view.channel(0);
+      for (int i = 0; i < kSamplesPerChannel; ++i) {
+        channel[i] = 65535.f * random_generator.Rand<float>() - 32768.f;
+        signal[i * kNumStreams + s] = channel[i];
+      }
+    }
+
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      gain_appliers[s]->ApplyGain(frames[s]->float_frame_view());
+      EXPECT_EQ(gain_appliers[s]->GetGainFactor(),
+                batched_gain_applier.GetGainFactor(s));
+    }
+    batched_gain_applier.ApplyGain(signal);
+
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      rtc::ArrayView<const float> channel =
+          frames[s]->float_frame_view().channel(0);
+      for (int i = 0; i < kSamplesPerChannel; ++i) {
+        ASSERT_EQ(channel[i], signal[i * kNumStreams + s])
+            << "frame " << frame << ", stream " << s << ", sample " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(AutomaticGainController2BatchedGainApplier, BitExactWithClipping) {
+  TestBitExactWithGainApplierPerStream(/*hard_clip_samples=*/true);
+}
+
+TEST(AutomaticGainController2BatchedGainApplier, BitExactWithoutClipping) {
+  TestBitExactWithGainApplierPerStream(/*hard_clip_samples=*/false);
+}
+
+TEST(AutomaticGainController2BatchedGainApplier, UnitGainLeavesSignalIntact) {
+  BatchedGainApplier batched_gain_applier(/*num_streams=*/2,
+                                          /*hard_clip_samples=*/false,
+                                          /*initial_gain_factor=*/1.f);
+  std::vector<float> signal = {1.f, -2.f, 40000.f, -0.f};
+  const std::vector<float> expected = signal;
+  batched_gain_applier.ApplyGain(signal);
+  EXPECT_EQ(expected, signal);
+}
+
+}  // namespace webrtc
@@ -30,7 +30,8 @@ namespace rnn_vad {
 // detection.
 class RnnVad {
  public:
-  explicit RnnVad(const AvailableCpuFeatures& cpu_features);
+  // Uses quantized weights for all the layers if `int8_weights` is true.
+  RnnVad(const AvailableCpuFeatures& cpu_features, bool int8_weights);
   RnnVad(const RnnVad&) = delete;
   RnnVad& operator=(const RnnVad&) = delete;
   ~RnnVad();
@@ -32,25 +32,30 @@ std::vector<float> GetScaledParams(rtc::ArrayView<const int8_t> params) {
 
 // TODO(bugs.chromium.org/10480): Hard-code optimized layout and remove this
 // function to improve setup time.
-// Casts and scales `weights` and re-arranges the layout.
-std::vector<float> PreprocessWeights(rtc::ArrayView<const int8_t> weights,
+// Re-arranges the layout of `weights` so that the weights for each output unit
+// are contiguous.
+std::vector<int8_t> TransposeWeights(rtc::ArrayView<const int8_t> weights,
                                      int output_size) {
   if (output_size == 1) {
-    return GetScaledParams(weights);
+    return std::vector<int8_t>(weights.begin(), weights.end());
   }
-  // Transpose, scale and cast.
   const int input_size = rtc::CheckedDivExact(
       rtc::dchecked_cast<int>(weights.size()), output_size);
-  std::vector<float> w(weights.size());
+  std::vector<int8_t> w(weights.size());
   for (int o = 0; o < output_size; ++o) {
     for (int i = 0; i < input_size; ++i) {
-      w[o * input_size + i] = rnnoise::kWeightsScale *
-                              static_cast<float>(weights[i * output_size + o]);
+      w[o * input_size + i] = weights[i * output_size + o];
     }
   }
   return w;
 }
 
+// Casts and scales `weights` and re-arranges the layout.
+std::vector<float> PreprocessWeights(rtc::ArrayView<const int8_t> weights,
+                                     int output_size) {
+  return GetScaledParams(TransposeWeights(weights, output_size));
+}
+
 rtc::FunctionView<float(float)> GetActivationFunction(
     ActivationFunction activation_function) {
   switch (activation_function) {
@@ -70,11 +75,15 @@ FullyConnectedLayer::FullyConnectedLayer(
     const rtc::ArrayView<const int8_t> weights,
     ActivationFunction activation_function,
     const AvailableCpuFeatures& cpu_features,
+    bool int8_weights,
     absl::string_view layer_name)
     : input_size_(input_size),
       output_size_(output_size),
       bias_(GetScaledParams(bias)),
-      weights_(PreprocessWeights(weights, output_size)),
+      weights_(int8_weights ? std::vector<float>()
+                            : PreprocessWeights(weights, output_size)),
+      int8_weights_(int8_weights ? TransposeWeights(weights, output_size)
+                                 : std::vector<int8_t>()),
       vector_math_(cpu_features),
       activation_function_(GetActivationFunction(activation_function)) {
   RTC_DCHECK_LE(output_size_, kFullyConnectedLayerMaxUnits)
@@ -82,7 +91,8 @@ FullyConnectedLayer::FullyConnectedLayer(
   RTC_DCHECK_EQ(output_size_, bias_.size())
       << "Mismatching output size and bias terms array size (" << layer_name
       << ").";
-  RTC_DCHECK_EQ(input_size_ * output_size_, weights_.size())
+  RTC_DCHECK_EQ(input_size_ * output_size_,
+                weights_.size() + int8_weights_.size())
       << "Mismatching input-output size and weight coefficients array size ("
       << layer_name << ").";
 }
@@ -91,6 +101,17 @@ FullyConnectedLayer::~FullyConnectedLayer() = default;
 
 void FullyConnectedLayer::ComputeOutput(rtc::ArrayView<const float> input) {
   RTC_DCHECK_EQ(input.size(), input_size_);
+  if (!int8_weights_.empty()) {
+    rtc::ArrayView<const int8_t> weights(int8_weights_);
+    for (int o = 0; o < output_size_; ++o) {
+      output_[o] = activation_function_(
+          bias_[o] +
+          ::rnnoise::kWeightsScale *
+              vector_math_.DotProductInt8(
+                  input, weights.subview(o * input_size_, input_size_)));
+    }
+    return;
+  }
   rtc::ArrayView<const float> weights(weights_);
   for (int o = 0; o < output_size_; ++o) {
     output_[o] = activation_function_(
@@ -34,12 +34,15 @@ constexpr int kFullyConnectedLayerMaxUnits = 24;
 class FullyConnectedLayer {
  public:
   // Ctor. `output_size` cannot be greater than `kFullyConnectedLayerMaxUnits`.
+  // If `int8_weights` is true, the weights are kept quantized and scaled on the
+  // fly, which reduces the memory footprint of the layer by a factor of 4.
   FullyConnectedLayer(int input_size,
                       int output_size,
                       rtc::ArrayView<const int8_t> bias,
                       rtc::ArrayView<const int8_t> weights,
                       ActivationFunction activation_function,
                       const AvailableCpuFeatures& cpu_features,
+                      bool int8_weights,
                       absl::string_view layer_name);
   FullyConnectedLayer(const FullyConnectedLayer&) = delete;
   FullyConnectedLayer& operator=(const FullyConnectedLayer&) = delete;
@@ -59,7 +62,9 @@ class FullyConnectedLayer {
   const int input_size_;
   const int output_size_;
   const std::vector<float> bias_;
+  // Only one of `weights_` and `int8_weights_` is non-empty.
   const std::vector<float> weights_;
+  const std::vector<int8_t> int8_weights_;
   const VectorMath vector_math_;
   rtc::FunctionView<float(float)> activation_function_;
   // Over-allocated array with size equal to `output_size_`.
@@ -56,6 +56,20 @@ TEST_P(RnnFcParametrization, CheckFullyConnectedLayerOutput) {
                          kInputDenseBias, kInputDenseWeights,
                          ActivationFunction::kTansigApproximated,
                          /*cpu_features=*/GetParam(),
+                         /*int8_weights=*/false,
+                         /*layer_name=*/"FC");
+  fc.ComputeOutput(kFullyConnectedInputVector);
+  ExpectNearAbsolute(kFullyConnectedExpectedOutput, fc, 1e-5f);
+}
+
+// Checks that the output of a fully connected layer with quantized weights is
+// within tolerance given test input data.
+TEST_P(RnnFcParametrization, CheckFullyConnectedLayerOutputWithInt8Weights) {
+  FullyConnectedLayer fc(kInputLayerInputSize, kInputLayerOutputSize,
+                         kInputDenseBias, kInputDenseWeights,
+                         ActivationFunction::kTansigApproximated,
+                         /*cpu_features=*/GetParam(),
+                         /*int8_weights=*/true,
                          /*layer_name=*/"FC");
   fc.ComputeOutput(kFullyConnectedInputVector);
   ExpectNearAbsolute(kFullyConnectedExpectedOutput, fc, 1e-5f);
@@ -66,6 +80,7 @@ TEST_P(RnnFcParametrization, DISABLED_BenchmarkFullyConnectedLayer) {
   FullyConnectedLayer fc(kInputLayerInputSize, kInputLayerOutputSize,
                          kInputDenseBias, kInputDenseWeights,
                          ActivationFunction::kTansigApproximated, cpu_features,
+                         /*int8_weights=*/false,
                          /*layer_name=*/"FC");
 
   constexpr int kNumTests = 10000;
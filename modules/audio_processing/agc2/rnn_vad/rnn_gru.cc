@@ -21,28 +21,51 @@ namespace {
 
 constexpr int kNumGruGates = 3;  // Update, reset, output.
 
-std::vector<float> PreprocessGruTensor(rtc::ArrayView<const int8_t> tensor_src,
+// Transposes `tensor_src` so that, for each gate, the coefficients for each
+// output unit are contiguous.
+std::vector<int8_t> TransposeGruTensor(rtc::ArrayView<const int8_t> tensor_src,
                                        int output_size) {
-  // Transpose, cast and scale.
   // `n` is the size of the first dimension of the 3-dim tensor `weights`.
   const int n = rtc::CheckedDivExact(rtc::dchecked_cast<int>(tensor_src.size()),
                                      output_size * kNumGruGates);
   const int stride_src = kNumGruGates * output_size;
   const int stride_dst = n * output_size;
-  std::vector<float> tensor_dst(tensor_src.size());
+  std::vector<int8_t> tensor_dst(tensor_src.size());
   for (int g = 0; g < kNumGruGates; ++g) {
     for (int o = 0; o < output_size; ++o) {
       for (int i = 0; i < n; ++i) {
         tensor_dst[g * stride_dst + o * n + i] =
-            ::rnnoise::kWeightsScale *
-            static_cast<float>(
-                tensor_src[i * stride_src + g * output_size + o]);
+            tensor_src[i * stride_src + g * output_size + o];
       }
     }
   }
   return tensor_dst;
 }
 
+std::vector<float> PreprocessGruTensor(rtc::ArrayView<const int8_t> tensor_src,
+                                       int output_size) {
+  // Transpose, cast and scale.
+  const std::vector<int8_t> transposed =
+      TransposeGruTensor(tensor_src, output_size);
+  std::vector<float> tensor_dst(transposed.size());
+  for (size_t i = 0; i < transposed.size(); ++i) {
+    tensor_dst[i] = ::rnnoise::kWeightsScale * static_cast<float>(transposed[i]);
+  }
+  return tensor_dst;
+}
+
+// Dispatches the dot product to `vector_math` depending on the weights type.
+float DotProduct(const VectorMath& vector_math,
+                 rtc::ArrayView<const float> x,
+                 rtc::ArrayView<const float> weights) {
+  return vector_math.DotProduct(x, weights);
+}
+float DotProduct(const VectorMath& vector_math,
+                 rtc::ArrayView<const float> x,
+                 rtc::ArrayView<const int8_t> weights) {
+  return vector_math.DotProductInt8(x, weights);
+}
+
 // Computes the output for the update or the reset gate.
 // Operation: `g = sigmoid(W^T∙i + R^T∙s + b)` where
 // - `g`: output gate vector
@@ -51,14 +74,18 @@ std::vector<float> PreprocessGruTensor(rtc::ArrayView<const int8_t> tensor_src,
 // - `R`: recurrent weights matrix
 // - `s`: state gate vector
 // - `b`: bias vector
+// The coefficients in `weights` and `recurrent_weights` are multiplied by
+// `weights_scale`.
+template <typename T>
 void ComputeUpdateResetGate(int input_size,
                             int output_size,
                             const VectorMath& vector_math,
+                            float weights_scale,
                             rtc::ArrayView<const float> input,
                             rtc::ArrayView<const float> state,
                             rtc::ArrayView<const float> bias,
-                            rtc::ArrayView<const float> weights,
-                            rtc::ArrayView<const float> recurrent_weights,
+                            rtc::ArrayView<const T> weights,
+                            rtc::ArrayView<const T> recurrent_weights,
                             rtc::ArrayView<float> gate) {
   RTC_DCHECK_EQ(input.size(), input_size);
   RTC_DCHECK_EQ(state.size(), output_size);
@@ -68,10 +95,12 @@ void ComputeUpdateResetGate(int input_size,
   RTC_DCHECK_GE(gate.size(), output_size);  // `gate` is over-allocated.
   for (int o = 0; o < output_size; ++o) {
     float x = bias[o];
-    x += vector_math.DotProduct(input,
-                                weights.subview(o * input_size, input_size));
-    x += vector_math.DotProduct(
-        state, recurrent_weights.subview(o * output_size, output_size));
+    x += weights_scale *
+         DotProduct(vector_math, input,
+                    weights.subview(o * input_size, input_size));
+    x += weights_scale *
+         DotProduct(vector_math, state,
+                    recurrent_weights.subview(o * output_size, output_size));
     gate[o] = ::rnnoise::SigmoidApproximated(x);
   }
 }
@@ -87,15 +116,19 @@ void ComputeUpdateResetGate(int input_size,
 // - `r`: reset gate vector
 // - `b`: bias vector
 // - `.*` element-wise product
+// The coefficients in `weights` and `recurrent_weights` are multiplied by
+// `weights_scale`.
+template <typename T>
 void ComputeStateGate(int input_size,
                       int output_size,
                       const VectorMath& vector_math,
+                      float weights_scale,
                       rtc::ArrayView<const float> input,
                       rtc::ArrayView<const float> update,
                       rtc::ArrayView<const float> reset,
                       rtc::ArrayView<const float> bias,
-                      rtc::ArrayView<const float> weights,
-                      rtc::ArrayView<const float> recurrent_weights,
+                      rtc::ArrayView<const T> weights,
+                      rtc::ArrayView<const T> recurrent_weights,
                       rtc::ArrayView<float> state) {
   RTC_DCHECK_EQ(input.size(), input_size);
   RTC_DCHECK_GE(update.size(), output_size);  // `update` is over-allocated.
@@ -110,15 +143,59 @@ void ComputeStateGate(int input_size,
   }
   for (int o = 0; o < output_size; ++o) {
     float x = bias[o];
-    x += vector_math.DotProduct(input,
-                                weights.subview(o * input_size, input_size));
-    x += vector_math.DotProduct(
-        {reset_x_state.data(), static_cast<size_t>(output_size)},
-        recurrent_weights.subview(o * output_size, output_size));
+    x += weights_scale *
+         DotProduct(vector_math, input,
+                    weights.subview(o * input_size, input_size));
+    x += weights_scale *
+         DotProduct(vector_math,
+                    {reset_x_state.data(), static_cast<size_t>(output_size)},
+                    recurrent_weights.subview(o * output_size, output_size));
     state[o] = update[o] * state[o] + (1.f - update[o]) * std::max(0.f, x);
   }
 }
 
+// Computes the GRU layer output and updates `state`. The tensors below are
+// organized as a sequence of flattened tensors for the `update`, `reset` and
+// `state` gates.
+template <typename T>
+void ComputeGruLayerOutput(int input_size,
+                           int output_size,
+                           const VectorMath& vector_math,
+                           float weights_scale,
+                           rtc::ArrayView<const float> input,
+                           rtc::ArrayView<const float> bias,
+                           rtc::ArrayView<const T> weights,
+                           rtc::ArrayView<const T> recurrent_weights,
+                           rtc::ArrayView<float> state) {
+  // Strides to access to the flattened tensors for a specific gate.
+  const int stride_weights = input_size * output_size;
+  const int stride_recurrent_weights = output_size * output_size;
+
+  // Update gate.
+  std::array<float, kGruLayerMaxUnits> update;
+  ComputeUpdateResetGate<T>(
+      input_size, output_size, vector_math, weights_scale, input, state,
+      bias.subview(0, output_size), weights.subview(0, stride_weights),
+      recurrent_weights.subview(0, stride_recurrent_weights), update);
+  // Reset gate.
+  std::array<float, kGruLayerMaxUnits> reset;
+  ComputeUpdateResetGate<T>(
+      input_size, output_size, vector_math, weights_scale, input, state,
+      bias.subview(output_size, output_size),
+      weights.subview(stride_weights, stride_weights),
+      recurrent_weights.subview(stride_recurrent_weights,
+                                stride_recurrent_weights),
+      reset);
+  // State gate.
+  ComputeStateGate<T>(input_size, output_size, vector_math, weights_scale,
+                      input, update, reset,
+                      bias.subview(2 * output_size, output_size),
+                      weights.subview(2 * stride_weights, stride_weights),
+                      recurrent_weights.subview(2 * stride_recurrent_weights,
+                                                stride_recurrent_weights),
+                      state);
+}
+
 }  // namespace
 
 GatedRecurrentLayer::GatedRecurrentLayer(
@@ -128,23 +205,33 @@ GatedRecurrentLayer::GatedRecurrentLayer(
     const rtc::ArrayView<const int8_t> weights,
     const rtc::ArrayView<const int8_t> recurrent_weights,
     const AvailableCpuFeatures& cpu_features,
+    bool int8_weights,
     absl::string_view layer_name)
     : input_size_(input_size),
       output_size_(output_size),
       bias_(PreprocessGruTensor(bias, output_size)),
-      weights_(PreprocessGruTensor(weights, output_size)),
-      recurrent_weights_(PreprocessGruTensor(recurrent_weights, output_size)),
+      weights_(int8_weights ? std::vector<float>()
+                            : PreprocessGruTensor(weights, output_size)),
+      recurrent_weights_(
+          int8_weights ? std::vector<float>()
+                       : PreprocessGruTensor(recurrent_weights, output_size)),
+      int8_weights_(int8_weights ? TransposeGruTensor(weights, output_size)
+                                 : std::vector<int8_t>()),
+      int8_recurrent_weights_(
+          int8_weights ? TransposeGruTensor(recurrent_weights, output_size)
+                       : std::vector<int8_t>()),
       vector_math_(cpu_features) {
   RTC_DCHECK_LE(output_size_, kGruLayerMaxUnits)
       << "Insufficient GRU layer over-allocation (" << layer_name << ").";
   RTC_DCHECK_EQ(kNumGruGates * output_size_, bias_.size())
       << "Mismatching output size and bias terms array size (" << layer_name
       << ").";
-  RTC_DCHECK_EQ(kNumGruGates * input_size_ * output_size_, weights_.size())
+  RTC_DCHECK_EQ(kNumGruGates * input_size_ * output_size_,
+                weights_.size() + int8_weights_.size())
       << "Mismatching input-output size and weight coefficients array size ("
       << layer_name << ").";
   RTC_DCHECK_EQ(kNumGruGates * output_size_ * output_size_,
-                recurrent_weights_.size())
+                recurrent_weights_.size() + int8_recurrent_weights_.size())
       << "Mismatching input-output size and recurrent weight coefficients array"
          " size ("
       << layer_name << ").";
@@ -159,39 +246,17 @@ void GatedRecurrentLayer::Reset() {
 
 void GatedRecurrentLayer::ComputeOutput(rtc::ArrayView<const float> input) {
   RTC_DCHECK_EQ(input.size(), input_size_);
-
-  // The tensors below are organized as a sequence of flattened tensors for the
-  // `update`, `reset` and `state` gates.
-  rtc::ArrayView<const float> bias(bias_);
-  rtc::ArrayView<const float> weights(weights_);
-  rtc::ArrayView<const float> recurrent_weights(recurrent_weights_);
-  // Strides to access to the flattened tensors for a specific gate.
-  const int stride_weights = input_size_ * output_size_;
-  const int stride_recurrent_weights = output_size_ * output_size_;
-
   rtc::ArrayView<float> state(state_.data(), output_size_);
-
-  // Update gate.
-  std::array<float, kGruLayerMaxUnits> update;
-  ComputeUpdateResetGate(
-      input_size_, output_size_, vector_math_, input, state,
-      bias.subview(0, output_size_), weights.subview(0, stride_weights),
-      recurrent_weights.subview(0, stride_recurrent_weights), update);
-  // Reset gate.
-  std::array<float, kGruLayerMaxUnits> reset;
-  ComputeUpdateResetGate(input_size_, output_size_, vector_math_, input, state,
-                         bias.subview(output_size_, output_size_),
-                         weights.subview(stride_weights, stride_weights),
-                         recurrent_weights.subview(stride_recurrent_weights,
-                                                   stride_recurrent_weights),
-                         reset);
-  // State gate.
-  ComputeStateGate(input_size_, output_size_, vector_math_, input, update,
-                   reset, bias.subview(2 * output_size_, output_size_),
-                   weights.subview(2 * stride_weights, stride_weights),
-                   recurrent_weights.subview(2 * stride_recurrent_weights,
-                                             stride_recurrent_weights),
-                   state);
+  if (!int8_weights_.empty()) {
+    ComputeGruLayerOutput<int8_t>(input_size_, output_size_, vector_math_,
+                                  ::rnnoise::kWeightsScale, input, bias_,
+                                  int8_weights_, int8_recurrent_weights_,
+                                  state);
+    return;
+  }
+  ComputeGruLayerOutput<float>(input_size_, output_size_, vector_math_,
+                               /*weights_scale=*/1.f, input, bias_, weights_,
+                               recurrent_weights_, state);
 }
 
 }  // namespace rnn_vad
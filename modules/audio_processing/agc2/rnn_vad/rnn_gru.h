@@ -30,12 +30,16 @@ constexpr int kGruLayerMaxUnits = 24;
 class GatedRecurrentLayer {
  public:
   // Ctor. `output_size` cannot be greater than `kGruLayerMaxUnits`.
+  // If `int8_weights` is true, the weights and the recurrent weights are kept
+  // quantized and scaled on the fly, which reduces the memory footprint of the
+  // layer by a factor of 4.
   GatedRecurrentLayer(int input_size,
                       int output_size,
                       rtc::ArrayView<const int8_t> bias,
                       rtc::ArrayView<const int8_t> weights,
                       rtc::ArrayView<const int8_t> recurrent_weights,
                       const AvailableCpuFeatures& cpu_features,
+                      bool int8_weights,
                       absl::string_view layer_name);
   GatedRecurrentLayer(const GatedRecurrentLayer&) = delete;
   GatedRecurrentLayer& operator=(const GatedRecurrentLayer&) = delete;
@@ -57,8 +61,11 @@ class GatedRecurrentLayer {
   const int input_size_;
   const int output_size_;
   const std::vector<float> bias_;
+  // Either the float or the int8 weights are non-empty.
   const std::vector<float> weights_;
   const std::vector<float> recurrent_weights_;
+  const std::vector<int8_t> int8_weights_;
+  const std::vector<int8_t> int8_recurrent_weights_;
   const VectorMath vector_math_;
   // Over-allocated array with size equal to `output_size_`.
   std::array<float, kGruLayerMaxUnits> state_;
@@ -113,6 +113,18 @@ TEST_P(RnnGruParametrization, CheckGatedRecurrentLayer) {
   GatedRecurrentLayer gru(kGruInputSize, kGruOutputSize, kGruBias, kGruWeights,
                           kGruRecurrentWeights,
                           /*cpu_features=*/GetParam(),
+                          /*int8_weights=*/false,
+                          /*layer_name=*/"GRU");
+  TestGatedRecurrentLayer(gru, kGruInputSequence, kGruExpectedOutputSequence);
+}
+
+// Checks that the output of a GRU layer with quantized weights is within
+// tolerance given test input data.
+TEST_P(RnnGruParametrization, CheckGatedRecurrentLayerWithInt8Weights) {
+  GatedRecurrentLayer gru(kGruInputSize, kGruOutputSize, kGruBias, kGruWeights,
+                          kGruRecurrentWeights,
+                          /*cpu_features=*/GetParam(),
+                          /*int8_weights=*/true,
                           /*layer_name=*/"GRU");
   TestGatedRecurrentLayer(gru, kGruInputSequence, kGruExpectedOutputSequence);
 }
@@ -133,6 +145,7 @@ TEST_P(RnnGruParametrization, DISABLED_BenchmarkGatedRecurrentLayer) {
                           kHiddenGruBias, kHiddenGruWeights,
                           kHiddenGruRecurrentWeights,
                           /*cpu_features=*/GetParam(),
+                          /*int8_weights=*/false,
                           /*layer_name=*/"GRU");
 
   rtc::ArrayView<const float> input_sequence(gru_input_sequence);
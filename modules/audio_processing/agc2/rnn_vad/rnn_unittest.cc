@@ -36,7 +36,7 @@ void WarmUpRnnVad(RnnVad& rnn_vad) {
 
 // Checks that the speech probability is zero with silence.
 TEST(RnnVadTest, CheckZeroProbabilityWithSilence) {
-  RnnVad rnn_vad(GetAvailableCpuFeatures());
+  RnnVad rnn_vad(GetAvailableCpuFeatures(), /*int8_weights=*/false);
   WarmUpRnnVad(rnn_vad);
   EXPECT_EQ(rnn_vad.ComputeVadProbability(kFeatures, /*is_silence=*/true), 0.f);
 }
@@ -44,7 +44,7 @@ TEST(RnnVadTest, CheckZeroProbabilityWithSilence) {
 // Checks that the same output is produced after reset given the same input
 // sequence.
 TEST(RnnVadTest, CheckRnnVadReset) {
-  RnnVad rnn_vad(GetAvailableCpuFeatures());
+  RnnVad rnn_vad(GetAvailableCpuFeatures(), /*int8_weights=*/false);
   WarmUpRnnVad(rnn_vad);
   float pre = rnn_vad.ComputeVadProbability(kFeatures, /*is_silence=*/false);
   rnn_vad.Reset();
@@ -56,7 +56,7 @@ TEST(RnnVadTest, CheckRnnVadReset) {
 // Checks that the same output is produced after silence is observed given the
 // same input sequence.
 TEST(RnnVadTest, CheckRnnVadSilence) {
-  RnnVad rnn_vad(GetAvailableCpuFeatures());
+  RnnVad rnn_vad(GetAvailableCpuFeatures(), /*int8_weights=*/false);
   WarmUpRnnVad(rnn_vad);
   float pre = rnn_vad.ComputeVadProbability(kFeatures, /*is_silence=*/false);
   rnn_vad.ComputeVadProbability(kFeatures, /*is_silence=*/true);
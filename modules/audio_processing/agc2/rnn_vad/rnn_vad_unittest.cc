@@ -11,6 +11,7 @@
 #include <array>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "common_audio/resampler/push_sinc_resampler.h"
@@ -56,17 +57,21 @@ TEST(RnnVadTest, CheckWriteComputedOutputIsFalse) {
       << "Cannot land if kWriteComputedOutput is true.";
 }
 
+// Parametrization with the CPU features and whether int8 weights are used.
 class RnnVadProbabilityParametrization
-    : public ::testing::TestWithParam<AvailableCpuFeatures> {};
+    : public ::testing::TestWithParam<std::tuple<AvailableCpuFeatures, bool>> {
+ protected:
+  AvailableCpuFeatures cpu_features() const { return std::get<0>(GetParam()); }
+  bool int8_weights() const { return std::get<1>(GetParam()); }
+};
 
 // Checks that the computed VAD probability for a test input sequence sampled at
 // 48 kHz is within tolerance.
 TEST_P(RnnVadProbabilityParametrization, RnnVadProbabilityWithinTolerance) {
   // Init resampler, feature extractor and RNN.
   PushSincResampler decimator(kFrameSize10ms48kHz, kFrameSize10ms24kHz);
-  const AvailableCpuFeatures cpu_features = GetParam();
-  FeaturesExtractor features_extractor(cpu_features);
-  RnnVad rnn_vad(cpu_features);
+  FeaturesExtractor features_extractor(cpu_features());
+  RnnVad rnn_vad(cpu_features(), int8_weights());
 
   // Init input samples and expected output readers.
   std::unique_ptr<FileReader> samples_reader = CreatePcmSamplesReader();
@@ -130,10 +135,9 @@ TEST_P(RnnVadProbabilityParametrization, DISABLED_RnnVadPerformance) {
                        kFrameSize10ms24kHz);
   }
   // Initialize.
-  const AvailableCpuFeatures cpu_features = GetParam();
-  FeaturesExtractor features_extractor(cpu_features);
+  FeaturesExtractor features_extractor(cpu_features());
   std::array<float, kFeatureVectorSize> feature_vector;
-  RnnVad rnn_vad(cpu_features);
+  RnnVad rnn_vad(cpu_features(), int8_weights());
   constexpr int number_of_tests = 100;
   ::webrtc::test::PerformanceTimer perf_timer(number_of_tests);
   for (int k = 0; k < number_of_tests; ++k) {
@@ -155,6 +159,49 @@ TEST_P(RnnVadProbabilityParametrization, DISABLED_RnnVadPerformance) {
                 perf_timer.GetDurationStandardDeviation());
 }
 
+// Benchmark for the RNN alone which reports the cost per 10 ms frame. Feature
+// extraction is excluded by pre-computing the feature vectors. Keep disabled
+// and only enable locally to measure performance (see above).
+TEST_P(RnnVadProbabilityParametrization, DISABLED_RnnVadCostPer10msFrame) {
+  // Pre-compute the feature vectors.
+  std::unique_ptr<FileReader> samples_reader = CreatePcmSamplesReader();
+  // The last incomplete frame is ignored.
+  const int num_frames = samples_reader->size() / kFrameSize10ms48kHz;
+  std::array<float, kFrameSize10ms48kHz> samples_48k;
+  std::array<float, kFrameSize10ms24kHz> samples_24k;
+  PushSincResampler decimator(kFrameSize10ms48kHz, kFrameSize10ms24kHz);
+  FeaturesExtractor features_extractor(cpu_features());
+  std::vector<float> feature_vectors(num_frames * kFeatureVectorSize);
+  std::vector<bool> is_silence(num_frames);
+  for (int i = 0; i < num_frames; ++i) {
+    ASSERT_TRUE(samples_reader->ReadChunk(samples_48k));
+    decimator.Resample(samples_48k.data(), samples_48k.size(),
+                       samples_24k.data(), samples_24k.size());
+    is_silence[i] = features_extractor.CheckSilenceComputeFeatures(
+        samples_24k,
+        {&feature_vectors[i * kFeatureVectorSize], kFeatureVectorSize});
+  }
+
+  RnnVad rnn_vad(cpu_features(), int8_weights());
+  constexpr int kNumTests = 100;
+  ::webrtc::test::PerformanceTimer perf_timer(kNumTests);
+  for (int k = 0; k < kNumTests; ++k) {
+    rnn_vad.Reset();
+    perf_timer.StartTimer();
+    for (int i = 0; i < num_frames; ++i) {
+      rnn_vad.ComputeVadProbability(
+          {&feature_vectors[i * kFeatureVectorSize], kFeatureVectorSize},
+          is_silence[i]);
+    }
+    perf_timer.StopTimer();
+  }
+  RTC_LOG(LS_INFO) << "CPU features: " << cpu_features().ToString()
+                   << " | int8 weights: " << int8_weights() << " | "
+                   << (perf_timer.GetDurationAverage() / num_frames) << " +/- "
+                   << (perf_timer.GetDurationStandardDeviation() / num_frames)
+                   << " us per 10 ms frame";
+}
+
 // Finds the relevant CPU features combinations to test.
 std::vector<AvailableCpuFeatures> GetCpuFeaturesToTest() {
   std::vector<AvailableCpuFeatures> v;
@@ -175,9 +222,12 @@ std::vector<AvailableCpuFeatures> GetCpuFeaturesToTest() {
 INSTANTIATE_TEST_SUITE_P(
     RnnVadTest,
     RnnVadProbabilityParametrization,
-    ::testing::ValuesIn(GetCpuFeaturesToTest()),
-    [](const ::testing::TestParamInfo<AvailableCpuFeatures>& info) {
-      return info.param.ToString();
+    ::testing::Combine(::testing::ValuesIn(GetCpuFeaturesToTest()),
+                       /*int8_weights=*/::testing::Bool()),
+    [](const ::testing::TestParamInfo<std::tuple<AvailableCpuFeatures, bool>>&
+           info) {
+      return std::get<0>(info.param).ToString() +
+             (std::get<1>(info.param) ? "_Int8" : "_Float");
     });
 
 }  // namespace
@@ -21,6 +21,9 @@
 #include <emmintrin.h>
 #endif
 
+#include <stdint.h>
+#include <string.h>
+
 #include <numeric>
 
 #include "api/array_view.h"
@@ -73,7 +76,7 @@ class VectorMath {
       }
       return dot_product;
     }
-#elif defined(WEBRTC_HAS_NEON) && defined(WEBRTC_ARCH_ARM64)
+#elif defined(WEBRTC_HAS_NEON)
     if (cpu_features_.neon) {
       float32x4_t accumulator = vdupq_n_f32(0.f);
       constexpr int kBlockSizeLog2 = 2;
@@ -84,7 +87,7 @@ class VectorMath {
         RTC_DCHECK_LE(i + kBlockSize, x.size());
         const float32x4_t x_i = vld1q_f32(&x[i]);
         const float32x4_t y_i = vld1q_f32(&y[i]);
-        accumulator = vfmaq_f32(accumulator, x_i, y_i);
+        accumulator = MultiplyAccumulateNeon(accumulator, x_i, y_i);
       }
       // Reduce `accumulator` by addition.
       const float32x2_t tmp =
@@ -101,9 +104,106 @@ class VectorMath {
     return std::inner_product(x.begin(), x.end(), y.begin(), 0.f);
   }
 
+  // Computes the dot product between `x` and the vector of quantized values
+  // `y`. The result is not scaled; the caller must apply the quantization
+  // scaling factor.
+  float DotProductInt8(rtc::ArrayView<const float> x,
+                       rtc::ArrayView<const int8_t> y) const {
+    RTC_DCHECK_EQ(x.size(), y.size());
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (cpu_features_.avx2) {
+      return DotProductInt8Avx2(x, y);
+    } else if (cpu_features_.sse2) {
+      __m128 accumulator = _mm_setzero_ps();
+      constexpr int kBlockSizeLog2 = 2;
+      constexpr int kBlockSize = 1 << kBlockSizeLog2;
+      const int incomplete_block_index = (x.size() >> kBlockSizeLog2)
+                                         << kBlockSizeLog2;
+      for (int i = 0; i < incomplete_block_index; i += kBlockSize) {
+        RTC_DCHECK_LE(i + kBlockSize, x.size());
+        const __m128 x_i = _mm_loadu_ps(&x[i]);
+        // Load 4 quantized values and sign-extend them to 32 bits; SSE2 has no
+        // dedicated instruction, hence each value is first moved into the most
+        // significant byte and then arithmetically shifted back.
+        int32_t packed;
+        memcpy(&packed, &y[i], sizeof(packed));
+        __m128i y_i = _mm_cvtsi32_si128(packed);
+        y_i = _mm_unpacklo_epi8(y_i, y_i);
+        y_i = _mm_unpacklo_epi16(y_i, y_i);
+        y_i = _mm_srai_epi32(y_i, 24);
+        const __m128 z_j = _mm_mul_ps(x_i, _mm_cvtepi32_ps(y_i));
+        accumulator = _mm_add_ps(accumulator, z_j);
+      }
+      // Reduce `accumulator` by addition.
+      __m128 high = _mm_movehl_ps(accumulator, accumulator);
+      accumulator = _mm_add_ps(accumulator, high);
+      high = _mm_shuffle_ps(accumulator, accumulator, 1);
+      accumulator = _mm_add_ps(accumulator, high);
+      float dot_product = _mm_cvtss_f32(accumulator);
+      // Add the result for the last block if incomplete.
+      for (int i = incomplete_block_index;
+           i < rtc::dchecked_cast<int>(x.size()); ++i) {
+        dot_product += x[i] * y[i];
+      }
+      return dot_product;
+    }
+#elif defined(WEBRTC_HAS_NEON)
+    if (cpu_features_.neon) {
+      float32x4_t accumulator = vdupq_n_f32(0.f);
+      constexpr int kBlockSizeLog2 = 3;
+      constexpr int kBlockSize = 1 << kBlockSizeLog2;
+      const int incomplete_block_index = (x.size() >> kBlockSizeLog2)
+                                         << kBlockSizeLog2;
+      for (int i = 0; i < incomplete_block_index; i += kBlockSize) {
+        RTC_DCHECK_LE(i + kBlockSize, x.size());
+        // Widen 8 quantized values to two vectors of 4 floats.
+        const int16x8_t y_i = vmovl_s8(vld1_s8(&y[i]));
+        const float32x4_t y_low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(y_i)));
+        const float32x4_t y_high =
+            vcvtq_f32_s32(vmovl_s16(vget_high_s16(y_i)));
+        accumulator =
+            MultiplyAccumulateNeon(accumulator, vld1q_f32(&x[i]), y_low);
+        accumulator =
+            MultiplyAccumulateNeon(accumulator, vld1q_f32(&x[i + 4]), y_high);
+      }
+      // Reduce `accumulator` by addition.
+      const float32x2_t tmp =
+          vpadd_f32(vget_low_f32(accumulator), vget_high_f32(accumulator));
+      float dot_product = vget_lane_f32(vpadd_f32(tmp, vrev64_f32(tmp)), 0);
+      // Add the result for the last block if incomplete.
+      for (int i = incomplete_block_index;
+           i < rtc::dchecked_cast<int>(x.size()); ++i) {
+        dot_product += x[i] * y[i];
+      }
+      return dot_product;
+    }
+#endif
+    float dot_product = 0.f;
+    for (size_t i = 0; i < x.size(); ++i) {
+      dot_product += x[i] * y[i];
+    }
+    return dot_product;
+  }
+
  private:
+#if defined(WEBRTC_HAS_NEON)
+  // Returns `accumulator + x * y`. Fused multiply-add is only available on
+  // ARM64.
+  static float32x4_t MultiplyAccumulateNeon(float32x4_t accumulator,
+                                            float32x4_t x,
+                                            float32x4_t y) {
+#if defined(WEBRTC_ARCH_ARM64)
+    return vfmaq_f32(accumulator, x, y);
+#else
+    return vmlaq_f32(accumulator, x, y);
+#endif
+  }
+#endif
+
   float DotProductAvx2(rtc::ArrayView<const float> x,
                        rtc::ArrayView<const float> y) const;
+  float DotProductInt8Avx2(rtc::ArrayView<const float> x,
+                           rtc::ArrayView<const int8_t> y) const;
 
   const AvailableCpuFeatures cpu_features_;
 };
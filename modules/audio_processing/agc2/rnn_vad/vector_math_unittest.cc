@@ -41,6 +41,25 @@ TEST_P(VectorMathParametrization, TestDotProduct) {
       kEnergyOfXSubspan);
 }
 
+TEST_P(VectorMathParametrization, TestDotProductWithInt8) {
+  constexpr int8_t kY[kSizeOfX] = {-128, 127, -1, 0,   1,   64,  -64,
+                                   33,   -33, 5,  -99, 100, -7,  7,
+                                   18,   -18, 90, -90, 2};
+  float expected = 0.f;
+  for (int i = 0; i < kSizeOfX; ++i) {
+    expected += kX[i] * kY[i];
+  }
+  VectorMath vector_math(/*cpu_features=*/GetParam());
+  EXPECT_NEAR(vector_math.DotProductInt8(kX, kY), expected, 1e-4f);
+  float expected_subspan = 0.f;
+  for (int i = 0; i < kSizeOfXSubSpan; ++i) {
+    expected_subspan += kX[i] * kY[i];
+  }
+  EXPECT_NEAR(vector_math.DotProductInt8({kX, kSizeOfXSubSpan},
+                                         {kY, kSizeOfXSubSpan}),
+              expected_subspan, 1e-4f);
+}
+
 // Finds the relevant CPU features combinations to test.
 std::vector<AvailableCpuFeatures> GetCpuFeaturesToTest() {
   std::vector<AvailableCpuFeatures> v;
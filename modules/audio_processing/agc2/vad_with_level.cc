@@ -32,8 +32,9 @@ using VoiceActivityDetector = VadLevelAnalyzer::VoiceActivityDetector;
 // Computes the speech probability on the first channel.
 class Vad : public VoiceActivityDetector {
  public:
-  explicit Vad(const AvailableCpuFeatures& cpu_features)
-      : features_extractor_(cpu_features), rnn_vad_(cpu_features) {}
+  Vad(const AvailableCpuFeatures& cpu_features, bool int8_weights)
+      : features_extractor_(cpu_features),
+        rnn_vad_(cpu_features, int8_weights) {}
   Vad(const Vad&) = delete;
   Vad& operator=(const Vad&) = delete;
   ~Vad() = default;
@@ -68,9 +69,10 @@ class Vad : public VoiceActivityDetector {
 }  // namespace
 
 VadLevelAnalyzer::VadLevelAnalyzer(int vad_reset_period_ms,
-                                   const AvailableCpuFeatures& cpu_features)
+                                   const AvailableCpuFeatures& cpu_features,
+                                   bool int8_weights)
     : VadLevelAnalyzer(vad_reset_period_ms,
-                       std::make_unique<Vad>(cpu_features)) {}
+                       std::make_unique<Vad>(cpu_features, int8_weights)) {}
 
 VadLevelAnalyzer::VadLevelAnalyzer(int vad_reset_period_ms,
                                    std::unique_ptr<VoiceActivityDetector> vad)
@@ -39,9 +39,11 @@ class VadLevelAnalyzer {
 
   // Ctor. `vad_reset_period_ms` indicates the period in milliseconds to call
   // `VadLevelAnalyzer::Reset()`; it must be equal to or greater than the
-  // duration of two frames. Uses `cpu_features` to instantiate the default VAD.
+  // duration of two frames. Uses `cpu_features` to instantiate the default VAD,
+  // which keeps its weights quantized if `int8_weights` is true.
   VadLevelAnalyzer(int vad_reset_period_ms,
-                   const AvailableCpuFeatures& cpu_features);
+                   const AvailableCpuFeatures& cpu_features,
+                   bool int8_weights);
   // Ctor. Uses a custom `vad`.
   VadLevelAnalyzer(int vad_reset_period_ms,
                    std::unique_ptr<VoiceActivityDetector> vad);
@@ -3137,6 +3137,10 @@ TEST(AudioProcessing, GainController2ConfigEqual) {
   b_adaptive.max_output_noise_level_dbfs =
       a_adaptive.max_output_noise_level_dbfs;
   EXPECT_EQ(a, b);
+
+  Toggle(a_adaptive.vad_int8_weights);
+  b_adaptive.vad_int8_weights = a_adaptive.vad_int8_weights;
+  EXPECT_EQ(a, b);
 }
 
 // Checks that one differing parameter is sufficient to make two configs
@@ -3191,6 +3195,10 @@ TEST(AudioProcessing, GainController2ConfigNotEqual) {
   a_adaptive.max_output_noise_level_dbfs += 1.0f;
   EXPECT_NE(a, b);
   a_adaptive = b_adaptive;
+
+  Toggle(a_adaptive.vad_int8_weights);
+  EXPECT_NE(a, b);
+  a_adaptive = b_adaptive;
 }
 
 }  // namespace webrtc
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/batched_audio_processing.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+// Splits `num_streams` streams into `num_shards` contiguous shards whose sizes
+// differ by at most one.
+std::vector<size_t> ComputeShardBounds(size_t num_streams, size_t num_shards) {
+  RTC_DCHECK_GT(num_shards, 0);
+  std::vector<size_t> bounds(num_shards + 1);
+  const size_t base = num_streams / num_shards;
+  const size_t remainder = num_streams % num_shards;
+  bounds[0] = 0;
+  for (size_t k = 0; k < num_shards; ++k) {
+    bounds[k + 1] = bounds[k] + base + (k < remainder ? 1 : 0);
+  }
+  RTC_DCHECK_EQ(bounds[num_shards], num_streams);
+  return bounds;
+}
+
+}  // namespace
+
+BatchedAudioProcessing::BatchedAudioProcessing(
+    const Settings& settings,
+    TaskQueueFactory* task_queue_factory)
+    : stream_config_(settings.sample_rate_hz, /*num_channels=*/1),
+      samples_per_frame_(stream_config_.num_frames()),
+      frames_(settings.num_streams * samples_per_frame_, 0.f),
+      shard_bounds_(ComputeShardBounds(
+          settings.num_streams,
+          std::max<size_t>(
+              1,
+              std::min(settings.num_streams, settings.num_workers + 1)))) {
+  RTC_DCHECK_GT(settings.num_streams, 0);
+  RTC_DCHECK(settings.num_workers == 0 || task_queue_factory);
+
+  processors_.reserve(settings.num_streams);
+  for (size_t k = 0; k < settings.num_streams; ++k) {
+    rtc::scoped_refptr<AudioProcessing> apm = AudioProcessingBuilder().Create();
+    apm->ApplyConfig(settings.config);
+    const ProcessingConfig processing_config = {
+        {stream_config_, stream_config_, stream_config_, stream_config_}};
+    apm->Initialize(processing_config);
+    processors_.push_back(std::move(apm));
+  }
+
+  // The calling thread processes the first shard; one worker is needed for
+  // each of the remaining ones.
+  for (size_t k = 1; k < num_shards(); ++k) {
+    workers_.push_back(std::make_unique<rtc::TaskQueue>(
+        task_queue_factory->CreateTaskQueue(
+            "BatchedAudioProcessing", TaskQueueFactory::Priority::HIGH)));
+  }
+}
+
+BatchedAudioProcessing::~BatchedAudioProcessing() = default;
+
+rtc::ArrayView<float> BatchedAudioProcessing::frame(size_t stream) {
+  RTC_DCHECK_LT(stream, num_streams());
+  return rtc::ArrayView<float>(&frames_[stream * samples_per_frame_],
+                               samples_per_frame_);
+}
+
+AudioProcessing* BatchedAudioProcessing::processor(size_t stream) {
+  RTC_DCHECK_LT(stream, num_streams());
+  return processors_[stream].get();
+}
+
+int BatchedAudioProcessing::ProcessStreams() {
+  if (workers_.empty()) {
+    return ProcessShard(0);
+  }
+
+  worker_error_.store(AudioProcessing::kNoError, std::memory_order_relaxed);
+  pending_shards_.store(static_cast<int>(workers_.size()),
+                        std::memory_order_relaxed);
+  for (size_t k = 0; k < workers_.size(); ++k) {
+    workers_[k]->PostTask([this, shard = k + 1] {
+      const int error = ProcessShard(shard);
+      if (error != AudioProcessing::kNoError) {
+        int expected = AudioProcessing::kNoError;
+        worker_error_.compare_exchange_strong(expected, error);
+      }
+      if (pending_shards_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        shards_done_.Set();
+      }
+    });
+  }
+
+  const int error = ProcessShard(0);
+  shards_done_.Wait(rtc::Event::kForever);
+  return error != AudioProcessing::kNoError ? error : worker_error_.load();
+}
+
+int BatchedAudioProcessing::ProcessShard(size_t shard) {
+  int result = AudioProcessing::kNoError;
+  for (size_t k = shard_bounds_[shard]; k < shard_bounds_[shard + 1]; ++k) {
+    float* channel = &frames_[k * samples_per_frame_];
+    const int error = processors_[k]->ProcessStream(
+        &channel, stream_config_, stream_config_, &channel);
+    if (error != AudioProcessing::kNoError &&
+        result == AudioProcessing::kNoError) {
+      result = error;
+    }
+  }
+  return result;
+}
+
+}  // namespace webrtc
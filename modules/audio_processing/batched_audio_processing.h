@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
+#define MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue.h"
+
+namespace webrtc {
+
+// Processes many independent mono capture streams (e.g., one per server-side
+// ingest stream) in lockstep, one 10 ms frame at a time. The frames of all the
+// streams live in a single contiguous block of `num_streams` rows, each one
+// holding `samples_per_frame()` samples, so that a shard of streams maps onto
+// a contiguous memory region. Each stream keeps its own `AudioProcessing`
+// instance and therefore its own band-splitting, noise suppression and AGC2
+// state. Streams are split into equally sized shards which are processed in
+// parallel on a pool of worker task queues; `ProcessStreams()` returns once
+// the current frame of every stream has been processed.
+//
+// `BatchedWienerFilter` and `BatchedGainApplier` provide the stages that are
+// element-wise across streams, i.e., the noise suppression Wiener gain and the
+// AGC2 gain application, as struct-of-arrays kernels for pipelines which keep
+// the state of all the streams interleaved.
+//
+// The methods of this class must be called from the same thread.
+class BatchedAudioProcessing {
+ public:
+  struct Settings {
+    // Number of independent streams in the batch.
+    size_t num_streams = 1;
+    // Sample rate of every stream.
+    int sample_rate_hz = 16000;
+    // Number of worker task queues. When zero, all the streams are processed
+    // on the thread calling `ProcessStreams()`. Otherwise, the calling thread
+    // processes one shard and each worker processes another one.
+    size_t num_workers = 0;
+    // Configuration applied to every stream.
+    AudioProcessing::Config config;
+  };
+
+  // `task_queue_factory` is only used when `settings.num_workers` > 0 and
+  // must then be non-null.
+  BatchedAudioProcessing(const Settings& settings,
+                         TaskQueueFactory* task_queue_factory);
+  BatchedAudioProcessing(const BatchedAudioProcessing&) = delete;
+  BatchedAudioProcessing& operator=(const BatchedAudioProcessing&) = delete;
+  ~BatchedAudioProcessing();
+
+  size_t num_streams() const { return processors_.size(); }
+  size_t num_shards() const { return shard_bounds_.size() - 1; }
+  size_t samples_per_frame() const { return samples_per_frame_; }
+
+  // Returns a view of the current frame of the stream with index `stream`.
+  // The caller writes the input samples (in the range [-1, 1]) into it before
+  // calling `ProcessStreams()` and reads the processed samples afterwards.
+  rtc::ArrayView<float> frame(size_t stream);
+
+  // Returns the `AudioProcessing` instance of the stream with index `stream`,
+  // e.g., to read its statistics or to post runtime settings. Must not be
+  // used for processing while `ProcessStreams()` is running.
+  AudioProcessing* processor(size_t stream);
+
+  // Processes, in place, the current frame of every stream. Returns
+  // `AudioProcessing::kNoError` on success, otherwise the error code of the
+  // first stream that failed.
+  int ProcessStreams();
+
+ private:
+  int ProcessShard(size_t shard);
+
+  const StreamConfig stream_config_;
+  const size_t samples_per_frame_;
+  std::vector<rtc::scoped_refptr<AudioProcessing>> processors_;
+  // Frames of all the streams, stream-major.
+  std::vector<float> frames_;
+  // Shard `k` contains the streams in [`shard_bounds_[k]`,
+  // `shard_bounds_[k + 1]`).
+  std::vector<size_t> shard_bounds_;
+  std::atomic<int> pending_shards_{0};
+  std::atomic<int> worker_error_{AudioProcessing::kNoError};
+  rtc::Event shards_done_;
+  // Declared last so that the workers are stopped before any state they may
+  // use gets destroyed.
+  std::vector<std::unique_ptr<rtc::TaskQueue>> workers_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
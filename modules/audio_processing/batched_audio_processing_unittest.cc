@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/batched_audio_processing.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kSampleRateHz = 48000;
+constexpr int kNumFrames = 50;
+
+AudioProcessing::Config CreateServerSideConfig() {
+  AudioProcessing::Config config;
+  config.noise_suppression.enabled = true;
+  config.gain_controller2.enabled = true;
+  config.gain_controller2.adaptive_digital.enabled = true;
+  return config;
+}
+
+// Fills `frame` with noise whose level depends on `stream` so that the
+// streams differ from each other.
+void FillFrame(size_t stream, Random& random, rtc::ArrayView<float> frame) {
+  const float amplitude = 0.05f * (1 + stream % 5);
+  for (float& sample : frame) {
+    sample = amplitude * (random.Rand<float>() * 2.f - 1.f);
+  }
+}
+
+void ExpectSameOutputAsIndependentProcessing(size_t num_streams,
+                                             size_t num_workers) {
+  std::unique_ptr<TaskQueueFactory> task_queue_factory =
+      CreateDefaultTaskQueueFactory();
+  BatchedAudioProcessing::Settings settings;
+  settings.num_streams = num_streams;
+  settings.sample_rate_hz = kSampleRateHz;
+  settings.num_workers = num_workers;
+  settings.config = CreateServerSideConfig();
+  BatchedAudioProcessing batch(settings, task_queue_factory.get());
+  ASSERT_EQ(batch.num_streams(), num_streams);
+
+  const StreamConfig stream_config(kSampleRateHz, /*num_channels=*/1);
+  std::vector<rtc::scoped_refptr<AudioProcessing>> references;
+  for (size_t k = 0; k < num_streams; ++k) {
+    references.push_back(AudioProcessingBuilder().Create());
+    references.back()->ApplyConfig(settings.config);
+  }
+
+  Random random(/*seed=*/42);
+  std::vector<float> reference_frame(batch.samples_per_frame());
+  for (int i = 0; i < kNumFrames; ++i) {
+    for (size_t k = 0; k < num_streams; ++k) {
+      FillFrame(k, random, batch.frame(k));
+    }
+    std::vector<std::vector<float>> reference_output;
+    for (size_t k = 0; k < num_streams; ++k) {
+      reference_frame.assign(batch.frame(k).begin(), batch.frame(k).end());
+      float* channel = reference_frame.data();
+      ASSERT_EQ(references[k]->ProcessStream(&channel, stream_config,
+                                             stream_config, &channel),
+                AudioProcessing::kNoError);
+      reference_output.push_back(reference_frame);
+    }
+
+    ASSERT_EQ(batch.ProcessStreams(), AudioProcessing::kNoError);
+
+    for (size_t k = 0; k < num_streams; ++k) {
+      rtc::ArrayView<const float> output = batch.frame(k);
+      for (size_t j = 0; j < output.size(); ++j) {
+        ASSERT_EQ(output[j], reference_output[k][j])
+            << "stream " << k << ", frame " << i << ", sample " << j;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BatchedAudioProcessingTest, SplitsStreamsIntoBalancedShards) {
+  std::unique_ptr<TaskQueueFactory> task_queue_factory =
+      CreateDefaultTaskQueueFactory();
+  BatchedAudioProcessing::Settings settings;
+  settings.num_streams = 3;
+  settings.num_workers = 7;
+  BatchedAudioProcessing batch(settings, task_queue_factory.get());
+  // No more shards than streams.
+  EXPECT_EQ(batch.num_shards(), 3u);
+}
+
+TEST(BatchedAudioProcessingTest, FrameSizeMatchesSampleRate) {
+  BatchedAudioProcessing::Settings settings;
+  settings.sample_rate_hz = kSampleRateHz;
+  BatchedAudioProcessing batch(settings, /*task_queue_factory=*/nullptr);
+  EXPECT_EQ(batch.samples_per_frame(),
+            static_cast<size_t>(kSampleRateHz / 100));
+  EXPECT_EQ(batch.frame(0).size(), batch.samples_per_frame());
+}
+
+TEST(BatchedAudioProcessingTest, InlineProcessingIsBitExact) {
+  ExpectSameOutputAsIndependentProcessing(/*num_streams=*/4,
+                                          /*num_workers=*/0);
+}
+
+TEST(BatchedAudioProcessingTest, ShardedProcessingIsBitExact) {
+  ExpectSameOutputAsIndependentProcessing(/*num_streams=*/11,
+                                          /*num_workers=*/3);
+}
+
+}  // namespace webrtc
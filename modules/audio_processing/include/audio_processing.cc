@@ -96,7 +96,8 @@ bool Agc2Config::AdaptiveDigital::operator==(
          adjacent_speech_frames_threshold ==
              rhs.adjacent_speech_frames_threshold &&
          max_gain_change_db_per_second == rhs.max_gain_change_db_per_second &&
-         max_output_noise_level_dbfs == rhs.max_output_noise_level_dbfs;
+         max_output_noise_level_dbfs == rhs.max_output_noise_level_dbfs &&
+         vad_int8_weights == rhs.vad_int8_weights;
 }
 
 bool Agc2Config::operator==(const Agc2Config& rhs) const {
@@ -209,6 +210,8 @@ std::string AudioProcessing::Config::ToString() const {
           << gain_controller2.adaptive_digital.max_gain_change_db_per_second
           << ", max_output_noise_level_dbfs: "
           << gain_controller2.adaptive_digital.max_output_noise_level_dbfs
+          << ", vad_int8_weights: "
+          << gain_controller2.adaptive_digital.vad_int8_weights
           << "}}, residual_echo_detector: { enabled: "
           << residual_echo_detector.enabled
           << " }, level_estimation: { enabled: " << level_estimation.enabled
@@ -379,6 +379,9 @@ class RTC_EXPORT AudioProcessing : public rtc::RefCountInterface {
         int adjacent_speech_frames_threshold = 12;
         float max_gain_change_db_per_second = 3.0f;
         float max_output_noise_level_dbfs = -50.0f;
+        // When true, the RNN VAD keeps its weights quantized (int8) and
+        // scales them on the fly, which reduces its memory footprint.
+        bool vad_int8_weights = false;
       } adaptive_digital;
     } gain_controller2;
 
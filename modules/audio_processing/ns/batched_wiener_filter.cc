@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/batched_wiener_filter.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+BatchedWienerFilter::BatchedWienerFilter(
+    size_t num_streams,
+    const SuppressionParams& suppression_params)
+    : num_streams_(num_streams),
+      suppression_params_(suppression_params),
+      spectra_prev_process_(kFftSizeBy2Plus1 * num_streams, 0.f),
+      initial_spectral_estimates_(kFftSizeBy2Plus1 * num_streams, 0.f),
+      filters_(kFftSizeBy2Plus1 * num_streams, 1.f) {
+  RTC_DCHECK_GT(num_streams, 0);
+}
+
+void BatchedWienerFilter::Update(
+    int32_t num_analyzed_frames,
+    rtc::ArrayView<const float> noise_spectra,
+    rtc::ArrayView<const float> prev_noise_spectra,
+    rtc::ArrayView<const float> parametric_noise_spectra,
+    rtc::ArrayView<const float> signal_spectra) {
+  const size_t size = filters_.size();
+  RTC_DCHECK_EQ(size, noise_spectra.size());
+  RTC_DCHECK_EQ(size, prev_noise_spectra.size());
+  RTC_DCHECK_EQ(size, parametric_noise_spectra.size());
+  RTC_DCHECK_EQ(size, signal_spectra.size());
+
+  // The update is element-wise, hence the bins of all the streams are handled
+  // in a single branch-free loop.
+  const float over_subtraction_factor =
+      suppression_params_.over_subtraction_factor;
+  const float minimum_attenuating_gain =
+      suppression_params_.minimum_attenuating_gain;
+  const float* noise = noise_spectra.data();
+  const float* prev_noise = prev_noise_spectra.data();
+  const float* signal = signal_spectra.data();
+  const float* prev_process = spectra_prev_process_.data();
+  float* filter = filters_.data();
+  for (size_t i = 0; i < size; ++i) {
+    // Previous estimate based on previous frame with gain filter.
+    const float prev_tsa =
+        prev_process[i] / (prev_noise[i] + 0.0001f) * filter[i];
+
+    // Current estimate. Computed unconditionally so that the loop has no
+    // branches.
+    const float tsa = signal[i] / (noise[i] + 0.0001f) - 1.f;
+    const float current_tsa = signal[i] > noise[i] ? tsa : 0.f;
+
+    // Directed decision estimate is sum of two terms: current estimate and
+    // previous estimate.
+    const float snr_prior = 0.98f * prev_tsa + (1.f - 0.98f) * current_tsa;
+    filter[i] = std::max(
+        std::min(snr_prior / (over_subtraction_factor + snr_prior), 1.f),
+        minimum_attenuating_gain);
+  }
+
+  if (num_analyzed_frames < kShortStartupPhaseBlocks) {
+    const float* parametric_noise = parametric_noise_spectra.data();
+    float* initial_estimate = initial_spectral_estimates_.data();
+    constexpr float kOnyByShortStartupPhaseBlocks =
+        1.f / kShortStartupPhaseBlocks;
+    const float initial_weight =
+        static_cast<float>(kShortStartupPhaseBlocks - num_analyzed_frames);
+    const float weight = static_cast<float>(num_analyzed_frames);
+    for (size_t i = 0; i < size; ++i) {
+      initial_estimate[i] += signal[i];
+      float filter_initial =
+          initial_estimate[i] - over_subtraction_factor * parametric_noise[i];
+      filter_initial /= initial_estimate[i] + 0.0001f;
+      filter_initial = std::max(std::min(filter_initial, 1.f),
+                                minimum_attenuating_gain);
+
+      // Weight the two suppression filters.
+      filter_initial *= initial_weight;
+      filter[i] *= weight;
+      filter[i] += filter_initial;
+      filter[i] *= kOnyByShortStartupPhaseBlocks;
+    }
+  }
+
+  std::copy(signal_spectra.begin(), signal_spectra.end(),
+            spectra_prev_process_.begin());
+}
+
+}  // namespace webrtc
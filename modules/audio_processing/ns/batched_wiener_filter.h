@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_NS_BATCHED_WIENER_FILTER_H_
+#define MODULES_AUDIO_PROCESSING_NS_BATCHED_WIENER_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/ns/ns_common.h"
+#include "modules/audio_processing/ns/suppression_params.h"
+
+namespace webrtc {
+
+// Computes the Wiener filter of `WienerFilter` for many independent streams at
+// once. All the spectra are stored bin-major, i.e., element
+// `bin * num_streams + stream` holds `bin` of `stream`, so that the per-bin
+// update runs over contiguous memory across streams and vectorizes. The
+// filters are bit-exact with those of one `WienerFilter` per stream. All the
+// streams must have analyzed the same number of frames.
+class BatchedWienerFilter {
+ public:
+  BatchedWienerFilter(size_t num_streams,
+                      const SuppressionParams& suppression_params);
+  BatchedWienerFilter(const BatchedWienerFilter&) = delete;
+  BatchedWienerFilter& operator=(const BatchedWienerFilter&) = delete;
+
+  // Updates the filter estimates. Each spectrum holds
+  // `kFftSizeBy2Plus1 * num_streams()` values.
+  void Update(int32_t num_analyzed_frames,
+              rtc::ArrayView<const float> noise_spectra,
+              rtc::ArrayView<const float> prev_noise_spectra,
+              rtc::ArrayView<const float> parametric_noise_spectra,
+              rtc::ArrayView<const float> signal_spectra);
+
+  // Returns the filters, in the same layout as the spectra.
+  rtc::ArrayView<const float> get_filters() const { return filters_; }
+
+  size_t num_streams() const { return num_streams_; }
+
+ private:
+  const size_t num_streams_;
+  const SuppressionParams& suppression_params_;
+  std::vector<float> spectra_prev_process_;
+  std::vector<float> initial_spectral_estimates_;
+  std::vector<float> filters_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_NS_BATCHED_WIENER_FILTER_H_
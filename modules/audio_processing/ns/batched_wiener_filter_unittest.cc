@@ -0,0 +1,96 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/ns/batched_wiener_filter.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "modules/audio_processing/ns/wiener_filter.h"
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kNumStreams = 5;
+
+using Spectrum = std::array<float, kFftSizeBy2Plus1>;
+
+void FillRandomSpectrum(Random& random_generator, Spectrum& spectrum) {
+  for (float& bin : spectrum) {
+    bin = 1000.f * random_generator.Rand<float>();
+  }
+}
+
+// Stores `spectrum` as the spectrum of `stream` in the bin-major layout.
+void Interleave(const Spectrum& spectrum,
+                size_t stream,
+                std::vector<float>& spectra) {
+  for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+    spectra[i * kNumStreams + stream] = spectrum[i];
+  }
+}
+
+// Verifies that the batched filters are bit-exact with one `WienerFilter` per
+// stream, both during and after the startup phase.
+TEST(BatchedWienerFilterTest, BitExactWithWienerFilterPerStream) {
+  for (auto level :
+       {NsConfig::SuppressionLevel::k6dB, NsConfig::SuppressionLevel::k21dB}) {
+    const SuppressionParams params(level);
+    std::vector<std::unique_ptr<WienerFilter>> filters;
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      filters.push_back(std::make_unique<WienerFilter>(params));
+    }
+    BatchedWienerFilter batched_filter(kNumStreams, params);
+    ASSERT_EQ(kNumStreams, batched_filter.num_streams());
+
+    Random random_generator(42);
+    std::vector<Spectrum> prev_noise(kNumStreams);
+    std::vector<float> noise_spectra(kFftSizeBy2Plus1 * kNumStreams);
+    std::vector<float> prev_noise_spectra(kFftSizeBy2Plus1 * kNumStreams);
+    std::vector<float> parametric_noise_spectra(kFftSizeBy2Plus1 *
+                                                kNumStreams);
+    std::vector<float> signal_spectra(kFftSizeBy2Plus1 * kNumStreams);
+    for (int32_t frame = 0; frame < 2 * kShortStartupPhaseBlocks; ++frame) {
+      for (size_t s = 0; s < kNumStreams; ++s) {
+        Spectrum noise;
+        Spectrum parametric_noise;
+        Spectrum signal;
+        FillRandomSpectrum(random_generator, noise);
+        FillRandomSpectrum(random_generator, parametric_noise);
+        FillRandomSpectrum(random_generator, signal);
+        Interleave(noise, s, noise_spectra);
+        Interleave(prev_noise[s], s, prev_noise_spectra);
+        Interleave(parametric_noise, s, parametric_noise_spectra);
+        Interleave(signal, s, signal_spectra);
+        filters[s]->Update(frame, noise, prev_noise[s], parametric_noise,
+                           signal);
+        prev_noise[s] = noise;
+      }
+      batched_filter.Update(frame, noise_spectra, prev_noise_spectra,
+                            parametric_noise_spectra, signal_spectra);
+
+      rtc::ArrayView<const float> batched = batched_filter.get_filters();
+      for (size_t s = 0; s < kNumStreams; ++s) {
+        rtc::ArrayView<const float, kFftSizeBy2Plus1> filter =
+            filters[s]->get_filter();
+        for (size_t i = 0; i < kFftSizeBy2Plus1; ++i) {
+          ASSERT_EQ(filter[i], batched[i * kNumStreams + s])
+              << "frame " << frame << ", stream " << s << ", bin " << i;
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
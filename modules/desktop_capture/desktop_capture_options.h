@@ -97,6 +97,14 @@ class RTC_EXPORT DesktopCaptureOptions {
     detect_updated_region_ = detect_updated_region;
   }
 
+  // Number of threads, including the capture thread, on which large updated
+  // regions are compared when `detect_updated_region()` is set. Defaults to 1,
+  // i.e., frames are compared on the capture thread only.
+  int max_diff_threads() const { return max_diff_threads_; }
+  void set_max_diff_threads(int max_diff_threads) {
+    max_diff_threads_ = max_diff_threads;
+  }
+
 #if defined(WEBRTC_WIN)
   // Enumerating windows owned by the current process on Windows has some
   // complications due to |GetWindowText*()| APIs potentially causing a
@@ -191,6 +199,7 @@ class RTC_EXPORT DesktopCaptureOptions {
 #endif
   bool disable_effects_ = true;
   bool detect_updated_region_ = false;
+  int max_diff_threads_ = 1;
 #if defined(WEBRTC_USE_PIPEWIRE)
   bool allow_pipewire_ = false;
 #endif
@@ -13,18 +13,48 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
 #include <utility>
+#include <vector>
 
 #include "modules/desktop_capture/desktop_geometry.h"
 #include "modules/desktop_capture/desktop_region.h"
 #include "modules/desktop_capture/differ_block.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/time_utils.h"
 
 namespace webrtc {
 
 namespace {
 
+// Regions smaller than this are always compared on the capture thread; waking
+// up the helper threads would cost more than it saves.
+constexpr int kMinParallelDiffPixels = 1024 * 1024;
+// Minimum height, in block-rows, of the band given to each thread.
+constexpr int kMinBlockRowsPerBand = 4;
+
+// Returns true if any of the `height` rows of `width_bytes` bytes starting from
+// `old_buffer` and `new_buffer` differ. memcmp() of whole rows is much cheaper
+// than per-block comparison, so this is used to skip unchanged block-rows,
+// which are the majority of most screen content.
+bool RowsDifference(const uint8_t* old_buffer,
+                    const uint8_t* new_buffer,
+                    int width_bytes,
+                    int height,
+                    int stride) {
+  for (int i = 0; i < height; i++) {
+    if (memcmp(old_buffer, new_buffer, width_bytes) != 0) {
+      return true;
+    }
+    old_buffer += stride;
+    new_buffer += stride;
+  }
+  return false;
+}
+
 // Returns true if (0, 0) - (`width`, `height`) vector in `old_buffer` and
 // `new_buffer` are equal. `width` should be less than 32
 // (defined by kBlockSize), otherwise BlockDifference() should be used.
@@ -127,27 +157,134 @@ void CompareFrames(const DesktopFrame& old_frame,
       old_frame.GetFrameDataAtPos(rect.top_left());
   const uint8_t* curr_block_row_start =
       new_frame.GetFrameDataAtPos(rect.top_left());
+  const int width_bytes = rect.width() * DesktopFrame::kBytesPerPixel;
 
   int top = rect.top();
   // The last row may have a different height, so we handle it separately.
   for (int y = 0; y < y_block_count; y++) {
-    CompareRow(prev_block_row_start, curr_block_row_start, rect.left(),
-               rect.right(), top, top + kBlockSize, old_frame.stride(), output);
+    if (RowsDifference(prev_block_row_start, curr_block_row_start, width_bytes,
+                       kBlockSize, old_frame.stride())) {
+      CompareRow(prev_block_row_start, curr_block_row_start, rect.left(),
+                 rect.right(), top, top + kBlockSize, old_frame.stride(),
+                 output);
+    }
     top += kBlockSize;
     prev_block_row_start += block_y_stride;
     curr_block_row_start += block_y_stride;
   }
-  CompareRow(prev_block_row_start, curr_block_row_start, rect.left(),
-             rect.right(), top, top + last_y_block_height, old_frame.stride(),
-             output);
+  if (RowsDifference(prev_block_row_start, curr_block_row_start, width_bytes,
+                     last_y_block_height, old_frame.stride())) {
+    CompareRow(prev_block_row_start, curr_block_row_start, rect.left(),
+               rect.right(), top, top + last_y_block_height,
+               old_frame.stride(), output);
+  }
 }
 
 }  // namespace
 
+// Helper threads comparing bands of a frame together with the capture thread.
+// The threads are kept for the lifetime of the wrapper, so that starting a
+// comparison only costs signaling an event per thread.
+class DesktopCapturerDifferWrapper::DiffWorkers {
+ public:
+  // A band of block-rows and the dirty region found in it.
+  struct Band {
+    DesktopRect rect;
+    DesktopRegion updated;
+  };
+
+  explicit DiffWorkers(int num_threads) {
+    RTC_DCHECK_GT(num_threads, 1);
+    for (int i = 0; i < num_threads - 1; i++) {
+      wake_up_events_.push_back(std::make_unique<rtc::Event>());
+    }
+    for (int i = 0; i < num_threads - 1; i++) {
+      rtc::Event* wake_up = wake_up_events_[i].get();
+      threads_.push_back(rtc::PlatformThread::SpawnJoinable(
+          [this, wake_up] { Run(wake_up); }, "DesktopDiffer"));
+    }
+  }
+
+  ~DiffWorkers() {
+    quit_.store(true);
+    for (auto& wake_up : wake_up_events_) {
+      wake_up->Set();
+    }
+    // Joins the threads.
+    threads_.clear();
+  }
+
+  int num_threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // Compares the `bands` of `old_frame` and `new_frame`, and returns when all
+  // of them are done. Must be called on the capture thread.
+  void Compare(const DesktopFrame& old_frame,
+               const DesktopFrame& new_frame,
+               std::vector<Band>* bands) {
+    old_frame_ = &old_frame;
+    new_frame_ = &new_frame;
+    bands_ = bands;
+    next_band_.store(0, std::memory_order_relaxed);
+    running_threads_.store(static_cast<int>(threads_.size()));
+    for (auto& wake_up : wake_up_events_) {
+      wake_up->Set();
+    }
+    CompareBands();
+    done_.Wait(rtc::Event::kForever, rtc::Event::kForever);
+  }
+
+ private:
+  void Run(rtc::Event* wake_up) {
+    while (true) {
+      // Threads are idle between frames, which is not worth a warning.
+      wake_up->Wait(rtc::Event::kForever, rtc::Event::kForever);
+      if (quit_.load()) {
+        return;
+      }
+      CompareBands();
+      if (running_threads_.fetch_sub(1) == 1) {
+        done_.Set();
+      }
+    }
+  }
+
+  // Takes bands until none is left.
+  void CompareBands() {
+    const int num_bands = static_cast<int>(bands_->size());
+    while (true) {
+      const int i = next_band_.fetch_add(1, std::memory_order_relaxed);
+      if (i >= num_bands) {
+        return;
+      }
+      Band& band = (*bands_)[i];
+      CompareFrames(*old_frame_, *new_frame_, band.rect, &band.updated);
+    }
+  }
+
+  std::vector<std::unique_ptr<rtc::Event>> wake_up_events_;
+  std::vector<rtc::PlatformThread> threads_;
+  rtc::Event done_;
+  std::atomic<bool> quit_{false};
+  std::atomic<int> next_band_{0};
+  std::atomic<int> running_threads_{0};
+  // Set by Compare() before the threads are woken up.
+  const DesktopFrame* old_frame_ = nullptr;
+  const DesktopFrame* new_frame_ = nullptr;
+  std::vector<Band>* bands_ = nullptr;
+};
+
 DesktopCapturerDifferWrapper::DesktopCapturerDifferWrapper(
     std::unique_ptr<DesktopCapturer> base_capturer)
-    : base_capturer_(std::move(base_capturer)) {
+    : DesktopCapturerDifferWrapper(std::move(base_capturer),
+                                   /*max_diff_threads=*/1) {}
+
+DesktopCapturerDifferWrapper::DesktopCapturerDifferWrapper(
+    std::unique_ptr<DesktopCapturer> base_capturer,
+    int max_diff_threads)
+    : base_capturer_(std::move(base_capturer)),
+      max_diff_threads_(max_diff_threads) {
   RTC_DCHECK(base_capturer_);
+  RTC_DCHECK_GE(max_diff_threads_, 1);
 }
 
 DesktopCapturerDifferWrapper::~DesktopCapturerDifferWrapper() {}
@@ -208,8 +345,7 @@ void DesktopCapturerDifferWrapper::OnCaptureResult(
     DesktopRegion hints;
     hints.Swap(frame->mutable_updated_region());
     for (DesktopRegion::Iterator it(hints); !it.IsAtEnd(); it.Advance()) {
-      CompareFrames(*last_frame_, *frame, it.rect(),
-                    frame->mutable_updated_region());
+      CompareWithLastFrame(*frame, it.rect(), frame->mutable_updated_region());
     }
   } else {
     frame->mutable_updated_region()->SetRect(
@@ -223,4 +359,43 @@ void DesktopCapturerDifferWrapper::OnCaptureResult(
   callback_->OnCaptureResult(result, std::move(frame));
 }
 
+void DesktopCapturerDifferWrapper::CompareWithLastFrame(
+    const DesktopFrame& frame,
+    const DesktopRect& rect,
+    DesktopRegion* output) {
+  DesktopRect clipped_rect = rect;
+  clipped_rect.IntersectWith(DesktopRect::MakeSize(frame.size()));
+  const int block_rows = (clipped_rect.height() + kBlockSize - 1) / kBlockSize;
+  const int num_bands =
+      std::min(max_diff_threads_, block_rows / kMinBlockRowsPerBand);
+  if (num_bands < 2 ||
+      clipped_rect.width() * clipped_rect.height() < kMinParallelDiffPixels) {
+    CompareFrames(*last_frame_, frame, clipped_rect, output);
+    return;
+  }
+
+  if (!diff_workers_) {
+    diff_workers_ = std::make_unique<DiffWorkers>(max_diff_threads_);
+  }
+  // Bands start at a multiple of kBlockSize from the top of `clipped_rect`, so
+  // that the blocks, and hence the output, are the same as if `clipped_rect`
+  // was compared at once.
+  std::vector<DiffWorkers::Band> bands(num_bands);
+  int top = clipped_rect.top();
+  for (int i = 0; i < num_bands; i++) {
+    const int band_block_rows =
+        block_rows / num_bands + (i < block_rows % num_bands ? 1 : 0);
+    const int bottom =
+        std::min(top + band_block_rows * kBlockSize, clipped_rect.bottom());
+    bands[i].rect = DesktopRect::MakeLTRB(clipped_rect.left(), top,
+                                          clipped_rect.right(), bottom);
+    top = bottom;
+  }
+  RTC_DCHECK_EQ(top, clipped_rect.bottom());
+  diff_workers_->Compare(*last_frame_, frame, &bands);
+  for (const DiffWorkers::Band& band : bands) {
+    output->AddRegion(band.updated);
+  }
+}
+
 }  // namespace webrtc
@@ -17,6 +17,7 @@
 #include "modules/desktop_capture/desktop_capturer.h"
 #include "modules/desktop_capture/desktop_frame.h"
 #include "modules/desktop_capture/desktop_geometry.h"
+#include "modules/desktop_capture/desktop_region.h"
 #include "modules/desktop_capture/shared_desktop_frame.h"
 #include "modules/desktop_capture/shared_memory.h"
 #include "rtc_base/system/rtc_export.h"
@@ -31,15 +32,25 @@ namespace webrtc {
 //
 // This class marks entire frame as updated if the frame size or frame stride
 // has been changed.
+//
+// Frames are compared on the capture thread unless more diff threads are
+// requested. Then large updated regions, e.g., a full 4K or 5K frame, are split
+// into bands of block-rows which are compared in parallel on helper threads.
 class RTC_EXPORT DesktopCapturerDifferWrapper
     : public DesktopCapturer,
       public DesktopCapturer::Callback {
  public:
   // Creates a DesktopCapturerDifferWrapper with a DesktopCapturer
-  // implementation, and takes its ownership.
+  // implementation, and takes its ownership. Frames are compared on the
+  // capture thread.
   explicit DesktopCapturerDifferWrapper(
       std::unique_ptr<DesktopCapturer> base_capturer);
 
+  // Same as above, but compares large regions on at most `max_diff_threads`
+  // threads, including the capture thread. 1 disables parallel comparison.
+  DesktopCapturerDifferWrapper(std::unique_ptr<DesktopCapturer> base_capturer,
+                               int max_diff_threads);
+
   ~DesktopCapturerDifferWrapper() override;
 
   // DesktopCapturer interface.
@@ -58,9 +69,20 @@ class RTC_EXPORT DesktopCapturerDifferWrapper
   void OnCaptureResult(Result result,
                        std::unique_ptr<DesktopFrame> frame) override;
 
+  // Compares `rect` area in `last_frame_` and `frame`, and outputs dirty
+  // regions into `output`.
+  void CompareWithLastFrame(const DesktopFrame& frame,
+                            const DesktopRect& rect,
+                            DesktopRegion* output);
+
+  class DiffWorkers;
+
   const std::unique_ptr<DesktopCapturer> base_capturer_;
+  const int max_diff_threads_;
   DesktopCapturer::Callback* callback_;
   std::unique_ptr<SharedDesktopFrame> last_frame_;
+  // Created the first time a region large enough to be split is compared.
+  std::unique_ptr<DiffWorkers> diff_workers_;
 };
 
 }  // namespace webrtc
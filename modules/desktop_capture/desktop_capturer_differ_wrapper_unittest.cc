@@ -10,6 +10,11 @@
 
 #include "modules/desktop_capture/desktop_capturer_differ_wrapper.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
 #include <initializer_list>
 #include <memory>
 #include <utility>
@@ -17,6 +22,7 @@
 
 #include "modules/desktop_capture/desktop_geometry.h"
 #include "modules/desktop_capture/desktop_region.h"
+#include "modules/desktop_capture/desktop_frame_generator.h"
 #include "modules/desktop_capture/differ_block.h"
 #include "modules/desktop_capture/fake_desktop_capturer.h"
 #include "modules/desktop_capture/mock_desktop_capturer_callback.h"
@@ -222,6 +228,126 @@ void ExecuteDifferWrapperTest(bool with_hints,
   }
 }
 
+// Returns copies of `frame()`, with the full frame as updated region, so that
+// the wrapper compares whole frames.
+class CopyingDesktopFrameGenerator : public DesktopFrameGenerator {
+ public:
+  explicit CopyingDesktopFrameGenerator(const DesktopSize& size)
+      : frame_(size) {}
+
+  std::unique_ptr<DesktopFrame> GetNextFrame(
+      SharedMemoryFactory* factory) override {
+    if (!next_frame_) {
+      PrepareNextFrame();
+    }
+    return std::move(next_frame_);
+  }
+
+  // Copies `frame()` ahead of the next GetNextFrame() call, to keep the copy
+  // out of time measurements.
+  void PrepareNextFrame() {
+    next_frame_.reset(BasicDesktopFrame::CopyOf(frame_));
+    next_frame_->mutable_updated_region()->SetRect(
+        DesktopRect::MakeSize(frame_.size()));
+  }
+
+  BasicDesktopFrame* frame() { return &frame_; }
+
+ private:
+  BasicDesktopFrame frame_;
+  std::unique_ptr<DesktopFrame> next_frame_;
+};
+
+// Keeps the updated region of the last captured frame.
+class UpdatedRegionCallback : public DesktopCapturer::Callback {
+ public:
+  void OnCaptureResult(DesktopCapturer::Result result,
+                       std::unique_ptr<DesktopFrame> frame) override {
+    ASSERT_EQ(result, DesktopCapturer::Result::SUCCESS);
+    updated_region_ = frame->updated_region();
+  }
+
+  const DesktopRegion& updated_region() const { return updated_region_; }
+
+ private:
+  DesktopRegion updated_region_;
+};
+
+// Fills `rect` of `frame` with random pixels.
+void PaintRandomly(Random* random,
+                   const DesktopRect& rect,
+                   DesktopFrame* frame) {
+  for (int y = rect.top(); y < rect.bottom(); y++) {
+    uint32_t* row = reinterpret_cast<uint32_t*>(
+        frame->GetFrameDataAtPos(DesktopVector(rect.left(), y)));
+    for (int x = 0; x < rect.width(); x++) {
+      row[x] = random->Rand<uint32_t>();
+    }
+  }
+}
+
+// Moves the content of `frame` up by `lines` rows, as a scrolling page would.
+void Scroll(int lines, DesktopFrame* frame) {
+  memmove(frame->data(), frame->data() + lines * frame->stride(),
+          (frame->size().height() - lines) * frame->stride());
+}
+
+// Measures the time DesktopCapturerDifferWrapper takes to find the updated
+// region of a `size` frame, for frames which are unchanged, have a small
+// update, are scrolled and are entirely changed.
+void ExecuteDifferWrapperBenchmark(const DesktopSize& size,
+                                   int max_diff_threads) {
+  constexpr int kFrames = 100;
+  Random random(/*seed=*/42);
+  CopyingDesktopFrameGenerator frame_generator(size);
+  PaintRandomly(&random, DesktopRect::MakeSize(size), frame_generator.frame());
+  std::unique_ptr<FakeDesktopCapturer> fake(new FakeDesktopCapturer());
+  fake->set_frame_generator(&frame_generator);
+  DesktopCapturerDifferWrapper capturer(std::move(fake), max_diff_threads);
+  UpdatedRegionCallback callback;
+  capturer.Start(&callback);
+  capturer.CaptureFrame();
+
+  const DesktopRect small_rect = DesktopRect::MakeXYWH(
+      size.width() / 3, size.height() / 3, size.width() / 20,
+      size.height() / 20);
+  const struct {
+    const char* name;
+    std::function<void(DesktopFrame*)> update;
+  } kPatterns[] = {
+      {"static", [](DesktopFrame*) {}},
+      {"small update",
+       [&](DesktopFrame* frame) {
+         PaintRandomly(&random, small_rect, frame);
+       }},
+      {"scroll", [](DesktopFrame* frame) { Scroll(1, frame); }},
+      {"full change",
+       [&](DesktopFrame* frame) {
+         // Changing a pixel per block is enough to mark every block as
+         // updated, and keeps the painting cost out of the measure.
+         for (int y = 0; y < size.height(); y += kBlockSize) {
+           for (int x = 0; x < size.width(); x += kBlockSize) {
+             *frame->GetFrameDataAtPos(DesktopVector(x, y)) += 1;
+           }
+         }
+       }},
+  };
+  for (const auto& pattern : kPatterns) {
+    int64_t total_ns = 0;
+    for (int i = 0; i < kFrames; i++) {
+      pattern.update(frame_generator.frame());
+      frame_generator.PrepareNextFrame();
+      const int64_t start = rtc::TimeNanos();
+      capturer.CaptureFrame();
+      total_ns += rtc::TimeNanos() - start;
+    }
+    printf("%dx%d, %d thread(s), %s: %.3f ms per frame\n", size.width(),
+           size.height(), max_diff_threads, pattern.name,
+           static_cast<double>(total_ns) / kFrames /
+               rtc::kNumNanosecsPerMillisec);
+  }
+}
+
 }  // namespace
 
 TEST(DesktopCapturerDifferWrapperTest, CaptureWithoutHints) {
@@ -288,4 +414,60 @@ TEST(DesktopCapturerDifferWrapperTest,
   ASSERT_LE(rtc::TimeMillis() - started, 15000);
 }
 
+TEST(DesktopCapturerDifferWrapperTest,
+     ParallelComparisonFindsSameRegionAsSingleThread) {
+  // Not a multiple of kBlockSize, to have partial blocks at the edges.
+  const DesktopSize kSize(3850, 2170);
+  Random random(/*seed=*/1234);
+  CopyingDesktopFrameGenerator frame_generator(kSize);
+  PaintRandomly(&random, DesktopRect::MakeSize(kSize), frame_generator.frame());
+
+  std::unique_ptr<FakeDesktopCapturer> fake(new FakeDesktopCapturer());
+  fake->set_frame_generator(&frame_generator);
+  DesktopCapturerDifferWrapper single_thread(std::move(fake),
+                                             /*max_diff_threads=*/1);
+  fake.reset(new FakeDesktopCapturer());
+  fake->set_frame_generator(&frame_generator);
+  DesktopCapturerDifferWrapper parallel(std::move(fake),
+                                        /*max_diff_threads=*/4);
+  UpdatedRegionCallback single_thread_callback;
+  UpdatedRegionCallback parallel_callback;
+  single_thread.Start(&single_thread_callback);
+  parallel.Start(&parallel_callback);
+  single_thread.CaptureFrame();
+  parallel.CaptureFrame();
+
+  for (int i = 0; i < 20; i++) {
+    for (int j = random.Rand(10); j >= 0; j--) {
+      const int left = random.Rand(0, kSize.width() - 2);
+      const int top = random.Rand(0, kSize.height() - 2);
+      const int right =
+          random.Rand(left + 1, std::min(left + 200, kSize.width()));
+      const int bottom =
+          random.Rand(top + 1, std::min(top + 200, kSize.height()));
+      PaintRandomly(&random, DesktopRect::MakeLTRB(left, top, right, bottom),
+                    frame_generator.frame());
+    }
+    single_thread.CaptureFrame();
+    parallel.CaptureFrame();
+    ASSERT_FALSE(single_thread_callback.updated_region().is_empty());
+    ASSERT_TRUE(single_thread_callback.updated_region().Equals(
+        parallel_callback.updated_region()));
+  }
+
+  // Nothing changed.
+  single_thread.CaptureFrame();
+  parallel.CaptureFrame();
+  EXPECT_TRUE(single_thread_callback.updated_region().is_empty());
+  EXPECT_TRUE(parallel_callback.updated_region().is_empty());
+}
+
+TEST(DesktopCapturerDifferWrapperTest, DISABLED_Capture4KAnd5KFramesPerf) {
+  for (const DesktopSize& size :
+       {DesktopSize(3840, 2160), DesktopSize(5120, 2880)}) {
+    ExecuteDifferWrapperBenchmark(size, /*max_diff_threads=*/1);
+    ExecuteDifferWrapperBenchmark(size, /*max_diff_threads=*/4);
+  }
+}
+
 }  // namespace webrtc
@@ -12,10 +12,16 @@
 
 #include <string.h>
 
-#include "modules/desktop_capture/differ_vector_sse2.h"
 #include "rtc_base/system/arch.h"
 #include "system_wrappers/include/cpu_features_wrapper.h"
 
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#elif !defined(WEBRTC_ARCH_ARM_FAMILY) && !defined(WEBRTC_ARCH_MIPS_FAMILY)
+#include "modules/desktop_capture/differ_vector_avx2.h"
+#include "modules/desktop_capture/differ_vector_sse2.h"
+#endif
+
 namespace webrtc {
 
 namespace {
@@ -24,28 +30,55 @@ bool VectorDifference_C(const uint8_t* image1, const uint8_t* image2) {
   return memcmp(image1, image2, kBlockSize * kBytesPerPixel) != 0;
 }
 
-}  // namespace
+#if defined(WEBRTC_HAS_NEON)
+bool VectorDifference_NEON(const uint8_t* image1, const uint8_t* image2) {
+  static_assert(kBlockSize * kBytesPerPixel % 64 == 0,
+                "A block row must be a multiple of 4 NEON registers");
+  uint8x16_t acc = vdupq_n_u8(0);
+  for (int i = 0; i < kBlockSize * kBytesPerPixel; i += 64) {
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + i), vld1q_u8(image2 + i)));
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + i + 16),
+                                 vld1q_u8(image2 + i + 16)));
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + i + 32),
+                                 vld1q_u8(image2 + i + 32)));
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + i + 48),
+                                 vld1q_u8(image2 + i + 48)));
+  }
+  // Fold the 16 bytes into 64 bits.
+  const uint64x2_t acc64 = vreinterpretq_u64_u8(acc);
+  return (vgetq_lane_u64(acc64, 0) | vgetq_lane_u64(acc64, 1)) != 0;
+}
+#endif
 
-bool VectorDifference(const uint8_t* image1, const uint8_t* image2) {
-  static bool (*diff_proc)(const uint8_t*, const uint8_t*) = nullptr;
+using DiffProc = bool (*)(const uint8_t*, const uint8_t*);
 
-  if (!diff_proc) {
-#if defined(WEBRTC_ARCH_ARM_FAMILY) || defined(WEBRTC_ARCH_MIPS_FAMILY)
-    // For ARM and MIPS processors, always use C version.
-    // TODO(hclam): Implement a NEON version.
-    diff_proc = &VectorDifference_C;
+DiffProc SelectDiffProc() {
+#if defined(WEBRTC_HAS_NEON)
+  return &VectorDifference_NEON;
+#elif defined(WEBRTC_ARCH_ARM_FAMILY) || defined(WEBRTC_ARCH_MIPS_FAMILY)
+  // For MIPS and ARM processors without NEON, always use C version.
+  return &VectorDifference_C;
 #else
-    bool have_sse2 = GetCPUInfo(kSSE2) != 0;
-    // For x86 processors, check if SSE2 is supported.
-    if (have_sse2 && kBlockSize == 32) {
-      diff_proc = &VectorDifference_SSE2_W32;
-    } else if (have_sse2 && kBlockSize == 16) {
-      diff_proc = &VectorDifference_SSE2_W16;
-    } else {
-      diff_proc = &VectorDifference_C;
-    }
-#endif
+  bool have_avx2 = GetCPUInfo(kAVX2) != 0;
+  bool have_sse2 = GetCPUInfo(kSSE2) != 0;
+  // For x86 processors, prefer AVX2 and then SSE2 if they are supported.
+  if (have_avx2 && kBlockSize == 32) {
+    return &VectorDifference_AVX2_W32;
+  } else if (have_sse2 && kBlockSize == 32) {
+    return &VectorDifference_SSE2_W32;
+  } else if (have_sse2 && kBlockSize == 16) {
+    return &VectorDifference_SSE2_W16;
   }
+  return &VectorDifference_C;
+#endif
+}
+
+}  // namespace
+
+bool VectorDifference(const uint8_t* image1, const uint8_t* image2) {
+  // Called concurrently by the diff workers, so this relies on the thread-safe
+  // initialization of function-local statics.
+  static const DiffProc diff_proc = SelectDiffProc();
 
   return diff_proc(image1, image2);
 }
@@ -12,6 +12,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
@@ -53,20 +54,25 @@ RtpPacketizerH264::RtpPacketizerH264(rtc::ArrayView<const uint8_t> payload,
   RTC_CHECK(packetization_mode == H264PacketizationMode::NonInterleaved ||
             packetization_mode == H264PacketizationMode::SingleNalUnit);
 
-  for (const auto& nalu :
-       H264::FindNaluIndices(payload.data(), payload.size())) {
+  std::vector<H264::NaluIndex> nalus =
+      H264::FindNaluIndices(payload.data(), payload.size());
+  input_fragments_.reserve(nalus.size());
+  for (const auto& nalu : nalus) {
     input_fragments_.push_back(
         payload.subview(nalu.payload_start_offset, nalu.payload_size));
   }
+  // Enough for the FU-A packets of the whole payload, plus one packet unit
+  // per NAL unit, so that generating the packets does not reallocate.
+  const int fu_a_capacity =
+      std::max(limits_.max_payload_len - static_cast<int>(kFuAHeaderSize), 1);
+  packets_.reserve(payload.size() / fu_a_capacity + 2 * nalus.size() + 1);
 
   if (!GeneratePackets(packetization_mode)) {
     // If failed to generate all the packets, discard already generated
     // packets in case the caller would ignore return value and still try to
     // call NextPacket().
     num_packets_left_ = 0;
-    while (!packets_.empty()) {
-      packets_.pop();
-    }
+    packets_.clear();
   }
 }
 
@@ -144,10 +150,10 @@ bool RtpPacketizerH264::PacketizeFuA(size_t fragment_index) {
   for (size_t i = 0; i < payload_sizes.size(); ++i) {
     int packet_length = payload_sizes[i];
     RTC_CHECK_GT(packet_length, 0);
-    packets_.push(PacketUnit(fragment.subview(offset, packet_length),
-                             /*first_fragment=*/i == 0,
-                             /*last_fragment=*/i == payload_sizes.size() - 1,
-                             false, fragment[0]));
+    packets_.emplace_back(fragment.subview(offset, packet_length),
+                          /*first_fragment=*/i == 0,
+                          /*last_fragment=*/i == payload_sizes.size() - 1,
+                          false, fragment[0]);
     offset += packet_length;
     payload_left -= packet_length;
   }
@@ -185,8 +191,8 @@ size_t RtpPacketizerH264::PacketizeStapA(size_t fragment_index) {
 
   while (payload_size_left >= payload_size_needed()) {
     RTC_CHECK_GT(fragment.size(), 0);
-    packets_.push(PacketUnit(fragment, aggregated_fragments == 0, false, true,
-                             fragment[0]));
+    packets_.emplace_back(fragment, aggregated_fragments == 0, false, true,
+                          fragment[0]);
     payload_size_left -= fragment.size();
     payload_size_left -= fragment_headers_length;
 
@@ -228,32 +234,31 @@ bool RtpPacketizerH264::PacketizeSingleNalu(size_t fragment_index) {
     return false;
   }
   RTC_CHECK_GT(fragment.size(), 0u);
-  packets_.push(PacketUnit(fragment, true /* first */, true /* last */,
-                           false /* aggregated */, fragment[0]));
+  packets_.emplace_back(fragment, true /* first */, true /* last */,
+                        false /* aggregated */, fragment[0]);
   ++num_packets_left_;
   return true;
 }
 
 bool RtpPacketizerH264::NextPacket(RtpPacketToSend* rtp_packet) {
   RTC_DCHECK(rtp_packet);
-  if (packets_.empty()) {
+  if (next_packet_ == packets_.size()) {
     return false;
   }
 
-  PacketUnit packet = packets_.front();
+  const PacketUnit& packet = packets_[next_packet_];
   if (packet.first_fragment && packet.last_fragment) {
     // Single NAL unit packet.
     size_t bytes_to_send = packet.source_fragment.size();
     uint8_t* buffer = rtp_packet->AllocatePayload(bytes_to_send);
     memcpy(buffer, packet.source_fragment.data(), bytes_to_send);
-    packets_.pop();
-    input_fragments_.pop_front();
+    ++next_packet_;
   } else if (packet.aggregated) {
     NextAggregatePacket(rtp_packet);
   } else {
     NextFragmentPacket(rtp_packet);
   }
-  rtp_packet->SetMarker(packets_.empty());
+  rtp_packet->SetMarker(next_packet_ == packets_.size());
   --num_packets_left_;
   return true;
 }
@@ -264,7 +269,7 @@ void RtpPacketizerH264::NextAggregatePacket(RtpPacketToSend* rtp_packet) {
   RTC_CHECK_GE(payload_capacity, kNalHeaderSize);
   uint8_t* buffer = rtp_packet->AllocatePayload(payload_capacity);
   RTC_DCHECK(buffer);
-  PacketUnit* packet = &packets_.front();
+  const PacketUnit* packet = &packets_[next_packet_];
   RTC_CHECK(packet->first_fragment);
   // STAP-A NALU header.
   buffer[0] = (packet->header & (kFBit | kNriMask)) | H264::NaluType::kStapA;
@@ -279,11 +284,10 @@ void RtpPacketizerH264::NextAggregatePacket(RtpPacketToSend* rtp_packet) {
     // Add NAL unit.
     memcpy(&buffer[index], fragment.data(), fragment.size());
     index += fragment.size();
-    packets_.pop();
-    input_fragments_.pop_front();
+    ++next_packet_;
     if (is_last_fragment)
       break;
-    packet = &packets_.front();
+    packet = &packets_[next_packet_];
     is_last_fragment = packet->last_fragment;
   }
   RTC_CHECK(is_last_fragment);
@@ -291,7 +295,7 @@ void RtpPacketizerH264::NextAggregatePacket(RtpPacketToSend* rtp_packet) {
 }
 
 void RtpPacketizerH264::NextFragmentPacket(RtpPacketToSend* rtp_packet) {
-  PacketUnit* packet = &packets_.front();
+  const PacketUnit* packet = &packets_[next_packet_];
   // NAL unit fragmented over multiple packets (FU-A).
   // We do not send original NALU header, so it will be replaced by the
   // FU indicator header of the first packet.
@@ -310,9 +314,7 @@ void RtpPacketizerH264::NextFragmentPacket(RtpPacketToSend* rtp_packet) {
   buffer[0] = fu_indicator;
   buffer[1] = fu_header;
   memcpy(buffer + kFuAHeaderSize, fragment.data(), fragment.size());
-  if (packet->last_fragment)
-    input_fragments_.pop_front();
-  packets_.pop();
+  ++next_packet_;
 }
 
 }  // namespace webrtc
@@ -14,9 +14,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <deque>
 #include <memory>
-#include <queue>
+#include <vector>
 
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/source/rtp_format.h"
@@ -80,8 +79,11 @@ class RtpPacketizerH264 : public RtpPacketizer {
 
   const PayloadSizeLimits limits_;
   size_t num_packets_left_;
-  std::deque<rtc::ArrayView<const uint8_t>> input_fragments_;
-  std::queue<PacketUnit> packets_;
+  std::vector<rtc::ArrayView<const uint8_t>> input_fragments_;
+  // All the packet units of the frame are generated up front, `next_packet_`
+  // is the index of the first one not yet written to a packet.
+  std::vector<PacketUnit> packets_;
+  size_t next_packet_ = 0;
 
   RTC_DISALLOW_COPY_AND_ASSIGN(RtpPacketizerH264);
 };
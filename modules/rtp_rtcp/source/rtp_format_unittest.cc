@@ -10,10 +10,20 @@
 
 #include "modules/rtp_rtcp/source/rtp_format.h"
 
+#include <stdio.h>
+
 #include <memory>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "modules/rtp_rtcp/source/rtp_video_header.h"
+#include "rtc_base/random.h"
+#include "rtc_base/time_utils.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -279,5 +289,136 @@ TEST(RtpPacketizerSplitAboutEqually, CanPutSinglePayloadByteInOnePacket) {
   EXPECT_THAT(RtpPacketizer::SplitAboutEqually(1, limits), ElementsAre(1));
 }
 
+// Templates of the packets of a frame as RTPSenderVideo creates them: the
+// extensions of the first and last packets differ from the middle ones.
+class PacketTemplates {
+ public:
+  PacketTemplates() {
+    extensions_.Register<TransportSequenceNumber>(1);
+    extensions_.Register<AbsoluteSendTime>(2);
+    extensions_.Register<RtpMid>(3);
+    extensions_.Register<VideoTimingExtension>(4);
+    middle_ = std::make_unique<RtpPacketToSend>(&extensions_);
+    middle_->ReserveExtension<TransportSequenceNumber>();
+    middle_->ReserveExtension<AbsoluteSendTime>();
+    first_ = std::make_unique<RtpPacketToSend>(*middle_);
+    first_->SetExtension<RtpMid>("mid");
+    last_ = std::make_unique<RtpPacketToSend>(*middle_);
+    last_->SetExtension<VideoTimingExtension>(VideoSendTiming());
+  }
+
+  // Template of the packet at `index` in a frame of `num_packets` packets.
+  const RtpPacketToSend& ForPacket(size_t index, size_t num_packets) const {
+    if (index == 0)
+      return *first_;
+    if (index == num_packets - 1)
+      return *last_;
+    return *middle_;
+  }
+
+ private:
+  RtpHeaderExtensionMap extensions_;
+  std::unique_ptr<RtpPacketToSend> first_;
+  std::unique_ptr<RtpPacketToSend> middle_;
+  std::unique_ptr<RtpPacketToSend> last_;
+};
+
+std::vector<uint8_t> CreatePayload(size_t size) {
+  Random random(/*seed=*/42);
+  std::vector<uint8_t> payload(size);
+  for (uint8_t& byte : payload) {
+    // No zero bytes, so that there are no start codes in H264 payloads.
+    byte = random.Rand(1, 255);
+  }
+  return payload;
+}
+
+// Encoded H264 key frame with SPS, PPS and `num_slices` IDR slices.
+std::vector<uint8_t> CreateH264KeyFrame(size_t size, int num_slices) {
+  constexpr uint8_t kStartCode[] = {0, 0, 0, 1};
+  constexpr uint8_t kSps[] = {0x67, 0x42, 0xc0, 0x1f, 0xda, 0x01, 0x40};
+  constexpr uint8_t kPps[] = {0x68, 0xce, 0x3c, 0x80};
+  std::vector<uint8_t> frame;
+  frame.insert(frame.end(), std::begin(kStartCode), std::end(kStartCode));
+  frame.insert(frame.end(), std::begin(kSps), std::end(kSps));
+  frame.insert(frame.end(), std::begin(kStartCode), std::end(kStartCode));
+  frame.insert(frame.end(), std::begin(kPps), std::end(kPps));
+  const std::vector<uint8_t> slice = CreatePayload(size / num_slices);
+  for (int i = 0; i < num_slices; ++i) {
+    frame.insert(frame.end(), std::begin(kStartCode), std::end(kStartCode));
+    frame.push_back(0x65);  // IDR slice.
+    frame.insert(frame.end(), slice.begin(), slice.end());
+  }
+  return frame;
+}
+
+std::unique_ptr<RtpPacketizer> CreatePacketizer(
+    VideoCodecType codec,
+    rtc::ArrayView<const uint8_t> payload) {
+  RTPVideoHeader video_header;
+  video_header.frame_type = VideoFrameType::kVideoFrameKey;
+  if (codec == kVideoCodecH264) {
+    auto& h264 = video_header.video_type_header.emplace<RTPVideoHeaderH264>();
+    h264.packetization_mode = H264PacketizationMode::NonInterleaved;
+  } else {
+    auto& vp8 = video_header.video_type_header.emplace<RTPVideoHeaderVP8>();
+    vp8.InitRTPVideoHeaderVP8();
+    vp8.pictureId = 17;
+  }
+  RtpPacketizer::PayloadSizeLimits limits;
+  limits.max_payload_len = 1100;
+  limits.first_packet_reduction_len = 10;
+  limits.last_packet_reduction_len = 8;
+  limits.single_packet_reduction_len = 18;
+  return RtpPacketizer::Create(codec, payload, limits, video_header);
+}
+
+// Packetizes 1080p and 4K key frames the way RTPSenderVideo does, copying the
+// packet template for each packet. Run it before and after a change to the
+// packetizers or to RtpPacket to compare their throughput.
+TEST(RtpPacketizerTest, DISABLED_KeyFramePacketizationBenchmark) {
+  constexpr int kNumFrames = 200;
+  struct Resolution {
+    const char* name;
+    size_t key_frame_size;
+  };
+  // Typical key frame sizes at 1080p and 4K.
+  constexpr Resolution kResolutions[] = {{"1080p", 200000}, {"4K", 800000}};
+  PacketTemplates templates;
+  for (VideoCodecType codec : {kVideoCodecH264, kVideoCodecVP8}) {
+    for (const Resolution& resolution : kResolutions) {
+      const std::vector<uint8_t> frame =
+          codec == kVideoCodecH264
+              ? CreateH264KeyFrame(resolution.key_frame_size, /*num_slices=*/4)
+              : CreatePayload(resolution.key_frame_size);
+      size_t num_packets = 0;
+      int64_t elapsed_ns = 0;
+      for (int i = 0; i < kNumFrames; ++i) {
+        std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+        const int64_t start = rtc::TimeNanos();
+        std::unique_ptr<RtpPacketizer> packetizer =
+            CreatePacketizer(codec, frame);
+        num_packets = packetizer->NumPackets();
+        packets.reserve(num_packets);
+        for (size_t j = 0; j < num_packets; ++j) {
+          auto packet = std::make_unique<RtpPacketToSend>(
+              templates.ForPacket(j, num_packets));
+          packet->set_first_packet_of_frame(j == 0);
+          ASSERT_TRUE(packetizer->NextPacket(packet.get()));
+          packets.push_back(std::move(packet));
+        }
+        elapsed_ns += rtc::TimeNanos() - start;
+      }
+      const double frame_us = static_cast<double>(elapsed_ns) / kNumFrames /
+                              rtc::kNumNanosecsPerMicrosec;
+      printf("%s %s key frame (%zu packets): %.1f us per frame, %.1f ns per "
+             "packet.\n",
+             codec == kVideoCodecH264 ? "H264" : "VP8", resolution.name,
+             num_packets, frame_us,
+             frame_us * rtc::kNumNanosecsPerMicrosec / num_packets);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace webrtc
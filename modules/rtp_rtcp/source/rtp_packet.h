@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
@@ -203,7 +204,10 @@ class RtpPacket {
   size_t payload_size_;
 
   ExtensionManager extensions_;
-  std::vector<ExtensionInfo> extension_entries_;
+  // Inlined so that copying a packet, e.g., from the template the packets of a
+  // frame are built from, doesn't allocate for the typical number of
+  // extensions.
+  absl::InlinedVector<ExtensionInfo, 8> extension_entries_;
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
 };
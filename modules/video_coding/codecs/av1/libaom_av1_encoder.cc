@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -48,6 +49,10 @@ constexpr int kBitDepth = 8;
 constexpr int kLagInFrames = 0;  // No look ahead.
 constexpr int kRtpTicksPerSecond = 90000;
 constexpr float kMinimumFrameRate = 1.0;
+// Each complexity reduction step raises the speed setting by one, up to the
+// fastest speed used for real-time encoding. Steps past that speed are not
+// advertised.
+constexpr int kMaxCpuSpeed = 9;
 
 // Only positive speeds, range for real-time coding currently is: 6 - 8.
 // Lower means slower/better quality, higher means fastest/lower quality.
@@ -92,6 +97,8 @@ class LibaomAv1Encoder final : public VideoEncoder {
 
   EncoderInfo GetEncoderInfo() const override;
 
+  void SetComplexityReduction(int steps) override;
+
  private:
   // Determine number of encoder threads to use.
   int NumberOfThreads(int width, int height, int number_of_cores);
@@ -108,6 +115,9 @@ class LibaomAv1Encoder final : public VideoEncoder {
 
   std::unique_ptr<ScalableVideoController> svc_controller_;
   bool inited_;
+  // Speed chosen for the resolution, before complexity reduction.
+  int cpu_speed_;
+  int complexity_reduction_;
   absl::optional<aom_svc_params_t> svc_params_;
   VideoCodec encoder_settings_;
   aom_image_t* frame_for_encode_;
@@ -143,6 +153,8 @@ int32_t VerifyCodecSettings(const VideoCodec& codec_settings) {
 
 LibaomAv1Encoder::LibaomAv1Encoder()
     : inited_(false),
+      cpu_speed_(0),
+      complexity_reduction_(0),
       frame_for_encode_(nullptr),
       encoded_image_callback_(nullptr) {}
 
@@ -245,9 +257,9 @@ int LibaomAv1Encoder::InitEncode(const VideoCodec* codec_settings,
   inited_ = true;
 
   // Set control parameters
-  ret = aom_codec_control(
-      &ctx_, AOME_SET_CPUUSED,
-      GetCpuSpeed(cfg_.g_w, cfg_.g_h, settings.number_of_cores));
+  cpu_speed_ = GetCpuSpeed(cfg_.g_w, cfg_.g_h, settings.number_of_cores);
+  complexity_reduction_ = 0;
+  ret = aom_codec_control(&ctx_, AOME_SET_CPUUSED, cpu_speed_);
   if (ret != AOM_CODEC_OK) {
     RTC_LOG(LS_WARNING) << "LibaomAv1Encoder::EncodeInit returned " << ret
                         << " on control AV1E_SET_CPUUSED.";
@@ -778,6 +790,23 @@ void LibaomAv1Encoder::SetRates(const RateControlParameters& parameters) {
   }
 }
 
+void LibaomAv1Encoder::SetComplexityReduction(int steps) {
+  if (!inited_) {
+    return;
+  }
+  const int speed = std::min(cpu_speed_ + std::max(steps, 0), kMaxCpuSpeed);
+  if (speed - cpu_speed_ == complexity_reduction_) {
+    return;
+  }
+  aom_codec_err_t ret = aom_codec_control(&ctx_, AOME_SET_CPUUSED, speed);
+  if (ret != AOM_CODEC_OK) {
+    RTC_LOG(LS_WARNING) << "LibaomAv1Encoder::SetComplexityReduction returned "
+                        << ret << " on control AOME_SET_CPUUSED.";
+    return;
+  }
+  complexity_reduction_ = speed - cpu_speed_;
+}
+
 VideoEncoder::EncoderInfo LibaomAv1Encoder::GetEncoderInfo() const {
   EncoderInfo info;
   info.supports_native_handle = false;
@@ -786,6 +815,8 @@ VideoEncoder::EncoderInfo LibaomAv1Encoder::GetEncoderInfo() const {
   info.is_hardware_accelerated = false;
   info.scaling_settings = VideoEncoder::ScalingSettings(kMinQindex, kMaxQindex);
   info.preferred_pixel_formats = {VideoFrameBuffer::Type::kI420};
+  info.max_complexity_reduction =
+      inited_ ? std::max(kMaxCpuSpeed - cpu_speed_, 0) : 0;
   if (SvcEnabled()) {
     for (int sid = 0; sid < svc_params_->number_spatial_layers; ++sid) {
       info.fps_allocation[sid].resize(svc_params_->number_temporal_layers);
@@ -10,6 +10,7 @@
 
 #include "modules/video_coding/codecs/av1/libaom_av1_encoder.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -167,5 +168,54 @@ TEST(LibaomAv1EncoderTest, PopulatesEncodedFrameSize) {
                             codec_settings.height)))));
 }
 
+TEST(LibaomAv1EncoderTest, MaxComplexityReductionDependsOnSpeed) {
+  std::unique_ptr<VideoEncoder> encoder = CreateLibaomAv1Encoder();
+  EXPECT_EQ(encoder->GetEncoderInfo().max_complexity_reduction, 0);
+
+  // Speed 7 at 320x180 and 9, the fastest speed, at 1280x720.
+  VideoCodec codec_settings = DefaultCodecSettings();
+  ASSERT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+            WEBRTC_VIDEO_CODEC_OK);
+  EXPECT_EQ(encoder->GetEncoderInfo().max_complexity_reduction, 2);
+
+  ASSERT_EQ(encoder->Release(), WEBRTC_VIDEO_CODEC_OK);
+  codec_settings.width = 1280;
+  codec_settings.height = 720;
+  ASSERT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+            WEBRTC_VIDEO_CODEC_OK);
+  EXPECT_EQ(encoder->GetEncoderInfo().max_complexity_reduction, 0);
+}
+
+TEST(LibaomAv1EncoderTest, ComplexityReductionChangesSpeed) {
+  // Encodes the same frames with the complexity reduced by `steps`.
+  auto encode = [](int steps) {
+    std::unique_ptr<VideoEncoder> encoder = CreateLibaomAv1Encoder();
+    VideoCodec codec_settings = DefaultCodecSettings();
+    EXPECT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+              WEBRTC_VIDEO_CODEC_OK);
+    encoder->SetComplexityReduction(steps);
+    return EncodedVideoFrameProducer(*encoder).SetNumInputFrames(10).Encode();
+  };
+
+  std::vector<EncodedVideoFrameProducer::EncodedFrame> default_frames =
+      encode(0);
+  std::vector<EncodedVideoFrameProducer::EncodedFrame> reduced_frames =
+      encode(2);
+  ASSERT_THAT(default_frames, SizeIs(10));
+  ASSERT_THAT(reduced_frames, SizeIs(10));
+
+  // A different speed yields a different bitstream.
+  bool bitstreams_differ = false;
+  for (size_t i = 0; i < default_frames.size(); ++i) {
+    const EncodedImage& a = default_frames[i].encoded_image;
+    const EncodedImage& b = reduced_frames[i].encoded_image;
+    if (a.size() != b.size() ||
+        !std::equal(a.data(), a.data() + a.size(), b.data())) {
+      bitstreams_differ = true;
+    }
+  }
+  EXPECT_TRUE(bitstreams_differ);
+}
+
 }  // namespace
 }  // namespace webrtc
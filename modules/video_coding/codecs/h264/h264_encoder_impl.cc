@@ -259,6 +259,7 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
 
     // Create encoder parameters based on the layer configuration.
     SEncParamExt encoder_params = CreateEncoderParams(i);
+    initial_complexity_mode_ = encoder_params.iComplexityMode;
 
     // Initialize.
     if (openh264_encoder->InitializeExt(&encoder_params) != 0) {
@@ -283,6 +284,7 @@ int32_t H264EncoderImpl::InitEncode(const VideoCodec* inst,
 
     tl0sync_limit_[i] = configurations_[i].num_temporal_layers;
   }
+  complexity_reduction_ = 0;
 
   SimulcastRateAllocator init_allocator(codec_);
   VideoBitrateAllocation allocation =
@@ -638,9 +640,42 @@ VideoEncoder::EncoderInfo H264EncoderImpl::GetEncoderInfo() const {
   info.has_internal_source = false;
   info.supports_simulcast = true;
   info.preferred_pixel_formats = {VideoFrameBuffer::Type::kI420};
+  info.max_complexity_reduction =
+      encoders_.empty() ? 0 : initial_complexity_mode_ - LOW_COMPLEXITY;
   return info;
 }
 
+void H264EncoderImpl::SetComplexityReduction(int steps) {
+  if (encoders_.empty()) {
+    return;
+  }
+  const int max_steps = initial_complexity_mode_ - LOW_COMPLEXITY;
+  steps = std::min(std::max(steps, 0), max_steps);
+  if (steps == complexity_reduction_) {
+    return;
+  }
+  ECOMPLEXITY_MODE mode =
+      static_cast<ECOMPLEXITY_MODE>(initial_complexity_mode_ - steps);
+  for (ISVCEncoder* openh264_encoder : encoders_) {
+    if (openh264_encoder->SetOption(ENCODER_OPTION_COMPLEXITY, &mode) != 0) {
+      RTC_LOG(LS_WARNING) << "Failed to set OpenH264 complexity mode " << mode;
+    }
+  }
+  complexity_reduction_ = steps;
+}
+
+int H264EncoderImpl::ComplexityModeForTesting() const {
+  if (encoders_.empty()) {
+    return -1;
+  }
+  SEncParamExt encoder_params;
+  if (encoders_[0]->GetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT,
+                              &encoder_params) != 0) {
+    return -1;
+  }
+  return encoder_params.iComplexityMode;
+}
+
 void H264EncoderImpl::LayerConfig::SetStreamState(bool send_stream) {
   if (send_stream && !sending) {
     // Need a key frame if we have not sent this stream before.
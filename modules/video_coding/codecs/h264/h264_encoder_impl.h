@@ -79,10 +79,17 @@ class H264EncoderImpl : public H264Encoder {
 
   EncoderInfo GetEncoderInfo() const override;
 
+  // Lowers the OpenH264 complexity mode by `steps` from the one the encoders
+  // were initialized with.
+  void SetComplexityReduction(int steps) override;
+
   // Exposed for testing.
   H264PacketizationMode PacketizationModeForTesting() const {
     return packetization_mode_;
   }
+  // Complexity mode reported by the first OpenH264 encoder, or -1 if there is
+  // none.
+  int ComplexityModeForTesting() const;
 
  private:
   SEncParamExt CreateEncoderParams(size_t i) const;
@@ -108,6 +115,10 @@ class H264EncoderImpl : public H264Encoder {
   bool has_reported_error_;
 
   std::vector<uint8_t> tl0sync_limit_;
+
+  // Complexity mode set by InitEncode(), and the current reduction from it.
+  int initial_complexity_mode_ = LOW_COMPLEXITY;
+  int complexity_reduction_ = 0;
 };
 
 }  // namespace webrtc
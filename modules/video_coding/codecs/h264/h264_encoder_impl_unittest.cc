@@ -84,6 +84,29 @@ TEST(H264EncoderImplTest, CanInitializeWithRemovedParameter) {
             encoder.PacketizationModeForTesting());
 }
 
+TEST(H264EncoderImplTest, ComplexityReductionLowersComplexityMode) {
+  H264EncoderImpl encoder(cricket::VideoCodec("H264"));
+  EXPECT_EQ(0, encoder.GetEncoderInfo().max_complexity_reduction);
+  VideoCodec codec_settings;
+  SetDefaultSettings(&codec_settings);
+  ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings, kSettings));
+
+  // Every advertised step lowers the complexity mode, down to the lowest one.
+  const int initial_mode = encoder.ComplexityModeForTesting();
+  const int max_steps = encoder.GetEncoderInfo().max_complexity_reduction;
+  EXPECT_EQ(LOW_COMPLEXITY, initial_mode - max_steps);
+  for (int steps = 1; steps <= max_steps; ++steps) {
+    encoder.SetComplexityReduction(steps);
+    EXPECT_EQ(initial_mode - steps, encoder.ComplexityModeForTesting());
+  }
+  encoder.SetComplexityReduction(max_steps + 1);
+  EXPECT_EQ(LOW_COMPLEXITY, encoder.ComplexityModeForTesting());
+
+  encoder.SetComplexityReduction(0);
+  EXPECT_EQ(initial_mode, encoder.ComplexityModeForTesting());
+}
+
 }  // anonymous namespace
 
 }  // namespace webrtc
@@ -51,6 +51,7 @@ class MultiplexEncoderAdapter : public VideoEncoder {
   void OnPacketLossRateUpdate(float packet_loss_rate) override;
   void OnRttUpdate(int64_t rtt_ms) override;
   void OnLossNotification(const LossNotification& loss_notification) override;
+  void SetComplexityReduction(int steps) override;
   int Release() override;
   EncoderInfo GetEncoderInfo() const override;
 
@@ -10,6 +10,7 @@
 
 #include "modules/video_coding/codecs/multiplex/include/multiplex_encoder_adapter.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "api/video/encoded_image.h"
@@ -128,9 +129,14 @@ int MultiplexEncoderAdapter::InitEncode(
     if (i == 0) {
       encoder_info_.is_hardware_accelerated =
           encoder_impl_info.is_hardware_accelerated;
+      encoder_info_.max_complexity_reduction =
+          encoder_impl_info.max_complexity_reduction;
     } else {
       encoder_info_.is_hardware_accelerated |=
           encoder_impl_info.is_hardware_accelerated;
+      encoder_info_.max_complexity_reduction =
+          std::min(encoder_info_.max_complexity_reduction,
+                   encoder_impl_info.max_complexity_reduction);
     }
 
     encoder_info_.requested_resolution_alignment = cricket::LeastCommonMultiple(
@@ -289,6 +295,12 @@ void MultiplexEncoderAdapter::OnLossNotification(
   }
 }
 
+void MultiplexEncoderAdapter::SetComplexityReduction(int steps) {
+  for (auto& encoder : encoders_) {
+    encoder->SetComplexityReduction(steps);
+  }
+}
+
 int MultiplexEncoderAdapter::Release() {
   for (auto& encoder : encoders_) {
     const int rv = encoder->Release();
@@ -232,6 +232,8 @@ void VideoCodecTestFixtureImpl::Config::SetCodecSettings(
 }
 
 size_t VideoCodecTestFixtureImpl::Config::NumberOfCores() const {
+  if (num_cores)
+    return *num_cores;
   return use_single_core ? 1 : CpuInfo::DetectNumberOfCores();
 }
 
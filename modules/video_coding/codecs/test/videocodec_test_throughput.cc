@@ -0,0 +1,251 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Throughput benchmark of the video codecs. Sweeps codecs, clips, simulcast
+// and SVC modes and thread counts through the VideoProcessor, and writes the
+// encode/decode speed, per-frame latency percentiles and peak memory use of
+// every configuration as JSON to the test output directory.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/numerics/samples_stats_counter.h"
+#include "api/test/create_videocodec_test_fixture.h"
+#include "api/test/video/function_video_encoder_factory.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "media/base/media_constants.h"
+#include "media/engine/internal_decoder_factory.h"
+#include "media/engine/internal_encoder_factory.h"
+#include "media/engine/simulcast_encoder_adapter.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/system/file_wrapper.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+#if defined(WEBRTC_POSIX)
+#include <sys/resource.h>
+#endif
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr size_t kNumFrames = 150;
+constexpr size_t kThreadCounts[] = {1, 2, 4};
+constexpr char kOutputFilename[] = "videocodec_test_throughput.json";
+
+struct Clip {
+  const char* filename;
+  int width;
+  int height;
+  int fps;
+  int target_kbps;
+};
+
+constexpr Clip kClips[] = {{"foreman_cif", 352, 288, 30, 700},
+                           {"FourPeople_1280x720_30", 1280, 720, 30, 1500}};
+
+enum class Mode { kSingleStream, kSimulcast, kSvc };
+
+const char* ModeName(Mode mode) {
+  switch (mode) {
+    case Mode::kSingleStream:
+      return "single";
+    case Mode::kSimulcast:
+      return "simulcast";
+    case Mode::kSvc:
+      return "svc";
+  }
+  return "";
+}
+
+// Simulcast is tested through the SimulcastEncoderAdapter for VP8, and SVC
+// with the spatial layers of VP9.
+bool IsModeSupported(const std::string& codec, Mode mode) {
+  switch (mode) {
+    case Mode::kSingleStream:
+      return true;
+    case Mode::kSimulcast:
+      return codec == cricket::kVp8CodecName;
+    case Mode::kSvc:
+      return codec == cricket::kVp9CodecName;
+  }
+  return false;
+}
+
+bool IsCodecSupported(const std::string& codec) {
+  for (const SdpVideoFormat& format :
+       InternalEncoderFactory().GetSupportedFormats()) {
+    if (format.name == codec)
+      return true;
+  }
+  return false;
+}
+
+// Peak resident set size of the process, in kilobytes. This is a high
+// watermark of the whole process, so it never decreases between
+// configurations.
+int64_t PeakRssKb() {
+#if defined(WEBRTC_POSIX)
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1;
+#if defined(WEBRTC_MAC)
+  // Reported in bytes on Mac, and in kilobytes elsewhere.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+void AppendLatency(const char* name,
+                   SamplesStatsCounter& latency_us,
+                   rtc::StringBuilder& json) {
+  json << ", \"" << name << "\": {";
+  if (!latency_us.IsEmpty()) {
+    json << "\"p50_us\": " << latency_us.GetPercentile(0.5)
+         << ", \"p90_us\": " << latency_us.GetPercentile(0.9)
+         << ", \"p99_us\": " << latency_us.GetPercentile(0.99)
+         << ", \"max_us\": " << latency_us.GetMax();
+  }
+  json << "}";
+}
+
+double FramesPerSecond(const SamplesStatsCounter& latency_us) {
+  if (latency_us.IsEmpty() || latency_us.GetAverage() <= 0.0)
+    return 0.0;
+  return 1000000.0 / latency_us.GetAverage();
+}
+
+// Runs one configuration and appends its results to `json`, as an object.
+void RunConfiguration(const std::string& codec,
+                      const Clip& clip,
+                      Mode mode,
+                      size_t num_threads,
+                      rtc::StringBuilder& json) {
+  VideoCodecTestFixture::Config config;
+  config.filename = clip.filename;
+  config.filepath = ResourcePath(config.filename, "yuv");
+  config.num_frames = kNumFrames;
+  config.num_cores = num_threads;
+  const size_t num_simulcast_streams = mode == Mode::kSimulcast ? 3 : 1;
+  const size_t num_spatial_layers = mode == Mode::kSvc ? 3 : 1;
+  config.SetCodecSettings(codec, num_simulcast_streams, num_spatial_layers,
+                          /*num_temporal_layers=*/1, /*denoising_on=*/false,
+                          /*frame_dropper_on=*/false,
+                          /*spatial_resize_on=*/false, clip.width,
+                          clip.height);
+  if (codec == cricket::kAv1CodecName)
+    config.codec_settings.SetScalabilityMode("NONE");
+
+  std::unique_ptr<VideoCodecTestFixture> fixture;
+  InternalEncoderFactory internal_encoder_factory;
+  if (mode == Mode::kSimulcast) {
+    fixture = CreateVideoCodecTestFixture(
+        config, std::make_unique<InternalDecoderFactory>(),
+        std::make_unique<FunctionVideoEncoderFactory>([&]() {
+          return std::make_unique<SimulcastEncoderAdapter>(
+              &internal_encoder_factory, SdpVideoFormat(codec));
+        }));
+  } else {
+    fixture = CreateVideoCodecTestFixture(config);
+  }
+
+  std::vector<RateProfile> rate_profiles = {
+      {static_cast<size_t>(clip.target_kbps), static_cast<double>(clip.fps),
+       0}};
+  fixture->RunTest(rate_profiles, nullptr, nullptr, nullptr);
+
+  // A frame is done once its last layer is encoded, resp. decoded, so the
+  // latency of a frame is the largest latency of its layers.
+  std::map<size_t, size_t> encode_time_us;
+  std::map<size_t, size_t> decode_time_us;
+  for (const VideoCodecTestStats::FrameStatistics& frame :
+       fixture->GetStats().GetFrameStatistics()) {
+    if (frame.encoding_successful) {
+      size_t& time_us = encode_time_us[frame.frame_number];
+      time_us = std::max(time_us, frame.encode_time_us);
+    }
+    if (frame.decoding_successful) {
+      size_t& time_us = decode_time_us[frame.frame_number];
+      time_us = std::max(time_us, frame.decode_time_us);
+    }
+  }
+  SamplesStatsCounter encode_latency_us;
+  for (const auto& frame : encode_time_us)
+    encode_latency_us.AddSample(frame.second);
+  SamplesStatsCounter decode_latency_us;
+  for (const auto& frame : decode_time_us)
+    decode_latency_us.AddSample(frame.second);
+
+  json << "{\"codec\": \"" << codec << "\", \"clip\": \"" << clip.filename
+       << "\", \"width\": " << clip.width << ", \"height\": " << clip.height
+       << ", \"mode\": \"" << ModeName(mode)
+       << "\", \"threads\": " << num_threads
+       << ", \"encoded_frames\": " << encode_time_us.size()
+       << ", \"decoded_frames\": " << decode_time_us.size()
+       << ", \"encode_fps\": " << FramesPerSecond(encode_latency_us)
+       << ", \"decode_fps\": " << FramesPerSecond(decode_latency_us);
+  AppendLatency("encode_latency", encode_latency_us, json);
+  AppendLatency("decode_latency", decode_latency_us, json);
+  json << ", \"peak_rss_kb\": " << PeakRssKb() << "}";
+}
+
+}  // namespace
+
+// Disabled by default since it runs for a long time. Run with
+// --gtest_also_run_disabled_tests to size encode hosts, or to compare the
+// JSON output of two builds.
+TEST(VideoCodecTestThroughput, DISABLED_Sweep) {
+  const std::string codecs[] = {cricket::kVp8CodecName, cricket::kVp9CodecName,
+                                cricket::kAv1CodecName,
+                                cricket::kH264CodecName};
+  rtc::StringBuilder json;
+  json << "{\"num_frames\": " << kNumFrames << ", \"results\": [";
+  bool first = true;
+  for (const std::string& codec : codecs) {
+    if (!IsCodecSupported(codec)) {
+      printf("Skipping %s, not supported in this build.\n", codec.c_str());
+      continue;
+    }
+    for (const Clip& clip : kClips) {
+      for (Mode mode : {Mode::kSingleStream, Mode::kSimulcast, Mode::kSvc}) {
+        if (!IsModeSupported(codec, mode))
+          continue;
+        for (size_t num_threads : kThreadCounts) {
+          if (!first)
+            json << ",\n";
+          first = false;
+          RunConfiguration(codec, clip, mode, num_threads, json);
+        }
+      }
+    }
+  }
+  json << "]}\n";
+
+  printf("%s", json.str().c_str());
+  const std::string output_path = OutputPath() + kOutputFilename;
+  FileWrapper output_file = FileWrapper::OpenWriteOnly(output_path);
+  ASSERT_TRUE(output_file.is_open()) << "Could not open " << output_path;
+  EXPECT_TRUE(output_file.Write(json.str().data(), json.str().size()));
+  output_file.Close();
+  printf("Wrote %s\n", output_path.c_str());
+}
+
+}  // namespace test
+}  // namespace webrtc
@@ -59,6 +59,13 @@ constexpr char kVp8ForcePartitionResilience[] =
 constexpr int kLowVp8QpThreshold = 29;
 constexpr int kHighVp8QpThreshold = 95;
 
+// Each complexity reduction step makes cpu-used this much more negative, i.e.,
+// the encoder faster, down to the fastest setting. Steps past the fastest
+// setting of every stream are not advertised.
+constexpr int kMaxComplexityReduction = 3;
+constexpr int kCpuSpeedPerComplexityStep = 2;
+constexpr int kFastestCpuSpeed = -16;
+
 constexpr int kTokenPartitions = VP8_ONE_TOKENPARTITION;
 constexpr uint32_t kVp832ByteAlign = 32u;
 
@@ -418,6 +425,35 @@ void LibvpxVp8Encoder::OnLossNotification(
   }
 }
 
+void LibvpxVp8Encoder::SetComplexityReduction(int steps) {
+  steps = std::min(std::max(steps, 0), MaxComplexityReduction());
+  if (steps == complexity_reduction_)
+    return;
+  complexity_reduction_ = steps;
+  if (!inited_)
+    return;
+  for (size_t i = 0; i < encoders_.size(); ++i) {
+    const int cpu_speed = std::max(
+        cpu_speed_[i] - complexity_reduction_ * kCpuSpeedPerComplexityStep,
+        kFastestCpuSpeed);
+    libvpx_->codec_control(&(encoders_[i]), VP8E_SET_CPUUSED, cpu_speed);
+  }
+}
+
+int LibvpxVp8Encoder::MaxComplexityReduction() const {
+  if (!inited_)
+    return 0;
+  int max_steps = 0;
+  for (size_t i = 0; i < encoders_.size(); ++i) {
+    // Round up, the last step may only go part of the way.
+    const int steps =
+        (cpu_speed_[i] - kFastestCpuSpeed + kCpuSpeedPerComplexityStep - 1) /
+        kCpuSpeedPerComplexityStep;
+    max_steps = std::max(max_steps, steps);
+  }
+  return std::min(max_steps, kMaxComplexityReduction);
+}
+
 void LibvpxVp8Encoder::SetStreamState(bool send_stream, int stream_idx) {
   if (send_stream && !send_stream_[stream_idx]) {
     // Need a key frame if we have not sent this stream before.
@@ -606,6 +642,7 @@ int LibvpxVp8Encoder::InitEncode(const VideoCodec* inst,
       break;
   }
   cpu_speed_default_ = cpu_speed_[0];
+  complexity_reduction_ = 0;
   // Set encoding complexity (cpu_speed) based on resolution and/or platform.
   cpu_speed_[0] = GetCpuSpeed(inst->width, inst->height);
   for (int i = 1; i < number_of_streams; ++i) {
@@ -1217,6 +1254,7 @@ VideoEncoder::EncoderInfo LibvpxVp8Encoder::GetEncoderInfo() const {
   info.is_hardware_accelerated = false;
   info.has_internal_source = false;
   info.supports_simulcast = true;
+  info.max_complexity_reduction = MaxComplexityReduction();
   if (!resolution_bitrate_limits_.empty()) {
     info.resolution_bitrate_limits = resolution_bitrate_limits_;
   }
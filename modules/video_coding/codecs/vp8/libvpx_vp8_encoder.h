@@ -60,6 +60,8 @@ class LibvpxVp8Encoder : public VideoEncoder {
 
   void OnLossNotification(const LossNotification& loss_notification) override;
 
+  void SetComplexityReduction(int steps) override;
+
   EncoderInfo GetEncoderInfo() const override;
 
   static vpx_enc_frame_flags_t EncodeFlags(const Vp8FrameConfig& references);
@@ -68,6 +70,10 @@ class LibvpxVp8Encoder : public VideoEncoder {
   // Get the cpu_speed setting for encoder based on resolution and/or platform.
   int GetCpuSpeed(int width, int height);
 
+  // Number of complexity reduction steps that still make cpu-used faster for
+  // at least one stream.
+  int MaxComplexityReduction() const;
+
   // Determine number of encoder threads to use.
   int NumberOfThreads(int width, int height, int number_of_cores);
 
@@ -114,6 +120,7 @@ class LibvpxVp8Encoder : public VideoEncoder {
   int64_t timestamp_ = 0;
   int qp_max_ = 56;
   int cpu_speed_default_ = -6;
+  int complexity_reduction_ = 0;
   int number_of_cores_ = 0;
   uint32_t rc_max_intra_target_ = 0;
   int num_active_streams_ = 0;
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "api/test/create_frame_generator.h"
@@ -34,12 +35,17 @@ namespace webrtc {
 
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::An;
+using ::testing::DoAll;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Field;
 using ::testing::Invoke;
+using ::testing::Mock;
 using ::testing::NiceMock;
 using ::testing::Return;
+using ::testing::SaveArg;
+using ::testing::TypedEq;
 using EncoderInfo = webrtc::VideoEncoder::EncoderInfo;
 using FramerateFractions =
     absl::InlinedVector<uint8_t, webrtc::kMaxTemporalStreams>;
@@ -192,6 +198,47 @@ TEST_F(TestVp8Impl, SetRates) {
       bitrate_allocation, static_cast<double>(codec_settings_.maxFramerate)));
 }
 
+TEST_F(TestVp8Impl, ComplexityReductionMakesCpuUsedFaster) {
+  auto* const vpx = new NiceMock<MockLibvpxInterface>();
+  LibvpxVp8Encoder encoder((std::unique_ptr<LibvpxInterface>(vpx)),
+                           VP8Encoder::Settings());
+  EXPECT_EQ(0, encoder.GetEncoderInfo().max_complexity_reduction);
+
+  // The initial cpu-used depends on the platform.
+  int cpu_used = 0;
+  EXPECT_CALL(*vpx, codec_control(_, VP8E_SET_CPUUSED, An<int>()))
+      .WillOnce(DoAll(SaveArg<2>(&cpu_used), Return(VPX_CODEC_OK)));
+  ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings_, kSettings));
+  Mock::VerifyAndClearExpectations(vpx);
+
+  // Each step makes cpu-used two lower, and only the steps that do not go past
+  // the fastest setting, -16, are advertised.
+  const int max_steps = encoder.GetEncoderInfo().max_complexity_reduction;
+  EXPECT_EQ(std::min((cpu_used + 16 + 1) / 2, 3), max_steps);
+  ASSERT_GT(max_steps, 0);
+
+  EXPECT_CALL(*vpx,
+              codec_control(_, VP8E_SET_CPUUSED, TypedEq<int>(cpu_used - 2)));
+  encoder.SetComplexityReduction(1);
+  Mock::VerifyAndClearExpectations(vpx);
+
+  EXPECT_CALL(*vpx, codec_control(_, VP8E_SET_CPUUSED,
+                                  TypedEq<int>(std::max(
+                                      cpu_used - 2 * max_steps, -16))));
+  encoder.SetComplexityReduction(max_steps + 1);
+  Mock::VerifyAndClearExpectations(vpx);
+
+  // Already at the largest reduction.
+  EXPECT_CALL(*vpx, codec_control(_, VP8E_SET_CPUUSED, An<int>())).Times(0);
+  encoder.SetComplexityReduction(max_steps + 2);
+  Mock::VerifyAndClearExpectations(vpx);
+
+  EXPECT_CALL(*vpx,
+              codec_control(_, VP8E_SET_CPUUSED, TypedEq<int>(cpu_used)));
+  encoder.SetComplexityReduction(0);
+}
+
 TEST_F(TestVp8Impl, EncodeFrameAndRelease) {
   EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder_->Release());
   EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
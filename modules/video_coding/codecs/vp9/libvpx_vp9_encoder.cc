@@ -63,6 +63,12 @@ const int kMaxAllowedPidDiff = 30;
 constexpr int kLowVp9QpThreshold = 149;
 constexpr int kHighVp9QpThreshold = 205;
 
+// Complexity reduction raises the speed setting by one per step, up to the
+// fastest speed used for real-time encoding. Steps past that speed are not
+// advertised.
+constexpr int kMaxComplexityReduction = 3;
+constexpr int kFastestRealtimeSpeed = 9;
+
 std::pair<size_t, size_t> GetActiveLayers(
     const VideoBitrateAllocation& allocation) {
   for (size_t sl_idx = 0; sl_idx < kMaxSpatialLayers; ++sl_idx) {
@@ -240,7 +246,8 @@ LibvpxVp9Encoder::LibvpxVp9Encoder(const cricket::VideoCodec& codec,
                             "Disabled")),
       performance_flags_(ParsePerformanceFlagsFromTrials(trials)),
       num_steady_state_frames_(0),
-      config_changed_(true) {
+      config_changed_(true),
+      complexity_reduction_(0) {
   codec_ = {};
   memset(&svc_params_, 0, sizeof(vpx_svc_extra_cfg_t));
 }
@@ -541,6 +548,7 @@ int LibvpxVp9Encoder::InitEncode(const VideoCodec* inst,
     codec_ = *inst;
   }
   memset(&svc_params_, 0, sizeof(vpx_svc_extra_cfg_t));
+  complexity_reduction_ = 0;
 
   force_key_frame_ = true;
   pics_since_key_ = 0;
@@ -1044,10 +1052,10 @@ int LibvpxVp9Encoder::Encode(const VideoFrame& input_image,
     // Update speed settings that might depend on temporal index.
     bool speed_updated = false;
     for (int sl_idx = 0; sl_idx < num_spatial_layers_; ++sl_idx) {
-      const int target_speed =
+      const int target_speed = ReducedComplexitySpeed(
           layer_id.temporal_layer_id_per_spatial[sl_idx] == 0
               ? performance_flags_by_spatial_index_[sl_idx].base_layer_speed
-              : performance_flags_by_spatial_index_[sl_idx].high_layer_speed;
+              : performance_flags_by_spatial_index_[sl_idx].high_layer_speed);
       if (svc_params_.speed_per_layer[sl_idx] != target_speed) {
         svc_params_.speed_per_layer[sl_idx] = target_speed;
         speed_updated = true;
@@ -1080,10 +1088,10 @@ int LibvpxVp9Encoder::Encode(const VideoFrame& input_image,
                       svc_params_.scaling_factor_den[i];
           int height = (svc_params_.scaling_factor_num[i] * config_->g_h) /
                        svc_params_.scaling_factor_den[i];
-          int speed =
+          int speed = ReducedComplexitySpeed(
               std::prev(performance_flags_.settings_by_resolution.lower_bound(
                             width * height))
-                  ->second.base_layer_speed;
+                  ->second.base_layer_speed);
           libvpx_->codec_control(encoder_, VP8E_SET_CPUUSED, speed);
           break;
         }
@@ -1741,6 +1749,7 @@ VideoEncoder::EncoderInfo LibvpxVp9Encoder::GetEncoderInfo() const {
   info.has_trusted_rate_controller = trusted_rate_controller_;
   info.is_hardware_accelerated = false;
   info.has_internal_source = false;
+  info.max_complexity_reduction = MaxComplexityReduction();
   if (inited_) {
     // Find the max configured fps of any active spatial layer.
     float max_fps = 0.0;
@@ -1781,6 +1790,40 @@ VideoEncoder::EncoderInfo LibvpxVp9Encoder::GetEncoderInfo() const {
   return info;
 }
 
+void LibvpxVp9Encoder::SetComplexityReduction(int steps) {
+  steps = std::min(std::max(steps, 0), MaxComplexityReduction());
+  if (steps == complexity_reduction_) {
+    return;
+  }
+  complexity_reduction_ = steps;
+  // Speeds are applied on the next Encode(), together with the configuration.
+  config_changed_ = true;
+}
+
+int LibvpxVp9Encoder::ReducedComplexitySpeed(int speed) const {
+  const int reduced =
+      std::min(speed + complexity_reduction_, kFastestRealtimeSpeed);
+  return std::max(speed, reduced);
+}
+
+int LibvpxVp9Encoder::MaxComplexityReduction() const {
+  if (!inited_ || performance_flags_by_spatial_index_.empty()) {
+    return 0;
+  }
+  // Without per-layer speeds, a single speed is set, based on the top layer
+  // when all layers are active.
+  int slowest_speed =
+      performance_flags_by_spatial_index_.rbegin()->base_layer_speed;
+  if (performance_flags_.use_per_layer_speed) {
+    for (const auto& flags : performance_flags_by_spatial_index_) {
+      slowest_speed = std::min(
+          {slowest_speed, flags.base_layer_speed, flags.high_layer_speed});
+    }
+  }
+  return std::min(std::max(kFastestRealtimeSpeed - slowest_speed, 0),
+                  kMaxComplexityReduction);
+}
+
 size_t LibvpxVp9Encoder::SteadyStateSize(int sid, int tid) {
   const size_t bitrate_bps = current_bitrate_allocation_.GetBitrate(
       sid, tid == kNoTemporalIdx ? 0 : tid);
@@ -58,6 +58,8 @@ class LibvpxVp9Encoder : public VP9Encoder {
 
   EncoderInfo GetEncoderInfo() const override;
 
+  void SetComplexityReduction(int steps) override;
+
  private:
   // Determine number of encoder threads to use.
   int NumberOfThreads(int width, int height, int number_of_cores);
@@ -243,6 +245,14 @@ class LibvpxVp9Encoder : public VP9Encoder {
   int num_steady_state_frames_;
   // Only set config when this flag is set.
   bool config_changed_;
+  // Added to the speed settings of `performance_flags_`, see
+  // SetComplexityReduction().
+  int complexity_reduction_;
+  // Returns `speed` raised by `complexity_reduction_`.
+  int ReducedComplexitySpeed(int speed) const;
+  // Returns the number of complexity reduction steps that still make the
+  // speed of at least one layer faster.
+  int MaxComplexityReduction() const;
 
   const LibvpxVp9EncoderInfoSettings encoder_info_override_;
 };
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef NET_DCSCTP_COMMON_RING_BUFFER_H_
+#define NET_DCSCTP_COMMON_RING_BUFFER_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "rtc_base/checks.h"
+
+namespace dcsctp {
+
+// A double-ended queue of elements, stored contiguously in a circular buffer
+// whose capacity doubles when it's full. Elements are added at the back,
+// removed from the front and accessed by their index, counted from the front,
+// all in constant time. Memory is only allocated when the buffer grows, so a
+// queue that stays within its capacity doesn't allocate at all.
+//
+// Element references are invalidated when an element is added to a buffer
+// that is full.
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer() = default;
+  RingBuffer(RingBuffer&&) = default;
+  RingBuffer& operator=(RingBuffer&&) = default;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return slots_.size(); }
+
+  T& operator[](size_t index) {
+    RTC_DCHECK_LT(index, size_);
+    return *slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+  const T& operator[](size_t index) const {
+    RTC_DCHECK_LT(index, size_);
+    return *slots_[(head_ + index) & (slots_.size() - 1)];
+  }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  // Adds an element, constructed from `args`, at the back.
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == slots_.size()) {
+      Grow();
+    }
+    absl::optional<T>& slot = slots_[(head_ + size_) & (slots_.size() - 1)];
+    slot.emplace(std::forward<Args>(args)...);
+    ++size_;
+    return *slot;
+  }
+
+  // Removes the element at the front.
+  void pop_front() {
+    RTC_DCHECK(!empty());
+    slots_[head_].reset();
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    --size_;
+  }
+
+  void clear() {
+    while (!empty()) {
+      pop_front();
+    }
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 16;
+
+  void Grow() {
+    // The capacity is kept a power of two, so that indices can be masked.
+    std::vector<absl::optional<T>> slots(
+        slots_.empty() ? kInitialCapacity : 2 * slots_.size());
+    for (size_t i = 0; i < size_; ++i) {
+      slots[i].emplace(std::move((*this)[i]));
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+  std::vector<absl::optional<T>> slots_;
+  // Index in `slots_` of the element at the front.
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace dcsctp
+
+#endif  // NET_DCSCTP_COMMON_RING_BUFFER_H_
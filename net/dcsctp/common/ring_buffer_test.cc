@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "net/dcsctp/common/ring_buffer.h"
+
+#include <memory>
+
+#include "test/gmock.h"
+
+namespace dcsctp {
+namespace {
+
+TEST(RingBufferTest, IsEmptyWhenCreated) {
+  RingBuffer<int> buffer;
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_EQ(buffer.capacity(), 0u);
+}
+
+TEST(RingBufferTest, AddsAtBackAndRemovesFromFront) {
+  RingBuffer<int> buffer;
+  buffer.emplace_back(1);
+  buffer.emplace_back(2);
+  buffer.emplace_back(3);
+  EXPECT_EQ(buffer.size(), 3u);
+  EXPECT_EQ(buffer.front(), 1);
+  EXPECT_EQ(buffer.back(), 3);
+  EXPECT_EQ(buffer[1], 2);
+
+  buffer.pop_front();
+  EXPECT_EQ(buffer.size(), 2u);
+  EXPECT_EQ(buffer.front(), 2);
+  EXPECT_EQ(buffer[1], 3);
+}
+
+TEST(RingBufferTest, WrapsAroundWithoutGrowing) {
+  RingBuffer<int> buffer;
+  buffer.emplace_back(0);
+  size_t capacity = buffer.capacity();
+
+  for (int i = 1; i < 1000; ++i) {
+    buffer.emplace_back(i);
+    buffer.pop_front();
+    EXPECT_EQ(buffer.front(), i);
+  }
+  EXPECT_EQ(buffer.size(), 1u);
+  EXPECT_EQ(buffer.capacity(), capacity);
+}
+
+TEST(RingBufferTest, KeepsOrderWhenGrowingWhileWrapped) {
+  RingBuffer<int> buffer;
+  int next = 0;
+  for (int i = 0; i < 10; ++i) {
+    buffer.emplace_back(next++);
+  }
+  for (int i = 0; i < 8; ++i) {
+    buffer.pop_front();
+  }
+  for (int i = 0; i < 100; ++i) {
+    buffer.emplace_back(next++);
+  }
+
+  ASSERT_EQ(buffer.size(), 102u);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    EXPECT_EQ(buffer[i], static_cast<int>(i) + 8);
+  }
+}
+
+TEST(RingBufferTest, HoldsMoveOnlyTypes) {
+  RingBuffer<std::unique_ptr<int>> buffer;
+  for (int i = 0; i < 50; ++i) {
+    buffer.emplace_back(std::make_unique<int>(i));
+  }
+  EXPECT_EQ(*buffer.front(), 0);
+  EXPECT_EQ(*buffer.back(), 49);
+
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+}  // namespace
+}  // namespace dcsctp
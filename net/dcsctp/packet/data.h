@@ -10,15 +10,81 @@
 #ifndef NET_DCSCTP_PACKET_DATA_H_
 #define NET_DCSCTP_PACKET_DATA_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "net/dcsctp/common/internal_types.h"
 #include "net/dcsctp/public/types.h"
+#include "rtc_base/checks.h"
 
 namespace dcsctp {
 
+// The payload of a DATA/I-DATA chunk. It either owns its bytes, or references a
+// part of a buffer that is shared with other payloads. The latter is used for
+// fragments of a message that is sent, which then all reference the message's
+// payload, and for retransmissions, without copying it.
+//
+// The bytes can't be modified, and copying a shared payload is cheap.
+class DataPayload {
+ public:
+  using value_type = uint8_t;
+  using iterator = const uint8_t*;
+  using const_iterator = const uint8_t*;
+
+  DataPayload() = default;
+  DataPayload(std::vector<uint8_t> bytes)  // NOLINT(runtime/explicit)
+      : owned_(std::move(bytes)) {}
+  DataPayload(std::initializer_list<uint8_t> bytes) : owned_(bytes) {}
+
+  // Creates a payload referencing `size` bytes at `offset` in `buffer`.
+  DataPayload(std::shared_ptr<const std::vector<uint8_t>> buffer,
+              size_t offset,
+              size_t size)
+      : shared_(std::move(buffer)), offset_(offset), size_(size) {
+    RTC_DCHECK_LE(offset_ + size_, shared_->size());
+  }
+
+  DataPayload(const DataPayload& other) = default;
+  DataPayload& operator=(const DataPayload& other) = default;
+  DataPayload(DataPayload&& other) = default;
+  DataPayload& operator=(DataPayload&& other) = default;
+
+  const uint8_t* data() const {
+    return shared_ ? shared_->data() + offset_ : owned_.data();
+  }
+  size_t size() const { return shared_ ? size_ : owned_.size(); }
+  bool empty() const { return size() == 0; }
+  const uint8_t* begin() const { return data(); }
+  const uint8_t* end() const { return data() + size(); }
+  uint8_t operator[](size_t index) const {
+    RTC_DCHECK_LT(index, size());
+    return data()[index];
+  }
+
+  // Indicates if the bytes are shared with other payloads.
+  bool is_shared() const { return shared_ != nullptr; }
+
+  // Returns the bytes, as a destructive action. Owned bytes are moved, while
+  // shared bytes are copied.
+  std::vector<uint8_t> Release() && {
+    if (shared_) {
+      return std::vector<uint8_t>(begin(), end());
+    }
+    return std::move(owned_);
+  }
+
+ private:
+  // Only one of `owned_` and `shared_` is used.
+  std::vector<uint8_t> owned_;
+  std::shared_ptr<const std::vector<uint8_t>> shared_;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+};
+
 // Represents data that is either received and extracted from a DATA/I-DATA
 // chunk, or data that is supposed to be sent, and wrapped in a DATA/I-DATA
 // chunk (depending on peer capabilities).
@@ -45,7 +111,7 @@ struct Data {
        MID message_id,
        FSN fsn,
        PPID ppid,
-       std::vector<uint8_t> payload,
+       DataPayload payload,
        IsBeginning is_beginning,
        IsEnd is_end,
        IsUnordered is_unordered)
@@ -63,7 +129,8 @@ struct Data {
   Data(Data&& other) = default;
   Data& operator=(Data&& other) = default;
 
-  // Creates a copy of this `Data` object.
+  // Creates a copy of this `Data` object. A shared payload is not copied, but
+  // shared with the copy.
   Data Clone() const {
     return Data(stream_id, ssn, message_id, fsn, ppid, payload, is_beginning,
                 is_end, is_unordered);
@@ -90,7 +157,7 @@ struct Data {
   PPID ppid;
 
   // The actual data payload.
-  std::vector<uint8_t> payload;
+  DataPayload payload;
 
   // If this data represents the first, last or a middle chunk.
   IsBeginning is_beginning;
@@ -11,13 +11,12 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <iterator>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "net/dcsctp/common/sequence_numbers.h"
@@ -31,81 +30,104 @@ namespace dcsctp {
 constexpr size_t DataTracker::kMaxDuplicateTsnReported;
 constexpr size_t DataTracker::kMaxGapAckBlocksReported;
 
-bool DataTracker::AdditionalTsnBlocks::Add(UnwrappedTSN tsn) {
-  // Find any block to expand. It will look for any block that includes (also
-  // when expanded) the provided `tsn`. It will return the block that is greater
-  // than, or equal to `tsn`.
-  auto it = absl::c_lower_bound(
-      blocks_, tsn, [&](const TsnRange& elem, const UnwrappedTSN& t) {
-        return elem.last.next_value() < t;
-      });
-
-  if (it == blocks_.end()) {
-    // No matching block found. There is no greater than, or equal block - which
-    // means that this TSN is greater than any block. It can then be inserted at
-    // the end.
-    blocks_.emplace_back(tsn, tsn);
-    return true;
+constexpr int DataTracker::AdditionalTsns::kBitsPerWord;
+
+bool DataTracker::AdditionalTsns::Add(UnwrappedTSN tsn) {
+  RTC_DCHECK(tsn >= base_);
+  size_t offset = UnwrappedTSN::Difference(tsn, base_);
+  size_t index = offset / kBitsPerWord;
+  while (words_.size() <= index) {
+    words_.emplace_back(0);
   }
 
-  if (tsn >= it->first && tsn <= it->last) {
-    // It's already in this block.
+  uint64_t bit = uint64_t{1} << (offset % kBitsPerWord);
+  if ((words_[index] & bit) != 0) {
     return false;
   }
+  words_[index] |= bit;
+  ++count_;
+  return true;
+}
 
-  if (it->last.next_value() == tsn) {
-    // This block can be expanded to the right, or merged with the next.
-    auto next_it = it + 1;
-    if (next_it != blocks_.end() && tsn.next_value() == next_it->first) {
-      // Expanding it would make it adjacent to next block - merge those.
-      it->last = next_it->last;
-      blocks_.erase(next_it);
-      return true;
-    }
-
-    // Expand to the right
-    it->last = tsn;
-    return true;
+UnwrappedTSN DataTracker::AdditionalTsns::EraseToAndFollowing(
+    UnwrappedTSN tsn) {
+  if (count_ == 0) {
+    // Fast path - no packet loss.
+    words_.clear();
+    base_ = tsn.next_value();
+    return tsn;
   }
 
-  if (it->first == tsn.next_value()) {
-    // This block can be expanded to the left. Merging to the left would've been
-    // covered by the above "merge to the right". Both blocks (expand a
-    // right-most block to the left and expand a left-most block to the right)
-    // would match, but the left-most would be returned by std::lower_bound.
-    RTC_DCHECK(it == blocks_.begin() || (it - 1)->last.next_value() != tsn);
+  // Extend `tsn` over the run of set bits that directly follows it.
+  if (tsn.next_value() >= base_) {
+    size_t offset = UnwrappedTSN::Difference(tsn.next_value(), base_);
+    tsn = UnwrappedTSN::AddTo(
+        tsn, static_cast<int>(FindBit(offset, false) - offset));
+  }
 
-    // Expand to the left.
-    it->first = tsn;
-    return true;
+  // Remove all words that only represent TSNs up to `tsn`, and clear the bits
+  // up to `tsn` in the word that follows.
+  while (!words_.empty() &&
+         UnwrappedTSN::AddTo(base_, kBitsPerWord - 1) <= tsn) {
+    count_ -= absl::popcount(words_.front());
+    words_.pop_front();
+    base_ = UnwrappedTSN::AddTo(base_, kBitsPerWord);
+  }
+  if (!words_.empty() && base_ <= tsn) {
+    size_t bits = UnwrappedTSN::Difference(tsn, base_) + 1;
+    uint64_t mask = (uint64_t{1} << bits) - 1;
+    count_ -= absl::popcount(words_.front() & mask);
+    words_.front() &= ~mask;
   }
 
-  // Need to create a new block in the middle.
-  blocks_.emplace(it, tsn, tsn);
-  return true;
+  if (count_ == 0) {
+    words_.clear();
+    base_ = tsn.next_value();
+  }
+  return tsn;
 }
 
-void DataTracker::AdditionalTsnBlocks::EraseTo(UnwrappedTSN tsn) {
-  // Find the block that is greater than or equals `tsn`.
-  auto it = absl::c_lower_bound(
-      blocks_, tsn, [&](const TsnRange& elem, const UnwrappedTSN& t) {
-        return elem.last < t;
-      });
-
-  // The block that is found is greater or equal (or possibly ::end, when no
-  // block is greater or equal). All blocks before this block can be safely
-  // removed. the TSN might be within this block, so possibly truncate it.
-  bool tsn_is_within_block = it != blocks_.end() && tsn >= it->first;
-  blocks_.erase(blocks_.begin(), it);
-
-  if (tsn_is_within_block) {
-    blocks_.front().first = tsn.next_value();
+size_t DataTracker::AdditionalTsns::FindBit(size_t offset, bool value) const {
+  const size_t num_bits = words_.size() * kBitsPerWord;
+  while (offset < num_bits) {
+    uint64_t word = words_[offset / kBitsPerWord];
+    if (!value) {
+      word = ~word;
+    }
+    // Bits shifted in from the top are zero, so a match is never found beyond
+    // the current word.
+    word >>= offset % kBitsPerWord;
+    if (word != 0) {
+      return offset + absl::countr_zero(word);
+    }
+    offset = (offset / kBitsPerWord + 1) * kBitsPerWord;
   }
+  return offset;
 }
 
-void DataTracker::AdditionalTsnBlocks::PopFront() {
-  RTC_DCHECK(!blocks_.empty());
-  blocks_.erase(blocks_.begin());
+std::vector<SackChunk::GapAckBlock> DataTracker::AdditionalTsns::GapAckBlocks(
+    UnwrappedTSN cumulative_tsn_ack,
+    size_t max_blocks) const {
+  std::vector<SackChunk::GapAckBlock> gap_ack_blocks;
+  if (count_ == 0) {
+    return gap_ack_blocks;
+  }
+
+  auto block_offset = [&](size_t offset) {
+    return static_cast<uint16_t>(UnwrappedTSN::Difference(
+        UnwrappedTSN::AddTo(base_, static_cast<int>(offset)),
+        cumulative_tsn_ack));
+  };
+
+  gap_ack_blocks.reserve(std::min(count_, max_blocks));
+  const size_t num_bits = words_.size() * kBitsPerWord;
+  size_t offset = FindBit(0, true);
+  while (offset < num_bits && gap_ack_blocks.size() < max_blocks) {
+    size_t end = FindBit(offset, false);
+    gap_ack_blocks.emplace_back(block_offset(offset), block_offset(end - 1));
+    offset = FindBit(end, true);
+  }
+  return gap_ack_blocks;
 }
 
 bool DataTracker::IsTSNValid(TSN tsn) const {
@@ -145,17 +167,12 @@ void DataTracker::Observe(TSN tsn,
     UpdateAckState(AckState::kImmediate, "duplicate data");
   } else {
     if (unwrapped_tsn == last_cumulative_acked_tsn_.next_value()) {
-      last_cumulative_acked_tsn_ = unwrapped_tsn;
       // The cumulative acked tsn may be moved even further, if a gap was
       // filled.
-      if (!additional_tsn_blocks_.empty() &&
-          additional_tsn_blocks_.front().first ==
-              last_cumulative_acked_tsn_.next_value()) {
-        last_cumulative_acked_tsn_ = additional_tsn_blocks_.front().last;
-        additional_tsn_blocks_.PopFront();
-      }
+      last_cumulative_acked_tsn_ =
+          additional_tsns_.EraseToAndFollowing(unwrapped_tsn);
     } else {
-      bool inserted = additional_tsn_blocks_.Add(unwrapped_tsn);
+      bool inserted = additional_tsns_.Add(unwrapped_tsn);
       if (!inserted) {
         // Already seen before.
         if (duplicate_tsns_.size() < kMaxDuplicateTsnReported) {
@@ -177,7 +194,7 @@ void DataTracker::Observe(TSN tsn,
   // the received DATA chunk sequence, it SHOULD send a SACK with Gap Ack
   // Blocks immediately.  The data receiver continues sending a SACK after
   // receipt of each SCTP packet that doesn't fill the gap."
-  if (!additional_tsn_blocks_.empty()) {
+  if (!additional_tsns_.empty()) {
     UpdateAckState(AckState::kImmediate, "packet loss");
   }
 
@@ -239,17 +256,10 @@ void DataTracker::HandleForwardTsn(TSN new_cumulative_ack) {
 
   // The `new_cumulative_ack` will become the current
   // `last_cumulative_acked_tsn_`, and if there have been prior "gaps" that are
-  // now overlapping with the new value, remove them.
-  last_cumulative_acked_tsn_ = unwrapped_tsn;
-  additional_tsn_blocks_.EraseTo(unwrapped_tsn);
-
-  // See if the `last_cumulative_acked_tsn_` can be moved even further:
-  if (!additional_tsn_blocks_.empty() &&
-      additional_tsn_blocks_.front().first ==
-          last_cumulative_acked_tsn_.next_value()) {
-    last_cumulative_acked_tsn_ = additional_tsn_blocks_.front().last;
-    additional_tsn_blocks_.PopFront();
-  }
+  // now overlapping with the new value, remove them. It may then be moved even
+  // further, if received TSNs directly follow it.
+  last_cumulative_acked_tsn_ =
+      additional_tsns_.EraseToAndFollowing(unwrapped_tsn);
 
   RTC_DLOG(LS_VERBOSE) << log_prefix_ << "FORWARD_TSN, cum_ack_tsn="
                        << *prev_last_cum_ack_tsn.Wrap() << "->"
@@ -280,23 +290,9 @@ SackChunk DataTracker::CreateSelectiveAck(size_t a_rwnd) {
   duplicate_tsns_.swap(duplicate_tsns);
 
   return SackChunk(last_cumulative_acked_tsn_.Wrap(), a_rwnd,
-                   CreateGapAckBlocks(), std::move(duplicate_tsns));
-}
-
-std::vector<SackChunk::GapAckBlock> DataTracker::CreateGapAckBlocks() const {
-  const auto& blocks = additional_tsn_blocks_.blocks();
-  std::vector<SackChunk::GapAckBlock> gap_ack_blocks;
-  gap_ack_blocks.reserve(std::min(blocks.size(), kMaxGapAckBlocksReported));
-  for (size_t i = 0; i < blocks.size() && i < kMaxGapAckBlocksReported; ++i) {
-    auto start_diff =
-        UnwrappedTSN::Difference(blocks[i].first, last_cumulative_acked_tsn_);
-    auto end_diff =
-        UnwrappedTSN::Difference(blocks[i].last, last_cumulative_acked_tsn_);
-    gap_ack_blocks.emplace_back(static_cast<uint16_t>(start_diff),
-                                static_cast<uint16_t>(end_diff));
-  }
-
-  return gap_ack_blocks;
+                   additional_tsns_.GapAckBlocks(last_cumulative_acked_tsn_,
+                                                 kMaxGapAckBlocksReported),
+                   std::move(duplicate_tsns));
 }
 
 bool DataTracker::ShouldSendAck(bool also_if_delayed) {
@@ -358,7 +354,7 @@ absl::string_view DataTracker::ToString(AckState ack_state) {
 
 HandoverReadinessStatus DataTracker::GetHandoverReadiness() const {
   HandoverReadinessStatus status;
-  if (!additional_tsn_blocks_.empty()) {
+  if (!additional_tsns_.empty()) {
     status.Add(HandoverUnreadinessReason::kDataTrackerTsnBlocksPending);
   }
   return status;
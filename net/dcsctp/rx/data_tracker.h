@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "net/dcsctp/common/ring_buffer.h"
 #include "net/dcsctp/common/sequence_numbers.h"
 #include "net/dcsctp/packet/chunk/data_common.h"
 #include "net/dcsctp/packet/chunk/sack_chunk.h"
@@ -62,7 +63,8 @@ class DataTracker {
         delayed_ack_timer_(*delayed_ack_timer),
         last_cumulative_acked_tsn_(tsn_unwrapper_.Unwrap(
             handover_state ? TSN(handover_state->rx.last_cumulative_acked_tsn)
-                           : TSN(*peer_initial_tsn - 1))) {}
+                           : TSN(*peer_initial_tsn - 1))),
+        additional_tsns_(last_cumulative_acked_tsn_.next_value()) {}
 
   // Indicates if the provided TSN is valid. If this return false, the data
   // should be dropped and not added to any other buffers, which essentially
@@ -127,49 +129,54 @@ class DataTracker {
     kImmediate,
   };
 
-  // Represents ranges of TSNs that have been received that are not directly
-  // following the last cumulative acked TSN. This information is returned to
-  // the sender in the "gap ack blocks" in the SACK chunk. The blocks are always
-  // non-overlapping and non-adjacent.
-  class AdditionalTsnBlocks {
+  // Represents the TSNs that have been received that are not directly
+  // following the last cumulative acked TSN, as a bitmap with one bit per TSN.
+  // Runs of set bits are returned to the sender in the "gap ack blocks" in the
+  // SACK chunk. The bitmap is stored in 64-bit words, which are scanned a word
+  // at a time, and it only covers the TSNs between the last cumulative acked
+  // TSN and the highest received TSN, which is bounded by
+  // `kMaxAcceptedOutstandingFragments`.
+  class AdditionalTsns {
    public:
-    // Represents an inclusive range of received TSNs, i.e. [first, last].
-    struct TsnRange {
-      TsnRange(UnwrappedTSN first, UnwrappedTSN last)
-          : first(first), last(last) {}
-      UnwrappedTSN first;
-      UnwrappedTSN last;
-    };
-
-    // Adds a TSN to the set. This will try to expand any existing block and
-    // might merge blocks to ensure that all blocks are non-adjacent. If a
-    // current block can't be expanded, a new block is created.
+    // `base` must not be greater than the TSN following the last cumulative
+    // acked TSN.
+    explicit AdditionalTsns(UnwrappedTSN base) : base_(base) {}
+
+    // Adds a TSN, which must be greater than the TSN following the last
+    // cumulative acked TSN, to the set.
     //
     // The return value indicates if `tsn` was added. If false is returned, the
-    // `tsn` was already represented in one of the blocks.
+    // `tsn` was already in the set.
     bool Add(UnwrappedTSN tsn);
 
-    // Erases all TSNs up to, and including `tsn`. This will remove all blocks
-    // that are completely below `tsn` and may truncate a block where `tsn` is
-    // within that block. In that case, the frontmost block's start TSN will be
-    // the next following tsn after `tsn`.
-    void EraseTo(UnwrappedTSN tsn);
-
-    // Removes the first block. Must not be called on an empty set.
-    void PopFront();
-
-    const std::vector<TsnRange>& blocks() const { return blocks_; }
+    // Erases all TSNs up to, and including `tsn`, as well as any TSNs that
+    // directly follow it. Returns the last erased TSN (or `tsn`, if no TSN
+    // follows it), which is the new cumulative acked TSN when `tsn` is.
+    UnwrappedTSN EraseToAndFollowing(UnwrappedTSN tsn);
 
-    bool empty() const { return blocks_.empty(); }
+    // Returns the first `max_blocks` runs of TSNs in the set, as gap ack
+    // blocks relative to `cumulative_tsn_ack`.
+    std::vector<SackChunk::GapAckBlock> GapAckBlocks(
+        UnwrappedTSN cumulative_tsn_ack,
+        size_t max_blocks) const;
 
-    const TsnRange& front() const { return blocks_.front(); }
+    bool empty() const { return count_ == 0; }
 
    private:
-    // A sorted vector of non-overlapping and non-adjacent blocks.
-    std::vector<TsnRange> blocks_;
+    static constexpr int kBitsPerWord = 64;
+
+    // Returns the offset of the first bit that is `value`, at or after
+    // `offset`. Bits beyond the end of the bitmap are unset, and if a set bit
+    // is searched for, the returned offset is then not within the bitmap.
+    size_t FindBit(size_t offset, bool value) const;
+
+    // The TSN represented by the least significant bit of the first word.
+    UnwrappedTSN base_;
+    RingBuffer<uint64_t> words_;
+    // The number of set bits.
+    size_t count_ = 0;
   };
 
-  std::vector<SackChunk::GapAckBlock> CreateGapAckBlocks() const;
   void UpdateAckState(AckState new_state, absl::string_view reason);
   static absl::string_view ToString(AckState ack_state);
 
@@ -183,7 +190,7 @@ class DataTracker {
   // All TSNs up until (and including) this value have been seen.
   UnwrappedTSN last_cumulative_acked_tsn_;
   // Received TSNs that are not directly following `last_cumulative_acked_tsn_`.
-  AdditionalTsnBlocks additional_tsn_blocks_;
+  AdditionalTsns additional_tsns_;
   std::set<TSN> duplicate_tsns_;
 };
 }  // namespace dcsctp
@@ -644,6 +644,44 @@ TEST_F(DataTrackerTest, GapAckBlockRemoveeFarAfterAllBlocks) {
   EXPECT_THAT(tracker_->CreateSelectiveAck(kArwnd).gap_ack_blocks(), IsEmpty());
 }
 
+TEST_F(DataTrackerTest, GapAckBlocksCanSpanManyTsns) {
+  Observer({11});
+  for (uint32_t tsn = 13; tsn < 200; ++tsn) {
+    if (tsn != 100) {
+      Observer({tsn});
+    }
+  }
+  SackChunk sack = tracker_->CreateSelectiveAck(kArwnd);
+  EXPECT_EQ(sack.cumulative_tsn_ack(), TSN(11));
+  EXPECT_THAT(sack.gap_ack_blocks(),
+              ElementsAre(SackChunk::GapAckBlock(2, 88),  //
+                          SackChunk::GapAckBlock(90, 188)));
+
+  Observer({12});
+  EXPECT_EQ(tracker_->CreateSelectiveAck(kArwnd).cumulative_tsn_ack(), TSN(99));
+  EXPECT_THAT(tracker_->CreateSelectiveAck(kArwnd).gap_ack_blocks(),
+              ElementsAre(SackChunk::GapAckBlock(2, 100)));
+
+  Observer({100});
+  EXPECT_EQ(tracker_->CreateSelectiveAck(kArwnd).cumulative_tsn_ack(),
+            TSN(199));
+  EXPECT_THAT(tracker_->CreateSelectiveAck(kArwnd).gap_ack_blocks(), IsEmpty());
+}
+
+TEST_F(DataTrackerTest, GapAckBlockRemoveWithinManyTsns) {
+  for (uint32_t tsn = 13; tsn < 150; ++tsn) {
+    if (tsn % 50 != 0) {
+      Observer({tsn});
+    }
+  }
+
+  tracker_->HandleForwardTsn(TSN(70));
+  SackChunk sack = tracker_->CreateSelectiveAck(kArwnd);
+  EXPECT_EQ(sack.cumulative_tsn_ack(), TSN(99));
+  EXPECT_THAT(sack.gap_ack_blocks(),
+              ElementsAre(SackChunk::GapAckBlock(2, 50)));
+}
+
 TEST_F(DataTrackerTest, HandoverEmpty) {
   HandoverTracker();
   Observer({11});
@@ -0,0 +1,258 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "net/dcsctp/rx/interleaved_reassembly_streams.h"
+
+#include <stddef.h>
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "api/array_view.h"
+#include "net/dcsctp/common/sequence_numbers.h"
+#include "net/dcsctp/packet/chunk/forward_tsn_common.h"
+#include "net/dcsctp/packet/data.h"
+#include "net/dcsctp/public/dcsctp_message.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace dcsctp {
+
+InterleavedReassemblyStreams::InterleavedReassemblyStreams(
+    absl::string_view log_prefix,
+    OnAssembledMessage on_assembled_message,
+    const DcSctpSocketHandoverState* handover_state)
+    : log_prefix_(log_prefix),
+      on_assembled_message_(std::move(on_assembled_message)) {
+  if (handover_state) {
+    // For ordered streams, `next_ssn` holds the next MID to be delivered.
+    for (const DcSctpSocketHandoverState::OrderedStream& state_stream :
+         handover_state->rx.ordered_streams) {
+      FullStreamId stream_id(IsUnordered(false), StreamID(state_stream.id));
+      streams_.emplace(
+          std::piecewise_construct, std::forward_as_tuple(stream_id),
+          std::forward_as_tuple(stream_id, this, MID(state_stream.next_ssn)));
+    }
+    for (const DcSctpSocketHandoverState::UnorderedStream& state_stream :
+         handover_state->rx.unordered_streams) {
+      FullStreamId stream_id(IsUnordered(true), StreamID(state_stream.id));
+      streams_.emplace(std::piecewise_construct,
+                       std::forward_as_tuple(stream_id),
+                       std::forward_as_tuple(stream_id, this));
+    }
+  }
+}
+
+size_t InterleavedReassemblyStreams::Stream::AssembleMessage(
+    ChunkMap& chunks) {
+  std::vector<UnwrappedTSN> tsns;
+  tsns.reserve(chunks.size());
+
+  // The payload of the first fragment becomes the message's buffer, so
+  // unfragmented messages are never copied.
+  Data& first = chunks.begin()->second.second;
+  StreamID stream_id = first.stream_id;
+  PPID ppid = first.ppid;
+  std::vector<uint8_t> payload = std::move(first.payload).Release();
+  tsns.push_back(chunks.begin()->second.first);
+  for (auto it = std::next(chunks.begin()); it != chunks.end(); ++it) {
+    tsns.push_back(it->second.first);
+    const Data& data = it->second.second;
+    payload.insert(payload.end(), data.payload.begin(), data.payload.end());
+  }
+
+  size_t payload_size = payload.size();
+  parent_.on_assembled_message_(
+      tsns, DcSctpMessage(stream_id, ppid, std::move(payload)));
+  return payload_size;
+}
+
+size_t InterleavedReassemblyStreams::Stream::TryToAssembleMessage(
+    UnwrappedMID mid) {
+  if (!*stream_id_.unordered && mid != next_mid_) {
+    return 0;
+  }
+
+  auto it = chunks_by_mid_.find(mid);
+  if (it == chunks_by_mid_.end()) {
+    return 0;
+  }
+
+  // The fragments are numbered from zero, so all have been received when the
+  // last one has, and the number of fragments matches its FSN.
+  ChunkMap& chunks = it->second;
+  if (!chunks.begin()->second.second.is_beginning ||
+      !chunks.rbegin()->second.second.is_end ||
+      *chunks.rbegin()->first != chunks.size() - 1) {
+    return 0;
+  }
+
+  size_t assembled_bytes = AssembleMessage(chunks);
+  chunks_by_mid_.erase(it);
+  if (!*stream_id_.unordered) {
+    next_mid_.Increment();
+  }
+  return assembled_bytes;
+}
+
+size_t InterleavedReassemblyStreams::Stream::TryToAssembleMessages() {
+  size_t assembled_bytes = 0;
+
+  for (;;) {
+    size_t assembled_bytes_this_iter = TryToAssembleMessage(next_mid_);
+    if (assembled_bytes_this_iter == 0) {
+      break;
+    }
+    assembled_bytes += assembled_bytes_this_iter;
+  }
+  return assembled_bytes;
+}
+
+int InterleavedReassemblyStreams::Stream::Add(UnwrappedTSN tsn, Data data) {
+  RTC_DCHECK_EQ(*data.is_unordered, *stream_id_.unordered);
+  RTC_DCHECK_EQ(*data.stream_id, *stream_id_.stream_id);
+  int queued_bytes = data.size();
+
+  UnwrappedMID mid = mid_unwrapper_.Unwrap(data.message_id);
+  if (!*stream_id_.unordered && mid < next_mid_) {
+    // Already delivered, or skipped by a FORWARD-TSN.
+    return 0;
+  }
+
+  FSN fsn = data.fsn;
+  if (!chunks_by_mid_[mid]
+           .emplace(std::piecewise_construct, std::forward_as_tuple(fsn),
+                    std::forward_as_tuple(tsn, std::move(data)))
+           .second /* !inserted */) {
+    return 0;
+  }
+
+  if (*stream_id_.unordered) {
+    queued_bytes -= TryToAssembleMessage(mid);
+  } else if (mid == next_mid_) {
+    queued_bytes -= TryToAssembleMessages();
+  }
+
+  return queued_bytes;
+}
+
+size_t InterleavedReassemblyStreams::Stream::EraseTo(MID message_id) {
+  UnwrappedMID unwrapped_mid = mid_unwrapper_.Unwrap(message_id);
+
+  auto end_iter = chunks_by_mid_.upper_bound(unwrapped_mid);
+  size_t removed_bytes = 0;
+  for (auto it = chunks_by_mid_.begin(); it != end_iter; ++it) {
+    removed_bytes += std::accumulate(
+        it->second.begin(), it->second.end(), size_t{0},
+        [](size_t r, const auto& p) { return r + p.second.second.size(); });
+  }
+  chunks_by_mid_.erase(chunks_by_mid_.begin(), end_iter);
+
+  if (!*stream_id_.unordered) {
+    if (unwrapped_mid >= next_mid_) {
+      unwrapped_mid.Increment();
+      next_mid_ = unwrapped_mid;
+    }
+    removed_bytes += TryToAssembleMessages();
+  }
+  return removed_bytes;
+}
+
+InterleavedReassemblyStreams::Stream&
+InterleavedReassemblyStreams::GetOrCreateStream(const FullStreamId& stream_id) {
+  auto it = streams_.find(stream_id);
+  if (it == streams_.end()) {
+    it = streams_
+             .emplace(std::piecewise_construct,
+                      std::forward_as_tuple(stream_id),
+                      std::forward_as_tuple(stream_id, this))
+             .first;
+  }
+  return it->second;
+}
+
+int InterleavedReassemblyStreams::Add(UnwrappedTSN tsn, Data data) {
+  return GetOrCreateStream(FullStreamId(data.is_unordered, data.stream_id))
+      .Add(tsn, std::move(data));
+}
+
+size_t InterleavedReassemblyStreams::HandleForwardTsn(
+    UnwrappedTSN new_cumulative_ack_tsn,
+    rtc::ArrayView<const AnyForwardTsnChunk::SkippedStream> skipped_streams) {
+  // Unlike FORWARD-TSN, I-FORWARD-TSN lists the skipped messages of both
+  // ordered and unordered streams, so `new_cumulative_ack_tsn` isn't needed.
+  size_t bytes_removed = 0;
+  for (const auto& skipped_stream : skipped_streams) {
+    bytes_removed +=
+        GetOrCreateStream(
+            FullStreamId(skipped_stream.unordered, skipped_stream.stream_id))
+            .EraseTo(skipped_stream.message_id);
+  }
+  return bytes_removed;
+}
+
+void InterleavedReassemblyStreams::ResetStreams(
+    rtc::ArrayView<const StreamID> stream_ids) {
+  if (stream_ids.empty()) {
+    for (auto& entry : streams_) {
+      RTC_DLOG(LS_VERBOSE) << log_prefix_ << "Resetting implicit stream_id="
+                           << *entry.first.stream_id;
+      entry.second.Reset();
+    }
+  } else {
+    for (StreamID stream_id : stream_ids) {
+      for (IsUnordered unordered : {IsUnordered(false), IsUnordered(true)}) {
+        auto it = streams_.find(FullStreamId(unordered, stream_id));
+        if (it != streams_.end()) {
+          RTC_DLOG(LS_VERBOSE)
+              << log_prefix_ << "Resetting explicit stream_id=" << *stream_id;
+          it->second.Reset();
+        }
+      }
+    }
+  }
+}
+
+HandoverReadinessStatus InterleavedReassemblyStreams::GetHandoverReadiness()
+    const {
+  HandoverReadinessStatus status;
+  for (const auto& entry : streams_) {
+    if (entry.second.has_unassembled_chunks()) {
+      status.Add(
+          *entry.first.unordered
+              ? HandoverUnreadinessReason::kUnorderedStreamHasUnassembledChunks
+              : HandoverUnreadinessReason::kOrderedStreamHasUnassembledChunks);
+    }
+  }
+  return status;
+}
+
+void InterleavedReassemblyStreams::AddHandoverState(
+    DcSctpSocketHandoverState& state) {
+  for (const auto& entry : streams_) {
+    if (*entry.first.unordered) {
+      DcSctpSocketHandoverState::UnorderedStream state_stream;
+      state_stream.id = entry.first.stream_id.value();
+      state.rx.unordered_streams.push_back(std::move(state_stream));
+    } else {
+      DcSctpSocketHandoverState::OrderedStream state_stream;
+      state_stream.id = entry.first.stream_id.value();
+      state_stream.next_ssn = entry.second.next_mid().value();
+      state.rx.ordered_streams.push_back(std::move(state_stream));
+    }
+  }
+}
+
+}  // namespace dcsctp
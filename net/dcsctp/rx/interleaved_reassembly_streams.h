@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef NET_DCSCTP_RX_INTERLEAVED_REASSEMBLY_STREAMS_H_
+#define NET_DCSCTP_RX_INTERLEAVED_REASSEMBLY_STREAMS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "api/array_view.h"
+#include "net/dcsctp/common/sequence_numbers.h"
+#include "net/dcsctp/packet/chunk/forward_tsn_common.h"
+#include "net/dcsctp/packet/data.h"
+#include "net/dcsctp/rx/reassembly_streams.h"
+
+namespace dcsctp {
+
+// Handles reassembly of incoming data when interleaved message sending is
+// enabled on the association, i.e. when RFC8260 is in use.
+//
+// With I-DATA, fragments of different messages on the same stream may arrive
+// interleaved, so messages are identified by their Message Identifier (MID)
+// and fragments by their Fragment Sequence Number (FSN), rather than by their
+// TSNs being consecutive.
+class InterleavedReassemblyStreams : public ReassemblyStreams {
+ public:
+  InterleavedReassemblyStreams(
+      absl::string_view log_prefix,
+      OnAssembledMessage on_assembled_message,
+      const DcSctpSocketHandoverState* handover_state = nullptr);
+
+  int Add(UnwrappedTSN tsn, Data data) override;
+
+  size_t HandleForwardTsn(
+      UnwrappedTSN new_cumulative_ack_tsn,
+      rtc::ArrayView<const AnyForwardTsnChunk::SkippedStream> skipped_streams)
+      override;
+
+  void ResetStreams(rtc::ArrayView<const StreamID> stream_ids) override;
+
+  HandoverReadinessStatus GetHandoverReadiness() const override;
+  void AddHandoverState(DcSctpSocketHandoverState& state) override;
+
+ private:
+  // Ordered and unordered messages are sent on separate streams, each having
+  // their own MID sequence.
+  struct FullStreamId {
+    FullStreamId(IsUnordered unordered, StreamID stream_id)
+        : unordered(unordered), stream_id(stream_id) {}
+
+    friend bool operator<(FullStreamId a, FullStreamId b) {
+      return std::make_pair(*a.unordered, *a.stream_id) <
+             std::make_pair(*b.unordered, *b.stream_id);
+    }
+
+    IsUnordered unordered;
+    StreamID stream_id;
+  };
+
+  // Manages all received data for a specific ordered or unordered stream, and
+  // assembles messages when possible.
+  class Stream {
+   public:
+    Stream(FullStreamId stream_id,
+           InterleavedReassemblyStreams* parent,
+           MID next_mid = MID(0))
+        : stream_id_(stream_id),
+          parent_(*parent),
+          next_mid_(mid_unwrapper_.Unwrap(next_mid)) {}
+    int Add(UnwrappedTSN tsn, Data data);
+    // Returns the number of bytes removed from the queue.
+    size_t EraseTo(MID message_id);
+    void Reset() {
+      mid_unwrapper_.Reset();
+      next_mid_ = mid_unwrapper_.Unwrap(MID(0));
+    }
+    MID next_mid() const { return next_mid_.Wrap(); }
+    bool has_unassembled_chunks() const { return !chunks_by_mid_.empty(); }
+
+   private:
+    // The fragments of a message, in FSN order.
+    using ChunkMap = std::map<FSN, std::pair<UnwrappedTSN, Data>>;
+
+    // Assembles the message identified by `mid` if all its fragments have been
+    // received and, for ordered streams, it's the next one to be delivered.
+    // Returns the number of bytes assembled.
+    size_t TryToAssembleMessage(UnwrappedMID mid);
+    size_t TryToAssembleMessages();
+    // Delivers a complete message and returns its size.
+    size_t AssembleMessage(ChunkMap& chunks);
+
+    const FullStreamId stream_id_;
+    InterleavedReassemblyStreams& parent_;
+    // This must be an ordered container to be able to iterate in MID order.
+    std::map<UnwrappedMID, ChunkMap> chunks_by_mid_;
+    UnwrappedMID::Unwrapper mid_unwrapper_;
+    // Only used by ordered streams.
+    UnwrappedMID next_mid_;
+  };
+
+  Stream& GetOrCreateStream(const FullStreamId& stream_id);
+
+  const std::string log_prefix_;
+
+  // Callback for when a message has been assembled.
+  const OnAssembledMessage on_assembled_message_;
+
+  // All unordered and ordered streams, managing not-yet-assembled data.
+  std::map<FullStreamId, Stream> streams_;
+};
+
+}  // namespace dcsctp
+
+#endif  // NET_DCSCTP_RX_INTERLEAVED_REASSEMBLY_STREAMS_H_
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "net/dcsctp/rx/interleaved_reassembly_streams.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "net/dcsctp/common/sequence_numbers.h"
+#include "net/dcsctp/packet/chunk/forward_tsn_common.h"
+#include "net/dcsctp/packet/data.h"
+#include "net/dcsctp/rx/reassembly_streams.h"
+#include "net/dcsctp/testing/data_generator.h"
+#include "rtc_base/gunit.h"
+#include "test/gmock.h"
+
+namespace dcsctp {
+namespace {
+using ::testing::ElementsAre;
+using ::testing::InSequence;
+using ::testing::MockFunction;
+using ::testing::NiceMock;
+using ::testing::Property;
+
+class InterleavedReassemblyStreamsTest : public testing::Test {
+ protected:
+  UnwrappedTSN tsn(uint32_t value) { return tsn_.Unwrap(TSN(value)); }
+
+  InterleavedReassemblyStreamsTest() {}
+  DataGenerator gen_;
+  UnwrappedTSN::Unwrapper tsn_;
+};
+
+TEST_F(InterleavedReassemblyStreamsTest,
+       AddUnorderedMessageReturnsCorrectSize) {
+  NiceMock<MockFunction<ReassemblyStreams::OnAssembledMessage>> on_assembled;
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  EXPECT_EQ(streams.Add(tsn(1), gen_.Unordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), gen_.Unordered({2, 3, 4})), 3);
+  EXPECT_EQ(streams.Add(tsn(3), gen_.Unordered({5, 6})), 2);
+  // Adding the end fragment should make it empty again.
+  EXPECT_EQ(streams.Add(tsn(4), gen_.Unordered({7}, "E")), -6);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest,
+       AddSimpleOrderedMessageReturnsCorrectSize) {
+  NiceMock<MockFunction<ReassemblyStreams::OnAssembledMessage>> on_assembled;
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  EXPECT_EQ(streams.Add(tsn(1), gen_.Ordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), gen_.Ordered({2, 3, 4})), 3);
+  EXPECT_EQ(streams.Add(tsn(3), gen_.Ordered({5, 6})), 2);
+  EXPECT_EQ(streams.Add(tsn(4), gen_.Ordered({7}, "E")), -6);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest,
+       AssemblesMessagesInterleavedOnTheSameStream) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+  {
+    InSequence s;
+    EXPECT_CALL(on_assembled,
+                Call(ElementsAre(tsn(1), tsn(3), tsn(5)),
+                     Property(&DcSctpMessage::payload, ElementsAre(1, 3, 5))));
+    EXPECT_CALL(on_assembled,
+                Call(ElementsAre(tsn(2), tsn(4)),
+                     Property(&DcSctpMessage::payload, ElementsAre(2, 4))));
+  }
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  DataGenerator gen0(MID(0));
+  DataGenerator gen1(MID(1));
+  EXPECT_EQ(streams.Add(tsn(1), gen0.Ordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), gen1.Ordered({2}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(3), gen0.Ordered({3})), 1);
+  // The second message is complete, but must wait for the first one.
+  EXPECT_EQ(streams.Add(tsn(4), gen1.Ordered({4}, "E")), 1);
+  EXPECT_EQ(streams.Add(tsn(5), gen0.Ordered({5}, "E")), -4);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest,
+       DeliversUnorderedMessagesWhenComplete) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+  {
+    InSequence s;
+    EXPECT_CALL(on_assembled,
+                Call(ElementsAre(tsn(2), tsn(4)),
+                     Property(&DcSctpMessage::payload, ElementsAre(2, 4))));
+    EXPECT_CALL(on_assembled,
+                Call(ElementsAre(tsn(1), tsn(3)),
+                     Property(&DcSctpMessage::payload, ElementsAre(1, 3))));
+  }
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  DataGenerator gen0(MID(0));
+  DataGenerator gen1(MID(1));
+  EXPECT_EQ(streams.Add(tsn(1), gen0.Unordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), gen1.Unordered({2}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(4), gen1.Unordered({4}, "E")), -1);
+  EXPECT_EQ(streams.Add(tsn(3), gen0.Unordered({3}, "E")), -1);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest, IgnoresDuplicateFragments) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+  EXPECT_CALL(on_assembled,
+              Call(ElementsAre(tsn(1), tsn(2)),
+                   Property(&DcSctpMessage::payload, ElementsAre(1, 2))));
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  Data first = gen_.Ordered({1}, "B");
+  EXPECT_EQ(streams.Add(tsn(1), first.Clone()), 1);
+  EXPECT_EQ(streams.Add(tsn(1), std::move(first)), 0);
+  EXPECT_EQ(streams.Add(tsn(2), gen_.Ordered({2}, "E")), -1);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest,
+       ForwardTsnSkipsMessageAndDeliversFollowing) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+  EXPECT_CALL(on_assembled,
+              Call(ElementsAre(tsn(2)),
+                   Property(&DcSctpMessage::payload, ElementsAre(2, 3))));
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  DataGenerator gen0(MID(0));
+  DataGenerator gen1(MID(1));
+  EXPECT_EQ(streams.Add(tsn(1), gen0.Ordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), gen1.Ordered({2, 3}, "BE")), 2);
+
+  AnyForwardTsnChunk::SkippedStream skipped[] = {
+      AnyForwardTsnChunk::SkippedStream(IsUnordered(false), StreamID(1),
+                                        MID(0))};
+  EXPECT_EQ(streams.HandleForwardTsn(tsn(1), skipped), 3u);
+
+  // Fragments of the skipped message are ignored.
+  EXPECT_EQ(streams.Add(tsn(3), gen0.Ordered({4}, "E")), 0);
+}
+
+TEST_F(InterleavedReassemblyStreamsTest, KeepsOrderedAndUnorderedApart) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+  EXPECT_CALL(on_assembled,
+              Call(ElementsAre(tsn(2)),
+                   Property(&DcSctpMessage::payload, ElementsAre(2))));
+
+  InterleavedReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  // Both messages have MID 0, but on different streams.
+  EXPECT_EQ(streams.Add(tsn(1), DataGenerator().Ordered({1}, "B")), 1);
+  EXPECT_EQ(streams.Add(tsn(2), DataGenerator().Unordered({2}, "BE")), 0);
+
+  EXPECT_EQ(streams.GetHandoverReadiness(),
+            HandoverReadinessStatus(
+                HandoverUnreadinessReason::kOrderedStreamHasUnassembledChunks));
+}
+
+}  // namespace
+}  // namespace dcsctp
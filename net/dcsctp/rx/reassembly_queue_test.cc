@@ -226,6 +226,32 @@ TEST_F(ReassemblyQueueTest, ForwardTSNRemoveOrdered) {
               ElementsAre(SctpMessageIs(kStreamID, kPPID, kMessage2Payload)));
 }
 
+TEST_F(ReassemblyQueueTest, IForwardTSNRemoveInterleavedOrdered) {
+  ReassemblyQueue reasm("log: ", TSN(10), kBufferSize,
+                        /*use_message_interleaving=*/true);
+  DataGenerator gen0(MID(0));
+  DataGenerator gen1(MID(1));
+  // The fragments of two messages are interleaved, and the second fragment of
+  // the first message (TSN 12) is lost.
+  reasm.Add(TSN(10), gen0.Ordered({1}, "B"));
+  reasm.Add(TSN(11), gen1.Ordered({5}, "B"));
+  reasm.Add(TSN(13), gen1.Ordered({6}));
+  reasm.Add(TSN(14), gen1.Ordered({7}));
+  reasm.Add(TSN(15), gen1.Ordered({8}, "E"));
+  EXPECT_EQ(reasm.queued_bytes(), 5u);
+
+  EXPECT_FALSE(reasm.HasMessages());
+
+  reasm.Handle(IForwardTsnChunk(
+      TSN(12), {IForwardTsnChunk::SkippedStream(IsUnordered(false), kStreamID,
+                                                kMID)}));
+  EXPECT_EQ(reasm.queued_bytes(), 0u);
+
+  EXPECT_TRUE(reasm.HasMessages());
+  EXPECT_THAT(reasm.FlushMessages(),
+              ElementsAre(SctpMessageIs(kStreamID, kPPID, kMessage2Payload)));
+}
+
 TEST_F(ReassemblyQueueTest, ForwardTSNRemoveALotOrdered) {
   ReassemblyQueue reasm("log: ", TSN(10), kBufferSize);
   reasm.Add(TSN(10), gen_.Ordered({1}, "B"));
@@ -369,7 +395,8 @@ TEST_F(ReassemblyQueueTest, HandoverInInitialState) {
   DcSctpSocketHandoverState state;
   reasm1.AddHandoverState(state);
   g_handover_state_transformer_for_test(&state);
-  ReassemblyQueue reasm2("log: ", TSN(100), kBufferSize, &state);
+  ReassemblyQueue reasm2("log: ", TSN(100), kBufferSize,
+                         /*use_message_interleaving=*/false, &state);
 
   reasm2.Add(TSN(10), gen_.Ordered({1, 2, 3, 4}, "BE"));
   EXPECT_THAT(reasm2.FlushMessages(), SizeIs(1));
@@ -384,7 +411,8 @@ TEST_F(ReassemblyQueueTest, HandoverAfterHavingAssembedOneMessage) {
   DcSctpSocketHandoverState state;
   reasm1.AddHandoverState(state);
   g_handover_state_transformer_for_test(&state);
-  ReassemblyQueue reasm2("log: ", TSN(100), kBufferSize, &state);
+  ReassemblyQueue reasm2("log: ", TSN(100), kBufferSize,
+                         /*use_message_interleaving=*/false, &state);
 
   reasm2.Add(TSN(11), gen_.Ordered({1, 2, 3, 4}, "BE"));
   EXPECT_THAT(reasm2.FlushMessages(), SizeIs(1));
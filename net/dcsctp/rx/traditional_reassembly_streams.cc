@@ -13,70 +13,21 @@
 
 #include <cstdint>
 #include <functional>
-#include <iterator>
 #include <map>
 #include <numeric>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "net/dcsctp/common/sequence_numbers.h"
 #include "net/dcsctp/packet/chunk/forward_tsn_common.h"
 #include "net/dcsctp/packet/data.h"
 #include "net/dcsctp/public/dcsctp_message.h"
+#include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 
 namespace dcsctp {
-namespace {
-
-// Given a map (`chunks`) and an iterator to within that map (`iter`), this
-// function will return an iterator to the first chunk in that message, which
-// has the `is_beginning` flag set. If there are any gaps, or if the beginning
-// can't be found, `absl::nullopt` is returned.
-absl::optional<std::map<UnwrappedTSN, Data>::iterator> FindBeginning(
-    const std::map<UnwrappedTSN, Data>& chunks,
-    std::map<UnwrappedTSN, Data>::iterator iter) {
-  UnwrappedTSN prev_tsn = iter->first;
-  for (;;) {
-    if (iter->second.is_beginning) {
-      return iter;
-    }
-    if (iter == chunks.begin()) {
-      return absl::nullopt;
-    }
-    --iter;
-    if (iter->first.next_value() != prev_tsn) {
-      return absl::nullopt;
-    }
-    prev_tsn = iter->first;
-  }
-}
-
-// Given a map (`chunks`) and an iterator to within that map (`iter`), this
-// function will return an iterator to the chunk after the last chunk in that
-// message, which has the `is_end` flag set. If there are any gaps, or if the
-// end can't be found, `absl::nullopt` is returned.
-absl::optional<std::map<UnwrappedTSN, Data>::iterator> FindEnd(
-    std::map<UnwrappedTSN, Data>& chunks,
-    std::map<UnwrappedTSN, Data>::iterator iter) {
-  UnwrappedTSN prev_tsn = iter->first;
-  for (;;) {
-    if (iter->second.is_end) {
-      return ++iter;
-    }
-    ++iter;
-    if (iter == chunks.end()) {
-      return absl::nullopt;
-    }
-    if (iter->first != prev_tsn.next_value()) {
-      return absl::nullopt;
-    }
-    prev_tsn = iter->first;
-  }
-}
-}  // namespace
 
 TraditionalReassemblyStreams::TraditionalReassemblyStreams(
     absl::string_view log_prefix,
@@ -102,107 +53,129 @@ TraditionalReassemblyStreams::TraditionalReassemblyStreams(
   }
 }
 
-int TraditionalReassemblyStreams::UnorderedStream::Add(UnwrappedTSN tsn,
-                                                       Data data) {
-  int queued_bytes = data.size();
-  auto p = chunks_.emplace(tsn, std::move(data));
-  if (!p.second /* !inserted */) {
-    return 0;
-  }
-
-  queued_bytes -= TryToAssembleMessage(p.first);
+TraditionalReassemblyStreams::PartialMessage::PartialMessage(UnwrappedTSN tsn,
+                                                             Data data)
+    : stream_id_(data.stream_id),
+      ppid_(data.ppid),
+      tsns_({tsn}),
+      payload_(std::move(data.payload).Release()),
+      is_complete_(*data.is_end) {
+  RTC_DCHECK(data.is_beginning);
+}
 
-  return queued_bytes;
+void TraditionalReassemblyStreams::PartialMessage::Append(UnwrappedTSN tsn,
+                                                          Data data) {
+  RTC_DCHECK(!is_complete_);
+  RTC_DCHECK(tsn == next_tsn());
+  tsns_.push_back(tsn);
+  payload_.insert(payload_.end(), data.payload.begin(), data.payload.end());
+  is_complete_ = *data.is_end;
 }
 
-size_t TraditionalReassemblyStreams::UnorderedStream::TryToAssembleMessage(
-    ChunkMap::iterator iter) {
-  // TODO(boivie): This method is O(N) with the number of fragments in a
-  // message, which can be inefficient for very large values of N. This could be
-  // optimized by e.g. only trying to assemble a message once _any_ beginning
-  // and _any_ end has been found.
-  absl::optional<ChunkMap::iterator> start = FindBeginning(chunks_, iter);
-  if (!start.has_value()) {
-    return 0;
-  }
-  absl::optional<ChunkMap::iterator> end = FindEnd(chunks_, iter);
-  if (!end.has_value()) {
-    return 0;
+void TraditionalReassemblyStreams::PartialMessage::AppendFrom(
+    ChunkMap& chunks) {
+  while (!is_complete_ && !chunks.empty()) {
+    auto it = chunks.find(next_tsn());
+    if (it == chunks.end() || it->second.is_beginning) {
+      return;
+    }
+    Append(it->first, std::move(it->second));
+    chunks.erase(it);
   }
-
-  size_t bytes_assembled = AssembleMessage(*start, *end);
-  chunks_.erase(*start, *end);
-  return bytes_assembled;
 }
 
 size_t TraditionalReassemblyStreams::StreamBase::AssembleMessage(
-    const ChunkMap::iterator start,
-    const ChunkMap::iterator end) {
-  size_t count = std::distance(start, end);
-
-  if (count == 1) {
-    // Fast path - zero-copy
-    const Data& data = start->second;
-    size_t payload_size = start->second.size();
-    UnwrappedTSN tsns[1] = {start->first};
-    DcSctpMessage message(data.stream_id, data.ppid, std::move(data.payload));
-    parent_.on_assembled_message_(tsns, std::move(message));
-    return payload_size;
-  }
-
-  // Slow path - will need to concatenate the payload.
-  std::vector<UnwrappedTSN> tsns;
-  std::vector<uint8_t> payload;
+    PartialMessage message) {
+  RTC_DCHECK(message.is_complete());
+  size_t payload_size = message.size();
+  parent_.on_assembled_message_(message.tsns(),
+                                std::move(message).ReleaseMessage());
+  return payload_size;
+}
 
-  size_t payload_size = std::accumulate(
-      start, end, 0,
-      [](size_t v, const auto& p) { return v + p.second.size(); });
+int TraditionalReassemblyStreams::UnorderedStream::Add(UnwrappedTSN tsn,
+                                                       Data data) {
+  int queued_bytes = data.size();
 
-  tsns.reserve(count);
-  payload.reserve(payload_size);
-  for (auto it = start; it != end; ++it) {
-    const Data& data = it->second;
-    tsns.push_back(it->first);
-    payload.insert(payload.end(), data.payload.begin(), data.payload.end());
+  // Unordered messages are only identified by their fragments having
+  // consecutive TSNs, so the message that `tsn` may belong to is the one that
+  // starts closest before it.
+  auto it = messages_.upper_bound(tsn);
+  if (it != messages_.begin()) {
+    --it;
+    PartialMessage& message = it->second;
+    if (message.Contains(tsn)) {
+      return 0;
+    }
+    if (!data.is_beginning && tsn == message.next_tsn()) {
+      message.Append(tsn, std::move(data));
+      message.AppendFrom(chunks_);
+      if (message.is_complete()) {
+        queued_bytes -= AssembleMessage(std::move(message));
+        messages_.erase(it);
+      }
+      return queued_bytes;
+    }
   }
 
-  DcSctpMessage message(start->second.stream_id, start->second.ppid,
-                        std::move(payload));
-  parent_.on_assembled_message_(tsns, std::move(message));
+  if (data.is_beginning) {
+    PartialMessage message(tsn, std::move(data));
+    message.AppendFrom(chunks_);
+    if (message.is_complete()) {
+      queued_bytes -= AssembleMessage(std::move(message));
+    } else {
+      messages_.emplace(tsn, std::move(message));
+    }
+    return queued_bytes;
+  }
 
-  return payload_size;
+  if (!chunks_.emplace(tsn, std::move(data)).second /* !inserted */) {
+    return 0;
+  }
+  return queued_bytes;
 }
 
 size_t TraditionalReassemblyStreams::UnorderedStream::EraseTo(
     UnwrappedTSN tsn) {
-  auto end_iter = chunks_.upper_bound(tsn);
+  // Messages are abandoned as a whole, so messages that start before `tsn` are
+  // removed completely.
+  auto end_message = messages_.upper_bound(tsn);
   size_t removed_bytes = std::accumulate(
-      chunks_.begin(), end_iter, 0,
+      messages_.begin(), end_message, size_t{0},
       [](size_t r, const auto& p) { return r + p.second.size(); });
+  messages_.erase(messages_.begin(), end_message);
 
+  auto end_iter = chunks_.upper_bound(tsn);
+  removed_bytes += std::accumulate(
+      chunks_.begin(), end_iter, size_t{0},
+      [](size_t r, const auto& p) { return r + p.second.size(); });
   chunks_.erase(chunks_.begin(), end_iter);
   return removed_bytes;
 }
 
-size_t TraditionalReassemblyStreams::OrderedStream::TryToAssembleMessage() {
-  if (chunks_by_ssn_.empty() || chunks_by_ssn_.begin()->first != next_ssn_) {
-    return 0;
-  }
-
-  ChunkMap& chunks = chunks_by_ssn_.begin()->second;
+size_t TraditionalReassemblyStreams::OrderedStream::Message::size() const {
+  return std::accumulate(chunks.begin(), chunks.end(),
+                         message.has_value() ? message->size() : 0,
+                         [](size_t r, const auto& p) {
+                           return r + p.second.size();
+                         });
+}
 
-  if (!chunks.begin()->second.is_beginning || !chunks.rbegin()->second.is_end) {
+size_t TraditionalReassemblyStreams::OrderedStream::TryToAssembleMessage() {
+  if (messages_by_ssn_.empty() ||
+      messages_by_ssn_.begin()->first != next_ssn_) {
     return 0;
   }
 
-  uint32_t tsn_diff =
-      UnwrappedTSN::Difference(chunks.rbegin()->first, chunks.begin()->first);
-  if (tsn_diff != chunks.size() - 1) {
+  Message& entry = messages_by_ssn_.begin()->second;
+  if (!entry.message.has_value() || !entry.message->is_complete()) {
     return 0;
   }
 
-  size_t assembled_bytes = AssembleMessage(chunks.begin(), chunks.end());
-  chunks_by_ssn_.erase(chunks_by_ssn_.begin());
+  // Any remaining chunks can't be part of the message, and are dropped.
+  size_t assembled_bytes = entry.size();
+  AssembleMessage(std::move(*entry.message));
+  messages_by_ssn_.erase(messages_by_ssn_.begin());
   next_ssn_.Increment();
   return assembled_bytes;
 }
@@ -225,8 +198,30 @@ int TraditionalReassemblyStreams::OrderedStream::Add(UnwrappedTSN tsn,
   int queued_bytes = data.size();
 
   UnwrappedSSN ssn = ssn_unwrapper_.Unwrap(data.ssn);
-  auto p = chunks_by_ssn_[ssn].emplace(tsn, std::move(data));
-  if (!p.second /* !inserted */) {
+  if (ssn == next_ssn_ && data.is_beginning && data.is_end &&
+      messages_by_ssn_.find(ssn) == messages_by_ssn_.end()) {
+    // Fast path - an unfragmented message that can be delivered directly.
+    queued_bytes -= AssembleMessage(PartialMessage(tsn, std::move(data)));
+    next_ssn_.Increment();
+    queued_bytes -= TryToAssembleMessages();
+    return queued_bytes;
+  }
+
+  Message& entry = messages_by_ssn_[ssn];
+  absl::optional<PartialMessage>& message = entry.message;
+  if (message.has_value() && message->Contains(tsn)) {
+    return 0;
+  }
+
+  if (!message.has_value() && data.is_beginning) {
+    message.emplace(tsn, std::move(data));
+    message->AppendFrom(entry.chunks);
+  } else if (message.has_value() && !message->is_complete() &&
+             !data.is_beginning && tsn == message->next_tsn()) {
+    message->Append(tsn, std::move(data));
+    message->AppendFrom(entry.chunks);
+  } else if (!entry.chunks.emplace(tsn, std::move(data)).second
+             /* !inserted */) {
     return 0;
   }
 
@@ -240,15 +235,11 @@ int TraditionalReassemblyStreams::OrderedStream::Add(UnwrappedTSN tsn,
 size_t TraditionalReassemblyStreams::OrderedStream::EraseTo(SSN ssn) {
   UnwrappedSSN unwrapped_ssn = ssn_unwrapper_.Unwrap(ssn);
 
-  auto end_iter = chunks_by_ssn_.upper_bound(unwrapped_ssn);
+  auto end_iter = messages_by_ssn_.upper_bound(unwrapped_ssn);
   size_t removed_bytes = std::accumulate(
-      chunks_by_ssn_.begin(), end_iter, 0, [](size_t r1, const auto& p) {
-        return r1 +
-               absl::c_accumulate(p.second, 0, [](size_t r2, const auto& q) {
-                 return r2 + q.second.size();
-               });
-      });
-  chunks_by_ssn_.erase(chunks_by_ssn_.begin(), end_iter);
+      messages_by_ssn_.begin(), end_iter, size_t{0},
+      [](size_t r, const auto& p) { return r + p.second.size(); });
+  messages_by_ssn_.erase(messages_by_ssn_.begin(), end_iter);
 
   if (unwrapped_ssn >= next_ssn_) {
     unwrapped_ssn.Increment();
@@ -14,12 +14,16 @@
 
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "api/array_view.h"
 #include "net/dcsctp/common/sequence_numbers.h"
 #include "net/dcsctp/packet/chunk/forward_tsn_common.h"
 #include "net/dcsctp/packet/data.h"
+#include "net/dcsctp/public/dcsctp_message.h"
 #include "net/dcsctp/rx/reassembly_streams.h"
 
 namespace dcsctp {
@@ -49,14 +53,54 @@ class TraditionalReassemblyStreams : public ReassemblyStreams {
  private:
   using ChunkMap = std::map<UnwrappedTSN, Data>;
 
+  // A message that is being reassembled. Its fragments are gathered, in TSN
+  // order, into a single buffer as they arrive, which is then handed over as
+  // the message's payload once the last fragment has been added. The payload
+  // of the first fragment becomes that buffer, so unfragmented messages are
+  // never copied.
+  class PartialMessage {
+   public:
+    // Starts a message with its first fragment.
+    PartialMessage(UnwrappedTSN tsn, Data data);
+
+    // Adds `data`, the fragment with the TSN after the last one added.
+    void Append(UnwrappedTSN tsn, Data data);
+
+    // Adds the fragments that directly follow the last one added, which are
+    // removed from `chunks`.
+    void AppendFrom(ChunkMap& chunks);
+
+    // Indicates if `tsn` is one of the fragments that have been added.
+    bool Contains(UnwrappedTSN tsn) const {
+      return tsn >= tsns_.front() && tsn <= tsns_.back();
+    }
+
+    // The TSN of the fragment that should be added next.
+    UnwrappedTSN next_tsn() const { return tsns_.back().next_value(); }
+    bool is_complete() const { return is_complete_; }
+    size_t size() const { return payload_.size(); }
+
+    rtc::ArrayView<const UnwrappedTSN> tsns() const { return tsns_; }
+    DcSctpMessage ReleaseMessage() && {
+      return DcSctpMessage(stream_id_, ppid_, std::move(payload_));
+    }
+
+   private:
+    const StreamID stream_id_;
+    const PPID ppid_;
+    std::vector<UnwrappedTSN> tsns_;
+    std::vector<uint8_t> payload_;
+    bool is_complete_;
+  };
+
   // Base class for `UnorderedStream` and `OrderedStream`.
   class StreamBase {
    protected:
     explicit StreamBase(TraditionalReassemblyStreams* parent)
         : parent_(*parent) {}
 
-    size_t AssembleMessage(const ChunkMap::iterator start,
-                           const ChunkMap::iterator end);
+    // Delivers a complete message and returns its size.
+    size_t AssembleMessage(PartialMessage message);
     TraditionalReassemblyStreams& parent_;
   };
 
@@ -69,16 +113,14 @@ class TraditionalReassemblyStreams : public ReassemblyStreams {
     int Add(UnwrappedTSN tsn, Data data);
     // Returns the number of bytes removed from the queue.
     size_t EraseTo(UnwrappedTSN tsn);
-    bool has_unassembled_chunks() const { return !chunks_.empty(); }
+    bool has_unassembled_chunks() const {
+      return !messages_.empty() || !chunks_.empty();
+    }
 
    private:
-    // Given an iterator to any chunk within the map, try to assemble a message
-    // into `reassembled_messages` containing it and - if successful - erase
-    // those chunks from the stream chunks map.
-    //
-    // Returns the number of bytes that were assembled.
-    size_t TryToAssembleMessage(ChunkMap::iterator iter);
-
+    // Messages that are being reassembled, by the TSN of their first fragment.
+    std::map<UnwrappedTSN, PartialMessage> messages_;
+    // Fragments that were received before the fragment preceding them.
     ChunkMap chunks_;
   };
 
@@ -96,15 +138,25 @@ class TraditionalReassemblyStreams : public ReassemblyStreams {
       next_ssn_ = ssn_unwrapper_.Unwrap(SSN(0));
     }
     SSN next_ssn() const { return next_ssn_.Wrap(); }
-    bool has_unassembled_chunks() const { return !chunks_by_ssn_.empty(); }
+    bool has_unassembled_chunks() const { return !messages_by_ssn_.empty(); }
 
    private:
+    struct Message {
+      // The number of payload bytes that are held.
+      size_t size() const;
+
+      // Present when the first fragment has been received.
+      absl::optional<PartialMessage> message;
+      // Fragments that were received before the fragment preceding them.
+      ChunkMap chunks;
+    };
+
     // Try to assemble one or several messages in order from the stream.
     // Returns the number of bytes assembled if a message was assembled.
     size_t TryToAssembleMessage();
     size_t TryToAssembleMessages();
     // This must be an ordered container to be able to iterate in SSN order.
-    std::map<UnwrappedSSN, ChunkMap> chunks_by_ssn_;
+    std::map<UnwrappedSSN, Message> messages_by_ssn_;
     UnwrappedSSN::Unwrapper ssn_unwrapper_;
     UnwrappedSSN next_ssn_;
   };
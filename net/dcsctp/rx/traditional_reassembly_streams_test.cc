@@ -25,8 +25,10 @@
 
 namespace dcsctp {
 namespace {
+using ::testing::ElementsAre;
 using ::testing::MockFunction;
 using ::testing::NiceMock;
+using ::testing::Property;
 
 class TraditionalReassemblyStreamsTest : public testing::Test {
  protected:
@@ -79,6 +81,48 @@ TEST_F(TraditionalReassemblyStreamsTest,
   EXPECT_EQ(streams.Add(tsn(2), std::move(late)), -8);
 }
 
+TEST_F(TraditionalReassemblyStreamsTest,
+       GathersUnorderedFragmentsReceivedOutOfOrder) {
+  MockFunction<ReassemblyStreams::OnAssembledMessage> on_assembled;
+
+  TraditionalReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  Data a1 = gen_.Unordered({1}, "B");
+  Data a2 = gen_.Unordered({2, 3});
+  Data a3 = gen_.Unordered({4}, "E");
+  Data b1 = gen_.Unordered({5, 6}, "B");
+  Data b2 = gen_.Unordered({7}, "E");
+
+  EXPECT_EQ(streams.Add(tsn(3), std::move(a3)), 1);
+  EXPECT_EQ(streams.Add(tsn(5), std::move(b2)), 1);
+  EXPECT_EQ(streams.Add(tsn(1), std::move(a1)), 1);
+
+  EXPECT_CALL(on_assembled,
+              Call(ElementsAre(tsn(4), tsn(5)),
+                   Property(&DcSctpMessage::payload, ElementsAre(5, 6, 7))));
+  EXPECT_EQ(streams.Add(tsn(4), std::move(b1)), -1);
+
+  EXPECT_CALL(on_assembled, Call(ElementsAre(tsn(1), tsn(2), tsn(3)),
+                                 Property(&DcSctpMessage::payload,
+                                          ElementsAre(1, 2, 3, 4))));
+  EXPECT_EQ(streams.Add(tsn(2), std::move(a2)), -2);
+}
+
+TEST_F(TraditionalReassemblyStreamsTest, IgnoresDuplicateFragments) {
+  NiceMock<MockFunction<ReassemblyStreams::OnAssembledMessage>> on_assembled;
+
+  TraditionalReassemblyStreams streams("", on_assembled.AsStdFunction());
+
+  Data first = gen_.Ordered({1}, "B");
+  Data middle = gen_.Ordered({2, 3});
+  Data last = gen_.Ordered({4}, "E");
+  EXPECT_EQ(streams.Add(tsn(1), first.Clone()), 1);
+  EXPECT_EQ(streams.Add(tsn(2), middle.Clone()), 2);
+  EXPECT_EQ(streams.Add(tsn(1), first.Clone()), 0);
+  EXPECT_EQ(streams.Add(tsn(2), middle.Clone()), 0);
+  EXPECT_EQ(streams.Add(tsn(3), std::move(last)), -3);
+}
+
 TEST_F(TraditionalReassemblyStreamsTest,
        DeleteUnorderedMessageReturnsCorrectSize) {
   NiceMock<MockFunction<ReassemblyStreams::OnAssembledMessage>> on_assembled;
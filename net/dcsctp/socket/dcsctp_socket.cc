@@ -330,6 +330,7 @@ void DcSctpSocket::RestoreFromState(const DcSctpSocketHandoverState& state) {
           TSN(state.peer_initial_tsn), static_cast<size_t>(0),
           TieTag(state.tie_tag), packet_sender_,
           [this]() { return state_ == State::kEstablished; }, &state);
+      send_queue_.EnableMessageInterleaving(capabilities.message_interleaving);
       RTC_DLOG(LS_VERBOSE) << log_prefix() << "Created peer TCB from state: "
                            << tcb_->ToString();
 
@@ -799,7 +800,7 @@ bool DcSctpSocket::Dispatch(const CommonHeader& header,
       HandleIData(header, descriptor);
       break;
     case IForwardTsnChunk::kType:
-      HandleForwardTsn(header, descriptor);
+      HandleIForwardTsn(header, descriptor);
       break;
     default:
       return HandleUnrecognizedChunk(descriptor);
@@ -950,6 +951,28 @@ bool DcSctpSocket::ValidateHasTCB() {
   return false;
 }
 
+bool DcSctpSocket::ValidateMessageInterleaving(bool is_interleaved_chunk,
+                                               absl::string_view chunk_name) {
+  // https://tools.ietf.org/html/rfc8260#section-2.1
+  // "If I-DATA support has been negotiated for an association, I-DATA chunks
+  // MUST be used for all user messages and DATA chunks MUST NOT be used. If
+  // I-DATA support has not been negotiated for an association, DATA chunks
+  // MUST be used for all user messages and I-DATA chunks MUST NOT be used."
+  if (is_interleaved_chunk == tcb_->capabilities().message_interleaving) {
+    return true;
+  }
+
+  rtc::StringBuilder sb;
+  sb << "Received " << chunk_name << " chunk, but message interleaving was "
+     << (is_interleaved_chunk ? "not " : "")
+     << "negotiated during connection establishment";
+  packet_sender_.Send(tcb_->PacketBuilder().Add(AbortChunk(
+      /*filled_in_verification_tag=*/true,
+      Parameters::Builder().Add(ProtocolViolationCause(sb.str())).Build())));
+  InternalClose(ErrorKind::kProtocolViolation, sb.str());
+  return false;
+}
+
 void DcSctpSocket::ReportFailedToParseChunk(int chunk_type) {
   rtc::StringBuilder sb;
   sb << "Failed to parse chunk of type: " << chunk_type;
@@ -959,7 +982,8 @@ void DcSctpSocket::ReportFailedToParseChunk(int chunk_type) {
 void DcSctpSocket::HandleData(const CommonHeader& header,
                               const SctpPacket::ChunkDescriptor& descriptor) {
   absl::optional<DataChunk> chunk = DataChunk::Parse(descriptor.data);
-  if (ValidateParseSuccess(chunk) && ValidateHasTCB()) {
+  if (ValidateParseSuccess(chunk) && ValidateHasTCB() &&
+      ValidateMessageInterleaving(/*is_interleaved_chunk=*/false, "DATA")) {
     HandleDataCommon(*chunk);
   }
 }
@@ -967,7 +991,8 @@ void DcSctpSocket::HandleData(const CommonHeader& header,
 void DcSctpSocket::HandleIData(const CommonHeader& header,
                                const SctpPacket::ChunkDescriptor& descriptor) {
   absl::optional<IDataChunk> chunk = IDataChunk::Parse(descriptor.data);
-  if (ValidateParseSuccess(chunk) && ValidateHasTCB()) {
+  if (ValidateParseSuccess(chunk) && ValidateHasTCB() &&
+      ValidateMessageInterleaving(/*is_interleaved_chunk=*/true, "I-DATA")) {
     HandleDataCommon(*chunk);
   }
 }
@@ -1191,6 +1216,7 @@ void DcSctpSocket::HandleInitAck(
       connect_params_.initial_tsn, chunk->initiate_tag(), chunk->initial_tsn(),
       chunk->a_rwnd(), MakeTieTag(callbacks_), packet_sender_,
       [this]() { return state_ == State::kEstablished; });
+  send_queue_.EnableMessageInterleaving(capabilities.message_interleaving);
   RTC_DLOG(LS_VERBOSE) << log_prefix()
                        << "Created peer TCB: " << tcb_->ToString();
 
@@ -1252,6 +1278,8 @@ void DcSctpSocket::HandleCookieEcho(
         connect_params_.initial_tsn, cookie->initiate_tag(),
         cookie->initial_tsn(), cookie->a_rwnd(), MakeTieTag(callbacks_),
         packet_sender_, [this]() { return state_ == State::kEstablished; });
+    send_queue_.EnableMessageInterleaving(
+        cookie->capabilities().message_interleaving);
     RTC_DLOG(LS_VERBOSE) << log_prefix()
                          << "Created peer TCB: " << tcb_->ToString();
   }
@@ -1571,7 +1599,9 @@ void DcSctpSocket::HandleForwardTsn(
     const SctpPacket::ChunkDescriptor& descriptor) {
   absl::optional<ForwardTsnChunk> chunk =
       ForwardTsnChunk::Parse(descriptor.data);
-  if (ValidateParseSuccess(chunk) && ValidateHasTCB()) {
+  if (ValidateParseSuccess(chunk) && ValidateHasTCB() &&
+      ValidateMessageInterleaving(/*is_interleaved_chunk=*/false,
+                                  "FORWARD-TSN")) {
     HandleForwardTsnCommon(*chunk);
   }
 }
@@ -1581,7 +1611,9 @@ void DcSctpSocket::HandleIForwardTsn(
     const SctpPacket::ChunkDescriptor& descriptor) {
   absl::optional<IForwardTsnChunk> chunk =
       IForwardTsnChunk::Parse(descriptor.data);
-  if (ValidateParseSuccess(chunk) && ValidateHasTCB()) {
+  if (ValidateParseSuccess(chunk) && ValidateHasTCB() &&
+      ValidateMessageInterleaving(/*is_interleaved_chunk=*/true,
+                                  "I-FORWARD-TSN")) {
     HandleForwardTsnCommon(*chunk);
   }
 }
@@ -171,6 +171,12 @@ class DcSctpSocket : public DcSctpSocketInterface {
   void DeliverReassembledMessages();
   // Returns true if there is a TCB, and false otherwise (and reports an error).
   bool ValidateHasTCB();
+  // Returns true if a received chunk named `chunk_name` is of the kind that
+  // should be used on this association, given if message interleaving has been
+  // negotiated and if the chunk is an interleaved one (e.g. I-DATA). If not,
+  // the association is aborted and false is returned.
+  bool ValidateMessageInterleaving(bool is_interleaved_chunk,
+                                   absl::string_view chunk_name);
 
   // Returns true if the parsing of a chunk of type `T` succeeded. If it didn't,
   // it reports an error and returns false.
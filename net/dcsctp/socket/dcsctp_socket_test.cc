@@ -9,7 +9,9 @@
  */
 #include "net/dcsctp/socket/dcsctp_socket.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
 #include <deque>
 #include <memory>
 #include <string>
@@ -49,6 +51,7 @@
 #include "net/dcsctp/socket/mock_dcsctp_socket_callbacks.h"
 #include "net/dcsctp/testing/testing_macros.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/time_utils.h"
 #include "test/gmock.h"
 
 ABSL_FLAG(bool, dcsctp_capture_packets, false, "Print packet capture.");
@@ -2075,5 +2078,256 @@ TEST_F(DcSctpSocketTest, BothCanDetectDcsctpImplementation) {
   EXPECT_EQ(sock_a_->peer_implementation(), SctpImplementation::kDcsctp);
   EXPECT_EQ(sock_z_->peer_implementation(), SctpImplementation::kDcsctp);
 }
+
+class DcSctpSocketInterleavingTest : public DcSctpSocketTest {
+ protected:
+  DcSctpSocketInterleavingTest()
+      : DcSctpSocketTest(/*enable_message_interleaving=*/true) {}
+};
+
+TEST_F(DcSctpSocketInterleavingTest, SmallMessageIsNotDelayedByLargeMessage) {
+  ConnectSockets();
+
+  sock_a_->Send(DcSctpMessage(StreamID(1), PPID(53),
+                              std::vector<uint8_t>(kLargeMessageSize)),
+                kSendOptions);
+  sock_a_->Send(DcSctpMessage(StreamID(2), PPID(53),
+                              std::vector<uint8_t>(kSmallMessageSize)),
+                kSendOptions);
+  ExchangeMessages(*sock_a_, cb_a_, *sock_z_, cb_z_);
+
+  // The small message is sent in between fragments of the large message, and
+  // is received before it.
+  ASSERT_HAS_VALUE_AND_ASSIGN(DcSctpMessage msg1,
+                              cb_z_.ConsumeReceivedMessage());
+  EXPECT_EQ(msg1.stream_id(), StreamID(2));
+  ASSERT_HAS_VALUE_AND_ASSIGN(DcSctpMessage msg2,
+                              cb_z_.ConsumeReceivedMessage());
+  EXPECT_EQ(msg2.stream_id(), StreamID(1));
+  EXPECT_THAT(msg2.payload(), SizeIs(kLargeMessageSize));
+}
+
+TEST_F(DcSctpSocketInterleavingTest, ReceivingDataChunkAborts) {
+  ConnectSockets();
+
+  // I-DATA has been negotiated, so DATA chunks must not be used.
+  EXPECT_CALL(cb_z_, OnAborted(ErrorKind::kProtocolViolation, _));
+  AnyDataChunk::Options opts;
+  opts.is_beginning = Data::IsBeginning(true);
+  opts.is_end = Data::IsEnd(true);
+  sock_z_->ReceivePacket(
+      SctpPacket::Builder(sock_z_->verification_tag(), options_)
+          .Add(DataChunk(TSN(1), StreamID(1), SSN(0), PPID(53),
+                         std::vector<uint8_t>(kSmallMessageSize), opts))
+          .Build());
+  EXPECT_EQ(sock_z_->state(), SocketState::kClosed);
+
+  EXPECT_CALL(cb_a_, OnAborted(ErrorKind::kPeerReported, _));
+  sock_a_->ReceivePacket(cb_z_.ConsumeSentPacket());
+  EXPECT_EQ(sock_a_->state(), SocketState::kClosed);
+}
+
+TEST_F(DcSctpSocketInterleavingTest, SkipsAbandonedMessageWithIForwardTsn) {
+  ConnectSockets();
+
+  SendOptions send_options;
+  send_options.max_retransmissions = 0;
+  std::vector<uint8_t> payload(options_.mtu - 100);
+  sock_a_->Send(DcSctpMessage(StreamID(1), PPID(51), payload), send_options);
+  sock_a_->Send(DcSctpMessage(StreamID(1), PPID(52), payload), send_options);
+  sock_a_->Send(DcSctpMessage(StreamID(1), PPID(53), payload), send_options);
+
+  sock_z_->ReceivePacket(cb_a_.ConsumeSentPacket());
+  // Second I-DATA (lost)
+  cb_a_.ConsumeSentPacket();
+  sock_z_->ReceivePacket(cb_a_.ConsumeSentPacket());
+  ExchangeMessages(*sock_a_, cb_a_, *sock_z_, cb_z_);
+
+  // The lost message is abandoned when the t3-rtx timer expires, and skipped
+  // with an I-FORWARD-TSN, which lets the third message be delivered.
+  AdvanceTime(options_.rto_initial);
+  RunTimers();
+  ExchangeMessages(*sock_a_, cb_a_, *sock_z_, cb_z_);
+
+  ASSERT_HAS_VALUE_AND_ASSIGN(DcSctpMessage msg1,
+                              cb_z_.ConsumeReceivedMessage());
+  EXPECT_EQ(msg1.ppid(), PPID(51));
+  ASSERT_HAS_VALUE_AND_ASSIGN(DcSctpMessage msg2,
+                              cb_z_.ConsumeReceivedMessage());
+  EXPECT_EQ(msg2.ppid(), PPID(53));
+  EXPECT_FALSE(cb_z_.ConsumeReceivedMessage().has_value());
+}
+
+class DcSctpSocketThroughputTest : public DcSctpSocketTest {
+ protected:
+  // Transfers `file_size` bytes from A to Z, as messages of `message_size`
+  // bytes that are sent on each of `streams` in turn, and returns the
+  // throughput in MB/s. The send buffer is kept half full, like data channel
+  // applications do when sending files.
+  double Transfer(rtc::ArrayView<const StreamID> streams,
+                  size_t message_size,
+                  size_t file_size) {
+    size_t bytes_sent = 0;
+    size_t bytes_received = 0;
+    size_t next_stream = 0;
+    int64_t start_us = rtc::TimeMicros();
+    while (bytes_received < file_size) {
+      while (bytes_sent < file_size &&
+             bytes_sent - bytes_received < options_.max_send_buffer_size / 2) {
+        sock_a_->Send(DcSctpMessage(streams[next_stream], PPID(51),
+                                    std::vector<uint8_t>(message_size)),
+                      kSendOptions);
+        bytes_sent += message_size;
+        next_stream = (next_stream + 1) % streams.size();
+      }
+      ExchangeMessages(*sock_a_, cb_a_, *sock_z_, cb_z_);
+      for (;;) {
+        absl::optional<DcSctpMessage> msg = cb_z_.ConsumeReceivedMessage();
+        if (!msg.has_value()) {
+          break;
+        }
+        bytes_received += msg->payload().size();
+      }
+      // Let the last SACK, which may be delayed, be sent.
+      AdvanceTime(options_.delayed_ack_max_timeout);
+      RunTimers();
+    }
+    return static_cast<double>(file_size) / (rtc::TimeMicros() - start_us);
+  }
+};
+
+// Measures the throughput of file transfers between two sockets. There is no
+// packet loss, so the congestion window grows large.
+TEST_F(DcSctpSocketThroughputTest, DISABLED_FileTransfer) {
+  constexpr size_t kFileSize = 64 * 1024 * 1024;
+  const StreamID kStreams[] = {StreamID(1)};
+  ConnectSockets();
+
+  for (size_t message_size : {16 * 1024, 64 * 1024, 256 * 1024}) {
+    printf("%4zu KiB messages: %8.1f MB/s\n", message_size / 1024,
+           Transfer(kStreams, message_size, kFileSize));
+  }
+}
+
+// As above, but with files sent on many streams at the same time, like data
+// channel applications with many open channels.
+TEST_F(DcSctpSocketThroughputTest, DISABLED_FileTransferOnManyStreams) {
+  constexpr size_t kFileSize = 64 * 1024 * 1024;
+  constexpr size_t kMessageSize = 16 * 1024;
+  ConnectSockets();
+
+  for (int num_streams : {1, 10, 100, 1000}) {
+    std::vector<StreamID> streams;
+    for (int i = 0; i < num_streams; ++i) {
+      streams.push_back(StreamID(i));
+    }
+    printf("%4d streams: %8.1f MB/s\n", num_streams,
+           Transfer(streams, kMessageSize, kFileSize));
+  }
+}
+
+// Measures how long small messages are delayed when they are sent while a file
+// is being transferred on another stream, with and without message
+// interleaving. The delay of a small message is the number of bytes that A
+// sends from when the message is sent until the packet carrying it has been
+// sent, which is also given as the time that takes on a 10 Mbit/s link. Any
+// delay from packets that were already sent is the same in both cases, and is
+// not included.
+class DcSctpSocketLatencyTest : public DcSctpSocketTest,
+                                public testing::WithParamInterface<bool> {
+ protected:
+  DcSctpSocketLatencyTest()
+      : DcSctpSocketTest(/*enable_message_interleaving=*/GetParam()) {}
+};
+
+TEST_P(DcSctpSocketLatencyTest, DISABLED_SmallMessageDelayDuringFileTransfer) {
+  constexpr StreamID kFileStream(1);
+  constexpr StreamID kSmallMessageStream(2);
+  constexpr size_t kFileMessageSize = 64 * 1024;
+  constexpr size_t kSmallMessages = 1000;
+  constexpr double kLinkBytesPerMs = 10'000'000 / 8 / 1000.0;
+  ConnectSockets();
+
+  // Packets sent by A that are yet to be received by Z, each with the number
+  // of bytes that A had sent when it was sent.
+  std::deque<std::pair<std::vector<uint8_t>, size_t>> link;
+  size_t sent_bytes = 0;
+  auto take_packets_from_a = [&]() {
+    for (;;) {
+      std::vector<uint8_t> packet = cb_a_.ConsumeSentPacket();
+      if (packet.empty()) {
+        break;
+      }
+      sent_bytes += packet.size();
+      link.emplace_back(std::move(packet), sent_bytes);
+    }
+  };
+  auto deliver_packets_from_z = [&]() {
+    for (;;) {
+      std::vector<uint8_t> packet = cb_z_.ConsumeSentPacket();
+      if (packet.empty()) {
+        break;
+      }
+      sock_a_->ReceivePacket(std::move(packet));
+    }
+  };
+
+  std::vector<size_t> delays;
+  while (delays.size() < kSmallMessages) {
+    while (sock_a_->buffered_amount(kFileStream) < 4 * kFileMessageSize) {
+      sock_a_->Send(DcSctpMessage(kFileStream, PPID(51),
+                                  std::vector<uint8_t>(kFileMessageSize)),
+                    kSendOptions);
+    }
+    take_packets_from_a();
+    size_t sent_at = sent_bytes;
+    sock_a_->Send(DcSctpMessage(kSmallMessageStream, PPID(51),
+                                std::vector<uint8_t>(kSmallMessageSize)),
+                  kSendOptions);
+
+    bool received = false;
+    while (!received) {
+      take_packets_from_a();
+      if (link.empty()) {
+        // Let a delayed SACK be sent.
+        AdvanceTime(options_.delayed_ack_max_timeout);
+        RunTimers();
+        deliver_packets_from_z();
+        continue;
+      }
+
+      size_t packet_sent_at = link.front().second;
+      sock_z_->ReceivePacket(std::move(link.front().first));
+      link.pop_front();
+      for (;;) {
+        absl::optional<DcSctpMessage> msg = cb_z_.ConsumeReceivedMessage();
+        if (!msg.has_value()) {
+          break;
+        }
+        if (msg->stream_id() == kSmallMessageStream) {
+          received = true;
+          delays.push_back(packet_sent_at - sent_at);
+        }
+      }
+      deliver_packets_from_z();
+    }
+  }
+
+  std::sort(delays.begin(), delays.end());
+  size_t median = delays[delays.size() / 2];
+  size_t p99 = delays[delays.size() * 99 / 100];
+  printf("Interleaving %-8s median %7zu bytes (%6.1f ms), "
+         "99th percentile %7zu bytes (%6.1f ms)\n",
+         GetParam() ? "enabled:" : "disabled:", median,
+         median / kLinkBytesPerMs, p99, p99 / kLinkBytesPerMs);
+}
+
+INSTANTIATE_TEST_SUITE_P(Interleaving,
+                         DcSctpSocketLatencyTest,
+                         testing::Bool(),
+                         [](const auto& test_info) {
+                           return test_info.param ? "Enabled" : "Disabled";
+                         });
+
 }  // namespace
 }  // namespace dcsctp
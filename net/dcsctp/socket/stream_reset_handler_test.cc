@@ -191,8 +191,9 @@ class StreamResetHandlerTest : public testing::Test {
 
     data_tracker_ = std::make_unique<DataTracker>(
         "log: ", delayed_ack_timer_.get(), kPeerInitialTsn, &state);
-    reasm_ = std::make_unique<ReassemblyQueue>("log: ", kPeerInitialTsn, kArwnd,
-                                               &state);
+    reasm_ = std::make_unique<ReassemblyQueue>(
+        "log: ", kPeerInitialTsn, kArwnd,
+        /*use_message_interleaving=*/false, &state);
     retransmission_queue_ = std::make_unique<RetransmissionQueue>(
         "", kMyInitialTsn, kArwnd, producer_, [](DurationMs rtt_ms) {}, []() {},
         *t3_rtx_timer_, DcSctpOptions(),
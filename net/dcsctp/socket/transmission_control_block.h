@@ -95,6 +95,7 @@ class TransmissionControlBlock : public Context {
         reassembly_queue_(log_prefix,
                           peer_initial_tsn,
                           options.max_receiver_window_buffer_size,
+                          capabilities.message_interleaving,
                           handover_state),
         retransmission_queue_(
             log_prefix,
@@ -97,19 +97,19 @@ bool RetransmissionQueue::IsConsistent() const {
   size_t actual_outstanding_items = 0;
 
   std::set<UnwrappedTSN> actual_to_be_retransmitted;
-  for (const auto& elem : outstanding_data_) {
-    if (elem.second.is_outstanding()) {
-      actual_outstanding_bytes += GetSerializedChunkSize(elem.second.data());
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    const TxData& item = outstanding_data_[i];
+    if (item.is_outstanding()) {
+      actual_outstanding_bytes += GetSerializedChunkSize(item.data());
       ++actual_outstanding_items;
     }
 
-    if (elem.second.should_be_retransmitted()) {
-      actual_to_be_retransmitted.insert(elem.first);
+    if (item.should_be_retransmitted()) {
+      actual_to_be_retransmitted.insert(outstanding_tsn(i));
     }
   }
 
-  if (outstanding_data_.empty() &&
-      next_tsn_ != last_cumulative_tsn_ack_.next_value()) {
+  if (first_outstanding_tsn() != last_cumulative_tsn_ack_.next_value()) {
     return false;
   }
 
@@ -123,15 +123,42 @@ size_t RetransmissionQueue::GetSerializedChunkSize(const Data& data) const {
   return RoundUpTo4(data_chunk_header_size_ + data.size());
 }
 
-void RetransmissionQueue::RemoveAcked(UnwrappedTSN cumulative_tsn_ack,
-                                      AckInfo& ack_info) {
-  auto first_unacked = outstanding_data_.upper_bound(cumulative_tsn_ack);
+std::pair<size_t, size_t> RetransmissionQueue::OutstandingRange(
+    UnwrappedTSN first,
+    UnwrappedTSN last) const {
+  if (outstanding_data_.empty() || last < first) {
+    return std::make_pair(0, 0);
+  }
+  UnwrappedTSN first_outstanding = first_outstanding_tsn();
+  UnwrappedTSN last_outstanding = outstanding_tsn(outstanding_data_.size() - 1);
+  if (last < first_outstanding || first > last_outstanding) {
+    return std::make_pair(0, 0);
+  }
+  size_t begin = first <= first_outstanding
+                     ? 0
+                     : UnwrappedTSN::Difference(first, first_outstanding);
+  size_t end = last >= last_outstanding
+                   ? outstanding_data_.size()
+                   : UnwrappedTSN::Difference(last, first_outstanding) + 1;
+  return std::make_pair(begin, end);
+}
 
-  for (auto iter = outstanding_data_.begin(); iter != first_unacked; ++iter) {
-    AckChunk(ack_info, iter);
+RetransmissionQueue::TxData* RetransmissionQueue::FindOutstanding(
+    UnwrappedTSN tsn) {
+  std::pair<size_t, size_t> range = OutstandingRange(tsn, tsn);
+  if (range.first == range.second) {
+    return nullptr;
   }
+  return &outstanding_data_[range.first];
+}
 
-  outstanding_data_.erase(outstanding_data_.begin(), first_unacked);
+void RetransmissionQueue::RemoveAcked(UnwrappedTSN cumulative_tsn_ack,
+                                      AckInfo& ack_info) {
+  while (!outstanding_data_.empty() &&
+         first_outstanding_tsn() <= cumulative_tsn_ack) {
+    AckChunk(ack_info, first_outstanding_tsn(), outstanding_data_.front());
+    outstanding_data_.pop_front();
+  }
 }
 
 void RetransmissionQueue::AckGapBlocks(
@@ -144,33 +171,31 @@ void RetransmissionQueue::AckGapBlocks(
   // handled differently.
 
   for (auto& block : gap_ack_blocks) {
-    auto start = outstanding_data_.lower_bound(
-        UnwrappedTSN::AddTo(cumulative_tsn_ack, block.start));
-    auto end = outstanding_data_.upper_bound(
-        UnwrappedTSN::AddTo(cumulative_tsn_ack, block.end));
-    for (auto iter = start; iter != end; ++iter) {
-      AckChunk(ack_info, iter);
+    std::pair<size_t, size_t> range =
+        OutstandingRange(UnwrappedTSN::AddTo(cumulative_tsn_ack, block.start),
+                         UnwrappedTSN::AddTo(cumulative_tsn_ack, block.end));
+    for (size_t i = range.first; i < range.second; ++i) {
+      AckChunk(ack_info, outstanding_tsn(i), outstanding_data_[i]);
     }
   }
 }
 
-void RetransmissionQueue::AckChunk(
-    AckInfo& ack_info,
-    std::map<UnwrappedTSN, TxData>::iterator iter) {
-  if (!iter->second.is_acked()) {
-    size_t serialized_size = GetSerializedChunkSize(iter->second.data());
+void RetransmissionQueue::AckChunk(AckInfo& ack_info,
+                                   UnwrappedTSN tsn,
+                                   TxData& item) {
+  if (!item.is_acked()) {
+    size_t serialized_size = GetSerializedChunkSize(item.data());
     ack_info.bytes_acked += serialized_size;
-    ack_info.acked_tsns.push_back(iter->first.Wrap());
-    if (iter->second.is_outstanding()) {
+    ack_info.acked_tsns.push_back(tsn.Wrap());
+    if (item.is_outstanding()) {
       outstanding_bytes_ -= serialized_size;
       --outstanding_items_;
     }
-    if (iter->second.should_be_retransmitted()) {
-      to_be_retransmitted_.erase(iter->first);
+    if (item.should_be_retransmitted()) {
+      to_be_retransmitted_.erase(tsn);
     }
-    iter->second.Ack();
-    ack_info.highest_tsn_acked =
-        std::max(ack_info.highest_tsn_acked, iter->first);
+    item.Ack();
+    ack_info.highest_tsn_acked = std::max(ack_info.highest_tsn_acked, tsn);
   }
 }
 
@@ -203,12 +228,14 @@ void RetransmissionQueue::NackBetweenAckBlocks(
   for (auto& block : gap_ack_blocks) {
     UnwrappedTSN cur_block_first_acked =
         UnwrappedTSN::AddTo(cumulative_tsn_ack, block.start);
-    for (auto iter = outstanding_data_.upper_bound(prev_block_last_acked);
-         iter != outstanding_data_.lower_bound(cur_block_first_acked); ++iter) {
-      if (iter->first <= max_tsn_to_nack) {
-        ack_info.has_packet_loss =
-            NackItem(iter->first, iter->second, /*retransmit_now=*/false);
-      }
+    // Only the chunks up to `max_tsn_to_nack` are nacked.
+    std::pair<size_t, size_t> range = OutstandingRange(
+        prev_block_last_acked.next_value(),
+        std::min(UnwrappedTSN::AddTo(cur_block_first_acked, -1),
+                 max_tsn_to_nack));
+    for (size_t i = range.first; i < range.second; ++i) {
+      ack_info.has_packet_loss = NackItem(
+          outstanding_tsn(i), outstanding_data_[i], /*retransmit_now=*/false);
     }
     prev_block_last_acked = UnwrappedTSN::AddTo(cumulative_tsn_ack, block.end);
   }
@@ -309,9 +336,7 @@ void RetransmissionQueue::HandlePacketLoss(UnwrappedTSN highest_tsn_acked) {
     // https://tools.ietf.org/html/rfc4960#section-7.2.4
     // "If not in Fast Recovery, enter Fast Recovery and mark the highest
     // outstanding TSN as the Fast Recovery exit point."
-    fast_recovery_exit_tsn_ = outstanding_data_.empty()
-                                  ? last_cumulative_tsn_ack_
-                                  : outstanding_data_.rbegin()->first;
+    fast_recovery_exit_tsn_ = UnwrappedTSN::AddTo(next_tsn_, -1);
     RTC_DLOG(LS_VERBOSE) << log_prefix_
                          << "fast recovery initiated with exit_point="
                          << *fast_recovery_exit_tsn_->Wrap();
@@ -376,7 +401,7 @@ bool RetransmissionQueue::IsSackValid(const SackChunk& sack) const {
     // No in-flight data and cum-tsn-ack above what was last ACKed - not valid.
     return false;
   } else if (!outstanding_data_.empty() &&
-             cumulative_tsn_ack > outstanding_data_.rbegin()->first) {
+             cumulative_tsn_ack > UnwrappedTSN::AddTo(next_tsn_, -1)) {
     // There is in-flight data, but the cum-tsn-ack is beyond that - not valid.
     return false;
   }
@@ -464,15 +489,15 @@ void RetransmissionQueue::UpdateRTT(TimeMs now,
   // TODO(boivie): Consider occasionally sending DATA chunks with I-bit set and
   // use only those packets for measurement.
 
-  auto it = outstanding_data_.find(cumulative_tsn_ack);
-  if (it != outstanding_data_.end()) {
-    if (!it->second.has_been_retransmitted()) {
+  const TxData* item = FindOutstanding(cumulative_tsn_ack);
+  if (item != nullptr) {
+    if (!item->has_been_retransmitted()) {
       // https://tools.ietf.org/html/rfc4960#section-6.3.1
       // "Karn's algorithm: RTT measurements MUST NOT be made using
       // packets that were retransmitted (and thus for which it is ambiguous
       // whether the reply was for the first instance of the chunk or for a
       // later instance)"
-      DurationMs rtt = now - it->second.time_sent();
+      DurationMs rtt = now - item->time_sent();
       on_new_rtt_(rtt);
     }
   }
@@ -507,11 +532,10 @@ void RetransmissionQueue::HandleT3RtxTimerExpiry() {
   // T3-rtx timer expired but did not fit in one MTU (rule E3 above) should be
   // marked for retransmission and sent as soon as cwnd allows (normally, when a
   // SACK arrives)."
-  for (auto& elem : outstanding_data_) {
-    UnwrappedTSN tsn = elem.first;
-    TxData& item = elem.second;
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    TxData& item = outstanding_data_[i];
     if (!item.is_acked()) {
-      NackItem(tsn, item, /*retransmit_now=*/true);
+      NackItem(outstanding_tsn(i), item, /*retransmit_now=*/true);
     }
   }
 
@@ -558,9 +582,9 @@ RetransmissionQueue::GetChunksToBeRetransmitted(size_t max_size) {
   for (auto it = to_be_retransmitted_.begin();
        it != to_be_retransmitted_.end();) {
     UnwrappedTSN tsn = *it;
-    auto elem = outstanding_data_.find(tsn);
-    RTC_DCHECK(elem != outstanding_data_.end());
-    TxData& item = elem->second;
+    TxData* elem = FindOutstanding(tsn);
+    RTC_DCHECK(elem != nullptr);
+    TxData& item = *elem;
     RTC_DCHECK(item.should_be_retransmitted());
     RTC_DCHECK(!item.is_outstanding());
     RTC_DCHECK(!item.is_abandoned());
@@ -642,26 +666,20 @@ std::vector<std::pair<TSN, Data>> RetransmissionQueue::GetChunksToSend(
       outstanding_bytes_ += chunk_size;
       ++outstanding_items_;
       rwnd_ -= chunk_size;
-      auto item_it =
-          outstanding_data_
-              .emplace(tsn,
-                       RetransmissionQueue::TxData(
-                           chunk_opt->data.Clone(),
-                           partial_reliability_ ? chunk_opt->max_retransmissions
-                                                : absl::nullopt,
-                           now,
-                           partial_reliability_ ? chunk_opt->expires_at
-                                                : absl::nullopt))
-              .first;
-
-      if (item_it->second.has_expired(now)) {
+      TxData& item = outstanding_data_.emplace_back(
+          chunk_opt->data.Clone(),
+          partial_reliability_ ? chunk_opt->max_retransmissions
+                               : absl::nullopt,
+          now,
+          partial_reliability_ ? chunk_opt->expires_at : absl::nullopt);
+
+      if (item.has_expired(now)) {
         // No need to send it - it was expired when it was in the send
         // queue.
         RTC_DLOG(LS_VERBOSE)
-            << log_prefix_ << "Marking freshly produced chunk "
-            << *item_it->first.Wrap() << " and message "
-            << *item_it->second.data().message_id << " as expired";
-        AbandonAllFor(item_it->second);
+            << log_prefix_ << "Marking freshly produced chunk " << *tsn.Wrap()
+            << " and message " << *item.data().message_id << " as expired";
+        AbandonAllFor(item);
       } else {
         to_be_sent.emplace_back(tsn.Wrap(), std::move(chunk_opt->data));
       }
@@ -700,21 +718,22 @@ std::vector<std::pair<TSN, RetransmissionQueue::State>>
 RetransmissionQueue::GetChunkStatesForTesting() const {
   std::vector<std::pair<TSN, RetransmissionQueue::State>> states;
   states.emplace_back(last_cumulative_tsn_ack_.Wrap(), State::kAcked);
-  for (const auto& elem : outstanding_data_) {
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    const TxData& item = outstanding_data_[i];
     State state;
-    if (elem.second.is_abandoned()) {
+    if (item.is_abandoned()) {
       state = State::kAbandoned;
-    } else if (elem.second.should_be_retransmitted()) {
+    } else if (item.should_be_retransmitted()) {
       state = State::kToBeRetransmitted;
-    } else if (elem.second.is_acked()) {
+    } else if (item.is_acked()) {
       state = State::kAcked;
-    } else if (elem.second.is_outstanding()) {
+    } else if (item.is_outstanding()) {
       state = State::kInFlight;
     } else {
       state = State::kNacked;
     }
 
-    states.emplace_back(elem.first.Wrap(), state);
+    states.emplace_back(outstanding_tsn(i).Wrap(), state);
   }
   return states;
 }
@@ -730,9 +749,8 @@ bool RetransmissionQueue::ShouldSendForwardTsn(TimeMs now) {
   }
   ExpireOutstandingChunks(now);
   if (!outstanding_data_.empty()) {
-    auto it = outstanding_data_.begin();
-    return it->first == last_cumulative_tsn_ack_.next_value() &&
-           it->second.is_abandoned();
+    return first_outstanding_tsn() == last_cumulative_tsn_ack_.next_value() &&
+           outstanding_data_.front().is_abandoned();
   }
   RTC_DCHECK(IsConsistent());
   return false;
@@ -779,9 +797,9 @@ bool RetransmissionQueue::TxData::has_expired(TimeMs now) const {
 }
 
 void RetransmissionQueue::ExpireOutstandingChunks(TimeMs now) {
-  for (const auto& elem : outstanding_data_) {
-    UnwrappedTSN tsn = elem.first;
-    const TxData& item = elem.second;
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    UnwrappedTSN tsn = outstanding_tsn(i);
+    const TxData& item = outstanding_data_[i];
 
     // Chunks that are nacked can be expired. Care should be taken not to expire
     // unacked (in-flight) chunks as they might have been received, but the SACK
@@ -802,9 +820,13 @@ void RetransmissionQueue::ExpireOutstandingChunks(TimeMs now) {
 
 void RetransmissionQueue::AbandonAllFor(
     const RetransmissionQueue::TxData& item) {
+  // Adding the placeholder below may invalidate `item`.
+  const StreamID stream_id = item.data().stream_id;
+  const IsUnordered is_unordered = item.data().is_unordered;
+  const MID message_id = item.data().message_id;
+
   // Erase all remaining chunks from the producer, if any.
-  if (send_queue_.Discard(item.data().is_unordered, item.data().stream_id,
-                          item.data().message_id)) {
+  if (send_queue_.Discard(is_unordered, stream_id, message_id)) {
     // There were remaining chunks to be produced for this message. Since the
     // receiver may have already received all chunks (up till now) for this
     // message, we can't just FORWARD-TSN to the last fragment in this
@@ -815,16 +837,11 @@ void RetransmissionQueue::AbandonAllFor(
     // TSN in the sent FORWARD-TSN.
     UnwrappedTSN tsn = next_tsn_;
     next_tsn_.Increment();
-    Data message_end(item.data().stream_id, item.data().ssn,
-                     item.data().message_id, item.data().fsn, item.data().ppid,
-                     std::vector<uint8_t>(), Data::IsBeginning(false),
-                     Data::IsEnd(true), item.data().is_unordered);
-    TxData& added_item =
-        outstanding_data_
-            .emplace(tsn, RetransmissionQueue::TxData(std::move(message_end),
-                                                      absl::nullopt, TimeMs(0),
-                                                      absl::nullopt))
-            .first->second;
+    Data message_end(stream_id, item.data().ssn, message_id, item.data().fsn,
+                     item.data().ppid, std::vector<uint8_t>(),
+                     Data::IsBeginning(false), Data::IsEnd(true), is_unordered);
+    TxData& added_item = outstanding_data_.emplace_back(
+        std::move(message_end), absl::nullopt, TimeMs(0), absl::nullopt);
     // The added chunk shouldn't be included in `outstanding_bytes`, so set it
     // as acked.
     added_item.Ack();
@@ -832,14 +849,13 @@ void RetransmissionQueue::AbandonAllFor(
                          << "Adding unsent end placeholder for message at tsn="
                          << *tsn.Wrap();
   }
-  for (auto& elem : outstanding_data_) {
-    UnwrappedTSN tsn = elem.first;
-    TxData& other = elem.second;
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    UnwrappedTSN tsn = outstanding_tsn(i);
+    TxData& other = outstanding_data_[i];
 
-    if (!other.is_abandoned() &&
-        other.data().stream_id == item.data().stream_id &&
-        other.data().is_unordered == item.data().is_unordered &&
-        other.data().message_id == item.data().message_id) {
+    if (!other.is_abandoned() && other.data().stream_id == stream_id &&
+        other.data().is_unordered == is_unordered &&
+        other.data().message_id == message_id) {
       RTC_DLOG(LS_VERBOSE) << log_prefix_ << "Marking chunk " << *tsn.Wrap()
                            << " as abandoned";
       if (other.should_be_retransmitted()) {
@@ -868,9 +884,9 @@ ForwardTsnChunk RetransmissionQueue::CreateForwardTsn() const {
   std::map<StreamID, SSN> skipped_per_ordered_stream;
   UnwrappedTSN new_cumulative_ack = last_cumulative_tsn_ack_;
 
-  for (const auto& elem : outstanding_data_) {
-    UnwrappedTSN tsn = elem.first;
-    const TxData& item = elem.second;
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    UnwrappedTSN tsn = outstanding_tsn(i);
+    const TxData& item = outstanding_data_[i];
 
     if ((tsn != new_cumulative_ack.next_value()) || !item.is_abandoned()) {
       break;
@@ -894,9 +910,9 @@ IForwardTsnChunk RetransmissionQueue::CreateIForwardTsn() const {
   std::map<std::pair<IsUnordered, StreamID>, MID> skipped_per_stream;
   UnwrappedTSN new_cumulative_ack = last_cumulative_tsn_ack_;
 
-  for (const auto& elem : outstanding_data_) {
-    UnwrappedTSN tsn = elem.first;
-    const TxData& item = elem.second;
+  for (size_t i = 0; i < outstanding_data_.size(); ++i) {
+    UnwrappedTSN tsn = outstanding_tsn(i);
+    const TxData& item = outstanding_data_[i];
 
     if ((tsn != new_cumulative_ack.next_value()) || !item.is_abandoned()) {
       break;
@@ -12,7 +12,6 @@
 
 #include <cstdint>
 #include <functional>
-#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -21,6 +20,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "api/array_view.h"
+#include "net/dcsctp/common/ring_buffer.h"
 #include "net/dcsctp/common/sequence_numbers.h"
 #include "net/dcsctp/packet/chunk/forward_tsn_chunk.h"
 #include "net/dcsctp/packet/chunk/iforward_tsn_chunk.h"
@@ -294,10 +294,9 @@ class RetransmissionQueue {
                     rtc::ArrayView<const SackChunk::GapAckBlock> gap_ack_blocks,
                     AckInfo& ack_info);
 
-  // Acks the chunk referenced by `iter` and updates state in `ack_info` and the
-  // object's state.
-  void AckChunk(AckInfo& ack_info,
-                std::map<UnwrappedTSN, TxData>::iterator iter);
+  // Acks the chunk `item`, with TSN `tsn`, and updates state in `ack_info` and
+  // the object's state.
+  void AckChunk(AckInfo& ack_info, UnwrappedTSN tsn, TxData& item);
 
   // Mark chunks reported as "missing", as "nacked" or "to be retransmitted"
   // depending how many times this has happened. Only packets up until
@@ -344,6 +343,28 @@ class RetransmissionQueue {
   // that are still in the SendQueue and outstanding chunks.
   void AbandonAllFor(const RetransmissionQueue::TxData& item);
 
+  // Returns the TSN of the first chunk in `outstanding_data_`, which is the one
+  // following the last cumulative acked TSN.
+  UnwrappedTSN first_outstanding_tsn() const {
+    return UnwrappedTSN::AddTo(next_tsn_,
+                               -static_cast<int>(outstanding_data_.size()));
+  }
+
+  // Returns the TSN of the chunk at `index` in `outstanding_data_`.
+  UnwrappedTSN outstanding_tsn(size_t index) const {
+    return UnwrappedTSN::AddTo(first_outstanding_tsn(),
+                               static_cast<int>(index));
+  }
+
+  // Returns the index range [begin, end) in `outstanding_data_` of the chunks
+  // with TSNs from `first` to `last`, inclusive. Parts of the range that are
+  // not outstanding are excluded.
+  std::pair<size_t, size_t> OutstandingRange(UnwrappedTSN first,
+                                             UnwrappedTSN last) const;
+
+  // Returns the outstanding chunk with TSN `tsn`, or nullptr if there is none.
+  TxData* FindOutstanding(UnwrappedTSN tsn);
+
   // Returns the current congestion control algorithm phase.
   CongestionAlgorithmPhase phase() const {
     return (cwnd_ <= ssthresh_)
@@ -395,8 +416,10 @@ class RetransmissionQueue {
   SendQueue& send_queue_;
   // All the outstanding data chunks that are in-flight and that have not been
   // cumulative acked. Note that it also contains chunks that have been acked in
-  // gap ack blocks.
-  std::map<UnwrappedTSN, TxData> outstanding_data_;
+  // gap ack blocks. As every allocated TSN gets an entry, these are all TSNs
+  // from `last_cumulative_tsn_ack_` + 1 up to `next_tsn_` - 1, in order, and
+  // chunks are looked up by their offset from the first one.
+  RingBuffer<TxData> outstanding_data_;
   // Data chunks that are to be retransmitted.
   std::set<UnwrappedTSN> to_be_retransmitted_;
   // The number of bytes that are in-flight (sent but not yet acked or nacked).
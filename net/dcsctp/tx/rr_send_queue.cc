@@ -10,8 +10,10 @@
 #include "net/dcsctp/tx/rr_send_queue.h"
 
 #include <cstdint>
+#include <algorithm>
 #include <deque>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -79,19 +81,34 @@ bool RRSendQueue::IsConsistent() const {
     total_buffered_amount += stream_entry.second.buffered_amount().value();
   }
 
-  if (previous_message_has_ended_) {
-    auto it = streams_.find(current_stream_id_);
-    if (it != streams_.end() && it->second.has_partially_sent_message()) {
-      RTC_DLOG(LS_ERROR)
-          << "Previous message has ended, but still partial message in stream";
-      return false;
+  size_t num_active_streams = 0;
+  for (const auto& stream_entry : streams_) {
+    if (stream_entry.second.is_active()) {
+      ++num_active_streams;
     }
-  } else {
-    auto it = streams_.find(current_stream_id_);
-    if (it == streams_.end() || !it->second.has_partially_sent_message()) {
-      RTC_DLOG(LS_ERROR)
-          << "Previous message has NOT ended, but there is no partial message";
-      return false;
+  }
+  if (num_active_streams != active_streams_.size()) {
+    RTC_DLOG(LS_ERROR) << "Active streams are not all in the list";
+    return false;
+  }
+
+  // When interleaving, any number of streams may have a partially sent
+  // message.
+  if (!enable_message_interleaving_) {
+    if (previous_message_has_ended_) {
+      auto it = streams_.find(current_stream_id_);
+      if (it != streams_.end() && it->second.has_partially_sent_message()) {
+        RTC_DLOG(LS_ERROR) << "Previous message has ended, but still partial "
+                              "message in stream";
+        return false;
+      }
+    } else {
+      auto it = streams_.find(current_stream_id_);
+      if (it == streams_.end() || !it->second.has_partially_sent_message()) {
+        RTC_DLOG(LS_ERROR) << "Previous message has NOT ended, but there is no "
+                              "partial message";
+        return false;
+      }
     }
   }
 
@@ -140,7 +157,6 @@ absl::optional<SendQueue::DataToSend> RRSendQueue::OutgoingStream::Produce(
   RTC_DCHECK(!items_.empty());
 
   Item* item = &items_.front();
-  DcSctpMessage& message = item->message;
 
   if (item->remaining_size > max_size && max_size < kMinimumFragmentedPayload) {
     RTC_DCHECK(IsConsistent());
@@ -160,44 +176,33 @@ absl::optional<SendQueue::DataToSend> RRSendQueue::OutgoingStream::Produce(
   }
 
   // Grab the next `max_size` fragment from this message and calculate flags.
-  rtc::ArrayView<const uint8_t> chunk_payload =
-      item->message.payload().subview(item->remaining_offset, max_size);
-  rtc::ArrayView<const uint8_t> message_payload = message.payload();
-  Data::IsBeginning is_beginning(chunk_payload.data() ==
-                                 message_payload.data());
-  Data::IsEnd is_end((chunk_payload.data() + chunk_payload.size()) ==
-                     (message_payload.data() + message_payload.size()));
-
-  StreamID stream_id = message.stream_id();
-  PPID ppid = message.ppid();
-
-  // Zero-copy the payload if the message fits in a single chunk.
-  std::vector<uint8_t> payload =
-      is_beginning && is_end
-          ? std::move(message).ReleasePayload()
-          : std::vector<uint8_t>(chunk_payload.begin(), chunk_payload.end());
+  // The fragment references the message payload, without copying it.
+  size_t chunk_size = std::min(item->remaining_size, max_size);
+  Data::IsBeginning is_beginning(item->remaining_offset == 0);
+  Data::IsEnd is_end(chunk_size == item->remaining_size);
+  DataPayload payload(item->payload, item->remaining_offset, chunk_size);
 
   FSN fsn(item->current_fsn);
   item->current_fsn = FSN(*item->current_fsn + 1);
-  buffered_amount_.Decrease(payload.size());
-  total_buffered_amount_.Decrease(payload.size());
+  buffered_amount_.Decrease(chunk_size);
+  total_buffered_amount_.Decrease(chunk_size);
 
-  SendQueue::DataToSend chunk(Data(stream_id, item->ssn.value_or(SSN(0)),
-                                   item->message_id.value(), fsn, ppid,
+  SendQueue::DataToSend chunk(Data(stream_id_, item->ssn.value_or(SSN(0)),
+                                   item->message_id.value(), fsn, item->ppid,
                                    std::move(payload), is_beginning, is_end,
                                    item->send_options.unordered));
   chunk.max_retransmissions = item->send_options.max_retransmissions;
   chunk.expires_at = item->expires_at;
 
   if (is_end) {
-    // The entire message has been sent, and its last data copied to `chunk`, so
-    // it can safely be discarded.
+    // The entire message has been sent, and `chunk` keeps a reference to its
+    // payload, so it can safely be discarded.
     items_.pop_front();
   } else {
-    item->remaining_offset += chunk_payload.size();
-    item->remaining_size -= chunk_payload.size();
+    item->remaining_offset += chunk_size;
+    item->remaining_size -= chunk_size;
     RTC_DCHECK(item->remaining_offset + item->remaining_size ==
-               item->message.payload().size());
+               item->payload->size());
     RTC_DCHECK(item->remaining_size > 0);
   }
   RTC_DCHECK(IsConsistent());
@@ -248,12 +253,11 @@ void RRSendQueue::OutgoingStream::Reset() {
     // If this message has been partially sent, reset it so that it will be
     // re-sent.
     auto& item = items_.front();
-    buffered_amount_.Increase(item.message.payload().size() -
-                              item.remaining_size);
-    total_buffered_amount_.Increase(item.message.payload().size() -
+    buffered_amount_.Increase(item.payload->size() - item.remaining_size);
+    total_buffered_amount_.Increase(item.payload->size() -
                                     item.remaining_size);
     item.remaining_offset = 0;
-    item.remaining_size = item.message.payload().size();
+    item.remaining_size = item.payload->size();
     item.message_id = absl::nullopt;
     item.ssn = absl::nullopt;
     item.current_fsn = FSN(0);
@@ -285,8 +289,9 @@ void RRSendQueue::Add(TimeMs now,
     // lifetime (which may be zero).
     expires_at = now + *send_options.lifetime + DurationMs(1);
   }
-  GetOrCreateStreamInfo(message.stream_id())
-      .Add(std::move(message), expires_at, send_options);
+  OutgoingStream& stream = GetOrCreateStreamInfo(message.stream_id());
+  stream.Add(std::move(message), expires_at, send_options);
+  MaybeActivateStream(stream);
   RTC_DCHECK(IsConsistent());
 }
 
@@ -298,35 +303,38 @@ bool RRSendQueue::IsEmpty() const {
   return total_buffered_amount() == 0;
 }
 
-std::map<StreamID, RRSendQueue::OutgoingStream>::iterator
-RRSendQueue::GetNextStream(TimeMs now) {
-  auto start_it = streams_.lower_bound(StreamID(*current_stream_id_ + 1));
-
-  for (auto it = start_it; it != streams_.end(); ++it) {
-    if (it->second.HasDataToSend(now)) {
-      current_stream_id_ = it->first;
-      return it;
-    }
+void RRSendQueue::MaybeActivateStream(OutgoingStream& stream) {
+  if (!stream.is_active() && stream.buffered_amount().value() > 0) {
+    stream.set_active(true);
+    active_streams_.push_back(&stream);
   }
+}
 
-  for (auto it = streams_.begin(); it != start_it; ++it) {
-    if (it->second.HasDataToSend(now)) {
-      current_stream_id_ = it->first;
-      return it;
+RRSendQueue::OutgoingStream* RRSendQueue::GetNextStream(TimeMs now) {
+  while (!active_streams_.empty()) {
+    OutgoingStream* stream = active_streams_.front();
+    active_streams_.pop_front();
+    if (stream->HasDataToSend(now)) {
+      // Other streams with data will be picked before this one again.
+      active_streams_.push_back(stream);
+      current_stream_id_ = stream->stream_id();
+      return stream;
     }
+    // It will be activated again when it gets data to send, or is resumed.
+    stream->set_active(false);
   }
-  return streams_.end();
+  return nullptr;
 }
 
 absl::optional<SendQueue::DataToSend> RRSendQueue::Produce(TimeMs now,
                                                            size_t max_size) {
-  std::map<StreamID, RRSendQueue::OutgoingStream>::iterator stream_it;
+  OutgoingStream* stream;
 
-  if (previous_message_has_ended_) {
-    // Previous message has ended. Round-robin to a different stream, if there
-    // even is one with data to send.
-    stream_it = GetNextStream(now);
-    if (stream_it == streams_.end()) {
+  if (previous_message_has_ended_ || enable_message_interleaving_) {
+    // Previous message has ended, or messages may be interleaved. Round-robin
+    // to a different stream, if there even is one with data to send.
+    stream = GetNextStream(now);
+    if (stream == nullptr) {
       RTC_DLOG(LS_VERBOSE)
           << log_prefix_
           << "There is no stream with data; Can't produce any data.";
@@ -334,11 +342,12 @@ absl::optional<SendQueue::DataToSend> RRSendQueue::Produce(TimeMs now,
     }
   } else {
     // The previous message has not ended; Continue from the current stream.
-    stream_it = streams_.find(current_stream_id_);
+    auto stream_it = streams_.find(current_stream_id_);
     RTC_DCHECK(stream_it != streams_.end());
+    stream = &stream_it->second;
   }
 
-  absl::optional<DataToSend> data = stream_it->second.Produce(now, max_size);
+  absl::optional<DataToSend> data = stream->Produce(now, max_size);
   if (data.has_value()) {
     RTC_DLOG(LS_VERBOSE) << log_prefix_ << "Producing DATA, type="
                          << (data->data.is_unordered ? "unordered" : "ordered")
@@ -348,7 +357,7 @@ absl::optional<SendQueue::DataToSend> RRSendQueue::Produce(TimeMs now,
                                  : *data->data.is_beginning
                                        ? "first"
                                        : *data->data.is_end ? "last" : "middle")
-                         << ", stream_id=" << *stream_it->first
+                         << ", stream_id=" << *stream->stream_id()
                          << ", ppid=" << *data->data.ppid
                          << ", length=" << data->data.payload.size();
 
@@ -396,6 +405,7 @@ void RRSendQueue::CommitResetStreams() {
   for (auto& stream_entry : streams_) {
     if (stream_entry.second.is_paused()) {
       stream_entry.second.Reset();
+      MaybeActivateStream(stream_entry.second);
     }
   }
   RTC_DCHECK(IsConsistent());
@@ -403,7 +413,10 @@ void RRSendQueue::CommitResetStreams() {
 
 void RRSendQueue::RollbackResetStreams() {
   for (auto& stream_entry : streams_) {
-    stream_entry.second.Resume();
+    if (stream_entry.second.is_paused()) {
+      stream_entry.second.Resume();
+      MaybeActivateStream(stream_entry.second);
+    }
   }
   RTC_DCHECK(IsConsistent());
 }
@@ -449,6 +462,7 @@ RRSendQueue::OutgoingStream& RRSendQueue::GetOrCreateStreamInfo(
   return streams_
       .emplace(stream_id,
                OutgoingStream(
+                   stream_id,
                    [this, stream_id]() { on_buffered_amount_low_(stream_id); },
                    total_buffered_amount_))
       .first->second;
@@ -476,6 +490,7 @@ void RRSendQueue::RestoreFromState(const DcSctpSocketHandoverState& state) {
        state.tx.streams) {
     StreamID stream_id(state_stream.id);
     streams_.emplace(stream_id, OutgoingStream(
+                                    stream_id,
                                     [this, stream_id]() {
                                       on_buffered_amount_low_(stream_id);
                                     },
@@ -13,8 +13,10 @@
 #include <cstdint>
 #include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/strings/string_view.h"
@@ -34,7 +36,10 @@ namespace dcsctp {
 // it will cycle to send messages from different streams. It will send all
 // fragments from one message before continuing with a different message on
 // possibly a different stream, until support for message interleaving has been
-// implemented.
+// implemented. Only streams that have messages to send take part in the
+// cycle, so idle streams don't add to the cost of scheduling.
+//
+// Produced fragments don't copy the message payload, but reference it.
 //
 // As messages can be (requested to be) sent before the connection is properly
 // established, this send queue is always present - even for closed connections.
@@ -80,6 +85,9 @@ class RRSendQueue : public SendQueue {
   }
   size_t buffered_amount_low_threshold(StreamID stream_id) const override;
   void SetBufferedAmountLowThreshold(StreamID stream_id, size_t bytes) override;
+  void EnableMessageInterleaving(bool enabled) override {
+    enable_message_interleaving_ = enabled;
+  }
 
   HandoverReadinessStatus GetHandoverReadiness() const;
   void AddHandoverState(DcSctpSocketHandoverState& state);
@@ -113,15 +121,19 @@ class RRSendQueue : public SendQueue {
   class OutgoingStream {
    public:
     explicit OutgoingStream(
+        StreamID stream_id,
         std::function<void()> on_buffered_amount_low,
         ThresholdWatcher& total_buffered_amount,
         const DcSctpSocketHandoverState::OutgoingStream* state = nullptr)
-        : next_unordered_mid_(MID(state ? state->next_unordered_mid : 0)),
+        : stream_id_(stream_id),
+          next_unordered_mid_(MID(state ? state->next_unordered_mid : 0)),
           next_ordered_mid_(MID(state ? state->next_ordered_mid : 0)),
           next_ssn_(SSN(state ? state->next_ssn : 0)),
           buffered_amount_(std::move(on_buffered_amount_low)),
           total_buffered_amount_(total_buffered_amount) {}
 
+    StreamID stream_id() const { return stream_id_; }
+
     // Enqueues a message to this stream.
     void Add(DcSctpMessage message,
              absl::optional<TimeMs> expires_at,
@@ -144,6 +156,11 @@ class RRSendQueue : public SendQueue {
 
     bool is_paused() const { return is_paused_; }
 
+    // Indicates if this stream is in the list of streams to produce data from,
+    // see `RRSendQueue::active_streams_`.
+    bool is_active() const { return is_active_; }
+    void set_active(bool is_active) { is_active_ = is_active; }
+
     // Resets this stream, meaning MIDs and SSNs are set to zero.
     void Reset();
 
@@ -163,12 +180,16 @@ class RRSendQueue : public SendQueue {
       explicit Item(DcSctpMessage msg,
                     absl::optional<TimeMs> expires_at,
                     const SendOptions& send_options)
-          : message(std::move(msg)),
+          : ppid(msg.ppid()),
+            payload(std::make_shared<const std::vector<uint8_t>>(
+                std::move(msg).ReleasePayload())),
             expires_at(expires_at),
             send_options(send_options),
             remaining_offset(0),
-            remaining_size(message.payload().size()) {}
-      DcSctpMessage message;
+            remaining_size(payload->size()) {}
+      PPID ppid;
+      // The message payload, which is shared with the produced fragments.
+      std::shared_ptr<const std::vector<uint8_t>> payload;
       absl::optional<TimeMs> expires_at;
       SendOptions send_options;
       // The remaining payload (offset and size) to be sent, when it has been
@@ -185,8 +206,10 @@ class RRSendQueue : public SendQueue {
 
     bool IsConsistent() const;
 
+    const StreamID stream_id_;
     // Streams are pause when they are about to be reset.
     bool is_paused_ = false;
+    bool is_active_ = false;
     // MIDs are different for unordered and ordered messages sent on a stream.
     MID next_unordered_mid_;
     MID next_ordered_mid_;
@@ -205,13 +228,13 @@ class RRSendQueue : public SendQueue {
 
   bool IsConsistent() const;
   OutgoingStream& GetOrCreateStreamInfo(StreamID stream_id);
-  absl::optional<DataToSend> Produce(
-      std::map<StreamID, OutgoingStream>::iterator it,
-      TimeMs now,
-      size_t max_size);
 
-  // Return the next stream, in round-robin fashion.
-  std::map<StreamID, OutgoingStream>::iterator GetNextStream(TimeMs now);
+  // Adds `stream` to `active_streams_`, if it has data and isn't there already.
+  void MaybeActivateStream(OutgoingStream& stream);
+
+  // Return the next stream, in round-robin fashion, or nullptr if no stream
+  // has data to send.
+  OutgoingStream* GetNextStream(TimeMs now);
 
   const std::string log_prefix_;
   const size_t buffer_size_;
@@ -227,6 +250,11 @@ class RRSendQueue : public SendQueue {
   // The total amount of buffer data, for all streams.
   ThresholdWatcher total_buffered_amount_;
 
+  // Indicates if fragments of messages on different streams may be sent
+  // interleaved, in which case every fragment is produced from the next stream
+  // in round-robin order.
+  bool enable_message_interleaving_ = false;
+
   // Indicates if the previous fragment sent was the end of a message. For
   // non-interleaved sending, this means that the next message may come from a
   // different stream. If not true, the next fragment must be produced from the
@@ -238,6 +266,12 @@ class RRSendQueue : public SendQueue {
 
   // All streams, and messages added to those.
   std::map<StreamID, OutgoingStream> streams_;
+
+  // The streams that have had data to send since they were last found not to
+  // have any, in round-robin order. A stream is moved to the back when it's
+  // picked by `GetNextStream`, and removed when it's found to have nothing
+  // to send, e.g. when it's empty or paused.
+  std::deque<OutgoingStream*> active_streams_;
 };
 }  // namespace dcsctp
 
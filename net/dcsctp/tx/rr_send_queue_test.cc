@@ -25,6 +25,7 @@
 
 namespace dcsctp {
 namespace {
+using ::testing::ElementsAreArray;
 using ::testing::SizeIs;
 
 constexpr TimeMs kNow = TimeMs(0);
@@ -779,5 +780,109 @@ TEST_F(RRSendQueueTest, WillStayInStreamWhenOnlySmallFragmentRemaining) {
 
   EXPECT_FALSE(buf_.Produce(kNow, 8).has_value());
 }
+
+TEST_F(RRSendQueueTest, FragmentsReferenceMessagePayload) {
+  std::vector<uint8_t> payload(30);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = i;
+  }
+  buf_.Add(kNow, DcSctpMessage(kStreamID, kPPID, payload));
+
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk1,
+                              buf_.Produce(kNow, /*max_size=*/20));
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk2,
+                              buf_.Produce(kNow, /*max_size=*/20));
+  EXPECT_THAT(chunk1.data.payload,
+              ElementsAreArray(payload.begin(), payload.begin() + 20));
+  EXPECT_THAT(chunk2.data.payload,
+              ElementsAreArray(payload.begin() + 20, payload.end()));
+
+  // The fragments are adjacent slices of the same buffer.
+  EXPECT_TRUE(chunk1.data.payload.is_shared());
+  EXPECT_TRUE(chunk2.data.payload.is_shared());
+  EXPECT_EQ(chunk1.data.payload.end(), chunk2.data.payload.begin());
+
+  // Cloning a fragment, e.g. when retransmitting it, doesn't copy it either.
+  Data clone = chunk2.data.Clone();
+  EXPECT_EQ(clone.payload.begin(), chunk2.data.payload.begin());
+  EXPECT_EQ(clone.payload.size(), 10u);
+}
+
+TEST_F(RRSendQueueTest, OnlyCyclesBetweenStreamsWithData) {
+  // Many streams that have been used, but that are now idle.
+  for (int i = 0; i < 1000; ++i) {
+    buf_.Add(kNow,
+             DcSctpMessage(StreamID(100 + i), kPPID, std::vector<uint8_t>(1)));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(buf_.Produce(kNow, kOneFragmentPacketSize).has_value());
+  }
+  EXPECT_TRUE(buf_.IsEmpty());
+
+  buf_.Add(kNow, DcSctpMessage(StreamID(3), kPPID, std::vector<uint8_t>(1)));
+  buf_.Add(kNow, DcSctpMessage(StreamID(3), kPPID, std::vector<uint8_t>(2)));
+  buf_.Add(kNow, DcSctpMessage(StreamID(2000), kPPID, std::vector<uint8_t>(3)));
+  buf_.Add(kNow, DcSctpMessage(StreamID(2000), kPPID, std::vector<uint8_t>(4)));
+
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk1,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk1.data.stream_id, StreamID(3));
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk2,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk2.data.stream_id, StreamID(2000));
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk3,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk3.data.stream_id, StreamID(3));
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk4,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk4.data.stream_id, StreamID(2000));
+  EXPECT_FALSE(buf_.Produce(kNow, kOneFragmentPacketSize).has_value());
+}
+
+TEST_F(RRSendQueueTest, ResumedStreamIsCycledAgain) {
+  std::vector<uint8_t> payload(50);
+  buf_.PrepareResetStreams(std::vector<StreamID>({StreamID(1)}));
+  buf_.Add(kNow, DcSctpMessage(StreamID(1), kPPID, payload));
+  buf_.Add(kNow, DcSctpMessage(StreamID(2), kPPID, payload));
+
+  // The paused stream is skipped.
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk1,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk1.data.stream_id, StreamID(2));
+  EXPECT_FALSE(buf_.Produce(kNow, kOneFragmentPacketSize).has_value());
+
+  buf_.RollbackResetStreams();
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk2,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk2.data.stream_id, StreamID(1));
+}
+
+TEST_F(RRSendQueueTest, InterleavesFragmentsOfMessagesOnDifferentStreams) {
+  buf_.EnableMessageInterleaving(true);
+  buf_.Add(kNow,
+           DcSctpMessage(StreamID(1), kPPID,
+                         std::vector<uint8_t>(kOneFragmentPacketSize * 2)));
+  buf_.Add(kNow, DcSctpMessage(StreamID(2), kPPID, std::vector<uint8_t>(1)));
+
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk1,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk1.data.stream_id, StreamID(1));
+  EXPECT_TRUE(chunk1.data.is_beginning);
+  EXPECT_FALSE(chunk1.data.is_end);
+
+  // The small message doesn't have to wait for the large one to be sent.
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk2,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk2.data.stream_id, StreamID(2));
+  EXPECT_THAT(chunk2.data.payload, SizeIs(1));
+
+  ASSERT_HAS_VALUE_AND_ASSIGN(SendQueue::DataToSend chunk3,
+                              buf_.Produce(kNow, kOneFragmentPacketSize));
+  EXPECT_EQ(chunk3.data.stream_id, StreamID(1));
+  EXPECT_EQ(chunk3.data.message_id, chunk1.data.message_id);
+  EXPECT_TRUE(chunk3.data.is_end);
+
+  EXPECT_FALSE(buf_.Produce(kNow, kOneFragmentPacketSize).has_value());
+}
 }  // namespace
 }  // namespace dcsctp
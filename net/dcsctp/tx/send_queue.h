@@ -122,6 +122,12 @@ class SendQueue {
   // Sets a limit for the `OnBufferedAmountLow` event.
   virtual void SetBufferedAmountLowThreshold(StreamID stream_id,
                                              size_t bytes) = 0;
+
+  // Configures the send queue to support interleaved message sending as
+  // described in RFC8260. Every produced fragment may then come from a
+  // different stream, so that a large message doesn't delay messages sent on
+  // other streams until all of it has been sent.
+  virtual void EnableMessageInterleaving(bool enabled) = 0;
 };
 }  // namespace dcsctp
 
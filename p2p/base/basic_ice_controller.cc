@@ -10,6 +10,8 @@
 
 #include "p2p/base/basic_ice_controller.h"
 
+#include <iterator>
+
 namespace {
 
 // The minimum improvement in RTT that justifies a switch.
@@ -76,12 +78,10 @@ void BasicIceController::SetSelectedConnection(
 
 void BasicIceController::AddConnection(const Connection* connection) {
   connections_.push_back(connection);
-  unpinged_connections_.insert(connection);
 }
 
 void BasicIceController::OnConnectionDestroyed(const Connection* connection) {
   pinged_connections_.erase(connection);
-  unpinged_connections_.erase(connection);
   connections_.erase(absl::c_find(connections_, connection));
 }
 
@@ -115,8 +115,8 @@ IceControllerInterface::PingResult BasicIceController::SelectConnectionToPing(
 }
 
 void BasicIceController::MarkConnectionPinged(const Connection* conn) {
-  if (conn && pinged_connections_.insert(conn).second) {
-    unpinged_connections_.erase(conn);
+  if (conn) {
+    pinged_connections_.insert(conn);
   }
 }
 
@@ -142,94 +142,89 @@ const Connection* BasicIceController::FindNextPingableConnection() {
   // Rule 2.1: Among such connections, pick the one with the earliest
   // last-ping-sent time.
   if (weak()) {
-    std::vector<const Connection*> pingable_selectable_connections;
-    absl::c_copy_if(GetBestWritableConnectionPerNetwork(),
-                    std::back_inserter(pingable_selectable_connections),
-                    [this, now](const Connection* conn) {
-                      return WritableConnectionPastPingInterval(conn, now);
-                    });
-    auto iter = absl::c_min_element(
-        pingable_selectable_connections,
-        [](const Connection* conn1, const Connection* conn2) {
-          return conn1->last_ping_sent() < conn2->last_ping_sent();
-        });
-    if (iter != pingable_selectable_connections.end()) {
-      return *iter;
+    const Connection* conn =
+        FindLeastRecentlyPingedBestConnectionPerNetwork(now);
+    if (conn) {
+      return conn;
     }
   }
 
+  // Rules 3 and 4 are decided in a single pass over the connections, which
+  // checks whether each of them is pingable only once.
   // Rule 3: Triggered checks have priority over non-triggered connections.
   // Rule 3.1: Among triggered checks, oldest takes precedence.
-  const Connection* oldest_triggered_check =
-      FindOldestConnectionNeedingTriggeredCheck(now);
+  // Rule 4: Unpinged connections have priority over pinged ones.
+  // Rule 4.1: Among them, "more pingable" takes precedence.
+  const Connection* oldest_triggered_check = nullptr;
+  const Connection* most_pingable_unpinged = nullptr;
+  const Connection* most_pingable = nullptr;
+  for (const Connection* conn : connections_) {
+    if (!IsPingable(conn, now)) {
+      continue;
+    }
+    // Find "triggered checks".  We ping first those connections that have
+    // received a ping but have not sent a ping since receiving it
+    // (last_ping_received > last_ping_sent).  But we shouldn't do
+    // triggered checks if the connection is already writable.
+    if (!conn->writable() &&
+        conn->last_ping_received() > conn->last_ping_sent() &&
+        (!oldest_triggered_check ||
+         conn->last_ping_received() <
+             oldest_triggered_check->last_ping_received())) {
+      oldest_triggered_check = conn;
+    }
+    if (!most_pingable || MorePingable(conn, most_pingable)) {
+      most_pingable = conn;
+    }
+    if (pinged_connections_.count(conn) == 0 &&
+        (!most_pingable_unpinged ||
+         MorePingable(conn, most_pingable_unpinged))) {
+      most_pingable_unpinged = conn;
+    }
+  }
+
   if (oldest_triggered_check) {
+    RTC_LOG(LS_INFO) << "Selecting connection for triggered check: "
+                     << oldest_triggered_check->ToString();
     return oldest_triggered_check;
   }
-
-  // Rule 4: Unpinged connections have priority over pinged ones.
-  RTC_CHECK(connections_.size() ==
-            pinged_connections_.size() + unpinged_connections_.size());
-  // If there are unpinged and pingable connections, only ping those.
-  // Otherwise, treat everything as unpinged.
-  // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
-  // "pinged" to filter out unpinged connections.
-  if (absl::c_none_of(unpinged_connections_,
-                      [this, now](const Connection* conn) {
-                        return this->IsPingable(conn, now);
-                      })) {
-    unpinged_connections_.insert(pinged_connections_.begin(),
-                                 pinged_connections_.end());
-    pinged_connections_.clear();
-  }
-
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<const Connection*> pingable_connections;
-  absl::c_copy_if(
-      unpinged_connections_, std::back_inserter(pingable_connections),
-      [this, now](const Connection* conn) { return IsPingable(conn, now); });
-  auto iter = absl::c_max_element(
-      pingable_connections,
-      [this](const Connection* conn1, const Connection* conn2) {
-        // Some implementations of max_element
-        // compare an element with itself.
-        if (conn1 == conn2) {
-          return false;
-        }
-        return MorePingable(conn1, conn2) == conn2;
-      });
-  if (iter != pingable_connections.end()) {
-    return *iter;
+  if (most_pingable_unpinged) {
+    return most_pingable_unpinged;
   }
-  return nullptr;
+  // If there are no unpinged and pingable connections, start a new round and
+  // treat everything as unpinged.
+  pinged_connections_.clear();
+  return most_pingable;
 }
 
-// Find "triggered checks".  We ping first those connections that have
-// received a ping but have not sent a ping since receiving it
-// (last_ping_received > last_ping_sent).  But we shouldn't do
-// triggered checks if the connection is already writable.
-const Connection* BasicIceController::FindOldestConnectionNeedingTriggeredCheck(
-    int64_t now) {
-  const Connection* oldest_needing_triggered_check = nullptr;
-  for (auto* conn : connections_) {
-    if (!IsPingable(conn, now)) {
-      continue;
+const Connection*
+BasicIceController::FindLeastRecentlyPingedBestConnectionPerNetwork(
+    int64_t now) const {
+  // `connections_` has been sorted, so the first one in the list on a given
+  // network is the best connection on the network, except that the selected
+  // connection is always the best connection on the network. There are only
+  // a few networks, so they are looked up linearly.
+  std::vector<const rtc::Network*> networks;
+  const Connection* least_recently_pinged = nullptr;
+  auto consider_best_on_network = [&](const Connection* conn) {
+    if (absl::c_linear_search(networks, conn->network())) {
+      return;
     }
-    bool needs_triggered_check =
-        (!conn->writable() &&
-         conn->last_ping_received() > conn->last_ping_sent());
-    if (needs_triggered_check &&
-        (!oldest_needing_triggered_check ||
-         (conn->last_ping_received() <
-          oldest_needing_triggered_check->last_ping_received()))) {
-      oldest_needing_triggered_check = conn;
+    networks.push_back(conn->network());
+    if (conn->writable() && conn->connected() &&
+        WritableConnectionPastPingInterval(conn, now) &&
+        (!least_recently_pinged ||
+         conn->last_ping_sent() < least_recently_pinged->last_ping_sent())) {
+      least_recently_pinged = conn;
     }
+  };
+  if (selected_connection_) {
+    consider_best_on_network(selected_connection_);
   }
-
-  if (oldest_needing_triggered_check) {
-    RTC_LOG(LS_INFO) << "Selecting connection for triggered check: "
-                     << oldest_needing_triggered_check->ToString();
+  for (const Connection* conn : connections_) {
+    consider_best_on_network(conn);
   }
-  return oldest_needing_triggered_check;
+  return least_recently_pinged;
 }
 
 bool BasicIceController::WritableConnectionPastPingInterval(
@@ -322,34 +317,25 @@ bool BasicIceController::IsBackupConnection(const Connection* conn) const {
          conn != selected_connection_ && conn->active();
 }
 
-const Connection* BasicIceController::MorePingable(const Connection* conn1,
-                                                   const Connection* conn2) {
+bool BasicIceController::MorePingable(const Connection* conn1,
+                                      const Connection* conn2) const {
   RTC_DCHECK(conn1 != conn2);
   if (config_.prioritize_most_likely_candidate_pairs) {
     const Connection* most_likely_to_work_conn = MostLikelyToWork(conn1, conn2);
     if (most_likely_to_work_conn) {
-      return most_likely_to_work_conn;
+      return most_likely_to_work_conn == conn1;
     }
   }
 
-  const Connection* least_recently_pinged_conn =
-      LeastRecentlyPinged(conn1, conn2);
-  if (least_recently_pinged_conn) {
-    return least_recently_pinged_conn;
-  }
-
-  // During the initial state when nothing has been pinged yet, return the first
-  // one in the ordered `connections_`.
-  auto connections = connections_;
-  return *(std::find_if(connections.begin(), connections.end(),
-                        [conn1, conn2](const Connection* conn) {
-                          return conn == conn1 || conn == conn2;
-                        }));
+  // During the initial state when nothing has been pinged yet, neither is
+  // more pingable, and the first one in the ordered `connections_` is pinged
+  // first.
+  return LeastRecentlyPinged(conn1, conn2) == conn1;
 }
 
 const Connection* BasicIceController::MostLikelyToWork(
     const Connection* conn1,
-    const Connection* conn2) {
+    const Connection* conn2) const {
   bool rr1 = IsRelayRelay(conn1);
   bool rr2 = IsRelayRelay(conn2);
   if (rr1 && !rr2) {
@@ -361,7 +347,7 @@ const Connection* BasicIceController::MostLikelyToWork(
     bool udp2 = IsUdp(conn2);
     if (udp1 && !udp2) {
       return conn1;
-    } else if (udp2 && udp1) {
+    } else if (udp2 && !udp1) {
       return conn2;
     }
   }
@@ -370,7 +356,7 @@ const Connection* BasicIceController::MostLikelyToWork(
 
 const Connection* BasicIceController::LeastRecentlyPinged(
     const Connection* conn1,
-    const Connection* conn2) {
+    const Connection* conn2) const {
   if (conn1->last_ping_sent() < conn2->last_ping_sent()) {
     return conn1;
   }
@@ -399,18 +385,6 @@ BasicIceController::GetBestConnectionByNetwork() const {
   return best_connection_by_network;
 }
 
-std::vector<const Connection*>
-BasicIceController::GetBestWritableConnectionPerNetwork() const {
-  std::vector<const Connection*> connections;
-  for (auto kv : GetBestConnectionByNetwork()) {
-    const Connection* conn = kv.second;
-    if (conn->writable() && conn->connected()) {
-      connections.push_back(conn);
-    }
-  }
-  return connections;
-}
-
 IceControllerInterface::SwitchResult
 BasicIceController::HandleInitialSelectDampening(
     IceControllerEvent reason,
@@ -527,16 +501,7 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  absl::c_stable_sort(
-      connections_, [this](const Connection* a, const Connection* b) {
-        int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
-        if (cmp != 0) {
-          return cmp > 0;
-        }
-        // Otherwise, sort based on latency estimate.
-        return a->rtt() < b->rtt();
-      });
+  RankConnections();
 
   RTC_LOG(LS_VERBOSE) << "Sorting " << connections_.size()
                       << " available connections";
@@ -550,6 +515,62 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
   return ShouldSwitchConnection(reason, top_connection);
 }
 
+// Sorts `connections_` into the same order as a stable sort would. Between two
+// calls only a few connections usually change rank, so rather than sorting
+// from scratch, the connections that are still in order are kept in order,
+// and only the others are sorted and merged back in. That takes a linear
+// number of comparisons when few connections changed rank.
+void BasicIceController::RankConnections() {
+  struct Entry {
+    const Connection* connection;
+    size_t position;
+  };
+  auto ranks_before = [this](const Entry& a, const Entry& b) {
+    int cmp =
+        CompareConnections(a.connection, b.connection, absl::nullopt, nullptr);
+    if (cmp != 0) {
+      return cmp > 0;
+    }
+    // Otherwise, sort based on latency estimate.
+    if (a.connection->rtt() != b.connection->rtt()) {
+      return a.connection->rtt() < b.connection->rtt();
+    }
+    // Keep the previous order of connections that rank the same.
+    return a.position < b.position;
+  };
+
+  std::vector<Entry> in_order;
+  std::vector<Entry> out_of_order;
+  in_order.reserve(connections_.size());
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    Entry entry = {connections_[i], i};
+    if (in_order.empty() || !ranks_before(entry, in_order.back())) {
+      in_order.push_back(entry);
+    } else if (in_order.size() == 1 ||
+               !ranks_before(entry, in_order[in_order.size() - 2])) {
+      // Only the previous connection is out of order with `entry`, so it is
+      // likely the one that changed rank. Take it out instead of `entry`,
+      // which keeps the connections after it in order.
+      out_of_order.push_back(in_order.back());
+      in_order.back() = entry;
+    } else {
+      out_of_order.push_back(entry);
+    }
+  }
+  if (out_of_order.empty()) {
+    return;
+  }
+
+  std::sort(out_of_order.begin(), out_of_order.end(), ranks_before);
+  std::vector<Entry> ranked;
+  ranked.reserve(connections_.size());
+  std::merge(in_order.begin(), in_order.end(), out_of_order.begin(),
+             out_of_order.end(), std::back_inserter(ranked), ranks_before);
+  for (size_t i = 0; i < ranked.size(); ++i) {
+    connections_[i] = ranked[i].connection;
+  }
+}
+
 bool BasicIceController::ReadyToSend(const Connection* connection) const {
   // Note that we allow sending on an unreliable connection, because it's
   // possible that it became unreliable simply due to bad chance.
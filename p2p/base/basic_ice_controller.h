@@ -13,7 +13,7 @@
 
 #include <algorithm>
 #include <map>
-#include <set>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -78,18 +78,20 @@ class BasicIceController : public IceControllerInterface {
                     config_.receiving_timeout_or_default() / 10);
   }
 
-  const Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
-  // Between `conn1` and `conn2`, this function returns the one which should
-  // be pinged first.
-  const Connection* MorePingable(const Connection* conn1,
-                                 const Connection* conn2);
+  // Among the best writable connections of each network, returns the least
+  // recently pinged one that is past its ping interval.
+  const Connection* FindLeastRecentlyPingedBestConnectionPerNetwork(
+      int64_t now) const;
+  // Returns true if `conn1` should be pinged before `conn2`. Connections that
+  // are equally pingable are pinged in the order of `connections_`.
+  bool MorePingable(const Connection* conn1, const Connection* conn2) const;
   // Select the connection which is Relay/Relay. If both of them are,
   // UDP relay protocol takes precedence.
   const Connection* MostLikelyToWork(const Connection* conn1,
-                                     const Connection* conn2);
+                                     const Connection* conn2) const;
   // Compare the last_ping_sent time and return the one least recently pinged.
   const Connection* LeastRecentlyPinged(const Connection* conn1,
-                                        const Connection* conn2);
+                                        const Connection* conn2) const;
 
   bool IsPingable(const Connection* conn, int64_t now) const;
   bool IsBackupConnection(const Connection* conn) const;
@@ -102,7 +104,6 @@ class BasicIceController : public IceControllerInterface {
 
   std::map<const rtc::Network*, const Connection*> GetBestConnectionByNetwork()
       const;
-  std::vector<const Connection*> GetBestWritableConnectionPerNetwork() const;
 
   bool ReadyToSend(const Connection* connection) const;
   bool PresumedWritable(const Connection* conn) const;
@@ -136,6 +137,10 @@ class BasicIceController : public IceControllerInterface {
                          absl::optional<int64_t> receiving_unchanged_threshold,
                          bool* missed_receiving_unchanged_threshold) const;
 
+  // Brings `connections_` back in rank order after the states of some
+  // connections changed, see the implementation.
+  void RankConnections();
+
   SwitchResult HandleInitialSelectDampening(IceControllerEvent reason,
                                             const Connection* new_connection);
 
@@ -147,14 +152,12 @@ class BasicIceController : public IceControllerInterface {
   const IceFieldTrials* field_trials_;
 
   // `connections_` is a sorted list with the first one always be the
-  // `selected_connection_` when it's not nullptr. The combination of
-  // `pinged_connections_` and `unpinged_connections_` has the same
-  // connections as `connections_`. These 2 sets maintain whether a
-  // connection should be pinged next or not.
+  // `selected_connection_` when it's not nullptr. `pinged_connections_` are
+  // the connections pinged since the last round of pings started; the others
+  // are pinged first.
   const Connection* selected_connection_ = nullptr;
   std::vector<const Connection*> connections_;
-  std::set<const Connection*> pinged_connections_;
-  std::set<const Connection*> unpinged_connections_;
+  std::unordered_set<const Connection*> pinged_connections_;
 
   // Timestamp for when we got the first selectable connection.
   int64_t initial_select_timestamp_ms_ = 0;
@@ -0,0 +1,261 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/basic_ice_controller.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/candidate.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/connection.h"
+#include "p2p/base/ice_controller_factory_interface.h"
+#include "p2p/base/p2p_constants.h"
+#include "p2p/base/port.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/network.h"
+#include "rtc_base/random.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kLocalAddr("192.168.1.2", 5000);
+
+// A port that never sends anything, for connections whose state is driven
+// directly by the test.
+class FakeIcePort : public Port {
+ public:
+  FakeIcePort(rtc::Thread* thread,
+              rtc::PacketSocketFactory* factory,
+              rtc::Network* network)
+      : Port(thread, LOCAL_PORT_TYPE, factory, network, 0, 0, "lfrag",
+             "lpass") {}
+
+  void PrepareAddress() override {
+    AddAddress(kLocalAddr, kLocalAddr, rtc::SocketAddress(), UDP_PROTOCOL_NAME,
+               "", "", LOCAL_PORT_TYPE, ICE_TYPE_PREFERENCE_HOST, 0, "", true);
+  }
+  bool SupportsProtocol(const std::string& protocol) const override {
+    return true;
+  }
+  ProtocolType GetProtocol() const override { return PROTO_UDP; }
+  Connection* CreateConnection(const Candidate& remote_candidate,
+                               CandidateOrigin origin) override {
+    Connection* conn = new ProxyConnection(this, 0, remote_candidate);
+    AddOrReplaceConnection(conn);
+    return conn;
+  }
+  int SendTo(const void* data,
+             size_t size,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options,
+             bool payload) override {
+    return static_cast<int>(size);
+  }
+  int SetOption(rtc::Socket::Option opt, int value) override { return 0; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int GetError() override { return 0; }
+
+ private:
+  void OnSentPacket(rtc::AsyncPacketSocket* socket,
+                    const rtc::SentPacket& sent_packet) override {}
+};
+
+class BasicIceControllerTest : public ::testing::Test {
+ public:
+  BasicIceControllerTest()
+      : thread_(&vss_),
+        socket_factory_(&vss_),
+        network_("unittest", "unittest", rtc::IPAddress(INADDR_ANY), 32),
+        port_(&thread_, &socket_factory_, &network_) {
+    // Let the connections receive pings at a time later than their last ping.
+    clock_.AdvanceTime(webrtc::TimeDelta::Seconds(1));
+    network_.AddIP(kLocalAddr.ipaddr());
+    port_.SetIceRole(ICEROLE_CONTROLLING);
+    port_.SetIceTiebreaker(1);
+    port_.PrepareAddress();
+
+    IceControllerFactoryArgs args;
+    args.ice_transport_state_func = [] {
+      return IceTransportState::STATE_INIT;
+    };
+    args.ice_role_func = [] { return ICEROLE_CONTROLLING; };
+    args.is_connection_pruned_func = [](const Connection*) { return false; };
+    args.ice_field_trials = &field_trials_;
+    controller_ = std::make_unique<BasicIceController>(args);
+  }
+
+  // Creates `count` connections to remote host candidates of distinct, random
+  // priorities.
+  std::vector<Connection*> CreateConnections(int count) {
+    std::vector<Connection*> conns;
+    for (int i = 0; i < count; ++i, ++next_remote_port_) {
+      Candidate remote(ICE_CANDIDATE_COMPONENT_DEFAULT, UDP_PROTOCOL_NAME,
+                       rtc::SocketAddress("10.0.0.1", next_remote_port_),
+                       next_remote_port_ * 10 + random_.Rand(9), "rfrag",
+                       "rpass", LOCAL_PORT_TYPE, 0, "");
+      conns.push_back(
+          port_.CreateConnection(remote, PortInterface::ORIGIN_MESSAGE));
+    }
+    // Add them in random order, so that the initial order is not the
+    // priority order.
+    std::vector<Connection*> shuffled = conns;
+    for (size_t i = shuffled.size(); i > 1; --i) {
+      std::swap(shuffled[i - 1], shuffled[random_.Rand(i - 1)]);
+    }
+    for (Connection* conn : shuffled) {
+      controller_->AddConnection(conn);
+    }
+    return conns;
+  }
+
+  // The order that the connections of the test are expected to be ranked in:
+  // writable ones first, then receiving ones, each by descending priority.
+  static bool RanksBefore(const Connection* a, const Connection* b) {
+    if (a->writable() != b->writable()) {
+      return a->writable();
+    }
+    if (a->receiving() != b->receiving()) {
+      return a->receiving();
+    }
+    return a->priority() > b->priority();
+  }
+
+  void SortConnections() {
+    controller_->SortAndSwitchConnection(
+        IceControllerEvent::CONNECT_STATE_CHANGE);
+  }
+
+  void ExpectRanked() {
+    std::vector<const Connection*> ranked(controller_->connections().begin(),
+                                          controller_->connections().end());
+    EXPECT_TRUE(std::is_sorted(ranked.begin(), ranked.end(), &RanksBefore));
+  }
+
+ protected:
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  rtc::Network network_;
+  FakeIcePort port_;
+  IceFieldTrials field_trials_;
+  webrtc::Random random_{1234};
+  int next_remote_port_ = 10000;
+  std::unique_ptr<BasicIceController> controller_;
+};
+
+}  // namespace
+
+TEST_F(BasicIceControllerTest, RanksConnectionsAsTheyChangeState) {
+  std::vector<Connection*> conns = CreateConnections(40);
+  SortConnections();
+  ExpectRanked();
+
+  // A few connections become receiving, then a few others writable, which
+  // moves them ahead of connections of higher priority.
+  for (int i = 0; i < 5; ++i) {
+    conns[random_.Rand(conns.size() - 1)]->ReceivedPing();
+  }
+  SortConnections();
+  ExpectRanked();
+  for (int i = 0; i < 5; ++i) {
+    conns[random_.Rand(conns.size() - 1)]->ReceivedPingResponse(10, "id");
+  }
+  SortConnections();
+  ExpectRanked();
+
+  // Connections added later are ranked among the others.
+  CreateConnections(10);
+  SortConnections();
+  ExpectRanked();
+  EXPECT_EQ(50u, controller_->connections().size());
+}
+
+TEST_F(BasicIceControllerTest, PingsEachConnectionOncePerRound) {
+  std::vector<Connection*> conns = CreateConnections(10);
+  SortConnections();
+
+  for (int round = 0; round < 2; ++round) {
+    std::vector<const Connection*> pinged;
+    for (size_t i = 0; i < conns.size(); ++i) {
+      const Connection* conn = controller_->FindNextPingableConnection();
+      ASSERT_TRUE(conn);
+      controller_->MarkConnectionPinged(conn);
+      pinged.push_back(conn);
+    }
+    // None of them has been pinged yet, so they are pinged in rank order.
+    EXPECT_TRUE(std::equal(pinged.begin(), pinged.end(),
+                           controller_->connections().begin(),
+                           controller_->connections().end()));
+  }
+}
+
+TEST_F(BasicIceControllerTest, PingsConnectionWithTriggeredCheckFirst) {
+  std::vector<Connection*> conns = CreateConnections(10);
+  SortConnections();
+  Connection* last = conns[0];
+  for (Connection* conn : conns) {
+    if (RanksBefore(last, conn))
+      last = conn;
+  }
+  last->ReceivedPing();
+  EXPECT_EQ(last, controller_->FindNextPingableConnection());
+}
+
+// Measures the cost of re-ranking the connections and picking the next one to
+// ping after a connection changes state, for growing numbers of candidate
+// pairs.
+TEST_F(BasicIceControllerTest, DISABLED_RankingAndPingingPerformance) {
+  constexpr int kNumEvents = 2000;
+  std::vector<Connection*> conns;
+  for (int num_connections : {16, 64, 256, 1024, 4096}) {
+    std::vector<Connection*> added =
+        CreateConnections(num_connections - conns.size());
+    conns.insert(conns.end(), added.begin(), added.end());
+    SortConnections();
+
+    int64_t start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumEvents; ++i) {
+      Connection* conn = conns[random_.Rand(conns.size() - 1)];
+      switch (i % 3) {
+        case 0:
+          conn->ReceivedPing();
+          break;
+        case 1:
+          conn->ReceivedPingResponse(10, "id");
+          break;
+        case 2:
+          conn->Prune();
+          break;
+      }
+      SortConnections();
+      const Connection* ping = controller_->FindNextPingableConnection();
+      if (ping) {
+        controller_->MarkConnectionPinged(ping);
+      }
+    }
+    int64_t elapsed_ns = rtc::SystemTimeNanos() - start_ns;
+    printf("%5d connections: %8.2f us per state change\n", num_connections,
+           elapsed_ns / 1000.0 / kNumEvents);
+  }
+}
+
+}  // namespace cricket
@@ -303,6 +303,11 @@ bool DtlsTransport::SetRemoteFingerprint(const std::string& digest_alg,
   return true;
 }
 
+void DtlsTransport::SetSslCryptoPool(rtc::SSLCryptoPool* pool) {
+  RTC_DCHECK_RUN_ON(&thread_checker_);
+  ssl_crypto_pool_ = pool;
+}
+
 std::unique_ptr<rtc::SSLCertChain> DtlsTransport::GetRemoteSSLCertChain()
     const {
   if (!dtls_) {
@@ -342,6 +347,9 @@ bool DtlsTransport::SetupDtls() {
   dtls_->SetMode(rtc::SSL_MODE_DTLS);
   dtls_->SetMaxProtocolVersion(ssl_max_version_);
   dtls_->SetServerRole(*dtls_role_);
+  if (ssl_crypto_pool_) {
+    dtls_->SetCryptoPool(ssl_crypto_pool_);
+  }
   dtls_->SignalEvent.connect(this, &DtlsTransport::OnDtlsEvent);
   dtls_->SignalSSLHandshakeError.connect(this,
                                          &DtlsTransport::OnDtlsHandshakeError);
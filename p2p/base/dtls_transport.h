@@ -136,6 +136,11 @@ class DtlsTransport : public DtlsTransportInternal {
                             const uint8_t* digest,
                             size_t digest_len) override;
 
+  // Runs the private key operations of DTLS handshakes on `pool`, rather than
+  // on the network thread. `pool` must outlive this transport. Only affects
+  // handshakes set up after this call.
+  void SetSslCryptoPool(rtc::SSLCryptoPool* pool);
+
   // Called to send a packet (via DTLS, if turned on).
   int SendPacket(const char* data,
                  size_t size,
@@ -236,6 +241,7 @@ class DtlsTransport : public DtlsTransportInternal {
   rtc::scoped_refptr<rtc::RTCCertificate> local_certificate_;
   absl::optional<rtc::SSLRole> dtls_role_;
   const rtc::SSLProtocolVersion ssl_max_version_;
+  rtc::SSLCryptoPool* ssl_crypto_pool_ = nullptr;
   rtc::Buffer remote_fingerprint_value_;
   std::string remote_fingerprint_algorithm_;
 
@@ -75,6 +75,7 @@ class DtlsTestClient : public sigslot::has_slots<> {
   void SetupMaxProtocolVersion(rtc::SSLProtocolVersion version) {
     ssl_max_version_ = version;
   }
+  void SetSslCryptoPool(rtc::SSLCryptoPool* pool) { ssl_crypto_pool_ = pool; }
   // Set up fake ICE transport and real DTLS transport under test.
   void SetupTransports(IceRole role, int async_delay_ms = 0) {
     fake_ice_transport_.reset(new FakeIceTransport("fake", 0));
@@ -90,6 +91,7 @@ class DtlsTestClient : public sigslot::has_slots<> {
     dtls_transport_ = std::make_unique<DtlsTransport>(
         fake_ice_transport_.get(), webrtc::CryptoOptions(),
         /*event_log=*/nullptr, ssl_max_version_);
+    dtls_transport_->SetSslCryptoPool(ssl_crypto_pool_);
     // Note: Certificate may be null here if testing passthrough.
     dtls_transport_->SetLocalCertificate(certificate_);
     dtls_transport_->SignalWritableState.connect(
@@ -290,6 +292,7 @@ class DtlsTestClient : public sigslot::has_slots<> {
   size_t packet_size_ = 0u;
   std::set<int> received_;
   rtc::SSLProtocolVersion ssl_max_version_ = rtc::SSL_PROTOCOL_DTLS_12;
+  rtc::SSLCryptoPool* ssl_crypto_pool_ = nullptr;
   int received_dtls_client_hellos_ = 0;
   int received_dtls_server_hellos_ = 0;
   rtc::SentPacket sent_packet_;
@@ -316,6 +319,13 @@ class DtlsTransportTestBase {
     use_dtls_ = true;
   }
 
+  // Runs the private key operations of the handshakes on a crypto pool.
+  void UseCryptoPool() {
+    crypto_pool_ = rtc::SSLCryptoPool::Create(2);
+    client1_.SetSslCryptoPool(crypto_pool_.get());
+    client2_.SetSslCryptoPool(crypto_pool_.get());
+  }
+
   // This test negotiates DTLS parameters before the underlying transports are
   // writable. DtlsEventOrderingTest is responsible for exercising differerent
   // orderings.
@@ -381,6 +391,8 @@ class DtlsTransportTestBase {
 
  protected:
   rtc::ScopedFakeClock fake_clock_;
+  // Outlives the clients.
+  std::unique_ptr<rtc::SSLCryptoPool> crypto_pool_;
   DtlsTestClient client1_;
   DtlsTestClient client2_;
   bool use_dtls_;
@@ -421,6 +433,15 @@ TEST_F(DtlsTransportTest, TestTransferDtls) {
   TestTransfer(1000, 100, /*srtp=*/false);
 }
 
+// Connect with DTLS, with the private key operations of the handshakes run on
+// a crypto pool, and transfer data over DTLS.
+TEST_F(DtlsTransportTest, TestTransferDtlsWithCryptoPool) {
+  PrepareDtls(rtc::KT_DEFAULT);
+  UseCryptoPool();
+  ASSERT_TRUE(Connect());
+  TestTransfer(1000, 100, /*srtp=*/false);
+}
+
 // Connect with DTLS, combine multiple DTLS records into one packet.
 // Our DTLS implementation doesn't do this, but other implementations may;
 // see https://tools.ietf.org/html/rfc6347#section-4.1.1.
@@ -0,0 +1,206 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <string>
+#include <utility>
+
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+
+namespace cricket {
+
+struct ShardedTurnServer::Shard {
+  std::unique_ptr<rtc::Thread> thread;
+  // Accessed on `thread` only. Reset when the server shuts down, after which
+  // packets still queued for the shard are dropped.
+  std::unique_ptr<TurnServer> server;
+  // One for each internal socket, owned by `server`.
+  std::vector<ShardSocket*> sockets;
+};
+
+// Stands in for an internal socket of the network thread on the thread of a
+// shard. The packets handed to the shard are signalled from here, and the
+// packets sent by the shard's TurnServer are posted to the real socket.
+class ShardedTurnServer::ShardSocket : public rtc::AsyncPacketSocket {
+ public:
+  ShardSocket(rtc::Thread* network_thread,
+              rtc::AsyncPacketSocket* socket,
+              rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> safety)
+      : network_thread_(network_thread),
+        socket_(socket),
+        local_address_(socket->GetLocalAddress()),
+        safety_(std::move(safety)) {}
+
+  void ReceivePacket(const rtc::CopyOnWriteBuffer& packet,
+                     const rtc::SocketAddress& addr,
+                     int64_t packet_time_us) {
+    SignalReadPacket(this, packet.cdata<char>(), packet.size(), addr,
+                     packet_time_us);
+  }
+
+  rtc::SocketAddress GetLocalAddress() const override {
+    return local_address_;
+  }
+  rtc::SocketAddress GetRemoteAddress() const override {
+    return rtc::SocketAddress();
+  }
+  int Send(const void* pv,
+           size_t cb,
+           const rtc::PacketOptions& options) override {
+    RTC_NOTREACHED() << "Only UDP sockets can be sharded";
+    return -1;
+  }
+  int SendTo(const void* pv,
+             size_t cb,
+             const rtc::SocketAddress& addr,
+             const rtc::PacketOptions& options) override {
+    rtc::CopyOnWriteBuffer packet(static_cast<const uint8_t*>(pv), cb);
+    rtc::AsyncPacketSocket* socket = socket_;
+    network_thread_->PostTask(webrtc::ToQueuedTask(
+        safety_, [socket, packet = std::move(packet), addr, options] {
+          socket->SendTo(packet.cdata(), packet.size(), addr, options);
+        }));
+    return static_cast<int>(cb);
+  }
+  int Close() override { return 0; }
+  State GetState() const override { return STATE_BOUND; }
+  int GetOption(rtc::Socket::Option opt, int* value) override { return -1; }
+  int SetOption(rtc::Socket::Option opt, int value) override { return -1; }
+  int GetError() const override { return 0; }
+  void SetError(int error) override {}
+
+ private:
+  rtc::Thread* const network_thread_;
+  rtc::AsyncPacketSocket* const socket_;
+  const rtc::SocketAddress local_address_;
+  const rtc::scoped_refptr<webrtc::PendingTaskSafetyFlag> safety_;
+};
+
+ShardedTurnServer::ShardedTurnServer(rtc::Thread* network_thread,
+                                     int num_shards)
+    : network_thread_(network_thread) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  RTC_DCHECK_GE(num_shards, 1);
+  for (int i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<Shard>();
+    shard->thread = rtc::Thread::CreateWithSocketServer();
+    shard->thread->SetName("TurnShard" + std::to_string(i), nullptr);
+    shard->thread->Start();
+    Shard* raw_shard = shard.get();
+    shard->thread->Invoke<void>(RTC_FROM_HERE, [raw_shard] {
+      raw_shard->server =
+          std::make_unique<TurnServer>(raw_shard->thread.get());
+    });
+    shards_.push_back(std::move(shard));
+  }
+}
+
+ShardedTurnServer::~ShardedTurnServer() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    Shard* raw_shard = shard.get();
+    shard->thread->Invoke<void>(RTC_FROM_HERE, [raw_shard] {
+      raw_shard->server.reset();
+      raw_shard->sockets.clear();
+    });
+    shard->thread->Stop();
+  }
+}
+
+// static
+int ShardedTurnServer::ShardIndex(const rtc::SocketAddress& src,
+                                  const rtc::SocketAddress& local,
+                                  int num_shards) {
+  RTC_DCHECK_GE(num_shards, 1);
+  uint64_t hash = src.Hash() ^ (static_cast<uint64_t>(local.Hash()) << 1);
+  // Mix the bits, since the address hashes barely touch the low bits that
+  // pick the shard.
+  hash *= 0x9E3779B97F4A7C15ull;
+  return static_cast<int>((hash >> 32) % static_cast<uint64_t>(num_shards));
+}
+
+void ShardedTurnServer::ConfigureServers(
+    std::function<void(TurnServer*)> configure) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    Shard* raw_shard = shard.get();
+    shard->thread->Invoke<void>(RTC_FROM_HERE, [raw_shard, &configure] {
+      configure(raw_shard->server.get());
+    });
+  }
+}
+
+void ShardedTurnServer::AddInternalSocket(rtc::AsyncPacketSocket* socket) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  internal_sockets_.emplace_back(socket);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    Shard* raw_shard = shard.get();
+    auto* shard_socket =
+        new ShardSocket(network_thread_, socket, safety_.flag());
+    shard->thread->Invoke<void>(RTC_FROM_HERE, [raw_shard, shard_socket] {
+      raw_shard->sockets.push_back(shard_socket);
+      raw_shard->server->AddInternalSocket(shard_socket, PROTO_UDP);
+    });
+  }
+  socket->SignalReadPacket.connect(this, &ShardedTurnServer::OnInternalPacket);
+}
+
+void ShardedTurnServer::SetExternalAddress(
+    const rtc::SocketAddress& external_addr) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    Shard* raw_shard = shard.get();
+    shard->thread->Invoke<void>(RTC_FROM_HERE, [raw_shard, &external_addr] {
+      raw_shard->server->SetExternalSocketFactory(
+          new rtc::BasicPacketSocketFactory(
+              raw_shard->thread->socketserver()),
+          external_addr);
+    });
+  }
+}
+
+std::vector<size_t> ShardedTurnServer::NumAllocations() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  std::vector<size_t> num_allocations;
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    Shard* raw_shard = shard.get();
+    num_allocations.push_back(shard->thread->Invoke<size_t>(
+        RTC_FROM_HERE,
+        [raw_shard] { return raw_shard->server->allocations().size(); }));
+  }
+  return num_allocations;
+}
+
+void ShardedTurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                                         const char* data,
+                                         size_t size,
+                                         const rtc::SocketAddress& addr,
+                                         const int64_t& packet_time_us) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  size_t socket_index = 0;
+  while (internal_sockets_[socket_index].get() != socket)
+    ++socket_index;
+  int shard_index = ShardIndex(addr, socket->GetLocalAddress(), num_shards());
+  Shard* shard = shards_[shard_index].get();
+  rtc::CopyOnWriteBuffer packet(data, size);
+  int64_t time_us = packet_time_us;
+  shard->thread->PostTask(webrtc::ToQueuedTask(
+      [shard, socket_index, packet = std::move(packet), addr, time_us] {
+        if (!shard->server)
+          return;
+        shard->sockets[socket_index]->ReceivePacket(packet, addr, time_us);
+      }));
+}
+
+}  // namespace cricket
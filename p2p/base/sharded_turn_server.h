@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDED_TURN_SERVER_H_
+#define P2P_BASE_SHARDED_TURN_SERVER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "api/sequence_checker.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/task_utils/pending_task_safety_flag.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/thread.h"
+
+namespace cricket {
+
+// Spreads the allocations of a TURN server over worker threads. Packets from
+// clients are received on the network thread and handed, by the 5-tuple they
+// were received on, to one of a number of shards. Each shard runs a
+// TurnServer on its own thread, which owns the allocations of its clients and
+// relays their traffic to and from peers on sockets of its own, so relaying
+// scales with the number of shards.
+//
+// Only UDP sockets can be sharded; TCP and TLS clients should be served by a
+// TurnServer directly. All methods must be called on the network thread.
+class ShardedTurnServer : public sigslot::has_slots<> {
+ public:
+  ShardedTurnServer(rtc::Thread* network_thread, int num_shards);
+  ~ShardedTurnServer() override;
+
+  // Returns the shard handling the allocation of the client `src`, received
+  // on the internal socket bound to `local`.
+  static int ShardIndex(const rtc::SocketAddress& src,
+                        const rtc::SocketAddress& local,
+                        int num_shards);
+
+  int num_shards() const { return static_cast<int>(shards_.size()); }
+
+  // Runs `configure` on the TurnServer of every shard, on the thread of the
+  // shard, e.g., to set the realm and the auth hook. Returns when done.
+  void ConfigureServers(std::function<void(TurnServer*)> configure);
+
+  // Starts listening for UDP packets from internal clients. Takes ownership
+  // of `socket`, which must have been created on the network thread.
+  void AddInternalSocket(rtc::AsyncPacketSocket* socket);
+
+  // Relayed addresses are allocated on `external_addr`, using the socket
+  // server of the thread of each shard.
+  void SetExternalAddress(const rtc::SocketAddress& external_addr);
+
+  // Number of allocations of each shard.
+  std::vector<size_t> NumAllocations();
+
+ private:
+  struct Shard;
+  class ShardSocket;
+
+  void OnInternalPacket(rtc::AsyncPacketSocket* socket,
+                        const char* data,
+                        size_t size,
+                        const rtc::SocketAddress& addr,
+                        const int64_t& packet_time_us);
+
+  rtc::Thread* const network_thread_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::vector<std::unique_ptr<rtc::AsyncPacketSocket>> internal_sockets_
+      RTC_GUARDED_BY(network_thread_);
+  // Guards the replies posted by the shards to the network thread.
+  webrtc::ScopedTaskSafety safety_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDED_TURN_SERVER_H_
@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
+#include "p2p/base/test_turn_client.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/test_client.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+constexpr char kUsername[] = "turnuser";
+constexpr int kChannelNumber = 0x4000;
+constexpr int kNumShards = 4;
+
+const rtc::SocketAddress kLoopbackAddr("127.0.0.1", 0);
+
+class TestAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+};
+
+class ShardedTurnServerTest : public ::testing::Test {
+ public:
+  ShardedTurnServerTest() : thread_(&pss_), server_(&thread_, kNumShards) {
+    rtc::AsyncPacketSocket* socket =
+        rtc::AsyncUDPSocket::Create(&pss_, kLoopbackAddr);
+    server_address_ = socket->GetLocalAddress();
+    server_.AddInternalSocket(socket);
+    server_.SetExternalAddress(kLoopbackAddr);
+    server_.ConfigureServers([this](TurnServer* server) {
+      server->set_realm("example.org");
+      server->set_auth_hook(&auth_);
+    });
+  }
+
+ protected:
+  rtc::PhysicalSocketServer pss_;
+  rtc::AutoSocketServerThread thread_;
+  TestAuth auth_;
+  ShardedTurnServer server_;
+  rtc::SocketAddress server_address_;
+};
+
+}  // namespace
+
+TEST(ShardedTurnServerShardIndexTest, IsStableAndSpreadsClients) {
+  const rtc::SocketAddress local("10.0.0.1", 3478);
+  std::vector<int> clients_per_shard(kNumShards);
+  for (int port = 10000; port < 11000; ++port) {
+    const rtc::SocketAddress src("192.168.1.2", port);
+    int index = ShardedTurnServer::ShardIndex(src, local, kNumShards);
+    ASSERT_GE(index, 0);
+    ASSERT_LT(index, kNumShards);
+    EXPECT_EQ(index, ShardedTurnServer::ShardIndex(src, local, kNumShards));
+    ++clients_per_shard[index];
+  }
+  for (int clients : clients_per_shard) {
+    EXPECT_GT(clients, 1000 / kNumShards / 2);
+  }
+}
+
+TEST_F(ShardedTurnServerTest, AnswersBindingRequests) {
+  TestTurnClient client(&pss_, kLoopbackAddr, server_address_, kUsername);
+  StunMessage request;
+  request.SetType(STUN_BINDING_REQUEST);
+  request.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+  rtc::ByteBufferWriter buf;
+  request.Write(&buf);
+  client.client().SendTo(buf.Data(), buf.Length(), server_address_);
+
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      client.client().NextPacket(rtc::TestClient::kTimeoutMs);
+  ASSERT_TRUE(packet);
+  StunMessage response;
+  rtc::ByteBufferReader reader(packet->buf, packet->size);
+  ASSERT_TRUE(response.Read(&reader));
+  EXPECT_EQ(STUN_BINDING_RESPONSE, response.type());
+  const StunAddressAttribute* mapped_attr =
+      response.GetAddress(STUN_ATTR_XOR_MAPPED_ADDRESS);
+  ASSERT_TRUE(mapped_attr);
+  EXPECT_EQ(client.client().address(), mapped_attr->GetAddress());
+}
+
+TEST_F(ShardedTurnServerTest, AllocatesOnTheShardOfTheClient) {
+  constexpr int kNumClients = 16;
+  std::vector<std::unique_ptr<TestTurnClient>> clients;
+  std::vector<size_t> expected_allocations(kNumShards);
+  for (int i = 0; i < kNumClients; ++i) {
+    clients.push_back(std::make_unique<TestTurnClient>(
+        &pss_, kLoopbackAddr, server_address_, kUsername));
+    ASSERT_TRUE(clients.back()->Allocate());
+    ++expected_allocations[ShardedTurnServer::ShardIndex(
+        clients.back()->client().address(), server_address_, kNumShards)];
+  }
+  EXPECT_EQ(expected_allocations, server_.NumAllocations());
+}
+
+TEST_F(ShardedTurnServerTest, RelaysChannelData) {
+  TestTurnClient client(&pss_, kLoopbackAddr, server_address_, kUsername);
+  rtc::TestClient peer(
+      absl::WrapUnique(rtc::AsyncUDPSocket::Create(&pss_, kLoopbackAddr)));
+  ASSERT_TRUE(client.Allocate());
+  ASSERT_TRUE(client.BindChannel(kChannelNumber, peer.address()));
+
+  const char kChannelData[] = {0x40, 0x00, 0x00, 0x02, 'h', 'i'};
+  client.client().SendTo(kChannelData, sizeof(kChannelData), server_address_);
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      peer.NextPacket(rtc::TestClient::kTimeoutMs);
+  ASSERT_TRUE(packet);
+  ASSERT_EQ(2u, packet->size);
+  EXPECT_EQ(0, memcmp("hi", packet->buf, 2));
+
+  peer.SendTo("hi", 2, packet->addr);
+  packet = client.client().NextPacket(rtc::TestClient::kTimeoutMs);
+  ASSERT_TRUE(packet);
+  ASSERT_EQ(sizeof(kChannelData), packet->size);
+  EXPECT_EQ(0, memcmp(kChannelData, packet->buf, sizeof(kChannelData)));
+}
+
+}  // namespace cricket
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_TEST_TURN_CLIENT_H_
+#define P2P_BASE_TEST_TURN_CLIENT_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/test_client.h"
+
+namespace cricket {
+
+// Speaks just enough TURN over UDP to allocate a relayed address and to bind
+// channels, for testing a TurnServer without a TurnPort. Authenticates with
+// the username as password, like TestTurnServer expects.
+class TestTurnClient {
+ public:
+  TestTurnClient(rtc::SocketFactory* socket_factory,
+                 const rtc::SocketAddress& local_address,
+                 const rtc::SocketAddress& server_address,
+                 const std::string& username)
+      : client_(absl::WrapUnique(
+            rtc::AsyncUDPSocket::Create(socket_factory, local_address))),
+        server_address_(server_address),
+        username_(username) {}
+
+  rtc::TestClient& client() { return client_; }
+  const rtc::SocketAddress& server_address() const { return server_address_; }
+  const rtc::SocketAddress& relayed_address() const {
+    return relayed_address_;
+  }
+
+  bool Allocate() {
+    // The first request is rejected with the realm and the nonce to
+    // authenticate the second one with.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      TurnMessage request;
+      request.SetType(STUN_ALLOCATE_REQUEST);
+      request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+          STUN_ATTR_REQUESTED_TRANSPORT, IPPROTO_UDP << 24));
+      std::unique_ptr<TurnMessage> response = Transact(&request);
+      if (!response) {
+        return false;
+      }
+      if (response->type() == STUN_ALLOCATE_RESPONSE) {
+        const StunAddressAttribute* relayed_attr =
+            response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS);
+        if (!relayed_attr) {
+          return false;
+        }
+        relayed_address_ = relayed_attr->GetAddress();
+        return true;
+      }
+      const StunByteStringAttribute* realm_attr =
+          response->GetByteString(STUN_ATTR_REALM);
+      const StunByteStringAttribute* nonce_attr =
+          response->GetByteString(STUN_ATTR_NONCE);
+      if (!realm_attr || !nonce_attr) {
+        return false;
+      }
+      realm_ = realm_attr->GetString();
+      nonce_ = nonce_attr->GetString();
+      ComputeStunCredentialHash(username_, realm_, username_, &key_);
+    }
+    return false;
+  }
+
+  bool BindChannel(int channel_number, const rtc::SocketAddress& peer) {
+    TurnMessage request;
+    request.SetType(TURN_CHANNEL_BIND_REQUEST);
+    request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_CHANNEL_NUMBER, channel_number << 16));
+    request.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer));
+    std::unique_ptr<TurnMessage> response = Transact(&request);
+    return response && response->type() == TURN_CHANNEL_BIND_RESPONSE;
+  }
+
+ private:
+  std::unique_ptr<TurnMessage> Transact(TurnMessage* request) {
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    if (!nonce_.empty()) {
+      request->AddAttribute(std::make_unique<StunByteStringAttribute>(
+          STUN_ATTR_USERNAME, username_));
+      request->AddAttribute(
+          std::make_unique<StunByteStringAttribute>(STUN_ATTR_REALM, realm_));
+      request->AddAttribute(
+          std::make_unique<StunByteStringAttribute>(STUN_ATTR_NONCE, nonce_));
+      request->AddMessageIntegrity(key_);
+    }
+    rtc::ByteBufferWriter buf;
+    request->Write(&buf);
+    client_.SendTo(buf.Data(), buf.Length(), server_address_);
+
+    std::unique_ptr<rtc::TestClient::Packet> packet =
+        client_.NextPacket(rtc::TestClient::kTimeoutMs);
+    if (!packet) {
+      return nullptr;
+    }
+    auto response = std::make_unique<TurnMessage>();
+    rtc::ByteBufferReader reader(packet->buf, packet->size);
+    if (!response->Read(&reader)) {
+      return nullptr;
+    }
+    return response;
+  }
+
+  rtc::TestClient client_;
+  const rtc::SocketAddress server_address_;
+  const std::string username_;
+  rtc::SocketAddress relayed_address_;
+  std::string realm_;
+  std::string nonce_;
+  std::string key_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_TEST_TURN_CLIENT_H_
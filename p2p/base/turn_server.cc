@@ -14,7 +14,6 @@
 #include <tuple>  // for std::tie
 #include <utility>
 
-#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "api/packet_socket_factory.h"
 #include "api/transport/stun.h"
@@ -216,16 +215,31 @@ void TurnServer::OnInternalPacket(rtc::AsyncPacketSocket* socket,
     HandleStunMessage(&conn, data, size);
   } else {
     // This is a channel message; let the allocation handle it.
-    TurnServerAllocation* allocation = FindAllocation(&conn);
-    if (allocation) {
-      allocation->HandleChannelData(data, size);
-    }
+    HandleChannelData(&conn, data, size);
     if (stun_message_observer_ != nullptr) {
       stun_message_observer_->ReceivedChannelData(data, size);
     }
   }
 }
 
+void TurnServer::HandleChannelData(TurnServerConnection* conn,
+                                   const char* data,
+                                   size_t size) {
+  // ChannelData is most of the relayed traffic, so it is forwarded straight
+  // from the header, without going through the STUN parser. The length field
+  // excludes the padding added over TCP (RFC 5766, section 11.5).
+  size_t length = TURN_CHANNEL_HEADER_SIZE + rtc::GetBE16(data + 2);
+  if (length > size) {
+    RTC_LOG(LS_WARNING) << "Received truncated channel data, length=" << length
+                        << ", size=" << size;
+    return;
+  }
+  TurnServerAllocation* allocation = FindAllocation(conn);
+  if (allocation) {
+    allocation->HandleChannelData(data, length);
+  }
+}
+
 void TurnServer::HandleStunMessage(TurnServerConnection* conn,
                                    const char* data,
                                    size_t size) {
@@ -582,6 +596,12 @@ bool TurnServerConnection::operator<(const TurnServerConnection& c) const {
   return std::tie(src_, dst_, proto_) < std::tie(c.src_, c.dst_, c.proto_);
 }
 
+size_t TurnServerConnection::Hash::operator()(
+    const TurnServerConnection& conn) const {
+  return conn.src_.Hash() ^ (conn.dst_.Hash() << 1) ^
+         static_cast<size_t>(conn.proto_);
+}
+
 std::string TurnServerConnection::ToString() const {
   const char* const kProtos[] = {"unknown", "udp", "tcp", "ssltcp"};
   rtc::StringBuilder ost;
@@ -605,12 +625,11 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 }
 
 TurnServerAllocation::~TurnServerAllocation() {
-  for (ChannelList::iterator it = channels_.begin(); it != channels_.end();
-       ++it) {
-    delete *it;
+  for (const auto& channel : channels_) {
+    delete channel.second;
   }
-  for (PermissionList::iterator it = perms_.begin(); it != perms_.end(); ++it) {
-    delete *it;
+  for (const auto& perm : perms_) {
+    delete perm.second;
   }
   thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
   RTC_LOG(LS_INFO) << ToString() << ": Allocation destroyed";
@@ -791,7 +810,8 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
     channel1 = new Channel(thread_, channel_id, peer_attr->GetAddress());
     channel1->SignalDestroyed.connect(
         this, &TurnServerAllocation::OnChannelDestroyed);
-    channels_.push_back(channel1);
+    channels_[channel_id] = channel1;
+    channels_by_peer_[channel1->peer()] = channel1;
   } else {
     channel1->Refresh();
   }
@@ -833,11 +853,11 @@ void TurnServerAllocation::OnExternalPacket(
   Channel* channel = FindChannel(addr);
   if (channel) {
     // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
-    buf.WriteUInt16(channel->id());
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(data, size);
-    server_->Send(&conn_, buf);
+    channel_data_buffer_.Clear();
+    channel_data_buffer_.WriteUInt16(channel->id());
+    channel_data_buffer_.WriteUInt16(static_cast<uint16_t>(size));
+    channel_data_buffer_.WriteBytes(data, size);
+    server_->Send(&conn_, channel_data_buffer_);
   } else if (!server_->enable_permission_checks_ ||
              HasPermission(addr.ipaddr())) {
     // No channel, but a permission exists. Send as a data indication.
@@ -876,7 +896,7 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
     perm = new Permission(thread_, addr);
     perm->SignalDestroyed.connect(this,
                                   &TurnServerAllocation::OnPermissionDestroyed);
-    perms_.push_back(perm);
+    perms_[addr] = perm;
   } else {
     perm->Refresh();
   }
@@ -884,32 +904,20 @@ void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
 
 TurnServerAllocation::Permission* TurnServerAllocation::FindPermission(
     const rtc::IPAddress& addr) const {
-  for (PermissionList::const_iterator it = perms_.begin(); it != perms_.end();
-       ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  PermissionMap::const_iterator it = perms_.find(addr);
+  return (it != perms_.end()) ? it->second : nullptr;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     int channel_id) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->id() == channel_id)
-      return *it;
-  }
-  return NULL;
+  ChannelIdMap::const_iterator it = channels_.find(channel_id);
+  return (it != channels_.end()) ? it->second : nullptr;
 }
 
 TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
     const rtc::SocketAddress& addr) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
-  }
-  return NULL;
+  ChannelPeerMap::const_iterator it = channels_by_peer_.find(addr);
+  return (it != channels_by_peer_.end()) ? it->second : nullptr;
 }
 
 void TurnServerAllocation::SendResponse(TurnMessage* msg) {
@@ -942,15 +950,15 @@ void TurnServerAllocation::OnMessage(rtc::Message* msg) {
 }
 
 void TurnServerAllocation::OnPermissionDestroyed(Permission* perm) {
-  auto it = absl::c_find(perms_, perm);
-  RTC_DCHECK(it != perms_.end());
-  perms_.erase(it);
+  size_t erased = perms_.erase(perm->peer());
+  RTC_DCHECK_EQ(erased, 1);
 }
 
 void TurnServerAllocation::OnChannelDestroyed(Channel* channel) {
-  auto it = absl::c_find(channels_, channel);
-  RTC_DCHECK(it != channels_.end());
-  channels_.erase(it);
+  size_t erased = channels_.erase(channel->id());
+  RTC_DCHECK_EQ(erased, 1);
+  erased = channels_by_peer_.erase(channel->peer());
+  RTC_DCHECK_EQ(erased, 1);
 }
 
 TurnServerAllocation::Permission::Permission(rtc::Thread* thread,
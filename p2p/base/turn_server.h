@@ -11,23 +11,24 @@
 #ifndef P2P_BASE_TURN_SERVER_H_
 #define P2P_BASE_TURN_SERVER_H_
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "api/sequence_checker.h"
 #include "p2p/base/port_interface.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
 
 namespace rtc {
-class ByteBufferWriter;
 class PacketSocketFactory;
 }  // namespace rtc
 
@@ -43,6 +44,12 @@ const int TURN_SERVER_PORT = 3478;
 // Encapsulates the client's connection to the server.
 class TurnServerConnection {
  public:
+  // Hashes the fields compared by operator==, for use in unordered
+  // containers.
+  struct Hash {
+    size_t operator()(const TurnServerConnection& conn) const;
+  };
+
   TurnServerConnection() : proto_(PROTO_UDP), socket_(NULL) {}
   TurnServerConnection(const rtc::SocketAddress& src,
                        ProtocolType proto,
@@ -93,8 +100,21 @@ class TurnServerAllocation : public rtc::MessageHandlerAutoCleanup,
  private:
   class Channel;
   class Permission;
-  typedef std::list<Permission*> PermissionList;
-  typedef std::list<Channel*> ChannelList;
+
+  // Permissions and channels are looked up for every relayed packet.
+  struct AddressHash {
+    size_t operator()(const rtc::IPAddress& addr) const {
+      return rtc::HashIP(addr);
+    }
+    size_t operator()(const rtc::SocketAddress& addr) const {
+      return addr.Hash();
+    }
+  };
+  typedef std::unordered_map<rtc::IPAddress, Permission*, AddressHash>
+      PermissionMap;
+  typedef std::unordered_map<int, Channel*> ChannelIdMap;
+  typedef std::unordered_map<rtc::SocketAddress, Channel*, AddressHash>
+      ChannelPeerMap;
 
   void HandleAllocateRequest(const TurnMessage* msg);
   void HandleRefreshRequest(const TurnMessage* msg);
@@ -137,8 +157,12 @@ class TurnServerAllocation : public rtc::MessageHandlerAutoCleanup,
   std::string username_;
   std::string origin_;
   std::string last_nonce_;
-  PermissionList perms_;
-  ChannelList channels_;
+  PermissionMap perms_;
+  // The same channels, indexed by channel number and by peer address.
+  ChannelIdMap channels_;
+  ChannelPeerMap channels_by_peer_;
+  // Reused to frame the packets received from peers as ChannelData.
+  rtc::ByteBufferWriter channel_data_buffer_;
 };
 
 // An interface through which the MD5 credential hash can be retrieved.
@@ -174,7 +198,9 @@ class StunMessageObserver {
 // Not yet wired up: TCP support.
 class TurnServer : public sigslot::has_slots<> {
  public:
-  typedef std::map<TurnServerConnection, std::unique_ptr<TurnServerAllocation>>
+  typedef std::unordered_map<TurnServerConnection,
+                             std::unique_ptr<TurnServerAllocation>,
+                             TurnServerConnection::Hash>
       AllocationMap;
 
   explicit TurnServer(rtc::Thread* thread);
@@ -274,6 +300,9 @@ class TurnServer : public sigslot::has_slots<> {
   void HandleStunMessage(TurnServerConnection* conn,
                          const char* data,
                          size_t size) RTC_RUN_ON(thread_);
+  void HandleChannelData(TurnServerConnection* conn,
+                         const char* data,
+                         size_t size) RTC_RUN_ON(thread_);
   void HandleBindingRequest(TurnServerConnection* conn, const StunMessage* msg)
       RTC_RUN_ON(thread_);
   void HandleAllocateRequest(TurnServerConnection* conn,
@@ -10,15 +10,65 @@
 
 #include "p2p/base/turn_server.h"
 
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "api/transport/stun.h"
 #include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/test_turn_client.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/test_client.h"
+#include "rtc_base/time_utils.h"
 #include "rtc_base/virtual_socket_server.h"
 #include "test/gtest.h"
 
 // NOTE: This is a work in progress. Currently this file only has tests for
-// TurnServerConnection, a primitive class used by TurnServer.
+// TurnServerConnection, a primitive class used by TurnServer, and for relaying
+// through channels.
 
 namespace cricket {
 
+namespace {
+
+constexpr char kRealm[] = "example.org";
+// The auth hook of the tests accepts the username as password.
+constexpr char kUsername[] = "turnuser";
+constexpr int kChannelNumber = 0x4000;
+
+const rtc::SocketAddress kTurnIntAddr("99.99.99.3", 3478);
+const rtc::SocketAddress kTurnExtAddr("99.99.99.5", 0);
+const rtc::SocketAddress kClientAddr("11.11.11.11", 0);
+const rtc::SocketAddress kPeerAddr("22.22.22.22", 5000);
+
+// Counts the packets received on a socket, without keeping them.
+class PacketCounter : public sigslot::has_slots<> {
+ public:
+  explicit PacketCounter(rtc::AsyncPacketSocket* socket) {
+    socket->SignalReadPacket.connect(this, &PacketCounter::OnReadPacket);
+  }
+
+  int packets() const { return packets_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& addr,
+                    const int64_t& packet_time_us) {
+    ++packets_;
+  }
+
+  int packets_ = 0;
+};
+
+}  // namespace
+
 class TurnServerConnectionTest : public ::testing::Test {
  public:
   TurnServerConnectionTest() : thread_(&vss_), socket_factory_(&vss_) {}
@@ -62,4 +112,131 @@ TEST_F(TurnServerConnectionTest, ComparisonOperators) {
   ExpectNotEqual(connection1, connection4);
 }
 
+class TurnServerRelayTest : public ::testing::Test,
+                            public TurnAuthInterface {
+ public:
+  TurnServerRelayTest()
+      : thread_(&vss_),
+        server_(&thread_),
+        peer_(absl::WrapUnique(
+            rtc::AsyncUDPSocket::Create(&vss_, kPeerAddr))) {
+    server_.AddInternalSocket(rtc::AsyncUDPSocket::Create(&vss_, kTurnIntAddr),
+                              PROTO_UDP);
+    server_.SetExternalSocketFactory(new rtc::BasicPacketSocketFactory(&vss_),
+                                     kTurnExtAddr);
+    server_.set_realm(kRealm);
+    server_.set_auth_hook(this);
+  }
+
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    return ComputeStunCredentialHash(username, realm, username, key);
+  }
+
+ protected:
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  TurnServer server_;
+  rtc::TestClient peer_;
+};
+
+TEST_F(TurnServerRelayTest, RelaysChannelDataToPeer) {
+  TestTurnClient client(&vss_, kClientAddr, kTurnIntAddr, kUsername);
+  ASSERT_TRUE(client.Allocate());
+  ASSERT_TRUE(client.BindChannel(kChannelNumber, peer_.address()));
+
+  // The padding to a multiple of four bytes, required over TCP, is not part
+  // of the data.
+  const char kChannelData[] = {0x40, 0x00, 0x00, 0x02, 'h', 'i', 0x00, 0x00};
+  client.client().SendTo(kChannelData, sizeof(kChannelData), kTurnIntAddr);
+
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      peer_.NextPacket(rtc::TestClient::kTimeoutMs);
+  ASSERT_TRUE(packet);
+  EXPECT_EQ(client.relayed_address(), packet->addr);
+  ASSERT_EQ(2u, packet->size);
+  EXPECT_EQ(0, memcmp("hi", packet->buf, 2));
+}
+
+TEST_F(TurnServerRelayTest, DropsTruncatedChannelData) {
+  TestTurnClient client(&vss_, kClientAddr, kTurnIntAddr, kUsername);
+  ASSERT_TRUE(client.Allocate());
+  ASSERT_TRUE(client.BindChannel(kChannelNumber, peer_.address()));
+
+  const char kChannelData[] = {0x40, 0x00, 0x00, 0x08, 'h', 'i'};
+  client.client().SendTo(kChannelData, sizeof(kChannelData), kTurnIntAddr);
+  EXPECT_TRUE(peer_.CheckNoPacket());
+}
+
+TEST_F(TurnServerRelayTest, DropsChannelDataOnUnboundChannel) {
+  TestTurnClient client(&vss_, kClientAddr, kTurnIntAddr, kUsername);
+  ASSERT_TRUE(client.Allocate());
+  ASSERT_TRUE(client.BindChannel(kChannelNumber, peer_.address()));
+
+  const char kChannelData[] = {0x40, 0x01, 0x00, 0x02, 'h', 'i'};
+  client.client().SendTo(kChannelData, sizeof(kChannelData), kTurnIntAddr);
+  EXPECT_TRUE(peer_.CheckNoPacket());
+}
+
+TEST_F(TurnServerRelayTest, RelaysPeerDataToClientAsChannelData) {
+  TestTurnClient client(&vss_, kClientAddr, kTurnIntAddr, kUsername);
+  ASSERT_TRUE(client.Allocate());
+  ASSERT_TRUE(client.BindChannel(kChannelNumber, peer_.address()));
+
+  peer_.SendTo("hi", 2, client.relayed_address());
+
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      client.client().NextPacket(rtc::TestClient::kTimeoutMs);
+  ASSERT_TRUE(packet);
+  const char kChannelData[] = {0x40, 0x00, 0x00, 0x02, 'h', 'i'};
+  ASSERT_EQ(sizeof(kChannelData), packet->size);
+  EXPECT_EQ(0, memcmp(kChannelData, packet->buf, sizeof(kChannelData)));
+}
+
+// Relays ChannelData from many allocations to peers and prints the packets
+// relayed per second. The VirtualSocketServer delivers packets without delay,
+// so this mostly measures the relay path of the server.
+TEST_F(TurnServerRelayTest, DISABLED_ChannelDataRelayThroughput) {
+  constexpr int kNumClients = 500;
+  constexpr int kPacketsPerClient = 200;
+  constexpr size_t kPayloadSize = 1000;
+
+  std::unique_ptr<rtc::AsyncPacketSocket> peer = absl::WrapUnique(
+      rtc::AsyncUDPSocket::Create(&vss_, rtc::SocketAddress("22.22.22.23", 0)));
+  PacketCounter counter(peer.get());
+  std::vector<std::unique_ptr<TestTurnClient>> clients;
+  for (int i = 0; i < kNumClients; ++i) {
+    clients.push_back(std::make_unique<TestTurnClient>(
+        &vss_, kClientAddr, kTurnIntAddr, kUsername));
+    ASSERT_TRUE(clients.back()->Allocate());
+    ASSERT_TRUE(
+        clients.back()->BindChannel(kChannelNumber, peer->GetLocalAddress()));
+  }
+
+  rtc::ByteBufferWriter channel_data;
+  channel_data.WriteUInt16(kChannelNumber);
+  channel_data.WriteUInt16(kPayloadSize);
+  channel_data.WriteBytes(std::string(kPayloadSize, 'x').data(), kPayloadSize);
+
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kPacketsPerClient; ++i) {
+    for (const std::unique_ptr<TestTurnClient>& client : clients) {
+      client->client().SendTo(channel_data.Data(), channel_data.Length(),
+                              kTurnIntAddr);
+    }
+    const int64_t deadline_ms = rtc::TimeMillis() + rtc::TestClient::kTimeoutMs;
+    while (counter.packets() < (i + 1) * kNumClients &&
+           rtc::TimeMillis() < deadline_ms) {
+      thread_.ProcessMessages(0);
+    }
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_us;
+
+  EXPECT_EQ(kNumClients * kPacketsPerClient, counter.packets());
+  printf("Relayed %d packets of %d allocations in %.1f ms: %.0f packets/s\n",
+         counter.packets(), kNumClients, elapsed_us / 1000.0,
+         counter.packets() * 1e6 / elapsed_us);
+}
+
 }  // namespace cricket
@@ -40,6 +40,18 @@ bool DataChannelController::SendData(int sid,
   return false;
 }
 
+RTCError DataChannelController::SendData_n(
+    int sid,
+    const SendDataParams& params,
+    const rtc::CopyOnWriteBuffer& payload) {
+  RTC_DCHECK_RUN_ON(network_thread());
+  if (!data_channel_transport()) {
+    return RTCError(RTCErrorType::INVALID_STATE,
+                    "SendData_n called before transport is ready");
+  }
+  return data_channel_transport()->SendData(sid, params, payload);
+}
+
 bool DataChannelController::ConnectDataChannel(
     SctpDataChannel* webrtc_data_channel) {
   RTC_DCHECK_RUN_ON(signaling_thread());
@@ -57,6 +57,9 @@ class DataChannelController : public SctpDataChannelProviderInterface,
                 const SendDataParams& params,
                 const rtc::CopyOnWriteBuffer& payload,
                 cricket::SendDataResult* result) override;
+  RTCError SendData_n(int sid,
+                      const SendDataParams& params,
+                      const rtc::CopyOnWriteBuffer& payload) override;
   bool ConnectDataChannel(SctpDataChannel* webrtc_data_channel) override;
   void DisconnectDataChannel(SctpDataChannel* webrtc_data_channel) override;
   void AddSctpDataStream(int sid) override;
@@ -8,17 +8,25 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "media/sctp/sctp_transport_internal.h"
+#include "pc/data_channel_utils.h"
 #include "pc/sctp_data_channel.h"
 #include "pc/sctp_utils.h"
 #include "pc/test/fake_data_channel_provider.h"
+#include "rtc_base/event.h"
 #include "rtc_base/gunit.h"
+#include "rtc_base/location.h"
 #include "rtc_base/numerics/safe_conversions.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 #include "test/gtest.h"
 
 using webrtc::DataChannelInterface;
@@ -674,6 +682,207 @@ TEST_F(SctpDataChannelTest, TransportGotErrorCode) {
       webrtc_data_channel_->error().sctp_cause_code());
 }
 
+// Tests that data sent with SendAsync() is accounted for in buffered_amount()
+// until it has been sent from the network thread.
+TEST_F(SctpDataChannelTest, SendAsyncSendsQueuedData) {
+  AddObserver();
+  SetChannelReady();
+  webrtc::DataBuffer buffer("abcd");
+  EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+  EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+  EXPECT_EQ(2 * buffer.size(), webrtc_data_channel_->buffered_amount());
+
+  EXPECT_EQ_WAIT(0U, webrtc_data_channel_->buffered_amount(), kDefaultTimeout);
+  EXPECT_EQ(2U, webrtc_data_channel_->messages_sent());
+  EXPECT_EQ(2 * buffer.size(), webrtc_data_channel_->bytes_sent());
+  EXPECT_EQ(0, provider_->last_sid());
+  // Both messages were sent by the same task on the network thread.
+  EXPECT_EQ(1U, observer_->on_buffered_amount_change_count());
+}
+
+// Tests that SendAsync() doesn't accept data unless the channel is open.
+TEST_F(SctpDataChannelTest, SendAsyncFailsUnlessOpen) {
+  webrtc::DataBuffer buffer("abcd");
+  EXPECT_FALSE(webrtc_data_channel_->SendAsync(buffer));
+
+  SetChannelReady();
+  EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+
+  webrtc_data_channel_->CloseAbruptlyWithError(
+      webrtc::RTCError(webrtc::RTCErrorType::OPERATION_ERROR_WITH_DATA, ""));
+  EXPECT_FALSE(webrtc_data_channel_->SendAsync(buffer));
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+}
+
+// Tests that data queued by SendAsync() is sent once the transport is no
+// longer blocked.
+TEST_F(SctpDataChannelTest, SendAsyncResumesWhenUnblocked) {
+  AddObserver();
+  SetChannelReady();
+  webrtc::DataBuffer buffer("abcd");
+  provider_->set_send_blocked(true);
+
+  const int number_of_packets = 3;
+  for (int i = 0; i < number_of_packets; ++i) {
+    EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+  }
+  rtc::Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(buffer.size() * number_of_packets,
+            webrtc_data_channel_->buffered_amount());
+  EXPECT_EQ(0U, webrtc_data_channel_->messages_sent());
+
+  provider_->set_send_blocked(false);
+  EXPECT_EQ_WAIT(0U, webrtc_data_channel_->buffered_amount(), kDefaultTimeout);
+  EXPECT_EQ(static_cast<uint32_t>(number_of_packets),
+            webrtc_data_channel_->messages_sent());
+}
+
+// Tests that the closing procedure waits for data queued by SendAsync().
+TEST_F(SctpDataChannelTest, SendAsyncDataSentBeforeClosing) {
+  SetChannelReady();
+  webrtc::DataBuffer buffer("abcd");
+  EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+
+  webrtc_data_channel_->Close();
+  EXPECT_EQ(webrtc::DataChannelInterface::kClosing,
+            webrtc_data_channel_->state());
+  EXPECT_FALSE(webrtc_data_channel_->SendAsync(buffer));
+
+  EXPECT_EQ_WAIT(webrtc::DataChannelInterface::kClosed,
+                 webrtc_data_channel_->state(), kDefaultTimeout);
+  EXPECT_EQ(1U, webrtc_data_channel_->messages_sent());
+  EXPECT_TRUE(webrtc_data_channel_->error().ok());
+}
+
+// Tests that the DataChannel is closed on transport errors when sending data
+// queued by SendAsync().
+TEST_F(SctpDataChannelTest, SendAsyncClosedOnTransportError) {
+  SetChannelReady();
+  webrtc::DataBuffer buffer("abcd");
+  provider_->set_transport_error();
+
+  EXPECT_TRUE(webrtc_data_channel_->SendAsync(buffer));
+
+  EXPECT_EQ_WAIT(webrtc::DataChannelInterface::kClosed,
+                 webrtc_data_channel_->state(), kDefaultTimeout);
+  EXPECT_EQ(webrtc::RTCErrorType::NETWORK_ERROR,
+            webrtc_data_channel_->error().type());
+}
+
+// Tests that buffered_amount() stays consistent when SendAsync() races with
+// the channel being closed abruptly on the signaling thread.
+TEST_F(SctpDataChannelTest, SendAsyncRacingCloseAbruptlyWithError) {
+  SetChannelReady();
+  provider_->set_send_blocked(true);
+  webrtc::DataBuffer buffer("abcd");
+
+  std::unique_ptr<rtc::Thread> sender = rtc::Thread::Create();
+  sender->Start();
+  rtc::Event started;
+  rtc::Event done;
+  sender->PostTask(webrtc::ToQueuedTask([&] {
+    started.Set();
+    while (webrtc_data_channel_->SendAsync(buffer)) {
+    }
+    done.Set();
+  }));
+  ASSERT_TRUE(started.Wait(kDefaultTimeout));
+
+  webrtc_data_channel_->CloseAbruptlyWithError(
+      webrtc::RTCError(webrtc::RTCErrorType::NETWORK_ERROR, "Closed"));
+  ASSERT_TRUE(done.Wait(kDefaultTimeout));
+  sender->Stop();
+
+  // Run the tasks posted by SendAsync() before and after the close.
+  rtc::Thread::Current()->ProcessMessages(0);
+  EXPECT_EQ(webrtc::DataChannelInterface::kClosed,
+            webrtc_data_channel_->state());
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+  EXPECT_FALSE(webrtc_data_channel_->SendAsync(buffer));
+  EXPECT_EQ(0U, webrtc_data_channel_->buffered_amount());
+}
+
+// A provider which, like DataChannelController, blocks on the network thread
+// when sending data from the signaling thread.
+class NetworkThreadDataChannelProvider : public FakeDataChannelProvider {
+ public:
+  explicit NetworkThreadDataChannelProvider(rtc::Thread* network_thread)
+      : network_thread_(network_thread) {}
+
+  bool SendData(int sid,
+                const webrtc::SendDataParams& params,
+                const rtc::CopyOnWriteBuffer& payload,
+                cricket::SendDataResult* result) override {
+    return network_thread_->Invoke<bool>(RTC_FROM_HERE, [&] {
+      return FakeDataChannelProvider::SendData(sid, params, payload, result);
+    });
+  }
+
+ private:
+  rtc::Thread* const network_thread_;
+};
+
+// Measures how many small messages per second can be sent through the API
+// proxy using Send(), which blocks on the signaling and network threads, and
+// using SendAsync(), which doesn't.
+TEST(SctpDataChannelPerformanceTest, DISABLED_MessagesPerSecond) {
+  constexpr int kNumMessages = 100000;
+  constexpr size_t kMessageSize = 100;
+
+  std::unique_ptr<rtc::Thread> signaling_thread = rtc::Thread::Create();
+  std::unique_ptr<rtc::Thread> network_thread = rtc::Thread::Create();
+  signaling_thread->Start();
+  network_thread->Start();
+  NetworkThreadDataChannelProvider provider(network_thread.get());
+
+  rtc::scoped_refptr<SctpDataChannel> channel;
+  rtc::scoped_refptr<DataChannelInterface> proxy;
+  signaling_thread->Invoke<void>(RTC_FROM_HERE, [&] {
+    provider.set_transport_available(true);
+    channel = SctpDataChannel::Create(&provider, "telemetry",
+                                      webrtc::InternalDataChannelInit(),
+                                      signaling_thread.get(),
+                                      network_thread.get());
+    channel->SetSctpSid(0);
+    provider.set_ready_to_send(true);
+    proxy = SctpDataChannel::CreateProxy(channel);
+  });
+  ASSERT_EQ_WAIT(webrtc::DataChannelInterface::kOpen, proxy->state(),
+                 kDefaultTimeout);
+
+  rtc::CopyOnWriteBuffer payload(kMessageSize);
+  memset(payload.MutableData(), 0, payload.size());
+  webrtc::DataBuffer buffer(payload, true);
+
+  int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumMessages; ++i) {
+    ASSERT_TRUE(proxy->Send(buffer));
+  }
+  int64_t send_us = rtc::TimeMicros() - start_us;
+
+  start_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumMessages; ++i) {
+    ASSERT_TRUE(proxy->SendAsync(buffer));
+  }
+  int64_t enqueue_us = rtc::TimeMicros() - start_us;
+  ASSERT_EQ_WAIT(0U, proxy->buffered_amount(), kDefaultTimeout);
+  int64_t send_async_us = rtc::TimeMicros() - start_us;
+
+  printf("Send:      %8.0f messages/s\n",
+         kNumMessages * 1e6 / std::max<int64_t>(send_us, 1));
+  printf("SendAsync: %8.0f messages/s (%.0f messages/s enqueued)\n",
+         kNumMessages * 1e6 / std::max<int64_t>(send_async_us, 1),
+         kNumMessages * 1e6 / std::max<int64_t>(enqueue_us, 1));
+
+  signaling_thread->Invoke<void>(RTC_FROM_HERE, [&] {
+    proxy = nullptr;
+    channel = nullptr;
+  });
+  // Let any tasks referencing the channel finish before the provider goes.
+  network_thread->Stop();
+  signaling_thread->Stop();
+}
+
 class SctpSidAllocatorTest : public ::testing::Test {
  protected:
   SctpSidAllocator allocator_;
@@ -745,3 +954,48 @@ TEST_F(SctpSidAllocatorTest, SctpIdReusedForRemovedDataChannel) {
   EXPECT_TRUE(allocator_.AllocateSid(rtc::SSL_CLIENT, &allocated_id));
   EXPECT_EQ(even_id + 6, allocated_id);
 }
+
+// Tests that packets pushed concurrently by several producers are all popped,
+// in the order each producer pushed them.
+TEST(ConcurrentPacketQueueTest, KeepsOrderOfEachProducer) {
+  constexpr int kNumProducers = 4;
+  constexpr uint32_t kPacketsPerProducer = 10000;
+
+  webrtc::ConcurrentPacketQueue queue;
+  std::vector<std::unique_ptr<rtc::Thread>> producers;
+  for (int p = 0; p < kNumProducers; ++p) {
+    producers.push_back(rtc::Thread::Create());
+    producers.back()->Start();
+    producers.back()->PostTask(webrtc::ToQueuedTask([&queue, p] {
+      for (uint32_t i = 0; i < kPacketsPerProducer; ++i) {
+        rtc::CopyOnWriteBuffer data(2 * sizeof(uint32_t));
+        uint32_t values[] = {static_cast<uint32_t>(p), i};
+        memcpy(data.MutableData(), values, sizeof(values));
+        queue.PushBack(std::make_unique<webrtc::DataBuffer>(data, true));
+      }
+    }));
+  }
+
+  std::vector<uint32_t> next_index(kNumProducers, 0);
+  uint32_t popped = 0;
+  int64_t deadline_ms = rtc::TimeMillis() + kDefaultTimeout;
+  while (popped < kNumProducers * kPacketsPerProducer &&
+         rtc::TimeMillis() < deadline_ms) {
+    std::unique_ptr<webrtc::DataBuffer> packet = queue.PopFront();
+    if (!packet) {
+      continue;
+    }
+    uint32_t values[2];
+    ASSERT_EQ(sizeof(values), packet->size());
+    memcpy(values, packet->data.data(), sizeof(values));
+    ASSERT_LT(values[0], static_cast<uint32_t>(kNumProducers));
+    EXPECT_EQ(next_index[values[0]]++, values[1]);
+    ++popped;
+  }
+  EXPECT_EQ(kNumProducers * kPacketsPerProducer, popped);
+  EXPECT_EQ(nullptr, queue.PopFront());
+
+  for (auto& producer : producers) {
+    producer->Stop();
+  }
+}
@@ -51,4 +51,37 @@ void PacketQueue::Swap(PacketQueue* other) {
   other->packets_.swap(packets_);
 }
 
+ConcurrentPacketQueue::ConcurrentPacketQueue()
+    : head_(new Node()), tail_(head_.load(std::memory_order_relaxed)) {}
+
+ConcurrentPacketQueue::~ConcurrentPacketQueue() {
+  while (tail_ != nullptr) {
+    Node* next = tail_->next.load(std::memory_order_acquire);
+    delete tail_;
+    tail_ = next;
+  }
+}
+
+void ConcurrentPacketQueue::PushBack(std::unique_ptr<DataBuffer> packet) {
+  RTC_DCHECK(packet);
+  Node* node = new Node();
+  node->packet = std::move(packet);
+  Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+  // Between the exchange and this store, the consumer will see the queue as
+  // ending at `prev`.
+  prev->next.store(node, std::memory_order_release);
+}
+
+std::unique_ptr<DataBuffer> ConcurrentPacketQueue::PopFront() {
+  Node* next = tail_->next.load(std::memory_order_acquire);
+  if (next == nullptr) {
+    return nullptr;
+  }
+  // `next` becomes the new stub, so its packet is moved out but the node is
+  // kept until the following one has been consumed.
+  delete tail_;
+  tail_ = next;
+  return std::move(next->packet);
+}
+
 }  // namespace webrtc
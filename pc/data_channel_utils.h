@@ -13,6 +13,8 @@
 
 #include <stddef.h>
 #include <stdint.h>
+
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
@@ -45,6 +47,43 @@ class PacketQueue final {
   size_t byte_count_ = 0;
 };
 
+// A lock-free, unbounded queue of packets with any number of producers and a
+// single consumer. Any thread may call PushBack() concurrently, while
+// PopFront() must always be called from the same thread (or sequence).
+//
+// This is an intrusive linked list with a permanent stub node, where producers
+// only ever swap the head pointer, and the consumer only ever touches the tail.
+// PopFront() may transiently return nullptr while a concurrent PushBack() has
+// not yet linked in its packet, so producers are expected to notify the
+// consumer after pushing, as SctpDataChannel does by posting a task.
+class ConcurrentPacketQueue final {
+ public:
+  ConcurrentPacketQueue();
+  ~ConcurrentPacketQueue();
+
+  ConcurrentPacketQueue(const ConcurrentPacketQueue&) = delete;
+  ConcurrentPacketQueue& operator=(const ConcurrentPacketQueue&) = delete;
+
+  // May be called on any thread.
+  void PushBack(std::unique_ptr<DataBuffer> packet);
+
+  // Returns the oldest packet, or nullptr if the queue is empty. Must only be
+  // called by the consumer.
+  std::unique_ptr<DataBuffer> PopFront();
+
+ private:
+  struct Node {
+    std::atomic<Node*> next{nullptr};
+    std::unique_ptr<DataBuffer> packet;
+  };
+
+  // The most recently pushed node. Modified by producers.
+  std::atomic<Node*> head_;
+  // The node before the oldest packet, which has already been consumed (or is
+  // the initial stub). Only accessed by the consumer.
+  Node* tail_;
+};
+
 struct DataChannelStats {
   int internal_id;
   int id;
@@ -415,9 +415,11 @@ JsepTransportController::CreateDtlsTransport(
     dtls = config_.dtls_transport_factory->CreateDtlsTransport(
         ice, config_.crypto_options, config_.ssl_max_version);
   } else {
-    dtls = std::make_unique<cricket::DtlsTransport>(ice, config_.crypto_options,
-                                                    config_.event_log,
-                                                    config_.ssl_max_version);
+    auto dtls_transport = std::make_unique<cricket::DtlsTransport>(
+        ice, config_.crypto_options, config_.event_log,
+        config_.ssl_max_version);
+    dtls_transport->SetSslCryptoPool(config_.ssl_crypto_pool);
+    dtls = std::move(dtls_transport);
   }
 
   RTC_DCHECK(dtls);
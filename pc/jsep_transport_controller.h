@@ -123,6 +123,10 @@ class JsepTransportController : public sigslot::has_slots<> {
     // Used to inject the ICE/DTLS transports created externally.
     webrtc::IceTransportFactory* ice_transport_factory = nullptr;
     cricket::DtlsTransportFactory* dtls_transport_factory = nullptr;
+    // If set, the DtlsTransports created without `dtls_transport_factory` run
+    // the private key operations of their handshakes on this pool, which must
+    // outlive the JsepTransportController.
+    rtc::SSLCryptoPool* ssl_crypto_pool = nullptr;
     Observer* transport_observer = nullptr;
     // Must be provided and valid for the lifetime of the
     // JsepTransportController instance.
@@ -468,6 +468,14 @@ class ConstMethodCall : public QueuedTask {
     return c_->method();                     \
   }
 
+// For use when the method is thread-safe and must be called directly, without
+// blocking on the primary thread.
+#define BYPASS_PROXY_METHOD1(r, method, t1) \
+  r method(t1 a1) override {                \
+    TRACE_BOILERPLATE(method);              \
+    return c_->method(std::move(a1));       \
+  }
+
 }  // namespace webrtc
 
 #endif  //  PC_PROXY_H_
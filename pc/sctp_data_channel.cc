@@ -22,7 +22,6 @@
 #include "rtc_base/location.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/ref_counted_object.h"
-#include "rtc_base/system/unused.h"
 #include "rtc_base/task_utils/to_queued_task.h"
 #include "rtc_base/thread.h"
 
@@ -62,10 +61,13 @@ PROXY_CONSTMETHOD0(uint32_t, messages_sent)
 PROXY_CONSTMETHOD0(uint64_t, bytes_sent)
 PROXY_CONSTMETHOD0(uint32_t, messages_received)
 PROXY_CONSTMETHOD0(uint64_t, bytes_received)
-PROXY_CONSTMETHOD0(uint64_t, buffered_amount)
+// Thread-safe, and may be polled frequently by senders using SendAsync.
+BYPASS_PROXY_CONSTMETHOD0(uint64_t, buffered_amount)
 PROXY_METHOD0(void, Close)
 // TODO(bugs.webrtc.org/11547): Change to run on the network thread.
 PROXY_METHOD1(bool, Send, const DataBuffer&)
+// Thread-safe, and must not block on the signaling thread.
+BYPASS_PROXY_METHOD1(bool, SendAsync, const DataBuffer&)
 END_PROXY_MAP(DataChannel)
 
 }  // namespace
@@ -179,7 +181,6 @@ SctpDataChannel::SctpDataChannel(const InternalDataChannelInit& config,
       observer_(nullptr),
       provider_(provider) {
   RTC_DCHECK_RUN_ON(signaling_thread_);
-  RTC_UNUSED(network_thread_);
 }
 
 bool SctpDataChannel::Init() {
@@ -199,13 +200,13 @@ bool SctpDataChannel::Init() {
 
   switch (config_.open_handshake_role) {
     case webrtc::InternalDataChannelInit::kNone:  // pre-negotiated
-      handshake_state_ = kHandshakeReady;
+      SetHandshakeState(kHandshakeReady);
       break;
     case webrtc::InternalDataChannelInit::kOpener:
-      handshake_state_ = kHandshakeShouldSendOpen;
+      SetHandshakeState(kHandshakeShouldSendOpen);
       break;
     case webrtc::InternalDataChannelInit::kAcker:
-      handshake_state_ = kHandshakeShouldSendAck;
+      SetHandshakeState(kHandshakeShouldSendAck);
       break;
   }
 
@@ -253,8 +254,8 @@ bool SctpDataChannel::reliable() const {
 }
 
 uint64_t SctpDataChannel::buffered_amount() const {
-  RTC_DCHECK_RUN_ON(signaling_thread_);
-  return buffered_amount_;
+  // May be called on any thread.
+  return buffered_amount_.load() & ~kBufferedAmountClosed;
 }
 
 void SctpDataChannel::Close() {
@@ -328,6 +329,46 @@ bool SctpDataChannel::Send(const DataBuffer& buffer) {
   return true;
 }
 
+bool SctpDataChannel::SendAsync(const DataBuffer& buffer) {
+  // May be called on any thread.
+  if (send_async_state_.load() != kOpen) {
+    return false;
+  }
+
+  // Adds to `buffered_amount_` unless an abrupt close has marked it closed,
+  // so that data is never accounted for on a closed channel.
+  uint64_t buffered_amount = buffered_amount_.load();
+  do {
+    if (buffered_amount & kBufferedAmountClosed) {
+      return false;
+    }
+    if (buffered_amount + buffer.size() > kMaxQueuedSendDataBytes) {
+      break;
+    }
+  } while (!buffered_amount_.compare_exchange_weak(
+      buffered_amount, buffered_amount + buffer.size()));
+
+  if (buffered_amount + buffer.size() > kMaxQueuedSendDataBytes) {
+    RTC_LOG(LS_ERROR) << "Closing the DataChannel due to a failure to queue "
+                         "additional data.";
+    signaling_thread_->PostTask(
+        ToQueuedTask([self = rtc::scoped_refptr<SctpDataChannel>(this)] {
+          RTC_DCHECK_RUN_ON(self->signaling_thread_);
+          self->CloseAbruptlyWithError(
+              RTCError(RTCErrorType::RESOURCE_EXHAUSTED,
+                       "Unable to queue data for sending"));
+        }));
+    return false;
+  }
+
+  // The payload is reference counted, so this doesn't copy the data.
+  pending_send_data_.PushBack(std::make_unique<DataBuffer>(buffer));
+  if (!pending_send_data_task_posted_.exchange(true)) {
+    PostSendPendingDataMessages();
+  }
+  return true;
+}
+
 void SctpDataChannel::SetSctpSid(int sid) {
   RTC_DCHECK_RUN_ON(signaling_thread_);
   RTC_DCHECK_LT(config_.id, 0);
@@ -416,7 +457,7 @@ void SctpDataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
     }
     if (ParseDataChannelOpenAckMessage(payload)) {
       // We can send unordered as soon as we receive the ACK message.
-      handshake_state_ = kHandshakeReady;
+      SetHandshakeState(kHandshakeReady);
       RTC_LOG(LS_INFO) << "DataChannel received OPEN_ACK message, sid = "
                        << params.sid;
     } else {
@@ -436,7 +477,7 @@ void SctpDataChannel::OnDataReceived(const cricket::ReceiveDataParams& params,
   // remote side must have received the OPEN (and old clients do not send
   // OPEN_ACK).
   if (handshake_state_ == kHandshakeWaitingForAck) {
-    handshake_state_ = kHandshakeReady;
+    SetHandshakeState(kHandshakeReady);
   }
 
   bool binary = (params.type == webrtc::DataMessageType::kBinary);
@@ -471,6 +512,9 @@ void SctpDataChannel::OnTransportReady(bool writable) {
 
   SendQueuedControlMessages();
   SendQueuedDataMessages();
+  if (pending_send_data_blocked_.exchange(false)) {
+    PostSendPendingDataMessages();
+  }
 
   UpdateState();
 }
@@ -486,8 +530,11 @@ void SctpDataChannel::CloseAbruptlyWithError(RTCError error) {
     DisconnectFromProvider();
   }
 
-  // Closing abruptly means any queued data gets thrown away.
-  buffered_amount_ = 0;
+  // Closing abruptly means any queued data gets thrown away. Resetting the
+  // buffered amount and marking it closed in one store keeps SendAsync() from
+  // adding to it afterwards.
+  send_async_state_.store(kClosed);
+  buffered_amount_.store(kBufferedAmountClosed);
 
   queued_send_data_.Clear();
   queued_control_data_.Clear();
@@ -539,9 +586,10 @@ void SctpDataChannel::UpdateState() {
       break;
     }
     case kClosing: {
-      // Wait for all queued data to be sent before beginning the closing
-      // procedure.
-      if (queued_send_data_.Empty() && queued_control_data_.Empty()) {
+      // Wait for all queued data, including data queued by SendAsync(), to be
+      // sent before beginning the closing procedure.
+      if (queued_send_data_.Empty() && queued_control_data_.Empty() &&
+          buffered_amount() == 0) {
         // For SCTP data channels, we need to wait for the closing procedure
         // to complete; after calling RemoveSctpDataStream,
         // OnClosingProcedureComplete will end up called asynchronously
@@ -566,6 +614,7 @@ void SctpDataChannel::SetState(DataState state) {
   }
 
   state_ = state;
+  send_async_state_.store(state);
   if (observer_) {
     observer_->OnStateChange();
   }
@@ -576,6 +625,12 @@ void SctpDataChannel::SetState(DataState state) {
   }
 }
 
+void SctpDataChannel::SetHandshakeState(HandshakeState state) {
+  RTC_DCHECK_RUN_ON(signaling_thread_);
+  handshake_state_ = state;
+  send_async_handshake_ready_.store(state == kHandshakeReady);
+}
+
 void SctpDataChannel::DisconnectFromProvider() {
   RTC_DCHECK_RUN_ON(signaling_thread_);
   if (!connected_to_provider_)
@@ -644,8 +699,7 @@ bool SctpDataChannel::SendDataMessage(const DataBuffer& buffer,
     ++messages_sent_;
     bytes_sent_ += buffer.size();
 
-    RTC_DCHECK(buffered_amount_ >= buffer.size());
-    buffered_amount_ -= buffer.size();
+    DecreaseBufferedAmount(buffer.size());
     if (observer_ && buffer.size() > 0) {
       observer_->OnBufferedAmountChange(buffer.size());
     }
@@ -679,6 +733,113 @@ bool SctpDataChannel::QueueSendDataMessage(const DataBuffer& buffer) {
   return true;
 }
 
+void SctpDataChannel::DecreaseBufferedAmount(uint64_t bytes) {
+  RTC_DCHECK_RUN_ON(signaling_thread_);
+  uint64_t buffered_amount = buffered_amount_.load();
+  do {
+    if (buffered_amount & kBufferedAmountClosed) {
+      return;
+    }
+    RTC_DCHECK_GE(buffered_amount, bytes);
+  } while (!buffered_amount_.compare_exchange_weak(buffered_amount,
+                                                   buffered_amount - bytes));
+}
+
+void SctpDataChannel::PostSendPendingDataMessages() {
+  // The reference held by the task is handed back to the signaling thread, so
+  // that the channel is never released on the network thread.
+  network_thread_->PostTask(ToQueuedTask(
+      [self = rtc::scoped_refptr<SctpDataChannel>(this)]() mutable {
+        uint32_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        RTCError error =
+            self->SendPendingDataMessages_n(&messages_sent, &bytes_sent);
+        rtc::Thread* signaling_thread = self->signaling_thread_;
+        signaling_thread->PostTask(
+            ToQueuedTask([self = std::move(self), messages_sent, bytes_sent,
+                          error = std::move(error)]() mutable {
+              self->OnPendingDataMessagesSent(messages_sent, bytes_sent,
+                                              std::move(error));
+            }));
+      }));
+}
+
+RTCError SctpDataChannel::SendPendingDataMessages_n(uint32_t* messages_sent,
+                                                    uint64_t* bytes_sent) {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  // Cleared before looking at the queue, so that any data queued after this
+  // point is either sent below, or posts a new task.
+  pending_send_data_task_posted_.store(false);
+
+  for (;;) {
+    std::unique_ptr<DataBuffer> buffer = std::move(blocked_pending_send_data_);
+    if (!buffer) {
+      buffer = pending_send_data_.PopFront();
+    }
+    if (!buffer) {
+      return RTCError::OK();
+    }
+    if (send_async_state_.load() == kClosed) {
+      // Closing abruptly means any queued data gets thrown away.
+      continue;
+    }
+
+    SendDataParams send_params;
+    // Send as ordered if it is still going through OPEN/ACK signaling.
+    send_params.ordered =
+        config_.ordered || !send_async_handshake_ready_.load();
+    send_params.max_rtx_count = config_.maxRetransmits;
+    send_params.max_rtx_ms = config_.maxRetransmitTime;
+    send_params.type =
+        buffer->binary ? DataMessageType::kBinary : DataMessageType::kText;
+
+    RTCError error =
+        provider_->SendData_n(config_.id, send_params, buffer->data);
+    if (error.type() == RTCErrorType::RESOURCE_EXHAUSTED) {
+      // Keep SendAsync() from posting tasks until OnTransportReady() resumes
+      // sending.
+      blocked_pending_send_data_ = std::move(buffer);
+      pending_send_data_task_posted_.store(true);
+      pending_send_data_blocked_.store(true);
+      return RTCError::OK();
+    }
+    if (!error.ok()) {
+      return error;
+    }
+    ++*messages_sent;
+    *bytes_sent += buffer->size();
+  }
+}
+
+void SctpDataChannel::OnPendingDataMessagesSent(uint32_t messages_sent,
+                                                uint64_t bytes_sent,
+                                                RTCError error) {
+  RTC_DCHECK_RUN_ON(signaling_thread_);
+  if (state_ == kClosed) {
+    return;
+  }
+
+  messages_sent_ += messages_sent;
+  bytes_sent_ += bytes_sent;
+  DecreaseBufferedAmount(bytes_sent);
+  if (observer_ && bytes_sent > 0) {
+    observer_->OnBufferedAmountChange(bytes_sent);
+  }
+
+  if (!error.ok()) {
+    RTC_LOG(LS_ERROR) << "Closing the DataChannel due to a failure to send "
+                         "queued data: "
+                      << error.message();
+    CloseAbruptlyWithError(
+        RTCError(RTCErrorType::NETWORK_ERROR, "Failure to send data"));
+    return;
+  }
+
+  if (state_ == kClosing) {
+    UpdateState();
+  }
+}
+
 void SctpDataChannel::SendQueuedControlMessages() {
   RTC_DCHECK_RUN_ON(signaling_thread_);
   PacketQueue control_packets;
@@ -718,9 +879,9 @@ bool SctpDataChannel::SendControlMessage(const rtc::CopyOnWriteBuffer& buffer) {
     RTC_LOG(LS_VERBOSE) << "Sent CONTROL message on channel " << config_.id;
 
     if (handshake_state_ == kHandshakeShouldSendAck) {
-      handshake_state_ = kHandshakeReady;
+      SetHandshakeState(kHandshakeReady);
     } else if (handshake_state_ == kHandshakeShouldSendOpen) {
-      handshake_state_ = kHandshakeWaitingForAck;
+      SetHandshakeState(kHandshakeWaitingForAck);
     }
   } else if (send_result == cricket::SDR_BLOCK) {
     QueueControlMessage(buffer);
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -44,6 +45,12 @@ class SctpDataChannelProviderInterface {
                         const SendDataParams& params,
                         const rtc::CopyOnWriteBuffer& payload,
                         cricket::SendDataResult* result) = 0;
+  // Sends the data to the transport from the network thread, without blocking
+  // on any other thread. Returns RESOURCE_EXHAUSTED if the transport is
+  // blocked.
+  virtual RTCError SendData_n(int sid,
+                              const SendDataParams& params,
+                              const rtc::CopyOnWriteBuffer& payload) = 0;
   // Connects to the transport signals.
   virtual bool ConnectDataChannel(SctpDataChannel* data_channel) = 0;
   // Disconnects from the transport signals.
@@ -170,6 +177,7 @@ class SctpDataChannel : public DataChannelInterface,
   uint32_t messages_received() const override;
   uint64_t bytes_received() const override;
   bool Send(const DataBuffer& buffer) override;
+  bool SendAsync(const DataBuffer& buffer) override;
 
   // Close immediately, ignoring any queued data or closing procedure.
   // This is called when the underlying SctpTransport is being destroyed.
@@ -242,6 +250,7 @@ class SctpDataChannel : public DataChannelInterface,
   bool Init();
   void UpdateState();
   void SetState(DataState state);
+  void SetHandshakeState(HandshakeState state);
   void DisconnectFromProvider();
 
   void DeliverQueuedReceivedData();
@@ -249,6 +258,20 @@ class SctpDataChannel : public DataChannelInterface,
   void SendQueuedDataMessages();
   bool SendDataMessage(const DataBuffer& buffer, bool queue_if_blocked);
   bool QueueSendDataMessage(const DataBuffer& buffer);
+  // Accounts for `bytes` that were sent, unless the channel was closed
+  // abruptly and all buffered data was thrown away.
+  void DecreaseBufferedAmount(uint64_t bytes);
+
+  // Posts a task to the network thread that sends the data queued by
+  // SendAsync(), and then reports the result back on the signaling thread.
+  void PostSendPendingDataMessages();
+  // Sends data from `pending_send_data_` until it's empty or the transport is
+  // blocked. Returns an error if the transport failed to send.
+  RTCError SendPendingDataMessages_n(uint32_t* messages_sent,
+                                     uint64_t* bytes_sent);
+  void OnPendingDataMessagesSent(uint32_t messages_sent,
+                                 uint64_t bytes_sent,
+                                 RTCError error);
 
   void SendQueuedControlMessages();
   void QueueControlMessage(const rtc::CopyOnWriteBuffer& buffer);
@@ -266,11 +289,15 @@ class SctpDataChannel : public DataChannelInterface,
   uint64_t bytes_sent_ RTC_GUARDED_BY(signaling_thread_) = 0;
   uint32_t messages_received_ RTC_GUARDED_BY(signaling_thread_) = 0;
   uint64_t bytes_received_ RTC_GUARDED_BY(signaling_thread_) = 0;
-  // Number of bytes of data that have been queued using Send(). Increased
-  // before each transport send and decreased after each successful send.
-  uint64_t buffered_amount_ RTC_GUARDED_BY(signaling_thread_) = 0;
-  SctpDataChannelProviderInterface* const provider_
-      RTC_GUARDED_BY(signaling_thread_);
+  // Number of bytes of data that have been queued using Send() or
+  // SendAsync(). Increased before each transport send and decreased after each
+  // successful send. May be read on any thread. CloseAbruptlyWithError() sets
+  // it to `kBufferedAmountClosed`, after which nothing is added to it.
+  static constexpr uint64_t kBufferedAmountClosed = uint64_t{1} << 63;
+  std::atomic<uint64_t> buffered_amount_{0};
+  // Used on the signaling thread, except for SendData_n() which is called on
+  // the network thread.
+  SctpDataChannelProviderInterface* const provider_;
   HandshakeState handshake_state_ RTC_GUARDED_BY(signaling_thread_) =
       kHandshakeInit;
   bool connected_to_provider_ RTC_GUARDED_BY(signaling_thread_) = false;
@@ -282,6 +309,23 @@ class SctpDataChannel : public DataChannelInterface,
   PacketQueue queued_control_data_ RTC_GUARDED_BY(signaling_thread_);
   PacketQueue queued_received_data_ RTC_GUARDED_BY(signaling_thread_);
   PacketQueue queued_send_data_ RTC_GUARDED_BY(signaling_thread_);
+
+  // Copies of `state_` and of whether `handshake_state_` is kHandshakeReady,
+  // for use by SendAsync() and on the network thread.
+  std::atomic<DataState> send_async_state_{kConnecting};
+  std::atomic<bool> send_async_handshake_ready_{false};
+  // Data queued by SendAsync(), which is consumed on the network thread.
+  ConcurrentPacketQueue pending_send_data_;
+  // Set while a task to send `pending_send_data_` has been posted and not yet
+  // started, or while the transport is blocked. Avoids posting one task per
+  // message.
+  std::atomic<bool> pending_send_data_task_posted_{false};
+  // Set when sending `pending_send_data_` was blocked by the transport, and
+  // has to be resumed when it becomes writable again.
+  std::atomic<bool> pending_send_data_blocked_{false};
+  // The message that was blocked, which is sent before any other.
+  std::unique_ptr<DataBuffer> blocked_pending_send_data_
+      RTC_GUARDED_BY(network_thread_);
 };
 
 }  // namespace webrtc
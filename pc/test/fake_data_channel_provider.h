@@ -47,6 +47,18 @@ class FakeDataChannelProvider
     return true;
   }
 
+  webrtc::RTCError SendData_n(int sid,
+                              const webrtc::SendDataParams& params,
+                              const rtc::CopyOnWriteBuffer& payload) override {
+    cricket::SendDataResult result = cricket::SDR_SUCCESS;
+    if (SendData(sid, params, payload, &result)) {
+      return webrtc::RTCError::OK();
+    }
+    return webrtc::RTCError(result == cricket::SDR_BLOCK
+                                ? webrtc::RTCErrorType::RESOURCE_EXHAUSTED
+                                : webrtc::RTCErrorType::NETWORK_ERROR);
+  }
+
   bool ConnectDataChannel(webrtc::SctpDataChannel* data_channel) override {
     RTC_CHECK(connected_channels_.find(data_channel) ==
               connected_channels_.end());
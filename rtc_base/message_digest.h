@@ -12,6 +12,7 @@
 #define RTC_BASE_MESSAGE_DIGEST_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <string>
 
@@ -87,6 +88,40 @@ inline std::string MD5(const std::string& input) {
 
 // Functions to compute RFC 2104 HMACs.
 
+// Computes an RFC 2104 HMAC over input that is supplied in several parts, so
+// that e.g. a message with a patched header can be authenticated without
+// first copying it into one buffer. Only digests with a 64-byte block size
+// (SHA-256 and down) are supported.
+class Hmac {
+ public:
+  // Keys the HMAC with `key_len` bytes of `key`. `digest` must outlive this
+  // object, and is used for the computation.
+  Hmac(MessageDigest* digest, const void* key, size_t key_len);
+  ~Hmac();
+
+  // Returns false if `digest` cannot be used for an HMAC.
+  bool IsValid() const { return valid_; }
+  // Updates the HMAC with `len` bytes from `buf`.
+  void Update(const void* buf, size_t len);
+  // Outputs the HMAC to `buf` with length `len`. Returns the number of bytes
+  // written, or 0 if `len` was too small or the HMAC is not valid. The HMAC
+  // is restarted with the same key afterwards.
+  size_t Finish(void* buf, size_t len);
+
+ private:
+  static constexpr size_t kBlockSize = 64;
+
+  void Start();
+
+  MessageDigest* const digest_;
+  const bool valid_;
+  // The key, padded to a full block.
+  uint8_t key_[kBlockSize];
+
+  Hmac(const Hmac&) = delete;
+  Hmac& operator=(const Hmac&) = delete;
+};
+
 // Computes the HMAC of `in_len` bytes of `input`, using the `digest` hash
 // implementation and `key_len` bytes of `key` to key the HMAC, and outputs
 // the HMAC to the buffer `output`, which is `out_len` bytes long. Returns the
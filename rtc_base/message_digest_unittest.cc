@@ -10,6 +10,8 @@
 
 #include "rtc_base/message_digest.h"
 
+#include <memory>
+
 #include "rtc_base/string_encode.h"
 #include "test/gtest.h"
 
@@ -146,6 +148,31 @@ TEST(MessageDigestTest, TestSha1Hmac) {
                         input.size(), output, sizeof(output) - 1));
 }
 
+TEST(MessageDigestTest, TestMultiPartHmac) {
+  std::unique_ptr<MessageDigest> digest(
+      MessageDigestFactory::Create(DIGEST_SHA_1));
+  ASSERT_TRUE(digest);
+  std::string key(80, '\xaa');
+  Hmac hmac(digest.get(), key.data(), key.size());
+  ASSERT_TRUE(hmac.IsValid());
+  hmac.Update("Test Using Larger Than ", 23);
+  hmac.Update("Block-Size Key - Hash Key First", 31);
+  char output[20];
+  EXPECT_EQ(sizeof(output), hmac.Finish(output, sizeof(output)));
+  EXPECT_EQ("aa4ae5e15272d00e95705637ce8a3b55ed402112",
+            hex_encode(output, sizeof(output)));
+
+  // A too small output buffer fails, and the HMAC restarts either way.
+  hmac.Update("abc", 3);
+  EXPECT_EQ(0U, hmac.Finish(output, sizeof(output) - 1));
+  std::string input("Test Using Larger Than Block-Size Key and Larger "
+                    "Than One Block-Size Data");
+  hmac.Update(input.data(), input.size());
+  EXPECT_EQ(sizeof(output), hmac.Finish(output, sizeof(output)));
+  EXPECT_EQ("e8e99d0f45237d786d6bbaa7965c7808bbff1a91",
+            hex_encode(output, sizeof(output)));
+}
+
 TEST(MessageDigestTest, TestBadHmac) {
   std::string output;
   EXPECT_FALSE(ComputeHmac("sha-9000", "key", "abc", &output));
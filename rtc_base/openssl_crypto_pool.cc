@@ -0,0 +1,41 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/openssl_crypto_pool.h"
+
+#include <string>
+#include <utility>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+OpenSSLCryptoPool::OpenSSLCryptoPool(int num_threads) {
+  RTC_DCHECK_GT(num_threads, 0);
+  for (int i = 0; i < num_threads; ++i) {
+    std::unique_ptr<Thread> thread = Thread::Create();
+    thread->SetName("SSLCryptoPool" + std::to_string(i), nullptr);
+    RTC_CHECK(thread->Start());
+    threads_.push_back(std::move(thread));
+  }
+}
+
+OpenSSLCryptoPool::~OpenSSLCryptoPool() {
+  for (const std::unique_ptr<Thread>& thread : threads_) {
+    thread->Stop();
+  }
+}
+
+void OpenSSLCryptoPool::PostTask(std::unique_ptr<webrtc::QueuedTask> task) {
+  ++num_tasks_;
+  threads_[next_thread_++ % threads_.size()]->PostTask(std::move(task));
+}
+
+}  // namespace rtc
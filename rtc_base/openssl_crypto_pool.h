@@ -0,0 +1,49 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_OPENSSL_CRYPTO_POOL_H_
+#define RTC_BASE_OPENSSL_CRYPTO_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/queued_task.h"
+#include "rtc_base/ssl_stream_adapter.h"
+#include "rtc_base/thread.h"
+
+namespace rtc {
+
+// The threads that OpenSSLStreamAdapters post their private key operations
+// to, in turn.
+class OpenSSLCryptoPool final : public SSLCryptoPool {
+ public:
+  explicit OpenSSLCryptoPool(int num_threads);
+  // Stops the threads. Tasks that haven't run yet are dropped.
+  ~OpenSSLCryptoPool() override;
+
+  // Runs `task` on the next thread of the pool. Can be called on any thread.
+  void PostTask(std::unique_ptr<webrtc::QueuedTask> task);
+
+  // The number of tasks posted so far.
+  int64_t num_tasks() const { return num_tasks_.load(); }
+
+ private:
+  std::vector<std::unique_ptr<Thread>> threads_;
+  std::atomic<size_t> next_thread_{0};
+  std::atomic<int64_t> num_tasks_{0};
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_OPENSSL_CRYPTO_POOL_H_
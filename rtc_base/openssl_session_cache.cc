@@ -10,7 +10,10 @@
 
 #include "rtc_base/openssl_session_cache.h"
 
+#include <openssl/rand.h>
+
 #include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/openssl.h"
 
 namespace rtc {
@@ -50,4 +53,66 @@ SSLMode OpenSSLSessionCache::GetSSLMode() const {
   return ssl_mode_;
 }
 
+namespace {
+
+// Sessions are only resumed by a server whose context has the same session ID
+// context as the one of the session.
+const unsigned char kSessionIdContext[] = "WebRTC";
+
+}  // namespace
+
+OpenSSLStreamSessionCache::OpenSSLStreamSessionCache() = default;
+
+OpenSSLStreamSessionCache::~OpenSSLStreamSessionCache() {
+  for (const auto& it : sessions_) {
+    SSL_SESSION_free(it.second);
+  }
+}
+
+bool OpenSSLStreamSessionCache::ConfigureContext(SSL_CTX* ctx) {
+  if (ticket_keys_.empty()) {
+    // The size of the keys differs between OpenSSL and BoringSSL.
+    size_t size = SSL_CTX_get_tlsext_ticket_keys(ctx, nullptr, 0);
+    ticket_keys_.SetSize(size);
+    if (size == 0 || RAND_bytes(ticket_keys_.data(), size) != 1) {
+      RTC_LOG(LS_ERROR) << "Failed to generate session ticket keys";
+      ticket_keys_.Clear();
+      return false;
+    }
+  }
+  return SSL_CTX_set_tlsext_ticket_keys(ctx, ticket_keys_.data(),
+                                        ticket_keys_.size()) == 1 &&
+         SSL_CTX_set_session_id_context(ctx, kSessionIdContext,
+                                        sizeof(kSessionIdContext) - 1) == 1;
+}
+
+SSL_SESSION* OpenSSLStreamSessionCache::LookupSession(
+    const std::string& key) const {
+  auto it = sessions_.find(key);
+  return (it != sessions_.end()) ? it->second : nullptr;
+}
+
+void OpenSSLStreamSessionCache::AddSession(const std::string& key,
+                                           SSL_SESSION* session) {
+  SSL_SESSION_up_ref(session);
+  auto it = sessions_.find(key);
+  if (it != sessions_.end()) {
+    SSL_SESSION_free(it->second);
+    it->second = session;
+    return;
+  }
+  if (sessions_.size() >= kMaxSessions) {
+    auto oldest = sessions_.begin();
+    for (auto it = sessions_.begin(); it != sessions_.end(); ++it) {
+      if (SSL_SESSION_get_time(it->second) <
+          SSL_SESSION_get_time(oldest->second)) {
+        oldest = it;
+      }
+    }
+    SSL_SESSION_free(oldest->second);
+    sessions_.erase(oldest);
+  }
+  sessions_[key] = session;
+}
+
 }  // namespace rtc
@@ -13,9 +13,12 @@
 
 #include <openssl/ossl_typ.h>
 
+#include <stddef.h>
+
 #include <map>
 #include <string>
 
+#include "rtc_base/buffer.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/ssl_stream_adapter.h"
 
@@ -63,6 +66,39 @@ class OpenSSLSessionCache final {
   RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLSessionCache);
 };
 
+// The SSLSessionCache of OpenSSLStreamAdapter. Unlike with OpenSSLAdapter,
+// every adapter has an SSL_CTX of its own, so the sessions are kept by the pair
+// of certificates of the handshake, and the contexts share the keys that the
+// session tickets are encrypted with, for a server to accept the tickets
+// issued by another.
+class OpenSSLStreamSessionCache final : public SSLSessionCache {
+ public:
+  static constexpr size_t kMaxSessions = 1000;
+
+  OpenSSLStreamSessionCache();
+  // Frees the cached SSL_SESSIONs.
+  ~OpenSSLStreamSessionCache() override;
+
+  // Configures `ctx` to issue and accept the session tickets of the contexts
+  // configured with this cache. Returns false on failure.
+  bool ConfigureContext(SSL_CTX* ctx);
+  // Looks up a session by key. The returned SSL_SESSION is not up_refed.
+  SSL_SESSION* LookupSession(const std::string& key) const;
+  // Adds a session to the cache, and up_refs it. Any existing session with the
+  // same key is replaced. When the cache is full, the oldest session is
+  // evicted.
+  void AddSession(const std::string& key, SSL_SESSION* session);
+  size_t size() const { return sessions_.size(); }
+
+ private:
+  // Generated randomly along with the first context.
+  Buffer ticket_keys_;
+  // Holds references to the SSL_SESSIONs.
+  std::map<std::string, SSL_SESSION*> sessions_;
+
+  RTC_DISALLOW_COPY_AND_ASSIGN(OpenSSLStreamSessionCache);
+};
+
 }  // namespace rtc
 
 #endif  // RTC_BASE_OPENSSL_SESSION_CACHE_H_
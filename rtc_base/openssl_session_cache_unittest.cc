@@ -15,6 +15,8 @@
 
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "rtc_base/gunit.h"
 #include "rtc_base/openssl.h"
@@ -101,4 +103,62 @@ TEST(OpenSSLSessionCache, AddToExistingReplacesPrevious) {
   SSL_CTX_free(ssl_ctx);
 }
 
+TEST(OpenSSLStreamSessionCache, AddToExistingReplacesPrevious) {
+  SSL_CTX* ssl_ctx = NewDtlsContext();
+  SSL_SESSION* ssl_session_1 = SSL_SESSION_new(ssl_ctx);
+  SSL_SESSION* ssl_session_2 = SSL_SESSION_new(ssl_ctx);
+
+  OpenSSLStreamSessionCache session_cache;
+  EXPECT_EQ(session_cache.LookupSession("key"), nullptr);
+  session_cache.AddSession("key", ssl_session_1);
+  EXPECT_EQ(session_cache.LookupSession("key"), ssl_session_1);
+  session_cache.AddSession("key", ssl_session_2);
+  EXPECT_EQ(session_cache.LookupSession("key"), ssl_session_2);
+  EXPECT_EQ(session_cache.size(), 1u);
+
+  SSL_SESSION_free(ssl_session_1);
+  SSL_SESSION_free(ssl_session_2);
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLStreamSessionCache, EvictsOldestSessionWhenFull) {
+  SSL_CTX* ssl_ctx = NewDtlsContext();
+
+  OpenSSLStreamSessionCache session_cache;
+  for (size_t i = 0; i <= OpenSSLStreamSessionCache::kMaxSessions; ++i) {
+    SSL_SESSION* ssl_session = SSL_SESSION_new(ssl_ctx);
+    // The first session is the newest but one.
+    SSL_SESSION_set_time(ssl_session, i == 0 ? 1000000 : 1000 + i);
+    session_cache.AddSession(std::to_string(i), ssl_session);
+    SSL_SESSION_free(ssl_session);
+  }
+  EXPECT_EQ(session_cache.size(), OpenSSLStreamSessionCache::kMaxSessions);
+  EXPECT_NE(session_cache.LookupSession("0"), nullptr);
+  EXPECT_EQ(session_cache.LookupSession("1"), nullptr);
+  EXPECT_NE(session_cache.LookupSession("2"), nullptr);
+
+  SSL_CTX_free(ssl_ctx);
+}
+
+TEST(OpenSSLStreamSessionCache, ContextsShareTicketKeys) {
+  SSL_CTX* ssl_ctx_1 = NewDtlsContext();
+  SSL_CTX* ssl_ctx_2 = NewDtlsContext();
+
+  OpenSSLStreamSessionCache session_cache;
+  ASSERT_TRUE(session_cache.ConfigureContext(ssl_ctx_1));
+  ASSERT_TRUE(session_cache.ConfigureContext(ssl_ctx_2));
+  const int keys_len = SSL_CTX_get_tlsext_ticket_keys(ssl_ctx_1, nullptr, 0);
+  ASSERT_GT(keys_len, 0);
+  std::vector<uint8_t> keys_1(keys_len);
+  std::vector<uint8_t> keys_2(keys_len);
+  ASSERT_EQ(SSL_CTX_get_tlsext_ticket_keys(ssl_ctx_1, keys_1.data(), keys_len),
+            1);
+  ASSERT_EQ(SSL_CTX_get_tlsext_ticket_keys(ssl_ctx_2, keys_2.data(), keys_len),
+            1);
+  EXPECT_EQ(keys_1, keys_2);
+
+  SSL_CTX_free(ssl_ctx_1);
+  SSL_CTX_free(ssl_ctx_2);
+}
+
 }  // namespace rtc
@@ -13,7 +13,9 @@
 #include <openssl/bio.h>
 #include <openssl/crypto.h>
 #include <openssl/err.h>
+#include <openssl/evp.h>
 #include <openssl/rand.h>
+#include <openssl/rsa.h>
 #include <openssl/tls1.h>
 #include <openssl/x509v3.h>
 #ifndef OPENSSL_IS_BORINGSSL
@@ -21,6 +23,8 @@
 #include <openssl/dtls1.h>
 #endif
 
+#include <string.h>
+
 #include <atomic>
 #include <memory>
 #include <utility>
@@ -150,6 +154,41 @@ void TimeCallbackForTesting(const SSL* ssl, struct timeval* out_clock) {
   out_clock->tv_sec = time / kNumNanosecsPerSec;
   out_clock->tv_usec = (time % kNumNanosecsPerSec) / kNumNanosecsPerMicrosec;
 }
+
+// Runs a private key operation of a handshake with `key`, like BoringSSL does
+// without a private key method: signs `input` with `signature_algorithm`, or
+// decrypts it if there is none. Returns an empty buffer on failure.
+Buffer RunPrivateKeyOperation(EVP_PKEY* key,
+                              absl::optional<uint16_t> signature_algorithm,
+                              const Buffer& input) {
+  size_t out_len = EVP_PKEY_size(key);
+  Buffer out(out_len);
+  bool success;
+  if (signature_algorithm) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    success =
+        EVP_DigestSignInit(
+            ctx.get(), &pctx,
+            SSL_get_signature_algorithm_digest(*signature_algorithm), nullptr,
+            key) &&
+        (!SSL_is_signature_algorithm_rsa_pss(*signature_algorithm) ||
+         (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) &&
+          EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1))) &&
+        EVP_DigestSign(ctx.get(), out.data(), &out_len, input.data(),
+                       input.size());
+  } else {
+    RSA* rsa = EVP_PKEY_get0_RSA(key);
+    success = rsa && RSA_decrypt(rsa, &out_len, out.data(), out.size(),
+                                 input.data(), input.size(), RSA_NO_PADDING);
+  }
+  if (!success) {
+    ERR_clear_error();
+    return Buffer();
+  }
+  out.SetSize(out_len);
+  return out;
+}
 #endif
 
 }  // namespace
@@ -326,6 +365,16 @@ void OpenSSLStreamAdapter::SetServerRole(SSLRole role) {
   role_ = role;
 }
 
+void OpenSSLStreamAdapter::SetSessionCache(SSLSessionCache* cache) {
+  RTC_DCHECK_EQ(SSL_NONE, state_);
+  session_cache_ = static_cast<OpenSSLStreamSessionCache*>(cache);
+}
+
+void OpenSSLStreamAdapter::SetCryptoPool(SSLCryptoPool* pool) {
+  RTC_DCHECK_EQ(SSL_NONE, state_);
+  crypto_pool_ = static_cast<OpenSSLCryptoPool*>(pool);
+}
+
 bool OpenSSLStreamAdapter::SetPeerCertificateDigest(
     const std::string& digest_alg,
     const unsigned char* digest_val,
@@ -370,6 +419,7 @@ bool OpenSSLStreamAdapter::SetPeerCertificateDigest(
   }
 
   if (state_ == SSL_CONNECTED) {
+    CacheSession();
     // Post the event asynchronously to unwind the stack. The caller
     // of ContinueSSL may be the same object listening for these
     // events and may not be prepared for reentrancy.
@@ -511,6 +561,10 @@ bool OpenSSLStreamAdapter::GetDtlsSrtpCryptoSuite(int* crypto_suite) {
   return true;
 }
 
+bool OpenSSLStreamAdapter::IsResumedSession() {
+  return (ssl_ && SSL_session_reused(ssl_) == 1);
+}
+
 bool OpenSSLStreamAdapter::IsTlsConnected() {
   return state_ == SSL_CONNECTED;
 }
@@ -876,6 +930,15 @@ int OpenSSLStreamAdapter::BeginSSL() {
 
   SSL_set_app_data(ssl_, this);
 
+  if (crypto_pool_) {
+#ifdef OPENSSL_IS_BORINGSSL
+    SSL_set_private_key_method(ssl_, &kPrivateKeyMethod);
+#else
+    RTC_LOG(LS_WARNING) << "Private key operations stay on this thread, "
+                           "offloading them requires BoringSSL.";
+#endif
+  }
+
   SSL_set_bio(ssl_, bio, bio);  // the SSL object owns the bio now.
   if (ssl_mode_ == SSL_MODE_DTLS) {
 #ifdef OPENSSL_IS_BORINGSSL
@@ -890,6 +953,19 @@ int OpenSSLStreamAdapter::BeginSSL() {
   SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE |
                          SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
+  if (session_cache_ && role_ == SSL_CLIENT) {
+    std::string key = SessionCacheKey();
+    SSL_SESSION* cached =
+        key.empty() ? nullptr : session_cache_->LookupSession(key);
+    if (cached) {
+      if (SSL_set_session(ssl_, cached) == 0) {
+        RTC_LOG(LS_WARNING) << "Failed to apply SSL session from cache";
+      } else {
+        RTC_DLOG(LS_INFO) << "Attempting to resume SSL session";
+      }
+    }
+  }
+
   // Do the connect
   return ContinueSSL();
 }
@@ -907,6 +983,10 @@ int OpenSSLStreamAdapter::ContinueSSL() {
   switch (ssl_error) {
     case SSL_ERROR_NONE:
       RTC_DLOG(LS_VERBOSE) << " -- success";
+      if (SSL_session_reused(ssl_) && !VerifyResumedPeerCertificate()) {
+        RTC_LOG(LS_WARNING) << "Rejected peer certificate of resumed session.";
+        return -1;
+      }
       // By this point, OpenSSL should have given us a certificate, or errored
       // out if one was missing.
       RTC_DCHECK(peer_cert_chain_ || !GetClientAuthEnabled());
@@ -921,6 +1001,7 @@ int OpenSSLStreamAdapter::ContinueSSL() {
         // The caller of ContinueSSL may be the same object listening for these
         // events and may not be prepared for reentrancy.
         // PostEvent(SE_OPEN | SE_READ | SE_WRITE, 0);
+        CacheSession();
         SignalEvent(this, SE_OPEN | SE_READ | SE_WRITE, 0);
       }
       break;
@@ -938,6 +1019,13 @@ int OpenSSLStreamAdapter::ContinueSSL() {
       RTC_DLOG(LS_VERBOSE) << " -- error want write";
       break;
 
+#ifdef OPENSSL_IS_BORINGSSL
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+      // Continued by OnPrivateKeyOperationDone().
+      RTC_DLOG(LS_VERBOSE) << " -- waiting for private key operation";
+      break;
+#endif
+
     case SSL_ERROR_ZERO_RETURN:
     default:
       SSLHandshakeError ssl_handshake_err = SSLHandshakeError::UNKNOWN;
@@ -1066,6 +1154,11 @@ SSL_CTX* OpenSSLStreamAdapter::SetupSSLContext() {
     return nullptr;
   }
 
+  if (session_cache_ && !session_cache_->ConfigureContext(ctx)) {
+    SSL_CTX_free(ctx);
+    return nullptr;
+  }
+
 #if !defined(NDEBUG)
   SSL_CTX_set_info_callback(ctx, OpenSSLAdapter::SSLInfoCallback);
 #endif
@@ -1138,6 +1231,61 @@ bool OpenSSLStreamAdapter::VerifyPeerCertificate() {
   return true;
 }
 
+bool OpenSSLStreamAdapter::VerifyResumedPeerCertificate() {
+  // No certificates are exchanged when a session is resumed, so the peer
+  // certificate of the session stands in for the one of a full handshake.
+#ifdef OPENSSL_IS_BORINGSSL
+  const STACK_OF(CRYPTO_BUFFER)* chain = SSL_get0_peer_certificates(ssl_);
+  if (!chain || sk_CRYPTO_BUFFER_num(chain) == 0) {
+    return false;
+  }
+  std::vector<std::unique_ptr<SSLCertificate>> cert_chain;
+  for (CRYPTO_BUFFER* cert : chain) {
+    cert_chain.emplace_back(new BoringSSLCertificate(bssl::UpRef(cert)));
+  }
+  peer_cert_chain_.reset(new SSLCertChain(std::move(cert_chain)));
+#else
+  X509* cert = SSL_get_peer_certificate(ssl_);
+  if (!cert) {
+    return false;
+  }
+  peer_cert_chain_.reset(
+      new SSLCertChain(std::make_unique<OpenSSLCertificate>(cert)));
+  X509_free(cert);
+#endif
+  // If the peer certificate digest isn't known yet, it is verified once it is.
+  return !HasPeerCertificateDigest() || VerifyPeerCertificate();
+}
+
+std::string OpenSSLStreamAdapter::SessionCacheKey() const {
+  // A session may only be resumed between the same two certificates: each
+  // side verifies the peer certificate of the session against the digest
+  // signaled for the new connection.
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  size_t digest_length;
+  if (!identity_ || !HasPeerCertificateDigest() ||
+      !identity_->certificate().ComputeDigest(DIGEST_SHA_256, digest,
+                                              sizeof(digest), &digest_length)) {
+    return std::string();
+  }
+  std::string key = peer_certificate_digest_algorithm_;
+  key.append(peer_certificate_digest_value_.data<char>(),
+             peer_certificate_digest_value_.size());
+  key.append(reinterpret_cast<const char*>(digest), digest_length);
+  return key;
+}
+
+void OpenSSLStreamAdapter::CacheSession() {
+  if (!session_cache_ || role_ != SSL_CLIENT || !peer_certificate_verified_) {
+    return;
+  }
+  SSL_SESSION* session = SSL_get_session(ssl_);
+  std::string key = SessionCacheKey();
+  if (session && SSL_SESSION_is_resumable(session) && !key.empty()) {
+    session_cache_->AddSession(key, session);
+  }
+}
+
 std::unique_ptr<SSLCertChain> OpenSSLStreamAdapter::GetPeerSSLCertChain()
     const {
   return peer_cert_chain_ ? peer_cert_chain_->Clone() : nullptr;
@@ -1172,6 +1320,90 @@ enum ssl_verify_result_t OpenSSLStreamAdapter::SSLVerifyCallback(
 
   return ssl_verify_ok;
 }
+
+const SSL_PRIVATE_KEY_METHOD OpenSSLStreamAdapter::kPrivateKeyMethod = {
+    &OpenSSLStreamAdapter::PrivateKeySign,
+    &OpenSSLStreamAdapter::PrivateKeyDecrypt,
+    &OpenSSLStreamAdapter::PrivateKeyComplete,
+};
+
+enum ssl_private_key_result_t OpenSSLStreamAdapter::PrivateKeySign(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    uint16_t signature_algorithm,
+    const uint8_t* in,
+    size_t in_len) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  stream->StartPrivateKeyOperation(signature_algorithm, in, in_len);
+  return ssl_private_key_retry;
+}
+
+enum ssl_private_key_result_t OpenSSLStreamAdapter::PrivateKeyDecrypt(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out,
+    const uint8_t* in,
+    size_t in_len) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  stream->StartPrivateKeyOperation(absl::nullopt, in, in_len);
+  return ssl_private_key_retry;
+}
+
+enum ssl_private_key_result_t OpenSSLStreamAdapter::PrivateKeyComplete(
+    SSL* ssl,
+    uint8_t* out,
+    size_t* out_len,
+    size_t max_out) {
+  OpenSSLStreamAdapter* stream =
+      reinterpret_cast<OpenSSLStreamAdapter*>(SSL_get_app_data(ssl));
+  if (!stream->private_key_result_) {
+    return ssl_private_key_retry;
+  }
+  Buffer result = std::move(*stream->private_key_result_);
+  stream->private_key_result_.reset();
+  if (result.empty() || result.size() > max_out) {
+    RTC_LOG(LS_ERROR) << "Private key operation failed.";
+    return ssl_private_key_failure;
+  }
+  memcpy(out, result.data(), result.size());
+  *out_len = result.size();
+  return ssl_private_key_success;
+}
+
+void OpenSSLStreamAdapter::StartPrivateKeyOperation(
+    absl::optional<uint16_t> signature_algorithm,
+    const uint8_t* in,
+    size_t in_len) {
+  RTC_DCHECK(crypto_pool_);
+  private_key_result_.reset();
+  crypto_pool_->PostTask(webrtc::ToQueuedTask(
+      [key = bssl::UpRef(SSL_get_privatekey(ssl_)), signature_algorithm,
+       input = Buffer(in, in_len), owner = owner_,
+       flag = task_safety_.flag(), this]() {
+        Buffer result =
+            RunPrivateKeyOperation(key.get(), signature_algorithm, input);
+        owner->PostTask(webrtc::ToQueuedTask(
+            flag, [this, result = std::move(result)]() mutable {
+              OnPrivateKeyOperationDone(std::move(result));
+            }));
+      }));
+}
+
+void OpenSSLStreamAdapter::OnPrivateKeyOperationDone(Buffer result) {
+  // The handshake may have failed or been closed in the meantime.
+  if (state_ != SSL_CONNECTING) {
+    return;
+  }
+  private_key_result_ = std::move(result);
+  if (int err = ContinueSSL()) {
+    Error("ContinueSSL", err, 0, true);
+  }
+}
 #else   // OPENSSL_IS_BORINGSSL
 int OpenSSLStreamAdapter::SSLVerifyCallback(X509_STORE_CTX* store, void* arg) {
   // Get our SSL structure and OpenSSLStreamAdapter from the store.
@@ -26,6 +26,8 @@
 #else
 #include "rtc_base/openssl_identity.h"
 #endif
+#include "rtc_base/openssl_crypto_pool.h"
+#include "rtc_base/openssl_session_cache.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/stream.h"
@@ -93,6 +95,8 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   void SetMode(SSLMode mode) override;
   void SetMaxProtocolVersion(SSLProtocolVersion version) override;
   void SetInitialRetransmissionTimeout(int timeout_ms) override;
+  void SetSessionCache(SSLSessionCache* cache) override;
+  void SetCryptoPool(SSLCryptoPool* pool) override;
 
   StreamResult Read(void* data,
                     size_t data_len,
@@ -125,6 +129,7 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   bool GetDtlsSrtpCryptoSuite(int* crypto_suite) override;
 
   bool IsTlsConnected() override;
+  bool IsResumedSession() override;
 
   // Capabilities interfaces.
   static bool IsBoringSsl();
@@ -182,6 +187,15 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   SSL_CTX* SetupSSLContext();
   // Verify the peer certificate matches the signaled digest.
   bool VerifyPeerCertificate();
+  // Takes the peer certificate of a resumed session, and verifies it if the
+  // digest is known.
+  bool VerifyResumedPeerCertificate();
+
+  // The key of the session in `session_cache_`, or empty if there is none.
+  std::string SessionCacheKey() const;
+  // Adds the session to `session_cache_` once the handshake has completed and
+  // the peer certificate has been verified, if this is the client.
+  void CacheSession();
 
 #ifdef OPENSSL_IS_BORINGSSL
   // SSL certificate verification callback. See SSL_CTX_set_custom_verify.
@@ -193,6 +207,37 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   static int SSLVerifyCallback(X509_STORE_CTX* store, void* arg);
 #endif
 
+#ifdef OPENSSL_IS_BORINGSSL
+  // Private key callbacks that run the operations on `crypto_pool_`. See
+  // SSL_set_private_key_method.
+  static const SSL_PRIVATE_KEY_METHOD kPrivateKeyMethod;
+  static enum ssl_private_key_result_t PrivateKeySign(
+      SSL* ssl,
+      uint8_t* out,
+      size_t* out_len,
+      size_t max_out,
+      uint16_t signature_algorithm,
+      const uint8_t* in,
+      size_t in_len);
+  static enum ssl_private_key_result_t PrivateKeyDecrypt(SSL* ssl,
+                                                         uint8_t* out,
+                                                         size_t* out_len,
+                                                         size_t max_out,
+                                                         const uint8_t* in,
+                                                         size_t in_len);
+  static enum ssl_private_key_result_t PrivateKeyComplete(SSL* ssl,
+                                                          uint8_t* out,
+                                                          size_t* out_len,
+                                                          size_t max_out);
+
+  // Signs `in` with `signature_algorithm` on `crypto_pool_`, or decrypts it if
+  // there is no `signature_algorithm`, then continues the handshake.
+  void StartPrivateKeyOperation(absl::optional<uint16_t> signature_algorithm,
+                                const uint8_t* in,
+                                size_t in_len);
+  void OnPrivateKeyOperationDone(Buffer result);
+#endif
+
   bool WaitingToVerifyPeerCertificate() const {
     return GetClientAuthEnabled() && !peer_certificate_verified_;
   }
@@ -236,6 +281,17 @@ class OpenSSLStreamAdapter final : public SSLStreamAdapter {
   // The DtlsSrtp ciphers
   std::string srtp_ciphers_;
 
+  // Sessions to resume and to cache, if set.
+  OpenSSLStreamSessionCache* session_cache_ = nullptr;
+
+  // Runs the private key operations of the handshake, if set.
+  OpenSSLCryptoPool* crypto_pool_ = nullptr;
+#ifdef OPENSSL_IS_BORINGSSL
+  // The result of the private key operation that the handshake waits for,
+  // once it has completed. Empty if the operation failed.
+  absl::optional<Buffer> private_key_result_;
+#endif
+
   // Do DTLS or not
   SSLMode ssl_mode_;
 
@@ -15,12 +15,14 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "rtc_base/checks.h"
 #include "rtc_base/location.h"
 #include "rtc_base/message_handler.h"
 #include "rtc_base/ref_counted_object.h"
 #include "rtc_base/ssl_identity.h"
+#include "rtc_base/time_utils.h"
 
 namespace rtc {
 
@@ -30,8 +32,101 @@ namespace {
 const char kIdentityName[] = "WebRTC";
 const uint64_t kYearInSeconds = 365 * 24 * 60 * 60;
 
+bool SameKeyParams(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type()) {
+    return false;
+  }
+  switch (a.type()) {
+    case KT_RSA:
+      return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+             a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+    case KT_ECDSA:
+      return a.ec_curve() == b.ec_curve();
+    default:
+      return true;
+  }
+}
+
 }  // namespace
 
+// The certificates generated ahead of time. Generates one certificate per task,
+// so that other tasks of the worker thread are not held up for long.
+class RTCCertificateGenerator::CertificatePool : public RefCountInterface {
+ public:
+  explicit CertificatePool(Thread* worker_thread)
+      : worker_thread_(worker_thread) {}
+
+  void Configure(const KeyParams& key_params, size_t size) {
+    RTC_DCHECK(worker_thread_->IsCurrent());
+    if (!SameKeyParams(key_params, key_params_)) {
+      certificates_.clear();
+    }
+    key_params_ = key_params;
+    size_ = size;
+    if (certificates_.size() > size_) {
+      certificates_.resize(size_);
+    }
+    ScheduleRefill();
+  }
+
+  // Returns a pooled certificate with `key_params`, or null if there is none.
+  scoped_refptr<RTCCertificate> Take(const KeyParams& key_params) {
+    RTC_DCHECK(worker_thread_->IsCurrent());
+    if (!SameKeyParams(key_params, key_params_)) {
+      return nullptr;
+    }
+    while (!certificates_.empty()) {
+      scoped_refptr<RTCCertificate> certificate =
+          std::move(certificates_.back());
+      certificates_.pop_back();
+      if (!certificate->HasExpired(TimeUTCMillis())) {
+        return certificate;
+      }
+    }
+    return nullptr;
+  }
+
+  void ScheduleRefill() {
+    RTC_DCHECK(worker_thread_->IsCurrent());
+    if (refill_scheduled_ || certificates_.size() >= size_) {
+      return;
+    }
+    refill_scheduled_ = true;
+    worker_thread_->PostTask(RTC_FROM_HERE,
+                             [pool = scoped_refptr<CertificatePool>(this)] {
+                               pool->Refill();
+                             });
+  }
+
+ protected:
+  ~CertificatePool() override = default;
+
+ private:
+  void Refill() {
+    RTC_DCHECK(worker_thread_->IsCurrent());
+    refill_scheduled_ = false;
+    if (certificates_.size() >= size_) {
+      return;
+    }
+    scoped_refptr<RTCCertificate> certificate =
+        RTCCertificateGenerator::GenerateCertificate(key_params_,
+                                                     absl::nullopt);
+    if (!certificate) {
+      // Don't keep trying with parameters that don't work.
+      size_ = certificates_.size();
+      return;
+    }
+    certificates_.push_back(std::move(certificate));
+    ScheduleRefill();
+  }
+
+  Thread* const worker_thread_;
+  KeyParams key_params_;
+  size_t size_ = 0;
+  std::vector<scoped_refptr<RTCCertificate>> certificates_;
+  bool refill_scheduled_ = false;
+};
+
 // static
 scoped_refptr<RTCCertificate> RTCCertificateGenerator::GenerateCertificate(
     const KeyParams& key_params,
@@ -64,11 +159,15 @@ scoped_refptr<RTCCertificate> RTCCertificateGenerator::GenerateCertificate(
 
 RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
                                                  Thread* worker_thread)
-    : signaling_thread_(signaling_thread), worker_thread_(worker_thread) {
+    : signaling_thread_(signaling_thread),
+      worker_thread_(worker_thread),
+      pool_(new RefCountedObject<CertificatePool>(worker_thread)) {
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
 }
 
+RTCCertificateGenerator::~RTCCertificateGenerator() = default;
+
 void RTCCertificateGenerator::GenerateCertificateAsync(
     const KeyParams& key_params,
     const absl::optional<uint64_t>& expires_ms,
@@ -79,16 +178,34 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
   // Create a new `RTCCertificateGenerationTask` for this generation request. It
   // is reference counted and referenced by the message data, ensuring it lives
   // until the task has completed (independent of `RTCCertificateGenerator`).
-  worker_thread_->PostTask(RTC_FROM_HERE, [key_params, expires_ms,
+  worker_thread_->PostTask(RTC_FROM_HERE, [key_params, expires_ms, pool = pool_,
                                            signaling_thread = signaling_thread_,
                                            cb = callback]() {
-    scoped_refptr<RTCCertificate> certificate =
-        RTCCertificateGenerator::GenerateCertificate(key_params, expires_ms);
+    scoped_refptr<RTCCertificate> certificate;
+    if (!expires_ms) {
+      certificate = pool->Take(key_params);
+    }
+    if (!certificate) {
+      certificate =
+          RTCCertificateGenerator::GenerateCertificate(key_params, expires_ms);
+    }
     signaling_thread->PostTask(
         RTC_FROM_HERE, [cert = std::move(certificate), cb = std::move(cb)]() {
           cert ? cb->OnSuccess(cert) : cb->OnFailure();
         });
+    // Replaces a certificate taken from the pool, after the requests that are
+    // already queued have been served.
+    pool->ScheduleRefill();
   });
 }
 
+void RTCCertificateGenerator::SetCertificatePool(const KeyParams& key_params,
+                                                 size_t pool_size) {
+  RTC_DCHECK(signaling_thread_->IsCurrent());
+  worker_thread_->PostTask(RTC_FROM_HERE,
+                           [key_params, pool_size, pool = pool_]() {
+                             pool->Configure(key_params, pool_size);
+                           });
+}
+
 }  // namespace rtc
@@ -11,6 +11,7 @@
 #ifndef RTC_BASE_RTC_CERTIFICATE_GENERATOR_H_
 #define RTC_BASE_RTC_CERTIFICATE_GENERATOR_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "absl/types/optional.h"
@@ -67,7 +68,7 @@ class RTC_EXPORT RTCCertificateGenerator
       const absl::optional<uint64_t>& expires_ms);
 
   RTCCertificateGenerator(Thread* signaling_thread, Thread* worker_thread);
-  ~RTCCertificateGenerator() override {}
+  ~RTCCertificateGenerator() override;
 
   // `RTCCertificateGeneratorInterface` overrides.
   // If `expires_ms` is specified, the certificate will expire in approximately
@@ -79,9 +80,21 @@ class RTC_EXPORT RTCCertificateGenerator
       const absl::optional<uint64_t>& expires_ms,
       const scoped_refptr<RTCCertificateGeneratorCallback>& callback) override;
 
+  // Keeps `pool_size` certificates with `key_params` generated ahead of time on
+  // the worker thread, so that `GenerateCertificateAsync` can hand one out
+  // without generating a key, when called with these `key_params` and without
+  // `expires_ms`. Each certificate is handed out once, and then replaced in the
+  // pool. A `pool_size` of 0 empties the pool.
+  // Must be called on the signaling thread.
+  void SetCertificatePool(const KeyParams& key_params, size_t pool_size);
+
  private:
+  class CertificatePool;
+
   Thread* const signaling_thread_;
   Thread* const worker_thread_;
+  // Accessed on the worker thread, by tasks that may outlive the generator.
+  const scoped_refptr<CertificatePool> pool_;
 };
 
 }  // namespace rtc
@@ -11,11 +11,14 @@
 #include "rtc_base/rtc_certificate_generator.h"
 
 #include <memory>
+#include <set>
+#include <string>
 
 #include "absl/types/optional.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/ref_counted_object.h"
+#include "rtc_base/ssl_certificate.h"
 #include "rtc_base/thread.h"
 #include "test/gtest.h"
 
@@ -101,6 +104,26 @@ TEST_F(RTCCertificateGeneratorTest, GenerateAsyncECDSA) {
   EXPECT_TRUE(fixture_->certificate());
 }
 
+TEST_F(RTCCertificateGeneratorTest, GenerateAsyncFromPool) {
+  fixture_->generator()->SetCertificatePool(KeyParams::ECDSA(), 2);
+  // More certificates than the pool holds are handed out, each only once, and
+  // a request for other key params is still served.
+  std::set<std::string> pems;
+  for (int i = 0; i < 4; ++i) {
+    fixture_->generator()->GenerateCertificateAsync(KeyParams::ECDSA(),
+                                                    absl::nullopt, fixture_);
+    EXPECT_TRUE_WAIT(fixture_->GenerateAsyncCompleted(), kGenerationTimeoutMs);
+    ASSERT_TRUE(fixture_->certificate());
+    pems.insert(fixture_->certificate()->GetSSLCertificate().ToPEMString());
+  }
+  EXPECT_EQ(4u, pems.size());
+
+  fixture_->generator()->GenerateCertificateAsync(KeyParams::RSA(),
+                                                  absl::nullopt, fixture_);
+  EXPECT_TRUE_WAIT(fixture_->GenerateAsyncCompleted(), kGenerationTimeoutMs);
+  EXPECT_TRUE(fixture_->certificate());
+}
+
 TEST_F(RTCCertificateGeneratorTest, GenerateWithExpires) {
   // By generating two certificates with different expiration we can compare the
   // two expiration times relative to each other without knowing the current
@@ -11,6 +11,8 @@
 #include "rtc_base/ssl_stream_adapter.h"
 
 #include "absl/memory/memory.h"
+#include "rtc_base/openssl_crypto_pool.h"
+#include "rtc_base/openssl_session_cache.h"
 #include "rtc_base/openssl_stream_adapter.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -89,6 +91,14 @@ bool IsGcmCryptoSuiteName(const std::string& crypto_suite) {
   return (crypto_suite == kCsAeadAes256Gcm || crypto_suite == kCsAeadAes128Gcm);
 }
 
+std::unique_ptr<SSLSessionCache> SSLSessionCache::Create() {
+  return std::make_unique<OpenSSLStreamSessionCache>();
+}
+
+std::unique_ptr<SSLCryptoPool> SSLCryptoPool::Create(int num_threads) {
+  return std::make_unique<OpenSSLCryptoPool>(num_threads);
+}
+
 std::unique_ptr<SSLStreamAdapter> SSLStreamAdapter::Create(
     std::unique_ptr<StreamInterface> stream) {
   return std::make_unique<OpenSSLStreamAdapter>(std::move(stream));
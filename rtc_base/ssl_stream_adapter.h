@@ -110,6 +110,34 @@ enum { SSE_MSG_TRUNC = 0xff0001 };
 // Used to send back UMA histogram value. Logged when Dtls handshake fails.
 enum class SSLHandshakeError { UNKNOWN, INCOMPATIBLE_CIPHERSUITE, MAX_VALUE };
 
+// Keeps the sessions of the handshakes that SSLStreamAdapters completed as the
+// client, so that later handshakes between the same two certificates can
+// resume them, and lets the server side of those handshakes accept the
+// resumption. A resumed handshake skips the certificate exchange and the key
+// agreement, which dominate the cost of a full handshake.
+// A cache is shared by the adapters of one thread, and must outlive them.
+class SSLSessionCache {
+ public:
+  // Creates a cache for the SSL implementation of the platform.
+  static std::unique_ptr<SSLSessionCache> Create();
+
+  virtual ~SSLSessionCache() = default;
+};
+
+// Threads that SSLStreamAdapters run the private key operations of their
+// handshakes on, i.e. the signatures that prove possession of the local
+// certificate, so that a thread serving many adapters isn't blocked by them.
+// A pool can be shared by the adapters of any number of threads, and must
+// outlive them.
+class SSLCryptoPool {
+ public:
+  // Creates a pool of `num_threads` threads for the SSL implementation of the
+  // platform.
+  static std::unique_ptr<SSLCryptoPool> Create(int num_threads);
+
+  virtual ~SSLCryptoPool() = default;
+};
+
 class SSLStreamAdapter : public StreamInterface, public sigslot::has_slots<> {
  public:
   // Instantiate an SSLStreamAdapter wrapping the given stream,
@@ -149,6 +177,20 @@ class SSLStreamAdapter : public StreamInterface, public sigslot::has_slots<> {
   // This should only be called before StartSSL().
   virtual void SetInitialRetransmissionTimeout(int timeout_ms) = 0;
 
+  // Resumes the session cached in `cache` for the local and the peer
+  // certificate, if any, and caches the session once the handshake completes.
+  // Sessions are only looked up if the peer certificate digest is set before
+  // the underlying stream opens, and the peer certificate of a resumed session
+  // is verified against the digest like that of a full handshake.
+  // This should only be called before StartSSL().
+  virtual void SetSessionCache(SSLSessionCache* cache) = 0;
+
+  // Runs the private key operations of the handshake on `pool`, and continues
+  // the handshake once they have completed. Only supported with BoringSSL,
+  // elsewhere they keep running on the thread of the adapter.
+  // This should only be called before StartSSL().
+  virtual void SetCryptoPool(SSLCryptoPool* pool) = 0;
+
   // StartSSL starts negotiation with a peer, whose certificate is verified
   // using the certificate digest. Generally, SetIdentity() and possibly
   // SetServerRole() should have been called before this.
@@ -225,6 +267,10 @@ class SSLStreamAdapter : public StreamInterface, public sigslot::has_slots<> {
   // SS_OPENING but IsTlsConnected should return true.
   virtual bool IsTlsConnected() = 0;
 
+  // Returns true if the established connection resumed a cached session
+  // rather than doing a full handshake.
+  virtual bool IsResumedSession() = 0;
+
   // Capabilities testing.
   // Used to have "DTLS supported", "DTLS-SRTP supported" etc. methods, but now
   // that's assumed.
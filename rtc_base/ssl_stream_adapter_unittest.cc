@@ -8,10 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "rtc_base/buffer_queue.h"
@@ -21,13 +24,18 @@
 #include "rtc_base/memory/fifo_buffer.h"
 #include "rtc_base/memory_stream.h"
 #include "rtc_base/message_digest.h"
+#include "rtc_base/openssl_crypto_pool.h"
 #include "rtc_base/openssl_stream_adapter.h"
+#include "rtc_base/socket_stream.h"
 #include "rtc_base/ssl_adapter.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/ssl_stream_adapter.h"
 #include "rtc_base/stream.h"
 #include "rtc_base/task_utils/pending_task_safety_flag.h"
 #include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
 #include "test/field_trial.h"
 
 using ::testing::Combine;
@@ -1736,3 +1744,236 @@ TEST_F(SSLStreamAdapterTestDTLSLegacyProtocols,
   SetupProtocolVersions(rtc::SSL_PROTOCOL_DTLS_10, rtc::SSL_PROTOCOL_DTLS_10);
   TestHandshake(false);
 }
+
+// Runs DTLS handshakes between two SSLStreamAdapters over VirtualSocketServer
+// sockets, each side with an SSLSessionCache.
+class SSLStreamAdapterSessionCacheTest : public ::testing::Test {
+ public:
+  SSLStreamAdapterSessionCacheTest()
+      : thread_(&vss_),
+        client_identity_(
+            rtc::SSLIdentity::Create("client", rtc::KeyParams::ECDSA())),
+        server_identity_(
+            rtc::SSLIdentity::Create("server", rtc::KeyParams::ECDSA())),
+        client_cache_(rtc::SSLSessionCache::Create()),
+        server_cache_(rtc::SSLSessionCache::Create()) {}
+
+  struct Result {
+    bool connected = false;
+    bool client_resumed = false;
+    bool server_resumed = false;
+    int srtp_crypto_suite = 0;
+    std::vector<uint8_t> client_key;
+    std::vector<uint8_t> server_key;
+  };
+
+  // Does a handshake between `client_identity` and `server_identity`, where
+  // the server expects the client certificate of `expected_client`.
+  Result Handshake(const rtc::SSLIdentity* client_identity,
+                   const rtc::SSLIdentity* server_identity,
+                   const rtc::SSLIdentity* expected_client,
+                   rtc::SSLSessionCache* client_cache,
+                   rtc::SSLSessionCache* server_cache) {
+    rtc::Socket* client_socket = vss_.CreateSocket(AF_INET, SOCK_DGRAM);
+    rtc::Socket* server_socket = vss_.CreateSocket(AF_INET, SOCK_DGRAM);
+    client_socket->Bind(rtc::SocketAddress("127.0.0.1", 0));
+    server_socket->Bind(rtc::SocketAddress("127.0.0.1", 0));
+    client_socket->Connect(server_socket->GetLocalAddress());
+    server_socket->Connect(client_socket->GetLocalAddress());
+
+    std::unique_ptr<rtc::SSLStreamAdapter> client = CreateAdapter(
+        client_socket, client_identity, server_identity, client_cache);
+    std::unique_ptr<rtc::SSLStreamAdapter> server = CreateAdapter(
+        server_socket, server_identity, expected_client, server_cache);
+    server->SetServerRole();
+    EXPECT_EQ(0, server->StartSSL());
+    EXPECT_EQ(0, client->StartSSL());
+
+    const int64_t deadline = rtc::TimeMillis() + kHandshakeTimeoutMs;
+    auto done = [&] {
+      return (client->GetState() == rtc::SS_OPEN &&
+              server->GetState() == rtc::SS_OPEN) ||
+             client->GetState() == rtc::SS_CLOSED ||
+             server->GetState() == rtc::SS_CLOSED;
+    };
+    while (!done() && rtc::TimeMillis() < deadline) {
+      thread_.ProcessMessages(0);
+    }
+
+    Result result;
+    result.connected = client->GetState() == rtc::SS_OPEN &&
+                       server->GetState() == rtc::SS_OPEN;
+    if (!result.connected) {
+      return result;
+    }
+    result.client_resumed = client->IsResumedSession();
+    result.server_resumed = server->IsResumedSession();
+    client->GetDtlsSrtpCryptoSuite(&result.srtp_crypto_suite);
+    result.client_key.resize(16);
+    result.server_key.resize(16);
+    EXPECT_TRUE(client->ExportKeyingMaterial(
+        kExporterLabel, kExporterContext, kExporterContextLen, false,
+        result.client_key.data(), result.client_key.size()));
+    EXPECT_TRUE(server->ExportKeyingMaterial(
+        kExporterLabel, kExporterContext, kExporterContextLen, false,
+        result.server_key.data(), result.server_key.size()));
+    return result;
+  }
+
+  Result Handshake() {
+    return Handshake(client_identity_.get(), server_identity_.get(),
+                     client_identity_.get(), client_cache_.get(),
+                     server_cache_.get());
+  }
+
+ protected:
+  static constexpr int kHandshakeTimeoutMs = 5000;
+
+  std::unique_ptr<rtc::SSLStreamAdapter> CreateAdapter(
+      rtc::Socket* socket,
+      const rtc::SSLIdentity* identity,
+      const rtc::SSLIdentity* peer,
+      rtc::SSLSessionCache* cache) {
+    std::unique_ptr<rtc::SSLStreamAdapter> adapter =
+        rtc::SSLStreamAdapter::Create(
+            std::make_unique<rtc::SocketStream>(socket));
+    adapter->SetMode(rtc::SSL_MODE_DTLS);
+    adapter->SetIdentity(identity->Clone());
+    adapter->SetDtlsSrtpCryptoSuites({rtc::kSrtpAes128CmSha1_80});
+    if (cache) {
+      adapter->SetSessionCache(cache);
+    }
+    if (crypto_pool_) {
+      adapter->SetCryptoPool(crypto_pool_);
+    }
+    unsigned char digest[20];
+    size_t digest_len;
+    EXPECT_TRUE(peer->certificate().ComputeDigest(rtc::DIGEST_SHA_1, digest,
+                                                  sizeof(digest), &digest_len));
+    EXPECT_TRUE(adapter->SetPeerCertificateDigest(rtc::DIGEST_SHA_1, digest,
+                                                  digest_len));
+    return adapter;
+  }
+
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  std::unique_ptr<rtc::SSLIdentity> client_identity_;
+  std::unique_ptr<rtc::SSLIdentity> server_identity_;
+  std::unique_ptr<rtc::SSLSessionCache> client_cache_;
+  std::unique_ptr<rtc::SSLSessionCache> server_cache_;
+  rtc::SSLCryptoPool* crypto_pool_ = nullptr;
+};
+
+TEST_F(SSLStreamAdapterSessionCacheTest, ResumesSessionOfSamePeers) {
+  Result first = Handshake();
+  ASSERT_TRUE(first.connected);
+  EXPECT_FALSE(first.client_resumed);
+  EXPECT_FALSE(first.server_resumed);
+
+  Result second = Handshake();
+  ASSERT_TRUE(second.connected);
+  EXPECT_TRUE(second.client_resumed);
+  EXPECT_TRUE(second.server_resumed);
+  // The resumed session negotiates SRTP and derives fresh keys that both
+  // sides agree on.
+  EXPECT_EQ(rtc::kSrtpAes128CmSha1_80, second.srtp_crypto_suite);
+  EXPECT_EQ(second.client_key, second.server_key);
+  EXPECT_NE(first.client_key, second.client_key);
+}
+
+TEST_F(SSLStreamAdapterSessionCacheTest, DoesNotResumeWithOtherCertificate) {
+  ASSERT_TRUE(Handshake().connected);
+
+  std::unique_ptr<rtc::SSLIdentity> other_client =
+      rtc::SSLIdentity::Create("other", rtc::KeyParams::ECDSA());
+  Result result = Handshake(other_client.get(), server_identity_.get(),
+                            other_client.get(), client_cache_.get(),
+                            server_cache_.get());
+  ASSERT_TRUE(result.connected);
+  EXPECT_FALSE(result.client_resumed);
+  EXPECT_FALSE(result.server_resumed);
+}
+
+TEST_F(SSLStreamAdapterSessionCacheTest, DoesNotResumeWithoutCache) {
+  ASSERT_TRUE(Handshake().connected);
+
+  Result result =
+      Handshake(client_identity_.get(), server_identity_.get(),
+                client_identity_.get(), client_cache_.get(), nullptr);
+  ASSERT_TRUE(result.connected);
+  EXPECT_FALSE(result.client_resumed);
+  EXPECT_FALSE(result.server_resumed);
+}
+
+// The server verifies the client certificate of a resumed session against the
+// digest it was given, like that of a full handshake.
+TEST_F(SSLStreamAdapterSessionCacheTest, RejectsResumedSessionOfOtherPeer) {
+  ASSERT_TRUE(Handshake().connected);
+
+  std::unique_ptr<rtc::SSLIdentity> other_client =
+      rtc::SSLIdentity::Create("other", rtc::KeyParams::ECDSA());
+  Result result = Handshake(client_identity_.get(), server_identity_.get(),
+                            other_client.get(), client_cache_.get(),
+                            server_cache_.get());
+  EXPECT_FALSE(result.connected);
+}
+
+class SSLStreamAdapterCryptoPoolTest : public SSLStreamAdapterSessionCacheTest {
+ public:
+  SSLStreamAdapterCryptoPoolTest() : pool_(2) { crypto_pool_ = &pool_; }
+
+ protected:
+  rtc::OpenSSLCryptoPool pool_;
+};
+
+TEST_F(SSLStreamAdapterCryptoPoolTest, HandshakesWithPrivateKeyOnPool) {
+  Result first = Handshake();
+  ASSERT_TRUE(first.connected);
+  EXPECT_EQ(first.client_key, first.server_key);
+#ifdef OPENSSL_IS_BORINGSSL
+  // At least the client signs its CertificateVerify and the server its
+  // ServerKeyExchange on the pool.
+  EXPECT_GE(pool_.num_tasks(), 2);
+#else
+  EXPECT_EQ(0, pool_.num_tasks());
+#endif
+
+  // A resumed handshake has no private key operations.
+  const int64_t num_tasks = pool_.num_tasks();
+  Result second = Handshake();
+  ASSERT_TRUE(second.connected);
+  EXPECT_TRUE(second.client_resumed);
+  EXPECT_EQ(second.client_key, second.server_key);
+  EXPECT_EQ(num_tasks, pool_.num_tasks());
+}
+
+// Measures how many DTLS handshakes per second complete over
+// VirtualSocketServer, with full handshakes and with resumed ones.
+TEST_F(SSLStreamAdapterSessionCacheTest, DISABLED_HandshakesPerSecond) {
+  constexpr int kNumHandshakes = 500;
+  for (bool resume : {false, true}) {
+    std::unique_ptr<rtc::SSLSessionCache> client_cache =
+        rtc::SSLSessionCache::Create();
+    if (resume) {
+      ASSERT_TRUE(Handshake(client_identity_.get(), server_identity_.get(),
+                            client_identity_.get(), client_cache.get(),
+                            server_cache_.get())
+                      .connected);
+    }
+    int64_t start_ns = rtc::SystemTimeNanos();
+    for (int i = 0; i < kNumHandshakes; ++i) {
+      Result result = Handshake(client_identity_.get(), server_identity_.get(),
+                                client_identity_.get(), client_cache.get(),
+                                resume ? server_cache_.get() : nullptr);
+      ASSERT_TRUE(result.connected);
+      ASSERT_EQ(resume, result.client_resumed);
+      if (!resume) {
+        // Don't let the full handshakes build up a session to resume.
+        client_cache = rtc::SSLSessionCache::Create();
+      }
+    }
+    int64_t elapsed_ns = rtc::SystemTimeNanos() - start_ns;
+    printf("%s handshakes: %8.1f per second\n", resume ? "Resumed" : "Full",
+           kNumHandshakes * 1e9 / elapsed_ns);
+  }
+}
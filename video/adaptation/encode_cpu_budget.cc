@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/adaptation/encode_cpu_budget.h"
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+
+constexpr double EncodeCpuBudget::kDefaultCoreFraction;
+constexpr double EncodeCpuBudget::kRestoreFraction;
+
+// static
+EncodeCpuBudget& EncodeCpuBudget::Get() {
+  static EncodeCpuBudget* const budget = new EncodeCpuBudget(
+      kDefaultCoreFraction * CpuInfo::DetectNumberOfCores());
+  return *budget;
+}
+
+EncodeCpuBudget::EncodeCpuBudget(double budget_cores)
+    : budget_cores_(budget_cores) {
+  RTC_DCHECK_GT(budget_cores_, 0.0);
+}
+
+EncodeCpuBudget::~EncodeCpuBudget() = default;
+
+int EncodeCpuBudget::RegisterStream() {
+  MutexLock lock(&mutex_);
+  const int stream_id = next_stream_id_++;
+  usage_cores_by_stream_[stream_id] = 0.0;
+  return stream_id;
+}
+
+void EncodeCpuBudget::UnregisterStream(int stream_id) {
+  MutexLock lock(&mutex_);
+  auto it = usage_cores_by_stream_.find(stream_id);
+  RTC_DCHECK(it != usage_cores_by_stream_.end());
+  if (it == usage_cores_by_stream_.end())
+    return;
+  usage_cores_by_stream_.erase(it);
+  UpdateTotalUsage();
+}
+
+void EncodeCpuBudget::ReportUsage(int stream_id, double usage_cores) {
+  RTC_DCHECK_GE(usage_cores, 0.0);
+  MutexLock lock(&mutex_);
+  auto it = usage_cores_by_stream_.find(stream_id);
+  RTC_DCHECK(it != usage_cores_by_stream_.end());
+  if (it == usage_cores_by_stream_.end())
+    return;
+  it->second = usage_cores;
+  UpdateTotalUsage();
+}
+
+EncodeCpuBudget::Recommendation EncodeCpuBudget::GetRecommendation(
+    int stream_id) const {
+  MutexLock lock(&mutex_);
+  auto it = usage_cores_by_stream_.find(stream_id);
+  if (it == usage_cores_by_stream_.end())
+    return Recommendation::kKeep;
+  if (total_usage_cores_ > budget_cores_) {
+    const double fair_share = budget_cores_ / usage_cores_by_stream_.size();
+    return it->second > fair_share ? Recommendation::kReduceComplexity
+                                   : Recommendation::kKeep;
+  }
+  return total_usage_cores_ < kRestoreFraction * budget_cores_
+             ? Recommendation::kRestoreComplexity
+             : Recommendation::kKeep;
+}
+
+void EncodeCpuBudget::UpdateTotalUsage() {
+  // Summed again rather than updated incrementally, so that rounding errors
+  // do not accumulate over the lifetime of the process.
+  total_usage_cores_ = 0.0;
+  for (const auto& stream_usage : usage_cores_by_stream_)
+    total_usage_cores_ += stream_usage.second;
+}
+
+double EncodeCpuBudget::TotalUsage() const {
+  MutexLock lock(&mutex_);
+  return total_usage_cores_;
+}
+
+}  // namespace webrtc
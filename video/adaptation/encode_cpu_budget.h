@@ -0,0 +1,70 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
+#define VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
+
+#include <map>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// CPU time available for encoding, shared by the video streams encoded in the
+// same process. Each stream reports how many cores it spent encoding over its
+// last measurement window. While the streams together use more than the
+// budget, the streams using more than an equal share of it are asked to reduce
+// their encoder complexity; once the total is back well below the budget, they
+// may restore it.
+//
+// This class is thread-safe.
+class EncodeCpuBudget {
+ public:
+  // Fraction of the cores of the host given to encoding by Get().
+  static constexpr double kDefaultCoreFraction = 0.8;
+  // Fraction of the budget below which streams may restore complexity.
+  static constexpr double kRestoreFraction = 0.7;
+
+  enum class Recommendation { kReduceComplexity, kKeep, kRestoreComplexity };
+
+  // Returns the budget shared by the whole process.
+  static EncodeCpuBudget& Get();
+
+  explicit EncodeCpuBudget(double budget_cores);
+  EncodeCpuBudget(const EncodeCpuBudget&) = delete;
+  EncodeCpuBudget& operator=(const EncodeCpuBudget&) = delete;
+  ~EncodeCpuBudget();
+
+  // Returns the id used by a new stream for its reports.
+  int RegisterStream();
+  void UnregisterStream(int stream_id);
+
+  // `usage_cores` is the encode time divided by the wall-clock time of the
+  // window, e.g. 0.5 for a stream spending 500 ms per second encoding.
+  void ReportUsage(int stream_id, double usage_cores);
+  Recommendation GetRecommendation(int stream_id) const;
+
+  double budget_cores() const { return budget_cores_; }
+  double TotalUsage() const;
+
+ private:
+  void UpdateTotalUsage() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable Mutex mutex_;
+  const double budget_cores_;
+  int next_stream_id_ RTC_GUARDED_BY(mutex_) = 0;
+  double total_usage_cores_ RTC_GUARDED_BY(mutex_) = 0.0;
+  std::map<int, double> usage_cores_by_stream_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
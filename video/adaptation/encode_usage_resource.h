@@ -47,10 +47,10 @@ class EncodeUsageResource : public VideoStreamEncoderResource,
   void SetTargetFrameRate(absl::optional<double> target_frame_rate);
   void OnEncodeStarted(const VideoFrame& cropped_frame,
                        int64_t time_when_first_seen_us);
-  void OnEncodeCompleted(uint32_t timestamp,
-                         int64_t time_sent_in_us,
-                         int64_t capture_time_us,
-                         absl::optional<int> encode_duration_us);
+  virtual void OnEncodeCompleted(uint32_t timestamp,
+                                 int64_t time_sent_in_us,
+                                 int64_t capture_time_us,
+                                 absl::optional<int> encode_duration_us);
 
   // OveruseFrameDetectorObserverInterface implementation.
   void AdaptUp() override;
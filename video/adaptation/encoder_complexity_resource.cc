@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/adaptation/encoder_complexity_resource.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/ref_counted_object.h"
+
+namespace webrtc {
+
+constexpr int64_t EncoderComplexityResource::kBudgetWindowUs;
+
+// static
+rtc::scoped_refptr<EncoderComplexityResource> EncoderComplexityResource::Create(
+    std::unique_ptr<OveruseFrameDetector> overuse_detector,
+    EncodeCpuBudget* budget) {
+  return rtc::make_ref_counted<EncoderComplexityResource>(
+      std::move(overuse_detector), budget);
+}
+
+EncoderComplexityResource::EncoderComplexityResource(
+    std::unique_ptr<OveruseFrameDetector> overuse_detector,
+    EncodeCpuBudget* budget)
+    : EncodeUsageResource(std::move(overuse_detector)),
+      budget_(budget),
+      budget_stream_id_(budget_->RegisterStream()),
+      max_complexity_reduction_(0),
+      cpu_limited_(false),
+      overuse_steps_(0),
+      budget_steps_(0),
+      window_start_us_(absl::nullopt),
+      window_encode_time_us_(0) {}
+
+EncoderComplexityResource::~EncoderComplexityResource() {
+  budget_->UnregisterStream(budget_stream_id_);
+}
+
+void EncoderComplexityResource::SetMaxComplexityReduction(int max_steps) {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  RTC_DCHECK_GE(max_steps, 0);
+  max_complexity_reduction_ = max_steps;
+  overuse_steps_ = std::min(overuse_steps_, max_steps);
+  budget_steps_ = std::min(budget_steps_, max_steps);
+}
+
+void EncoderComplexityResource::SetCpuLimited(bool cpu_limited) {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  cpu_limited_ = cpu_limited;
+}
+
+int EncoderComplexityResource::complexity_reduction() const {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  return std::min(overuse_steps_ + budget_steps_, max_complexity_reduction_);
+}
+
+void EncoderComplexityResource::OnEncodeCompleted(
+    uint32_t timestamp,
+    int64_t time_sent_in_us,
+    int64_t capture_time_us,
+    absl::optional<int> encode_duration_us) {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  EncodeUsageResource::OnEncodeCompleted(timestamp, time_sent_in_us,
+                                         capture_time_us, encode_duration_us);
+  if (encode_duration_us)
+    window_encode_time_us_ += *encode_duration_us;
+  UpdateBudgetSteps(time_sent_in_us);
+}
+
+void EncoderComplexityResource::AdaptUp() {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  if (!cpu_limited_ && overuse_steps_ > 0) {
+    --overuse_steps_;
+    return;
+  }
+  EncodeUsageResource::AdaptUp();
+}
+
+void EncoderComplexityResource::AdaptDown() {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  if (complexity_reduction() < max_complexity_reduction_) {
+    ++overuse_steps_;
+    return;
+  }
+  EncodeUsageResource::AdaptDown();
+}
+
+void EncoderComplexityResource::UpdateBudgetSteps(int64_t now_us) {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  if (!window_start_us_) {
+    window_start_us_ = now_us;
+    window_encode_time_us_ = 0;
+    return;
+  }
+  const int64_t window_us = now_us - *window_start_us_;
+  if (window_us < kBudgetWindowUs)
+    return;
+  budget_->ReportUsage(budget_stream_id_,
+                       static_cast<double>(window_encode_time_us_) / window_us);
+  switch (budget_->GetRecommendation(budget_stream_id_)) {
+    case EncodeCpuBudget::Recommendation::kReduceComplexity:
+      budget_steps_ = std::min(budget_steps_ + 1, max_complexity_reduction_);
+      break;
+    case EncodeCpuBudget::Recommendation::kRestoreComplexity:
+      budget_steps_ = std::max(budget_steps_ - 1, 0);
+      break;
+    case EncodeCpuBudget::Recommendation::kKeep:
+      break;
+  }
+  window_start_us_ = now_us;
+  window_encode_time_us_ = 0;
+}
+
+}  // namespace webrtc
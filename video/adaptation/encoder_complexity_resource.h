@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_ADAPTATION_ENCODER_COMPLEXITY_RESOURCE_H_
+#define VIDEO_ADAPTATION_ENCODER_COMPLEXITY_RESOURCE_H_
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/scoped_refptr.h"
+#include "video/adaptation/encode_cpu_budget.h"
+#include "video/adaptation/encode_usage_resource.h"
+#include "video/adaptation/overuse_frame_detector.h"
+
+namespace webrtc {
+
+// CPU adaptation that makes the encoder faster, e.g. a higher libvpx cpu-used,
+// before reducing resolution or frame rate. On overuse, the complexity is
+// reduced one step at a time, and overuse is only signaled to the adaptation
+// processor once the encoder is at its fastest setting. On underuse,
+// resolution and frame rate are restored first, then the complexity.
+//
+// The encode time of the stream is also reported to an EncodeCpuBudget shared
+// with the other streams of the process, and the complexity is reduced further
+// while the budget is exceeded. The steps taken for the budget never lead to
+// resolution or frame rate changes.
+class EncoderComplexityResource : public EncodeUsageResource {
+ public:
+  // Length of the window over which the encode time is reported to the budget.
+  static constexpr int64_t kBudgetWindowUs = 2000000;
+
+  static rtc::scoped_refptr<EncoderComplexityResource> Create(
+      std::unique_ptr<OveruseFrameDetector> overuse_detector,
+      EncodeCpuBudget* budget);
+
+  EncoderComplexityResource(
+      std::unique_ptr<OveruseFrameDetector> overuse_detector,
+      EncodeCpuBudget* budget);
+  ~EncoderComplexityResource() override;
+
+  // Number of steps the current encoder supports, from its EncoderInfo.
+  void SetMaxComplexityReduction(int max_steps);
+  // Whether resolution or frame rate is currently limited because of CPU.
+  void SetCpuLimited(bool cpu_limited);
+  // Reduction the encoder should currently use, see
+  // VideoEncoder::SetComplexityReduction().
+  int complexity_reduction() const;
+
+  void OnEncodeCompleted(uint32_t timestamp,
+                         int64_t time_sent_in_us,
+                         int64_t capture_time_us,
+                         absl::optional<int> encode_duration_us) override;
+
+  // OveruseFrameDetectorObserverInterface implementation.
+  void AdaptUp() override;
+  void AdaptDown() override;
+
+ private:
+  void UpdateBudgetSteps(int64_t now_us);
+
+  EncodeCpuBudget* const budget_;
+  const int budget_stream_id_;
+  int max_complexity_reduction_ RTC_GUARDED_BY(encoder_queue());
+  bool cpu_limited_ RTC_GUARDED_BY(encoder_queue());
+  // Steps taken because of overuse and because of the shared budget.
+  int overuse_steps_ RTC_GUARDED_BY(encoder_queue());
+  int budget_steps_ RTC_GUARDED_BY(encoder_queue());
+  absl::optional<int64_t> window_start_us_ RTC_GUARDED_BY(encoder_queue());
+  int64_t window_encode_time_us_ RTC_GUARDED_BY(encoder_queue());
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_ADAPTATION_ENCODER_COMPLEXITY_RESOURCE_H_
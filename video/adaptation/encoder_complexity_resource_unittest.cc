@@ -0,0 +1,153 @@
+/*
+ *  Copyright 2021 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/adaptation/encoder_complexity_resource.h"
+
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+#include "call/adaptation/test/mock_resource_listener.h"
+#include "rtc_base/time_utils.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "video/adaptation/encode_cpu_budget.h"
+
+namespace webrtc {
+
+using testing::Eq;
+using testing::StrictMock;
+
+namespace {
+
+constexpr int kMaxSteps = 3;
+constexpr int64_t kFrameIntervalUs = 33333;
+
+}  // namespace
+
+class EncoderComplexityResourceTest : public ::testing::Test {
+ public:
+  EncoderComplexityResourceTest()
+      : budget_(/*budget_cores=*/1.0),
+        resource_(EncoderComplexityResource::Create(
+            std::make_unique<OveruseFrameDetector>(nullptr),
+            &budget_)) {
+    resource_->RegisterEncoderTaskQueue(TaskQueueBase::Current());
+    resource_->SetResourceListener(&resource_listener_);
+    resource_->StartCheckForOveruse(CpuOveruseOptions());
+    resource_->SetMaxComplexityReduction(kMaxSteps);
+  }
+
+  ~EncoderComplexityResourceTest() override {
+    resource_->StopCheckForOveruse();
+    resource_->SetResourceListener(nullptr);
+  }
+
+  // Encodes frames for `duration_us`, each taking `encode_time_us`.
+  void EncodeFrames(int64_t duration_us, int encode_time_us) {
+    for (int64_t elapsed_us = 0; elapsed_us < duration_us;
+         elapsed_us += kFrameIntervalUs) {
+      now_us_ += kFrameIntervalUs;
+      resource_->OnEncodeCompleted(/*timestamp=*/0, now_us_, now_us_,
+                                   encode_time_us);
+    }
+  }
+
+ protected:
+  int64_t now_us_ = rtc::kNumMicrosecsPerSec;
+  EncodeCpuBudget budget_;
+  StrictMock<MockResourceListener> resource_listener_;
+  rtc::scoped_refptr<EncoderComplexityResource> resource_;
+};
+
+TEST_F(EncoderComplexityResourceTest, ReducesComplexityBeforeSignalingOveruse) {
+  for (int i = 1; i <= kMaxSteps; ++i) {
+    resource_->AdaptDown();
+    EXPECT_EQ(resource_->complexity_reduction(), i);
+  }
+  EXPECT_CALL(resource_listener_,
+              OnResourceUsageStateMeasured(Eq(resource_),
+                                           Eq(ResourceUsageState::kOveruse)));
+  resource_->AdaptDown();
+  EXPECT_EQ(resource_->complexity_reduction(), kMaxSteps);
+}
+
+TEST_F(EncoderComplexityResourceTest, RestoresResolutionBeforeComplexity) {
+  resource_->AdaptDown();
+  resource_->SetCpuLimited(true);
+  EXPECT_CALL(resource_listener_,
+              OnResourceUsageStateMeasured(Eq(resource_),
+                                           Eq(ResourceUsageState::kUnderuse)));
+  resource_->AdaptUp();
+  EXPECT_EQ(resource_->complexity_reduction(), 1);
+
+  resource_->SetCpuLimited(false);
+  resource_->AdaptUp();
+  EXPECT_EQ(resource_->complexity_reduction(), 0);
+}
+
+TEST_F(EncoderComplexityResourceTest, EncoderWithoutComplexityLevels) {
+  resource_->SetMaxComplexityReduction(0);
+  EXPECT_CALL(resource_listener_,
+              OnResourceUsageStateMeasured(Eq(resource_),
+                                           Eq(ResourceUsageState::kOveruse)));
+  resource_->AdaptDown();
+  EXPECT_EQ(resource_->complexity_reduction(), 0);
+}
+
+TEST_F(EncoderComplexityResourceTest, FollowsSharedBudget) {
+  // Another stream using half of the budget.
+  const int other_stream = budget_.RegisterStream();
+  budget_.ReportUsage(other_stream, 0.5);
+
+  // This stream uses 75% of a core, exceeding both the budget and its share.
+  EncodeFrames(2 * EncoderComplexityResource::kBudgetWindowUs,
+               kFrameIntervalUs * 3 / 4);
+  EXPECT_GT(budget_.TotalUsage(), budget_.budget_cores());
+  EXPECT_GE(resource_->complexity_reduction(), 1);
+
+  // Steps taken for the budget do not count as overuse.
+  resource_->SetCpuLimited(false);
+  EXPECT_CALL(resource_listener_,
+              OnResourceUsageStateMeasured(Eq(resource_),
+                                           Eq(ResourceUsageState::kUnderuse)));
+  resource_->AdaptUp();
+
+  // The other stream leaves and this one encodes faster.
+  budget_.UnregisterStream(other_stream);
+  EncodeFrames(10 * EncoderComplexityResource::kBudgetWindowUs,
+               kFrameIntervalUs / 4);
+  EXPECT_EQ(resource_->complexity_reduction(), 0);
+}
+
+TEST(EncodeCpuBudgetTest, AsksStreamsAboveFairShareToReduce) {
+  EncodeCpuBudget budget(/*budget_cores=*/2.0);
+  const int heavy = budget.RegisterStream();
+  const int light = budget.RegisterStream();
+  budget.ReportUsage(heavy, 1.0);
+  budget.ReportUsage(light, 0.2);
+  EXPECT_EQ(budget.GetRecommendation(heavy),
+            EncodeCpuBudget::Recommendation::kRestoreComplexity);
+
+  budget.ReportUsage(heavy, 1.9);
+  EXPECT_EQ(budget.GetRecommendation(heavy),
+            EncodeCpuBudget::Recommendation::kReduceComplexity);
+  EXPECT_EQ(budget.GetRecommendation(light),
+            EncodeCpuBudget::Recommendation::kKeep);
+
+  budget.ReportUsage(heavy, 1.5);
+  EXPECT_EQ(budget.GetRecommendation(heavy),
+            EncodeCpuBudget::Recommendation::kKeep);
+
+  budget.UnregisterStream(heavy);
+  EXPECT_DOUBLE_EQ(budget.TotalUsage(), 0.2);
+  budget.UnregisterStream(light);
+}
+
+}  // namespace webrtc
@@ -45,6 +45,8 @@ namespace {
 
 constexpr const char* kPixelLimitResourceFieldTrialName =
     "WebRTC-PixelLimitResource";
+constexpr const char* kEncoderComplexityAdaptationFieldTrialName =
+    "WebRTC-Video-EncoderComplexityAdaptation";
 
 bool IsResolutionScalingEnabled(DegradationPreference degradation_preference) {
   return degradation_preference == DegradationPreference::MAINTAIN_FRAMERATE ||
@@ -271,8 +273,16 @@ VideoStreamEncoderResourceManager::VideoStreamEncoderResourceManager(
       bitrate_constraint_(std::make_unique<BitrateConstraint>()),
       balanced_constraint_(std::make_unique<BalancedConstraint>(
           degradation_preference_provider_)),
+      encoder_complexity_resource_(
+          field_trial::IsEnabled(kEncoderComplexityAdaptationFieldTrialName)
+              ? EncoderComplexityResource::Create(std::move(overuse_detector),
+                                                  &EncodeCpuBudget::Get())
+              : nullptr),
       encode_usage_resource_(
-          EncodeUsageResource::Create(std::move(overuse_detector))),
+          encoder_complexity_resource_
+              ? rtc::scoped_refptr<EncodeUsageResource>(
+                    encoder_complexity_resource_)
+              : EncodeUsageResource::Create(std::move(overuse_detector))),
       quality_scaler_resource_(QualityScalerResource::Create()),
       pixel_limit_resource_(nullptr),
       bandwidth_quality_scaler_resource_(
@@ -434,6 +444,10 @@ void VideoStreamEncoderResourceManager::SetEncoderSettings(
   initial_frame_dropper_->OnEncoderSettingsUpdated(
       encoder_settings_->video_codec(), current_adaptation_counters_);
   MaybeUpdateTargetFrameRate();
+  if (encoder_complexity_resource_) {
+    encoder_complexity_resource_->SetMaxComplexityReduction(
+        encoder_settings_->encoder_info().max_complexity_reduction);
+  }
   if (quality_rampup_experiment_) {
     quality_rampup_experiment_->ConfigureQualityRampupExperiment(
         initial_frame_dropper_->last_stream_configuration_changed(),
@@ -513,6 +527,13 @@ void VideoStreamEncoderResourceManager::OnEncodeCompleted(
       encoded_image, time_sent_in_us, frame_size.bytes());
 }
 
+int VideoStreamEncoderResourceManager::ComplexityReduction() const {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  return encoder_complexity_resource_
+             ? encoder_complexity_resource_->complexity_reduction()
+             : 0;
+}
+
 void VideoStreamEncoderResourceManager::OnFrameDropped(
     EncodedImageCallback::DropReason reason) {
   RTC_DCHECK_RUN_ON(encoder_queue_);
@@ -730,6 +751,11 @@ void VideoStreamEncoderResourceManager::OnResourceLimitationChanged(
     }
   }
 
+  if (encoder_complexity_resource_) {
+    encoder_complexity_resource_->SetCpuLimited(
+        limitations[VideoAdaptationReason::kCpu].Total() > 0);
+  }
+
   VideoAdaptationReason adaptation_reason = GetReasonFromResource(resource);
   encoder_stats_observer_->OnAdaptationChanged(
       adaptation_reason, limitations[VideoAdaptationReason::kCpu],
@@ -46,6 +46,7 @@
 #include "video/adaptation/bandwidth_quality_scaler_resource.h"
 #include "video/adaptation/bitrate_constraint.h"
 #include "video/adaptation/encode_usage_resource.h"
+#include "video/adaptation/encoder_complexity_resource.h"
 #include "video/adaptation/overuse_frame_detector.h"
 #include "video/adaptation/pixel_limit_resource.h"
 #include "video/adaptation/quality_rampup_experiment_helper.h"
@@ -123,6 +124,10 @@ class VideoStreamEncoderResourceManager
                          absl::optional<int> encode_duration_us,
                          DataSize frame_size);
   void OnFrameDropped(EncodedImageCallback::DropReason reason);
+  // Complexity reduction the encoder should use, see
+  // VideoEncoder::SetComplexityReduction(). Always 0 unless the
+  // "WebRTC-Video-EncoderComplexityAdaptation" field trial is enabled.
+  int ComplexityReduction() const;
 
   // Resources need to be mapped to an AdaptReason (kCpu or kQuality) in order
   // to update legacy getStats().
@@ -186,6 +191,10 @@ class VideoStreamEncoderResourceManager
       RTC_GUARDED_BY(encoder_queue_);
   const std::unique_ptr<BalancedConstraint> balanced_constraint_
       RTC_GUARDED_BY(encoder_queue_);
+  // Set when complexity adaptation is enabled, in which case it is also the
+  // `encode_usage_resource_`.
+  const rtc::scoped_refptr<EncoderComplexityResource>
+      encoder_complexity_resource_;
   const rtc::scoped_refptr<EncodeUsageResource> encode_usage_resource_;
   const rtc::scoped_refptr<QualityScalerResource> quality_scaler_resource_;
   rtc::scoped_refptr<PixelLimitResource> pixel_limit_resource_;
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/shared_encode_scheduler.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/task_utils/to_queued_task.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+
+class SharedEncodeScheduler::StreamImpl : public VideoEncodeScheduler::Stream {
+ public:
+  explicit StreamImpl(SharedEncodeScheduler* scheduler)
+      : scheduler_(scheduler) {}
+  ~StreamImpl() override { scheduler_->UnregisterStream(this); }
+
+  int NumberOfCores() const override { return scheduler_->NumberOfCores(); }
+  bool BeginEncode(Priority priority) override {
+    return scheduler_->BeginEncode(this, priority);
+  }
+  void EndEncode() override { scheduler_->EndEncode(this); }
+
+ private:
+  SharedEncodeScheduler* const scheduler_;
+};
+
+// static
+SharedEncodeScheduler& SharedEncodeScheduler::Get() {
+  static SharedEncodeScheduler* const scheduler = [] {
+    const int cores = CpuInfo::DetectNumberOfCores();
+    return new SharedEncodeScheduler(cores, cores);
+  }();
+  return *scheduler;
+}
+
+SharedEncodeScheduler::SharedEncodeScheduler(int max_concurrent_encodes,
+                                             int total_cores)
+    : max_concurrent_encodes_(max_concurrent_encodes),
+      total_cores_(total_cores) {
+  RTC_DCHECK_GE(max_concurrent_encodes_, 1);
+  RTC_DCHECK_GE(total_cores_, 1);
+}
+
+SharedEncodeScheduler::~SharedEncodeScheduler() {
+  RTC_DCHECK(streams_.empty());
+}
+
+std::unique_ptr<VideoEncodeScheduler::Stream>
+SharedEncodeScheduler::RegisterStream(TaskQueueBase* task_queue,
+                                      StreamObserver* observer) {
+  RTC_DCHECK(task_queue);
+  RTC_DCHECK(observer);
+  auto stream = std::make_unique<StreamImpl>(this);
+  MutexLock lock(&mutex_);
+  const int old_cores = NumberOfCoresLocked();
+  ++metrics_.registered_streams;
+  // The new stream gets its share when its encoder is initialized.
+  MaybeNotifyNumberOfCoresLocked(old_cores);
+  streams_[stream.get()] = StreamState{task_queue, observer};
+  return stream;
+}
+
+VideoEncodeScheduler::Metrics SharedEncodeScheduler::GetMetrics() const {
+  MutexLock lock(&mutex_);
+  return metrics_;
+}
+
+int SharedEncodeScheduler::NumberOfCores() const {
+  MutexLock lock(&mutex_);
+  return NumberOfCoresLocked();
+}
+
+int SharedEncodeScheduler::NumberOfCoresLocked() const {
+  return std::max(1, total_cores_ / std::max(1, metrics_.registered_streams));
+}
+
+void SharedEncodeScheduler::UnregisterStream(const StreamImpl* stream) {
+  MutexLock lock(&mutex_);
+  auto it = streams_.find(stream);
+  RTC_DCHECK(it != streams_.end());
+  const int running_encodes = it->second.running_encodes;
+  streams_.erase(it);
+  for (std::deque<Waiter>& waiters : waiters_) {
+    for (auto waiter = waiters.begin(); waiter != waiters.end();) {
+      if (waiter->stream == stream) {
+        waiter = waiters.erase(waiter);
+        --metrics_.queued_encodes;
+      } else {
+        ++waiter;
+      }
+    }
+  }
+  // Encodes the stream was allowed but will never end, e.g., because it was
+  // stopped before it got to them.
+  for (int i = 0; i < running_encodes; ++i) {
+    AllowNextEncodeLocked();
+  }
+  const int old_cores = NumberOfCoresLocked();
+  RTC_DCHECK_GT(metrics_.registered_streams, 0);
+  --metrics_.registered_streams;
+  MaybeNotifyNumberOfCoresLocked(old_cores);
+}
+
+bool SharedEncodeScheduler::BeginEncode(const StreamImpl* stream,
+                                        Priority priority) {
+  MutexLock lock(&mutex_);
+  auto it = streams_.find(stream);
+  RTC_DCHECK(it != streams_.end());
+  StreamState& state = it->second;
+  ++metrics_.encodes;
+  if (metrics_.running_encodes < max_concurrent_encodes_ &&
+      metrics_.queued_encodes == 0) {
+    ++metrics_.running_encodes;
+    ++state.running_encodes;
+    return true;
+  }
+  waiters_[static_cast<int>(priority)].push_back(
+      Waiter{stream, rtc::TimeMicros()});
+  ++metrics_.queued_encodes;
+  ++metrics_.delayed_encodes;
+  metrics_.max_queued_encodes =
+      std::max(metrics_.max_queued_encodes, metrics_.queued_encodes);
+  return false;
+}
+
+void SharedEncodeScheduler::EndEncode(const StreamImpl* stream) {
+  MutexLock lock(&mutex_);
+  auto it = streams_.find(stream);
+  RTC_DCHECK(it != streams_.end());
+  StreamState& state = it->second;
+  RTC_DCHECK_GT(state.running_encodes, 0);
+  --state.running_encodes;
+  AllowNextEncodeLocked();
+}
+
+void SharedEncodeScheduler::AllowNextEncodeLocked() {
+  RTC_DCHECK_GT(metrics_.running_encodes, 0);
+  for (std::deque<Waiter>& waiters : waiters_) {
+    if (waiters.empty())
+      continue;
+    const Waiter waiter = waiters.front();
+    waiters.pop_front();
+    --metrics_.queued_encodes;
+    const int64_t wait_time_us = rtc::TimeMicros() - waiter.enqueued_us;
+    metrics_.total_wait_time_us += wait_time_us;
+    metrics_.max_wait_time_us =
+        std::max(metrics_.max_wait_time_us, wait_time_us);
+    // The slot is handed over, `running_encodes` included.
+    StreamState& state = streams_.find(waiter.stream)->second;
+    ++state.running_encodes;
+    state.task_queue->PostTask(ToQueuedTask(
+        [observer = state.observer] { observer->OnEncodeAllowed(); }));
+    return;
+  }
+  --metrics_.running_encodes;
+}
+
+void SharedEncodeScheduler::MaybeNotifyNumberOfCoresLocked(int old_cores) {
+  if (NumberOfCoresLocked() == old_cores)
+    return;
+  for (const auto& stream : streams_) {
+    stream.second.task_queue->PostTask(ToQueuedTask(
+        [observer = stream.second.observer] {
+          observer->OnNumberOfCoresChanged();
+        }));
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_SHARED_ENCODE_SCHEDULER_H_
+#define VIDEO_SHARED_ENCODE_SCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include <memory>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/video/video_encode_scheduler.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// VideoEncodeScheduler that lets at most `max_concurrent_encodes` frames be
+// encoded at the same time, and splits `total_cores` evenly between the
+// registered streams. Frames that have to wait are encoded in priority order,
+// and in arrival order within a priority. A waiting stream is told on its own
+// task queue when it may encode, so no encoder queue blocks on another.
+class SharedEncodeScheduler : public VideoEncodeScheduler {
+ public:
+  // Returns the scheduler shared by the whole process, using all the cores of
+  // the host.
+  static SharedEncodeScheduler& Get();
+
+  SharedEncodeScheduler(int max_concurrent_encodes, int total_cores);
+  SharedEncodeScheduler(const SharedEncodeScheduler&) = delete;
+  SharedEncodeScheduler& operator=(const SharedEncodeScheduler&) = delete;
+  ~SharedEncodeScheduler() override;
+
+  std::unique_ptr<Stream> RegisterStream(TaskQueueBase* task_queue,
+                                         StreamObserver* observer) override;
+  Metrics GetMetrics() const override;
+
+ private:
+  class StreamImpl;
+
+  struct StreamState {
+    TaskQueueBase* task_queue;
+    StreamObserver* observer;
+    // Encodes the stream was allowed and has not ended yet.
+    int running_encodes = 0;
+  };
+
+  struct Waiter {
+    const StreamImpl* stream;
+    int64_t enqueued_us;
+  };
+
+  int NumberOfCores() const;
+  int NumberOfCoresLocked() const RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void UnregisterStream(const StreamImpl* stream);
+  bool BeginEncode(const StreamImpl* stream, Priority priority);
+  void EndEncode(const StreamImpl* stream);
+  // Hands a free encode slot to the next waiting frame, if there is one.
+  void AllowNextEncodeLocked() RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Tells the streams that the number of cores changed from `old_cores`.
+  void MaybeNotifyNumberOfCoresLocked(int old_cores)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const int max_concurrent_encodes_;
+  const int total_cores_;
+
+  mutable Mutex mutex_;
+  std::map<const StreamImpl*, StreamState> streams_ RTC_GUARDED_BY(mutex_);
+  // Frames waiting for a slot, indexed by `Priority`.
+  std::deque<Waiter> waiters_[3] RTC_GUARDED_BY(mutex_);
+  Metrics metrics_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_SHARED_ENCODE_SCHEDULER_H_
@@ -0,0 +1,213 @@
+/*
+ *  Copyright (c) 2021 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/shared_encode_scheduler.h"
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/event.h"
+#include "rtc_base/task_queue_for_test.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using Priority = VideoEncodeScheduler::Priority;
+using ::testing::ElementsAre;
+
+constexpr int kWaitMs = 5000;
+
+// Counts the calls it gets on the task queue of its stream. Optionally ends
+// each allowed encode right away.
+class FakeStreamObserver : public VideoEncodeScheduler::StreamObserver {
+ public:
+  FakeStreamObserver() = default;
+  FakeStreamObserver(Priority priority,
+                     std::vector<Priority>* encoded,
+                     rtc::Event* all_encoded,
+                     size_t expected_encodes)
+      : priority_(priority),
+        encoded_(encoded),
+        all_encoded_(all_encoded),
+        expected_encodes_(expected_encodes) {}
+
+  void set_stream(VideoEncodeScheduler::Stream* stream) { stream_ = stream; }
+  int encodes_allowed() const { return encodes_allowed_; }
+  int number_of_cores_changes() const { return number_of_cores_changes_; }
+
+  void OnEncodeAllowed() override {
+    ++encodes_allowed_;
+    if (!encoded_)
+      return;
+    encoded_->push_back(priority_);
+    stream_->EndEncode();
+    if (encoded_->size() == expected_encodes_)
+      all_encoded_->Set();
+  }
+  void OnNumberOfCoresChanged() override { ++number_of_cores_changes_; }
+
+ private:
+  const Priority priority_ = Priority::kNormal;
+  std::vector<Priority>* const encoded_ = nullptr;
+  rtc::Event* const all_encoded_ = nullptr;
+  const size_t expected_encodes_ = 0;
+  VideoEncodeScheduler::Stream* stream_ = nullptr;
+  int encodes_allowed_ = 0;
+  int number_of_cores_changes_ = 0;
+};
+
+}  // namespace
+
+TEST(SharedEncodeSchedulerTest, SplitsCoresBetweenStreams) {
+  SharedEncodeScheduler scheduler(/*max_concurrent_encodes=*/4,
+                                  /*total_cores=*/8);
+  FakeStreamObserver observer;
+  TaskQueueForTest queue("EncoderQueue");
+  std::unique_ptr<VideoEncodeScheduler::Stream> first =
+      scheduler.RegisterStream(queue.Get(), &observer);
+  EXPECT_EQ(first->NumberOfCores(), 8);
+  std::vector<std::unique_ptr<VideoEncodeScheduler::Stream>> others;
+  for (int i = 0; i < 3; ++i) {
+    others.push_back(scheduler.RegisterStream(queue.Get(), &observer));
+  }
+  EXPECT_EQ(first->NumberOfCores(), 2);
+  for (int i = 0; i < 12; ++i) {
+    others.push_back(scheduler.RegisterStream(queue.Get(), &observer));
+  }
+  // Never less than one core.
+  EXPECT_EQ(first->NumberOfCores(), 1);
+  EXPECT_EQ(scheduler.GetMetrics().registered_streams, 16);
+  others.clear();
+  EXPECT_EQ(first->NumberOfCores(), 8);
+}
+
+TEST(SharedEncodeSchedulerTest, NotifiesStreamsWhenNumberOfCoresChanges) {
+  SharedEncodeScheduler scheduler(/*max_concurrent_encodes=*/2,
+                                  /*total_cores=*/2);
+  FakeStreamObserver observer_a;
+  FakeStreamObserver observer_b;
+  FakeStreamObserver observer_c;
+  TaskQueueForTest queue("EncoderQueue");
+  std::unique_ptr<VideoEncodeScheduler::Stream> a =
+      scheduler.RegisterStream(queue.Get(), &observer_a);
+  std::unique_ptr<VideoEncodeScheduler::Stream> b =
+      scheduler.RegisterStream(queue.Get(), &observer_b);
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer_a.number_of_cores_changes(), 1);
+  EXPECT_EQ(observer_b.number_of_cores_changes(), 0);
+
+  // Already down to one core each.
+  std::unique_ptr<VideoEncodeScheduler::Stream> c =
+      scheduler.RegisterStream(queue.Get(), &observer_c);
+  c = nullptr;
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer_a.number_of_cores_changes(), 1);
+
+  b = nullptr;
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer_a.number_of_cores_changes(), 2);
+  EXPECT_EQ(a->NumberOfCores(), 2);
+}
+
+TEST(SharedEncodeSchedulerTest, EncodesWithoutWaitingBelowLimit) {
+  SharedEncodeScheduler scheduler(/*max_concurrent_encodes=*/2,
+                                  /*total_cores=*/2);
+  FakeStreamObserver observer;
+  TaskQueueForTest queue("EncoderQueue");
+  std::unique_ptr<VideoEncodeScheduler::Stream> a =
+      scheduler.RegisterStream(queue.Get(), &observer);
+  std::unique_ptr<VideoEncodeScheduler::Stream> b =
+      scheduler.RegisterStream(queue.Get(), &observer);
+  EXPECT_TRUE(a->BeginEncode(Priority::kNormal));
+  EXPECT_TRUE(b->BeginEncode(Priority::kNormal));
+  EXPECT_EQ(scheduler.GetMetrics().running_encodes, 2);
+  a->EndEncode();
+  b->EndEncode();
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer.encodes_allowed(), 0);
+  const VideoEncodeScheduler::Metrics metrics = scheduler.GetMetrics();
+  EXPECT_EQ(metrics.running_encodes, 0);
+  EXPECT_EQ(metrics.encodes, 2);
+  EXPECT_EQ(metrics.delayed_encodes, 0);
+}
+
+TEST(SharedEncodeSchedulerTest, EncodesWaitingFramesInPriorityOrder) {
+  SharedEncodeScheduler scheduler(/*max_concurrent_encodes=*/1,
+                                  /*total_cores=*/1);
+  std::vector<Priority> encoded;
+  rtc::Event all_encoded;
+  FakeStreamObserver running_observer;
+  std::vector<std::unique_ptr<FakeStreamObserver>> observers;
+  const Priority priorities[] = {Priority::kNormal, Priority::kLowLatency,
+                                 Priority::kKeyFrame};
+  for (Priority priority : priorities) {
+    observers.push_back(std::make_unique<FakeStreamObserver>(
+        priority, &encoded, &all_encoded, /*expected_encodes=*/3));
+  }
+  TaskQueueForTest queue("EncoderQueue");
+  std::unique_ptr<VideoEncodeScheduler::Stream> running =
+      scheduler.RegisterStream(queue.Get(), &running_observer);
+  ASSERT_TRUE(running->BeginEncode(Priority::kNormal));
+
+  // The waiting frames do not block the thread that queues them.
+  std::vector<std::unique_ptr<VideoEncodeScheduler::Stream>> streams;
+  for (size_t i = 0; i < observers.size(); ++i) {
+    streams.push_back(
+        scheduler.RegisterStream(queue.Get(), observers[i].get()));
+    observers[i]->set_stream(streams.back().get());
+    EXPECT_FALSE(streams.back()->BeginEncode(priorities[i]));
+  }
+  EXPECT_EQ(scheduler.GetMetrics().queued_encodes, 3);
+
+  running->EndEncode();
+  ASSERT_TRUE(all_encoded.Wait(kWaitMs));
+  EXPECT_THAT(encoded, ElementsAre(Priority::kKeyFrame, Priority::kLowLatency,
+                                   Priority::kNormal));
+  const VideoEncodeScheduler::Metrics metrics = scheduler.GetMetrics();
+  EXPECT_EQ(metrics.encodes, 4);
+  EXPECT_EQ(metrics.delayed_encodes, 3);
+  EXPECT_EQ(metrics.max_queued_encodes, 3);
+  EXPECT_EQ(metrics.queued_encodes, 0);
+  EXPECT_EQ(metrics.running_encodes, 0);
+  EXPECT_GE(metrics.max_wait_time_us, 0);
+}
+
+TEST(SharedEncodeSchedulerTest, GivesBackSlotsOfUnregisteredStreams) {
+  SharedEncodeScheduler scheduler(/*max_concurrent_encodes=*/1,
+                                  /*total_cores=*/1);
+  FakeStreamObserver observer_a;
+  FakeStreamObserver observer_b;
+  FakeStreamObserver observer_c;
+  TaskQueueForTest queue("EncoderQueue");
+  std::unique_ptr<VideoEncodeScheduler::Stream> a =
+      scheduler.RegisterStream(queue.Get(), &observer_a);
+  std::unique_ptr<VideoEncodeScheduler::Stream> b =
+      scheduler.RegisterStream(queue.Get(), &observer_b);
+  std::unique_ptr<VideoEncodeScheduler::Stream> c =
+      scheduler.RegisterStream(queue.Get(), &observer_c);
+  ASSERT_TRUE(a->BeginEncode(Priority::kNormal));
+  EXPECT_FALSE(b->BeginEncode(Priority::kNormal));
+  EXPECT_FALSE(c->BeginEncode(Priority::kNormal));
+
+  // `b` gets the slot of `a`, but is stopped before it encodes.
+  a = nullptr;
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer_b.encodes_allowed(), 1);
+  b = nullptr;
+  queue.WaitForPreviouslyPostedTasks();
+  EXPECT_EQ(observer_c.encodes_allowed(), 1);
+  c->EndEncode();
+  EXPECT_EQ(scheduler.GetMetrics().running_encodes, 0);
+  EXPECT_EQ(scheduler.GetMetrics().queued_encodes, 0);
+}
+
+}  // namespace webrtc
@@ -31,6 +31,7 @@
 #include "api/video_codecs/video_encoder.h"
 #include "call/adaptation/resource_adaptation_processor.h"
 #include "call/adaptation/video_stream_adapter.h"
+#include "common_video/include/video_frame_buffer.h"
 #include "modules/video_coding/include/video_codec_initializer.h"
 #include "modules/video_coding/svc/svc_rate_allocator.h"
 #include "rtc_base/arraysize.h"
@@ -62,6 +63,11 @@ const int64_t kPendingFrameTimeoutMs = 1000;
 
 constexpr char kFrameDropperFieldTrial[] = "WebRTC-FrameDropper";
 
+// Prepares frames, e.g., converts them to a pixel format the encoder accepts,
+// on a separate task queue one frame ahead of the encoder.
+constexpr char kPipelinedPreprocessingFieldTrial[] =
+    "WebRTC-Video-PipelinedPreprocessing";
+
 // Averaging window spanning 90 frames at default 30fps, matching old media
 // optimization module defaults.
 const int64_t kFrameRateAvergingWindowSizeMs = (1000 / 30) * 90;
@@ -498,6 +504,52 @@ void ApplyEncoderBitrateLimitsIfSingleActiveStream(
                encoder_bitrate_limits->max_bitrate_bps);
 }
 
+// Crops `buffer` to `width` x `height`, starting at (`offset_x`, `offset_y`),
+// without scaling. An I420 buffer is cropped without any copy, by referencing
+// its planes, so that its pixels are only read if and when the frame gets
+// encoded. Other buffer types are cropped into a new buffer.
+rtc::scoped_refptr<VideoFrameBuffer> CropWithoutScaling(
+    rtc::scoped_refptr<VideoFrameBuffer> buffer,
+    int offset_x,
+    int offset_y,
+    int width,
+    int height) {
+  if (buffer->type() != VideoFrameBuffer::Type::kI420) {
+    return buffer->CropAndScale(offset_x, offset_y, width, height, width,
+                                height);
+  }
+  const I420BufferInterface* i420 = buffer->GetI420();
+  // Keep the offset even so that the chroma planes stay aligned, like
+  // I420Buffer::CropAndScaleFrom() does.
+  const int uv_offset_x = offset_x / 2;
+  const int uv_offset_y = offset_y / 2;
+  return WrapI420Buffer(
+      width, height,
+      i420->DataY() + i420->StrideY() * uv_offset_y * 2 + uv_offset_x * 2,
+      i420->StrideY(),
+      i420->DataU() + i420->StrideU() * uv_offset_y + uv_offset_x,
+      i420->StrideU(),
+      i420->DataV() + i420->StrideV() * uv_offset_y + uv_offset_x,
+      i420->StrideV(), [buffer] {});
+}
+
+// Reduces the size of `buffer` by `crop_width` x `crop_height`, by cropping if
+// the difference is small and by scaling otherwise.
+rtc::scoped_refptr<VideoFrameBuffer> CropOrScale(
+    rtc::scoped_refptr<VideoFrameBuffer> buffer,
+    int crop_width,
+    int crop_height) {
+  const int width = buffer->width() - crop_width;
+  const int height = buffer->height() - crop_height;
+  // TODO(ilnik): Remove scaling if cropping is too big, as it should never
+  // happen after SinkWants signaled correctly from ReconfigureEncoder.
+  if (crop_width < 4 && crop_height < 4) {
+    return CropWithoutScaling(std::move(buffer), crop_width / 2,
+                              crop_height / 2, width, height);
+  }
+  return buffer->Scale(width, height);
+}
+
 }  //  namespace
 
 VideoStreamEncoder::EncoderRateSettings::EncoderRateSettings()
@@ -527,6 +579,19 @@ bool VideoStreamEncoder::EncoderRateSettings::operator!=(
   return !(*this == rhs);
 }
 
+bool VideoStreamEncoder::PreprocessingState::operator==(
+    const PreprocessingState& rhs) const {
+  return encoder_initialized == rhs.encoder_initialized &&
+         pixel_formats == rhs.pixel_formats &&
+         input_width == rhs.input_width && input_height == rhs.input_height &&
+         crop_width == rhs.crop_width && crop_height == rhs.crop_height;
+}
+
+bool VideoStreamEncoder::PreprocessingState::operator!=(
+    const PreprocessingState& rhs) const {
+  return !(*this == rhs);
+}
+
 class VideoStreamEncoder::DegradationPreferenceManager
     : public DegradationPreferenceProvider {
  public:
@@ -601,6 +666,7 @@ VideoStreamEncoder::VideoStreamEncoder(
       encoder_selector_(settings.encoder_factory->GetEncoderSelector()),
       encoder_stats_observer_(encoder_stats_observer),
       encoder_initialized_(false),
+      encoder_complexity_reduction_(0),
       max_framerate_(-1),
       pending_encoder_reconfiguration_(false),
       pending_encoder_creation_(false),
@@ -620,6 +686,10 @@ VideoStreamEncoder::VideoStreamEncoder(
       captured_frame_count_(0),
       dropped_frame_cwnd_pushback_count_(0),
       dropped_frame_encoder_block_count_(0),
+      held_back_frame_size_count_(0),
+      held_back_frame_paused_count_(0),
+      dropped_frame_media_opt_count_(0),
+      converted_frame_count_(0),
       pending_frame_post_time_us_(0),
       accumulated_update_rect_{0, 0, 0, 0},
       accumulated_update_rect_is_valid_(true),
@@ -662,6 +732,12 @@ VideoStreamEncoder::VideoStreamEncoder(
       encoder_queue_(task_queue_factory->CreateTaskQueue(
           "EncoderQueue",
           TaskQueueFactory::Priority::NORMAL)) {
+  if (field_trial::IsEnabled(kPipelinedPreprocessingFieldTrial)) {
+    preprocessing_queue_ =
+        std::make_unique<rtc::TaskQueue>(task_queue_factory->CreateTaskQueue(
+            "EncoderPreprocessingQueue", TaskQueueFactory::Priority::NORMAL));
+  }
+
   TRACE_EVENT0("webrtc", "VideoStreamEncoder::VideoStreamEncoder");
   RTC_DCHECK(main_queue_);
   RTC_DCHECK(encoder_stats_observer);
@@ -672,6 +748,10 @@ VideoStreamEncoder::VideoStreamEncoder(
   rtc::Event initialize_processor_event;
   encoder_queue_.PostTask([this, &initialize_processor_event] {
     RTC_DCHECK_RUN_ON(&encoder_queue_);
+    if (settings_.encode_scheduler) {
+      encode_scheduler_stream_ = settings_.encode_scheduler->RegisterStream(
+          encoder_queue_.Get(), this);
+    }
     resource_adaptation_processor_->SetTaskQueue(encoder_queue_.Get());
     stream_resource_manager_.SetAdaptationProcessor(
         resource_adaptation_processor_.get(), video_stream_adapter_.get());
@@ -701,10 +781,21 @@ void VideoStreamEncoder::Stop() {
   RTC_DCHECK_RUN_ON(main_queue_);
   video_source_sink_controller_.SetSource(nullptr);
 
+  if (preprocessing_queue_) {
+    // Let frames already being prepared reach `encoder_queue_` ahead of the
+    // shutdown task. Any frame after that is dropped by
+    // `preprocessed_frame_safety_`.
+    rtc::Event preprocessing_flushed_event;
+    preprocessing_queue_->PostTask(
+        [&preprocessing_flushed_event] { preprocessing_flushed_event.Set(); });
+    preprocessing_flushed_event.Wait(rtc::Event::kForever);
+  }
+
   rtc::Event shutdown_event;
 
   encoder_queue_.PostTask([this, &shutdown_event] {
     RTC_DCHECK_RUN_ON(&encoder_queue_);
+    preprocessed_frame_safety_->SetNotAlive();
     if (resource_adaptation_processor_) {
       stream_resource_manager_.StopManagedResources();
       for (auto* constraint : adaptation_constraints_) {
@@ -725,6 +816,9 @@ void VideoStreamEncoder::Stop() {
     rate_allocator_ = nullptr;
     ReleaseEncoder();
     encoder_ = nullptr;
+    // Gives back a slot the scheduler may have handed over already.
+    encode_scheduler_stream_ = nullptr;
+    scheduled_frame_.reset();
     shutdown_event.Set();
   });
   shutdown_event.Wait(rtc::Event::kForever);
@@ -1120,6 +1214,18 @@ void VideoStreamEncoder::ReconfigureEncoder() {
     encoder_reset_required = RequiresEncoderReset(
         send_codec_, codec, was_encode_called_since_last_initialization_);
   }
+  // The share of the cores changes as other streams come and go. Initializing
+  // the encoder again costs a key frame, so a new share is only applied when
+  // every layer sends a key frame anyway, or when the encoder is reset for
+  // another reason.
+  if (!encoder_reset_required && encode_scheduler_stream_ &&
+      absl::c_all_of(next_frame_types_, [](VideoFrameType type) {
+        return type == VideoFrameType::kVideoFrameKey;
+      })) {
+    encoder_reset_required =
+        encode_scheduler_stream_->NumberOfCores() != encoder_number_of_cores_;
+    number_of_cores_changed_ = false;
+  }
   send_codec_ = codec;
 
   // Keep the same encoder, as long as the video_format is unchanged.
@@ -1132,9 +1238,14 @@ void VideoStreamEncoder::ReconfigureEncoder() {
     const size_t max_data_payload_length = max_data_payload_length_ > 0
                                                ? max_data_payload_length_
                                                : kDefaultPayloadSize;
+    const int number_of_cores = encode_scheduler_stream_
+                                    ? encode_scheduler_stream_->NumberOfCores()
+                                    : number_of_cores_;
+    encoder_number_of_cores_ = number_of_cores;
+    number_of_cores_changed_ = false;
     if (encoder_->InitEncode(
             &send_codec_,
-            VideoEncoder::Settings(settings_.capabilities, number_of_cores_,
+            VideoEncoder::Settings(settings_.capabilities, number_of_cores,
                                    max_data_payload_length)) != 0) {
       RTC_LOG(LS_ERROR) << "Failed to initialize the encoder associated with "
                            "codec type: "
@@ -1144,6 +1255,7 @@ void VideoStreamEncoder::ReconfigureEncoder() {
       success = false;
     } else {
       encoder_initialized_ = true;
+      encoder_complexity_reduction_ = 0;
       encoder_->RegisterEncodeCompleteCallback(this);
       frame_encode_metadata_writer_.OnEncoderInit(send_codec_,
                                                   HasInternalSource());
@@ -1316,52 +1428,163 @@ void VideoStreamEncoder::OnFrame(const VideoFrame& video_frame) {
   int64_t post_time_us = clock_->CurrentTime().us();
   ++posted_frames_waiting_for_encode_;
 
-  encoder_queue_.PostTask(
-      [this, incoming_frame, post_time_us, log_stats]() {
-        RTC_DCHECK_RUN_ON(&encoder_queue_);
-        encoder_stats_observer_->OnIncomingFrame(incoming_frame.width(),
-                                                 incoming_frame.height());
-        ++captured_frame_count_;
-        const int posted_frames_waiting_for_encode =
-            posted_frames_waiting_for_encode_.fetch_sub(1);
-        RTC_DCHECK_GT(posted_frames_waiting_for_encode, 0);
-        CheckForAnimatedContent(incoming_frame, post_time_us);
-        bool cwnd_frame_drop =
-            cwnd_frame_drop_interval_ &&
-            (cwnd_frame_counter_++ % cwnd_frame_drop_interval_.value() == 0);
-        if (posted_frames_waiting_for_encode == 1 && !cwnd_frame_drop) {
-          MaybeEncodeVideoFrame(incoming_frame, post_time_us);
-        } else {
-          if (cwnd_frame_drop) {
-            // Frame drop by congestion window pushback. Do not encode this
-            // frame.
-            ++dropped_frame_cwnd_pushback_count_;
-            encoder_stats_observer_->OnFrameDropped(
-                VideoStreamEncoderObserver::DropReason::kCongestionWindow);
-          } else {
-            // There is a newer frame in flight. Do not encode this frame.
-            RTC_LOG(LS_VERBOSE)
-                << "Incoming frame dropped due to that the encoder is blocked.";
-            ++dropped_frame_encoder_block_count_;
-            encoder_stats_observer_->OnFrameDropped(
-                VideoStreamEncoderObserver::DropReason::kEncoderQueue);
-          }
-          accumulated_update_rect_.Union(incoming_frame.update_rect());
-          accumulated_update_rect_is_valid_ &= incoming_frame.has_update_rect();
-        }
-        if (log_stats) {
-          RTC_LOG(LS_INFO) << "Number of frames: captured "
-                           << captured_frame_count_
-                           << ", dropped (due to congestion window pushback) "
-                           << dropped_frame_cwnd_pushback_count_
-                           << ", dropped (due to encoder blocked) "
-                           << dropped_frame_encoder_block_count_
-                           << ", interval_ms " << kFrameLogIntervalMs;
-          captured_frame_count_ = 0;
-          dropped_frame_cwnd_pushback_count_ = 0;
-          dropped_frame_encoder_block_count_ = 0;
-        }
-      });
+  if (preprocessing_queue_) {
+    // Frame N + 1 is prepared on `preprocessing_queue_` while frame N is being
+    // encoded on `encoder_queue_`.
+    ++posted_frames_waiting_for_preprocessing_;
+    preprocessing_queue_->PostTask(
+        [this, incoming_frame, post_time_us, log_stats]() {
+          RTC_DCHECK_RUN_ON(preprocessing_queue_.get());
+          // A frame with a newer frame posted after it is dropped on the
+          // encoder queue, so it is not worth preparing.
+          const bool newer_frame_posted =
+              posted_frames_waiting_for_preprocessing_.fetch_sub(1) > 1;
+          PreprocessedFrame preprocessed =
+              newer_frame_posted ? PreprocessedFrame{incoming_frame}
+                                 : PreprocessFrame(incoming_frame);
+          encoder_queue_.PostTask(ToQueuedTask(
+              preprocessed_frame_safety_,
+              [this, preprocessed, post_time_us, log_stats]() {
+                RTC_DCHECK_RUN_ON(&encoder_queue_);
+                if (preprocessed.cropped_buffer) {
+                  preprocessed_frame_ = preprocessed;
+                }
+                OnFrameOnEncoderQueue(preprocessed.frame, post_time_us,
+                                      log_stats);
+              }));
+        });
+    return;
+  }
+
+  encoder_queue_.PostTask([this, incoming_frame, post_time_us, log_stats]() {
+    RTC_DCHECK_RUN_ON(&encoder_queue_);
+    OnFrameOnEncoderQueue(incoming_frame, post_time_us, log_stats);
+  });
+}
+
+void VideoStreamEncoder::OnFrameOnEncoderQueue(
+    const VideoFrame& incoming_frame,
+    int64_t post_time_us,
+    bool log_stats) {
+  encoder_stats_observer_->OnIncomingFrame(incoming_frame.width(),
+                                           incoming_frame.height());
+  ++captured_frame_count_;
+  const int posted_frames_waiting_for_encode =
+      posted_frames_waiting_for_encode_.fetch_sub(1);
+  RTC_DCHECK_GT(posted_frames_waiting_for_encode, 0);
+  CheckForAnimatedContent(incoming_frame, post_time_us);
+  bool cwnd_frame_drop =
+      cwnd_frame_drop_interval_ &&
+      (cwnd_frame_counter_++ % cwnd_frame_drop_interval_.value() == 0);
+  if (posted_frames_waiting_for_encode == 1 && !cwnd_frame_drop) {
+    MaybeEncodeVideoFrame(incoming_frame, post_time_us);
+  } else {
+    if (cwnd_frame_drop) {
+      // Frame drop by congestion window pushback. Do not encode this
+      // frame.
+      ++dropped_frame_cwnd_pushback_count_;
+      encoder_stats_observer_->OnFrameDropped(
+          VideoStreamEncoderObserver::DropReason::kCongestionWindow);
+    } else {
+      // There is a newer frame in flight. Do not encode this frame.
+      RTC_LOG(LS_VERBOSE)
+          << "Incoming frame dropped due to that the encoder is blocked.";
+      ++dropped_frame_encoder_block_count_;
+      encoder_stats_observer_->OnFrameDropped(
+          VideoStreamEncoderObserver::DropReason::kEncoderQueue);
+    }
+    accumulated_update_rect_.Union(incoming_frame.update_rect());
+    accumulated_update_rect_is_valid_ &= incoming_frame.has_update_rect();
+  }
+  if (log_stats) {
+    RTC_LOG(LS_INFO) << "Number of frames: captured "
+                     << captured_frame_count_
+                     << ", dropped (due to congestion window pushback) "
+                     << dropped_frame_cwnd_pushback_count_
+                     << ", dropped (due to encoder blocked) "
+                     << dropped_frame_encoder_block_count_
+                     << ", held back (too large for bitrate) "
+                     << held_back_frame_size_count_
+                     << ", held back (encoder paused) "
+                     << held_back_frame_paused_count_
+                     << ", dropped (by frame dropper) "
+                     << dropped_frame_media_opt_count_
+                     << ", converted (cropped or scaled) "
+                     << converted_frame_count_
+                     << ", interval_ms " << kFrameLogIntervalMs;
+    captured_frame_count_ = 0;
+    dropped_frame_cwnd_pushback_count_ = 0;
+    dropped_frame_encoder_block_count_ = 0;
+    held_back_frame_size_count_ = 0;
+    held_back_frame_paused_count_ = 0;
+    dropped_frame_media_opt_count_ = 0;
+    converted_frame_count_ = 0;
+  }
+}
+
+VideoStreamEncoder::PreprocessedFrame VideoStreamEncoder::PreprocessFrame(
+    const VideoFrame& frame) {
+  RTC_DCHECK_RUN_ON(preprocessing_queue_.get());
+  PreprocessedFrame preprocessed{frame};
+  const VideoFrameBuffer::Type type = frame.video_frame_buffer()->type();
+  // Native buffers may only be mappable on specific threads, they are left to
+  // the encoder.
+  if (type == VideoFrameBuffer::Type::kNative) {
+    return preprocessed;
+  }
+  PreprocessingState state;
+  {
+    MutexLock lock(&preprocessing_mutex_);
+    state = preprocessing_state_;
+  }
+  if (!state.encoder_initialized) {
+    return preprocessed;
+  }
+
+  if (type != VideoFrameBuffer::Type::kI420 &&
+      !absl::c_linear_search(state.pixel_formats, type)) {
+    // The encoder would have to convert the frame itself.
+    rtc::scoped_refptr<I420BufferInterface> converted =
+        frame.video_frame_buffer()->ToI420();
+    if (!converted) {
+      RTC_LOG(LS_WARNING) << "Failed to convert "
+                          << VideoFrameBufferTypeToString(type)
+                          << " frame ahead of encoding.";
+      return preprocessed;
+    }
+    preprocessed.frame.set_video_frame_buffer(converted);
+  }
+
+  // Frames of another size make `encoder_queue_` reconfigure the encoder, and
+  // are cropped there.
+  if ((state.crop_width > 0 || state.crop_height > 0) &&
+      frame.width() == state.input_width &&
+      frame.height() == state.input_height) {
+    preprocessed.cropped_buffer =
+        CropOrScale(preprocessed.frame.video_frame_buffer(), state.crop_width,
+                    state.crop_height);
+    preprocessed.crop_width = state.crop_width;
+    preprocessed.crop_height = state.crop_height;
+  }
+  return preprocessed;
+}
+
+void VideoStreamEncoder::UpdatePreprocessingState() {
+  PreprocessingState state;
+  state.encoder_initialized = encoder_initialized_;
+  state.pixel_formats = encoder_info_.preferred_pixel_formats;
+  if (last_frame_info_) {
+    state.input_width = last_frame_info_->width;
+    state.input_height = last_frame_info_->height;
+  }
+  state.crop_width = crop_width_;
+  state.crop_height = crop_height_;
+  if (state == encoder_preprocessing_state_) {
+    return;
+  }
+  encoder_preprocessing_state_ = state;
+  MutexLock lock(&preprocessing_mutex_);
+  preprocessing_state_ = std::move(state);
 }
 
 void VideoStreamEncoder::OnDiscardedFrame() {
@@ -1544,6 +1767,15 @@ void VideoStreamEncoder::MaybeEncodeVideoFrame(const VideoFrame& video_frame,
   uint32_t framerate_fps = GetInputFramerateFps();
   input_framerate_.Update(1u, clock_->TimeInMilliseconds());
 
+  // A new share of the cores is applied when a key frame is sent anyway, so
+  // that streams coming and going do not make the others send key frames.
+  if (number_of_cores_changed_ &&
+      absl::c_all_of(next_frame_types_, [](VideoFrameType type) {
+        return type == VideoFrameType::kVideoFrameKey;
+      })) {
+    pending_encoder_reconfiguration_ = true;
+  }
+
   int64_t now_ms = clock_->TimeInMilliseconds();
   if (pending_encoder_reconfiguration_) {
     ReconfigureEncoder();
@@ -1575,6 +1807,7 @@ void VideoStreamEncoder::MaybeEncodeVideoFrame(const VideoFrame& video_frame,
 
   if (DropDueToSize(video_frame.size())) {
     RTC_LOG(LS_INFO) << "Dropping frame. Too large for target bitrate.";
+    ++held_back_frame_size_count_;
     stream_resource_manager_.OnFrameDroppedDueToSize();
     // Storing references to a native buffer risks blocking frame capture.
     if (video_frame.video_frame_buffer()->type() !=
@@ -1592,6 +1825,7 @@ void VideoStreamEncoder::MaybeEncodeVideoFrame(const VideoFrame& video_frame,
   stream_resource_manager_.OnMaybeEncodeFrame();
 
   if (EncoderPaused()) {
+    ++held_back_frame_paused_count_;
     // Storing references to a native buffer risks blocking frame capture.
     if (video_frame.video_frame_buffer()->type() !=
         VideoFrameBuffer::Type::kNative) {
@@ -1626,6 +1860,7 @@ void VideoStreamEncoder::MaybeEncodeVideoFrame(const VideoFrame& video_frame,
                 ? last_encoder_rate_settings_->encoder_target.bps()
                 : 0)
         << ", input frame rate " << framerate_fps;
+    ++dropped_frame_media_opt_count_;
     OnDroppedFrame(
         EncodedImageCallback::DropReason::kDroppedByMediaOptimizations);
     accumulated_update_rect_.Union(video_frame.update_rect());
@@ -1652,6 +1887,28 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
   if (!encoder_)
     return;
 
+  if (encode_scheduler_stream_ && !encode_slot_held_) {
+    if (scheduled_frame_) {
+      // A newer frame is here while the previous one waits for a slot. Only
+      // the newer one is encoded.
+      RTC_LOG(LS_VERBOSE) << "Frame waiting for an encode slot dropped.";
+      ++dropped_frame_encoder_block_count_;
+      encoder_stats_observer_->OnFrameDropped(
+          VideoStreamEncoderObserver::DropReason::kEncoderQueue);
+      accumulated_update_rect_.Union(scheduled_frame_->update_rect());
+      accumulated_update_rect_is_valid_ &= scheduled_frame_->has_update_rect();
+      scheduled_frame_ = video_frame;
+      scheduled_frame_post_time_us_ = time_when_posted_us;
+    } else if (encode_scheduler_stream_->BeginEncode(EncodePriority())) {
+      EncodeScheduledFrame(video_frame, time_when_posted_us);
+    } else {
+      // OnEncodeAllowed() encodes the frame once a slot is free.
+      scheduled_frame_ = video_frame;
+      scheduled_frame_post_time_us_ = time_when_posted_us;
+    }
+    return;
+  }
+
   TraceFrameDropEnd();
 
   // Encoder metadata needs to be updated before encode complete callback.
@@ -1682,6 +1939,12 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
   }
   encoder_info_ = info;
   last_encode_info_ms_ = clock_->TimeInMilliseconds();
+  if (preprocessing_queue_) {
+    UpdatePreprocessingState();
+  }
+  absl::optional<PreprocessedFrame> preprocessed_frame =
+      std::move(preprocessed_frame_);
+  preprocessed_frame_.reset();
 
   VideoFrame out_frame(video_frame);
   // Crop or scale the frame if needed. Dimension may be reduced to fit encoder
@@ -1693,23 +1956,31 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
     int cropped_width = video_frame.width() - crop_width_;
     int cropped_height = video_frame.height() - crop_height_;
     rtc::scoped_refptr<VideoFrameBuffer> cropped_buffer;
-    // TODO(ilnik): Remove scaling if cropping is too big, as it should never
-    // happen after SinkWants signaled correctly from ReconfigureEncoder.
+    if (preprocessed_frame &&
+        preprocessed_frame->frame.video_frame_buffer().get() ==
+            video_frame.video_frame_buffer().get() &&
+        preprocessed_frame->crop_width == crop_width_ &&
+        preprocessed_frame->crop_height == crop_height_) {
+      // Already done on `preprocessing_queue_`.
+      cropped_buffer = preprocessed_frame->cropped_buffer;
+    } else {
+      cropped_buffer = CropOrScale(video_frame.video_frame_buffer(),
+                                   crop_width_, crop_height_);
+    }
+    // Only I420 frames are cropped without copying.
+    bool converted = true;
     VideoFrame::UpdateRect update_rect = video_frame.update_rect();
     if (crop_width_ < 4 && crop_height_ < 4) {
-      // The difference is small, crop without scaling.
-      cropped_buffer = video_frame.video_frame_buffer()->CropAndScale(
-          crop_width_ / 2, crop_height_ / 2, cropped_width, cropped_height,
-          cropped_width, cropped_height);
+      // The difference is small, the frame was cropped without scaling.
+      converted = video_frame.video_frame_buffer()->type() !=
+                  VideoFrameBuffer::Type::kI420;
       update_rect.offset_x -= crop_width_ / 2;
       update_rect.offset_y -= crop_height_ / 2;
       update_rect.Intersect(
           VideoFrame::UpdateRect{0, 0, cropped_width, cropped_height});
 
     } else {
-      // The difference is large, scale it.
-      cropped_buffer = video_frame.video_frame_buffer()->Scale(cropped_width,
-                                                               cropped_height);
+      // The difference is large, the frame was scaled.
       if (!update_rect.IsEmpty()) {
         // Since we can't reason about pixels after scaling, we invalidate whole
         // picture, if anything changed.
@@ -1721,6 +1992,9 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
       RTC_LOG(LS_ERROR) << "Cropping and scaling frame failed, dropping frame.";
       return;
     }
+    if (converted) {
+      ++converted_frame_count_;
+    }
 
     out_frame.set_video_frame_buffer(cropped_buffer);
     out_frame.set_update_rect(update_rect);
@@ -1764,6 +2038,13 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
 
   frame_encode_metadata_writer_.OnEncodeStarted(out_frame);
 
+  const int complexity_reduction =
+      stream_resource_manager_.ComplexityReduction();
+  if (complexity_reduction != encoder_complexity_reduction_) {
+    encoder_->SetComplexityReduction(complexity_reduction);
+    encoder_complexity_reduction_ = complexity_reduction;
+  }
+
   const int32_t encode_status = encoder_->Encode(out_frame, &next_frame_types_);
   was_encode_called_since_last_initialization_ = true;
 
@@ -2205,6 +2486,47 @@ bool VideoStreamEncoder::HasInternalSource() const {
   return codec_info_.has_internal_source || encoder_info_.has_internal_source;
 }
 
+VideoEncodeScheduler::Priority VideoStreamEncoder::EncodePriority() const {
+  // Key frames are what receivers wait for, e.g., after packet loss or when
+  // joining. Screen content tolerates more latency than camera video.
+  if (absl::c_linear_search(next_frame_types_,
+                            VideoFrameType::kVideoFrameKey)) {
+    return VideoEncodeScheduler::Priority::kKeyFrame;
+  }
+  return encoder_config_.content_type ==
+                 VideoEncoderConfig::ContentType::kRealtimeVideo
+             ? VideoEncodeScheduler::Priority::kLowLatency
+             : VideoEncodeScheduler::Priority::kNormal;
+}
+
+void VideoStreamEncoder::EncodeScheduledFrame(const VideoFrame& frame,
+                                              int64_t time_when_posted_us) {
+  encode_slot_held_ = true;
+  EncodeVideoFrame(frame, time_when_posted_us);
+  encode_slot_held_ = false;
+  encode_scheduler_stream_->EndEncode();
+}
+
+void VideoStreamEncoder::OnEncodeAllowed() {
+  RTC_DCHECK_RUN_ON(&encoder_queue_);
+  // After Stop(), the slot was given back when the stream was released.
+  if (!encode_scheduler_stream_)
+    return;
+  RTC_DCHECK(scheduled_frame_);
+  VideoFrame frame = std::move(*scheduled_frame_);
+  scheduled_frame_.reset();
+  EncodeScheduledFrame(frame, scheduled_frame_post_time_us_);
+}
+
+void VideoStreamEncoder::OnNumberOfCoresChanged() {
+  RTC_DCHECK_RUN_ON(&encoder_queue_);
+  if (!encode_scheduler_stream_ || !encoder_initialized_)
+    return;
+  // Applied by ReconfigureEncoder() before the next key frame, see
+  // MaybeEncodeVideoFrame().
+  number_of_cores_changed_ = true;
+}
+
 void VideoStreamEncoder::ReleaseEncoder() {
   if (!encoder_ || !encoder_initialized_) {
     return;
@@ -17,10 +17,12 @@
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "api/adaptation/resource.h"
 #include "api/sequence_checker.h"
 #include "api/units/data_rate.h"
 #include "api/video/video_bitrate_allocator.h"
+#include "api/video/video_encode_scheduler.h"
 #include "api/video/video_rotation.h"
 #include "api/video/video_sink_interface.h"
 #include "api/video/video_stream_encoder_interface.h"
@@ -39,6 +41,7 @@
 #include "rtc_base/numerics/exp_filter.h"
 #include "rtc_base/race_checker.h"
 #include "rtc_base/rate_statistics.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/task_queue.h"
 #include "rtc_base/task_utils/pending_task_safety_flag.h"
 #include "rtc_base/thread_annotations.h"
@@ -60,7 +63,8 @@ namespace webrtc {
 //  Call Stop() when done.
 class VideoStreamEncoder : public VideoStreamEncoderInterface,
                            private EncodedImageCallback,
-                           public VideoSourceRestrictionsListener {
+                           public VideoSourceRestrictionsListener,
+                           private VideoEncodeScheduler::StreamObserver {
  public:
   // TODO(bugs.webrtc.org/12000): Reporting of VideoBitrateAllocation is being
   // deprecated. Instead VideoLayersAllocation should be reported.
@@ -118,6 +122,15 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   // Used for testing. For example the `ScalingObserverInterface` methods must
   // be called on `encoder_queue_`.
   rtc::TaskQueue* encoder_queue() { return &encoder_queue_; }
+  // Used for testing. Null unless frames are prepared ahead of encoding.
+  rtc::TaskQueue* preprocessing_queue() { return preprocessing_queue_.get(); }
+
+  // Used for testing. Frames cropped or scaled into a new buffer since the
+  // frame counts were last logged.
+  int ConvertedFrameCountForTesting() const {
+    RTC_DCHECK_RUN_ON(&encoder_queue_);
+    return converted_frame_count_;
+  }
 
   void OnVideoSourceRestrictionsUpdated(
       VideoSourceRestrictions restrictions,
@@ -168,6 +181,35 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
     DataRate stable_encoder_target;
   };
 
+  // State of `encoder_queue_` that `preprocessing_queue_` needs, mirrored
+  // under `preprocessing_mutex_`.
+  struct PreprocessingState {
+    bool operator==(const PreprocessingState& rhs) const;
+    bool operator!=(const PreprocessingState& rhs) const;
+
+    // Frames are left to the encoder until it is initialized, as its pixel
+    // formats are not known yet.
+    bool encoder_initialized = false;
+    absl::InlinedVector<VideoFrameBuffer::Type, kMaxPreferredPixelFormats>
+        pixel_formats;
+    // Frames of `input_width` x `input_height` are cropped, or scaled, by
+    // `crop_width` x `crop_height`.
+    int input_width = 0;
+    int input_height = 0;
+    int crop_width = 0;
+    int crop_height = 0;
+  };
+
+  // A frame prepared on `preprocessing_queue_`.
+  struct PreprocessedFrame {
+    VideoFrame frame;
+    // `frame` cropped, or scaled, by `crop_width` x `crop_height` if that was
+    // needed.
+    rtc::scoped_refptr<VideoFrameBuffer> cropped_buffer;
+    int crop_width = 0;
+    int crop_height = 0;
+  };
+
   class DegradationPreferenceManager;
 
   void ReconfigureEncoder() RTC_RUN_ON(&encoder_queue_);
@@ -211,6 +253,18 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
                      int temporal_index,
                      DataSize frame_size);
   bool HasInternalSource() const RTC_RUN_ON(&encoder_queue_);
+  // Priority of the next frame in `encode_scheduler_stream_`.
+  VideoEncodeScheduler::Priority EncodePriority() const
+      RTC_RUN_ON(&encoder_queue_);
+  // Encodes `frame` in a slot given by `encode_scheduler_stream_`, and gives
+  // the slot back.
+  void EncodeScheduledFrame(const VideoFrame& frame,
+                            int64_t time_when_posted_us)
+      RTC_RUN_ON(&encoder_queue_);
+
+  // Implements VideoEncodeScheduler::StreamObserver.
+  void OnEncodeAllowed() override;
+  void OnNumberOfCoresChanged() override;
   void ReleaseEncoder() RTC_RUN_ON(&encoder_queue_);
   // After calling this function `resource_adaptation_processor_` will be null.
   void ShutdownResourceAdaptationQueue();
@@ -219,6 +273,18 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
                                int64_t time_when_posted_in_ms)
       RTC_RUN_ON(&encoder_queue_);
 
+  // Handles a frame posted by OnFrame(): either drops it or passes it on to
+  // MaybeEncodeVideoFrame().
+  void OnFrameOnEncoderQueue(const VideoFrame& frame,
+                             int64_t post_time_us,
+                             bool log_stats) RTC_RUN_ON(&encoder_queue_);
+  // Runs on `preprocessing_queue_`. Converts `frame` to I420 if the encoder
+  // does not accept its pixel format, and crops or scales it to the size the
+  // encoder is configured for, so that `encoder_queue_` does not have to.
+  PreprocessedFrame PreprocessFrame(const VideoFrame& frame);
+  // Mirrors the state PreprocessFrame() depends on.
+  void UpdatePreprocessingState() RTC_RUN_ON(&encoder_queue_);
+
   // TODO(bugs.webrtc.org/11341) : Remove this version of RequestEncoderSwitch.
   void QueueRequestEncoderSwitch(
       const EncoderSwitchRequestCallback::Config& conf)
@@ -243,6 +309,22 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   std::unique_ptr<VideoEncoder> encoder_ RTC_GUARDED_BY(&encoder_queue_)
       RTC_PT_GUARDED_BY(&encoder_queue_);
   bool encoder_initialized_;
+  // Last value passed to encoder_->SetComplexityReduction() since InitEncode().
+  int encoder_complexity_reduction_ RTC_GUARDED_BY(&encoder_queue_);
+  // Set if the encoder shares the cores with other streams, see
+  // VideoStreamEncoderSettings::encode_scheduler. Released by Stop().
+  std::unique_ptr<VideoEncodeScheduler::Stream> encode_scheduler_stream_
+      RTC_GUARDED_BY(&encoder_queue_);
+  // Set while a frame is encoded in a slot of `encode_scheduler_stream_`.
+  bool encode_slot_held_ RTC_GUARDED_BY(&encoder_queue_) = false;
+  // The frame waiting for a slot of `encode_scheduler_stream_`, if any. A
+  // newer frame replaces it.
+  absl::optional<VideoFrame> scheduled_frame_ RTC_GUARDED_BY(&encoder_queue_);
+  int64_t scheduled_frame_post_time_us_ RTC_GUARDED_BY(&encoder_queue_) = 0;
+  // The number of cores the encoder was last initialized with.
+  int encoder_number_of_cores_ RTC_GUARDED_BY(&encoder_queue_) = 0;
+  // Set when the share of the cores changed after the encoder was initialized.
+  bool number_of_cores_changed_ RTC_GUARDED_BY(&encoder_queue_) = false;
   std::unique_ptr<VideoBitrateAllocator> rate_allocator_
       RTC_GUARDED_BY(&encoder_queue_) RTC_PT_GUARDED_BY(&encoder_queue_);
   int max_framerate_ RTC_GUARDED_BY(&encoder_queue_);
@@ -258,6 +340,13 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
       RTC_GUARDED_BY(&encoder_queue_);
   int crop_width_ RTC_GUARDED_BY(&encoder_queue_);
   int crop_height_ RTC_GUARDED_BY(&encoder_queue_);
+  // The last frame `preprocessing_queue_` cropped, used if that frame gets
+  // encoded.
+  absl::optional<PreprocessedFrame> preprocessed_frame_
+      RTC_GUARDED_BY(&encoder_queue_);
+  // Last state given to UpdatePreprocessingState().
+  PreprocessingState encoder_preprocessing_state_
+      RTC_GUARDED_BY(&encoder_queue_);
   absl::optional<uint32_t> encoder_target_bitrate_bps_
       RTC_GUARDED_BY(&encoder_queue_);
   size_t max_data_payload_length_ RTC_GUARDED_BY(&encoder_queue_);
@@ -276,6 +365,14 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   rtc::RaceChecker incoming_frame_race_checker_
       RTC_GUARDED_BY(incoming_frame_race_checker_);
   std::atomic<int> posted_frames_waiting_for_encode_;
+  // Frames posted to `preprocessing_queue_` and not yet handled there.
+  std::atomic<int> posted_frames_waiting_for_preprocessing_{0};
+  // Drops frames that leave `preprocessing_queue_` after Stop(). Used on
+  // `encoder_queue_`.
+  const rtc::scoped_refptr<PendingTaskSafetyFlag> preprocessed_frame_safety_ =
+      PendingTaskSafetyFlag::CreateDetached();
+  Mutex preprocessing_mutex_;
+  PreprocessingState preprocessing_state_ RTC_GUARDED_BY(preprocessing_mutex_);
   // Used to make sure incoming time stamp is increasing for every frame.
   int64_t last_captured_timestamp_ RTC_GUARDED_BY(incoming_frame_race_checker_);
   // Delta used for translating between NTP and internal timestamps.
@@ -286,6 +383,13 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   int captured_frame_count_ RTC_GUARDED_BY(&encoder_queue_);
   int dropped_frame_cwnd_pushback_count_ RTC_GUARDED_BY(&encoder_queue_);
   int dropped_frame_encoder_block_count_ RTC_GUARDED_BY(&encoder_queue_);
+  // Frames not encoded right away but kept as `pending_frame_`, because they
+  // are too large for the target bitrate or the encoder is paused.
+  int held_back_frame_size_count_ RTC_GUARDED_BY(&encoder_queue_);
+  int held_back_frame_paused_count_ RTC_GUARDED_BY(&encoder_queue_);
+  int dropped_frame_media_opt_count_ RTC_GUARDED_BY(&encoder_queue_);
+  // Frames that were cropped or scaled into a new buffer before encoding.
+  int converted_frame_count_ RTC_GUARDED_BY(&encoder_queue_);
   absl::optional<VideoFrame> pending_frame_ RTC_GUARDED_BY(&encoder_queue_);
   int64_t pending_frame_post_time_us_ RTC_GUARDED_BY(&encoder_queue_);
 
@@ -413,6 +517,10 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   // first to make sure no tasks run that use other members.
   rtc::TaskQueue encoder_queue_;
 
+  // Set if frames are prepared for encoding ahead of `encoder_queue_`. Its
+  // tasks post to `encoder_queue_`, so it is destroyed first.
+  std::unique_ptr<rtc::TaskQueue> preprocessing_queue_;
+
   // Used to cancel any potentially pending tasks to the main thread.
   ScopedTaskSafety task_safety_;
 
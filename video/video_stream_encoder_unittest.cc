@@ -24,6 +24,7 @@
 #include "api/video/builtin_video_bitrate_allocator_factory.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/nv12_buffer.h"
+#include "api/video/video_encode_scheduler.h"
 #include "api/video/video_adaptation_reason.h"
 #include "api/video/video_bitrate_allocation.h"
 #include "api/video_codecs/sdp_video_format.h"
@@ -51,6 +52,7 @@
 #include "rtc_base/logging.h"
 #include "rtc_base/ref_counted_object.h"
 #include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/task_utils/to_queued_task.h"
 #include "system_wrappers/include/field_trial.h"
 #include "system_wrappers/include/metrics.h"
 #include "test/encoder_settings.h"
@@ -191,6 +193,43 @@ class FakeNV12NativeBuffer : public webrtc::VideoFrameBuffer {
   rtc::Event* const event_;
 };
 
+// An NV12 buffer that signals `event` when its pixels are converted to I420,
+// cropped or scaled.
+class SignalingNV12Buffer : public webrtc::NV12BufferInterface {
+ public:
+  SignalingNV12Buffer(rtc::Event* event, int width, int height)
+      : nv12_buffer_(NV12Buffer::Create(width, height)), event_(event) {}
+
+  int width() const override { return nv12_buffer_->width(); }
+  int height() const override { return nv12_buffer_->height(); }
+  int StrideY() const override { return nv12_buffer_->StrideY(); }
+  int StrideUV() const override { return nv12_buffer_->StrideUV(); }
+  const uint8_t* DataY() const override { return nv12_buffer_->DataY(); }
+  const uint8_t* DataUV() const override { return nv12_buffer_->DataUV(); }
+  rtc::scoped_refptr<webrtc::I420BufferInterface> ToI420() override {
+    event_->Set();
+    return nv12_buffer_->ToI420();
+  }
+  rtc::scoped_refptr<VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override {
+    event_->Set();
+    return nv12_buffer_->CropAndScale(offset_x, offset_y, crop_width,
+                                      crop_height, scaled_width,
+                                      scaled_height);
+  }
+
+ private:
+  friend class rtc::RefCountedObject<SignalingNV12Buffer>;
+  ~SignalingNV12Buffer() override = default;
+  rtc::scoped_refptr<NV12Buffer> nv12_buffer_;
+  rtc::Event* const event_;
+};
+
 class CpuOveruseDetectorProxy : public OveruseFrameDetector {
  public:
   explicit CpuOveruseDetectorProxy(CpuOveruseMetricsObserver* metrics_observer)
@@ -340,6 +379,105 @@ auto FpsEqResolutionGt(const rtc::VideoSinkWants& other_wants) {
                WantsMaxPixels(Gt(other_wants.max_pixel_count)));
 }
 
+// VideoEncodeScheduler for a single stream, where the test decides when a
+// queued frame may be encoded and how many cores the stream gets.
+class FakeEncodeScheduler : public VideoEncodeScheduler {
+ public:
+  void SetAllowEncodes(bool allow) {
+    MutexLock lock(&mutex_);
+    allow_encodes_ = allow;
+  }
+
+  // Lets the frame queued by BeginEncode() be encoded.
+  void AllowQueuedEncode() {
+    MutexLock lock(&mutex_);
+    RTC_CHECK(task_queue_);
+    StreamObserver* observer = observer_;
+    task_queue_->PostTask(
+        ToQueuedTask([observer] { observer->OnEncodeAllowed(); }));
+  }
+
+  void SetNumberOfCores(int number_of_cores) {
+    MutexLock lock(&mutex_);
+    number_of_cores_ = number_of_cores;
+    if (registered_) {
+      StreamObserver* observer = observer_;
+      task_queue_->PostTask(
+          ToQueuedTask([observer] { observer->OnNumberOfCoresChanged(); }));
+    }
+  }
+
+  bool registered() const {
+    MutexLock lock(&mutex_);
+    return registered_;
+  }
+  int begin_encodes() const {
+    MutexLock lock(&mutex_);
+    return begin_encodes_;
+  }
+  int end_encodes() const {
+    MutexLock lock(&mutex_);
+    return end_encodes_;
+  }
+  absl::optional<Priority> last_priority() const {
+    MutexLock lock(&mutex_);
+    return last_priority_;
+  }
+
+  std::unique_ptr<Stream> RegisterStream(TaskQueueBase* task_queue,
+                                         StreamObserver* observer) override {
+    MutexLock lock(&mutex_);
+    RTC_CHECK(!registered_);
+    registered_ = true;
+    task_queue_ = task_queue;
+    observer_ = observer;
+    return std::make_unique<FakeStream>(this);
+  }
+
+  Metrics GetMetrics() const override { return Metrics(); }
+
+ private:
+  class FakeStream : public Stream {
+   public:
+    explicit FakeStream(FakeEncodeScheduler* scheduler)
+        : scheduler_(scheduler) {}
+    ~FakeStream() override {
+      MutexLock lock(&scheduler_->mutex_);
+      scheduler_->registered_ = false;
+    }
+
+    int NumberOfCores() const override {
+      MutexLock lock(&scheduler_->mutex_);
+      return scheduler_->number_of_cores_;
+    }
+
+    bool BeginEncode(Priority priority) override {
+      MutexLock lock(&scheduler_->mutex_);
+      ++scheduler_->begin_encodes_;
+      scheduler_->last_priority_ = priority;
+      return scheduler_->allow_encodes_;
+    }
+
+    void EndEncode() override {
+      MutexLock lock(&scheduler_->mutex_);
+      ++scheduler_->end_encodes_;
+    }
+
+   private:
+    FakeEncodeScheduler* const scheduler_;
+  };
+
+  mutable Mutex mutex_;
+  bool allow_encodes_ RTC_GUARDED_BY(mutex_) = true;
+  int number_of_cores_ RTC_GUARDED_BY(mutex_) = 4;
+  bool registered_ RTC_GUARDED_BY(mutex_) = false;
+  TaskQueueBase* task_queue_ RTC_GUARDED_BY(mutex_) = nullptr;
+  StreamObserver* observer_ RTC_GUARDED_BY(mutex_) = nullptr;
+  int begin_encodes_ RTC_GUARDED_BY(mutex_) = 0;
+  int end_encodes_ RTC_GUARDED_BY(mutex_) = 0;
+  absl::optional<Priority> last_priority_ RTC_GUARDED_BY(mutex_);
+};
+
 class VideoStreamEncoderUnderTest : public VideoStreamEncoder {
  public:
   VideoStreamEncoderUnderTest(TimeController* time_controller,
@@ -406,6 +544,28 @@ class VideoStreamEncoderUnderTest : public VideoStreamEncoder {
     ASSERT_TRUE(event.Wait(5000));
   }
 
+  // Like WaitUntilTaskQueueIsIdle(), but first lets the frames being prepared
+  // ahead of encoding reach the encoder queue.
+  void WaitUntilPreprocessingQueueIsIdle() {
+    if (preprocessing_queue()) {
+      rtc::Event event;
+      preprocessing_queue()->PostTask([&event] { event.Set(); });
+      ASSERT_TRUE(event.Wait(5000));
+    }
+    WaitUntilTaskQueueIsIdle();
+  }
+
+  int GetConvertedFrameCount() {
+    int count = 0;
+    rtc::Event event;
+    encoder_queue()->PostTask([this, &count, &event] {
+      count = ConvertedFrameCountForTesting();
+      event.Set();
+    });
+    EXPECT_TRUE(event.Wait(5000));
+    return count;
+  }
+
   // Triggers resource usage measurements on the fake CPU resource.
   void TriggerCpuOveruse() {
     rtc::Event event;
@@ -1010,6 +1170,12 @@ class VideoStreamEncoderTest : public ::testing::Test {
       return last_input_pixel_format_;
     }
 
+    // Returns the Y plane of the last input frame if it was an I420 frame.
+    const uint8_t* GetLastInputDataY() {
+      MutexLock lock(&local_mutex_);
+      return last_input_data_y_;
+    }
+
     int GetNumSetRates() const {
       MutexLock lock(&local_mutex_);
       return num_set_rates_;
@@ -1027,6 +1193,11 @@ class VideoStreamEncoderTest : public ::testing::Test {
       is_qp_trusted_ = trusted;
     }
 
+    int GetLastNumberOfCores() const {
+      MutexLock lock(&local_mutex_);
+      return last_number_of_cores_;
+    }
+
    private:
     int32_t Encode(const VideoFrame& input_image,
                    const std::vector<VideoFrameType>* frame_types) override {
@@ -1053,6 +1224,10 @@ class VideoStreamEncoderTest : public ::testing::Test {
         last_update_rect_ = input_image.update_rect();
         last_frame_types_ = *frame_types;
         last_input_pixel_format_ = input_image.video_frame_buffer()->type();
+        last_input_data_y_ =
+            *last_input_pixel_format_ == VideoFrameBuffer::Type::kI420
+                ? input_image.video_frame_buffer()->GetI420()->DataY()
+                : nullptr;
       }
       int32_t result = FakeEncoder::Encode(input_image, frame_types);
       if (block_encode)
@@ -1082,6 +1257,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
 
       MutexLock lock(&local_mutex_);
       EXPECT_EQ(initialized_, EncoderState::kUninitialized);
+      last_number_of_cores_ = settings.number_of_cores;
 
       if (config->codecType == kVideoCodecVP8) {
         // Simulate setting up temporal layers, in order to validate the life
@@ -1169,9 +1345,11 @@ class VideoStreamEncoderTest : public ::testing::Test {
     int num_set_rates_ RTC_GUARDED_BY(local_mutex_) = 0;
     absl::optional<VideoFrameBuffer::Type> last_input_pixel_format_
         RTC_GUARDED_BY(local_mutex_);
+    const uint8_t* last_input_data_y_ RTC_GUARDED_BY(local_mutex_) = nullptr;
     absl::InlinedVector<VideoFrameBuffer::Type, kMaxPreferredPixelFormats>
         preferred_pixel_formats_ RTC_GUARDED_BY(local_mutex_);
     absl::optional<bool> is_qp_trusted_ RTC_GUARDED_BY(local_mutex_);
+    int last_number_of_cores_ RTC_GUARDED_BY(local_mutex_) = 0;
   };
 
   class TestSink : public VideoStreamEncoder::EncoderSink {
@@ -1597,6 +1775,41 @@ TEST_F(VideoStreamEncoderTest,
   video_stream_encoder_->Stop();
 }
 
+TEST_F(VideoStreamEncoderTest, I420FrameGetsCroppedWithoutCopyIfNecessary) {
+  // Use the cropping factory.
+  video_encoder_config_.video_stream_factory =
+      rtc::make_ref_counted<CroppingVideoStreamFactory>();
+  video_stream_encoder_->ConfigureEncoder(std::move(video_encoder_config_),
+                                          kMaxPayloadLength);
+  video_stream_encoder_->WaitUntilTaskQueueIsIdle();
+
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  WaitForEncodedFrame(1);
+
+  // Send in a frame that needs to be cropped by a pixel in each dimension,
+  // since the width/height aren't divisible by 4 (see CreateEncoderStreams
+  // above). The encoder gets a view into the captured buffer, not a copy.
+  VideoFrame frame = CreateFrame(2, codec_width_ + 1, codec_height_ + 1);
+  const uint8_t* data_y = frame.video_frame_buffer()->GetI420()->DataY();
+  video_source_.IncomingCapturedFrame(frame);
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(VideoFrameBuffer::Type::kI420,
+            fake_encoder_.GetLastInputPixelFormat());
+  EXPECT_EQ(fake_encoder_.config().width, fake_encoder_.GetLastInputWidth());
+  EXPECT_EQ(fake_encoder_.config().height, fake_encoder_.GetLastInputHeight());
+  EXPECT_EQ(data_y, fake_encoder_.GetLastInputDataY());
+  EXPECT_EQ(0, video_stream_encoder_->GetConvertedFrameCount());
+
+  // An NV12 frame is cropped into a new buffer.
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(3, codec_width_ + 1, codec_height_ + 1));
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(1, video_stream_encoder_->GetConvertedFrameCount());
+  video_stream_encoder_->Stop();
+}
+
 TEST_F(VideoStreamEncoderTest, NonI420FramesShouldNotBeConvertedToI420) {
   video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
       kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
@@ -1609,6 +1822,275 @@ TEST_F(VideoStreamEncoderTest, NonI420FramesShouldNotBeConvertedToI420) {
   video_stream_encoder_->Stop();
 }
 
+TEST_F(VideoStreamEncoderTest,
+       PipelinedPreprocessingConvertsFramesInFormatsNotPreferred) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-PipelinedPreprocessing/Enabled/");
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  // Frames are left to the encoder until its pixel formats are known.
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(1, codec_width_, codec_height_));
+  WaitForEncodedFrame(1);
+  EXPECT_EQ(VideoFrameBuffer::Type::kNV12,
+            fake_encoder_.GetLastInputPixelFormat());
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(2, codec_width_, codec_height_));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(VideoFrameBuffer::Type::kI420,
+            fake_encoder_.GetLastInputPixelFormat());
+
+  // The preferred formats are picked up when the next frame is encoded, and
+  // apply to the frames prepared after that.
+  fake_encoder_.SetPreferredPixelFormats({VideoFrameBuffer::Type::kNV12});
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(3, codec_width_, codec_height_));
+  WaitForEncodedFrame(3);
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(4, codec_width_, codec_height_));
+  WaitForEncodedFrame(4);
+  EXPECT_EQ(VideoFrameBuffer::Type::kNV12,
+            fake_encoder_.GetLastInputPixelFormat());
+
+  // Native frames are left to the encoder.
+  rtc::Event frame_destroyed_event;
+  video_source_.IncomingCapturedFrame(CreateFakeNV12NativeFrame(
+      5, &frame_destroyed_event, codec_width_, codec_height_));
+  WaitForEncodedFrame(5);
+  EXPECT_EQ(VideoFrameBuffer::Type::kNative,
+            fake_encoder_.GetLastInputPixelFormat());
+  video_stream_encoder_->Stop();
+}
+
+TEST_F(VideoStreamEncoderTest,
+       PipelinedPreprocessingPreparesNextFrameWhileEncoding) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-PipelinedPreprocessing/Enabled/");
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  WaitForEncodedFrame(1);
+
+  fake_encoder_.BlockNextEncode();
+  video_source_.IncomingCapturedFrame(CreateFrame(2, nullptr));
+  WaitForEncodedFrame(2);
+  // Here, the encoder thread is blocked in the TestEncoder waiting for a call
+  // to ContinueEncode.
+
+  // Frame 3 is converted while frame 2 is still being encoded.
+  rtc::Event converted_event;
+  video_source_.IncomingCapturedFrame(
+      VideoFrame::Builder()
+          .set_video_frame_buffer(rtc::make_ref_counted<SignalingNV12Buffer>(
+              &converted_event, codec_width_, codec_height_))
+          .set_ntp_time_ms(3)
+          .set_timestamp_ms(3)
+          .set_rotation(kVideoRotation_0)
+          .build());
+  EXPECT_TRUE(converted_event.Wait(kDefaultTimeoutMs));
+
+  fake_encoder_.ContinueEncode();
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(VideoFrameBuffer::Type::kI420,
+            fake_encoder_.GetLastInputPixelFormat());
+  video_stream_encoder_->Stop();
+}
+
+TEST_F(VideoStreamEncoderTest, PipelinedPreprocessingCropsFramesAheadOfEncode) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-PipelinedPreprocessing/Enabled/");
+  VideoEncoderConfig video_encoder_config = video_encoder_config_.Copy();
+  video_encoder_config.video_stream_factory =
+      rtc::make_ref_counted<CroppingVideoStreamFactory>();
+  ConfigureEncoder(std::move(video_encoder_config));
+  fake_encoder_.SetPreferredPixelFormats({VideoFrameBuffer::Type::kNV12});
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(1, codec_width_ + 1, codec_height_ + 1));
+  WaitForEncodedFrame(1);
+
+  fake_encoder_.BlockNextEncode();
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(2, codec_width_ + 1, codec_height_ + 1));
+  WaitForEncodedFrame(2);
+
+  // Frame 3 is cropped while frame 2 is still being encoded.
+  rtc::Event cropped_event;
+  video_source_.IncomingCapturedFrame(
+      VideoFrame::Builder()
+          .set_video_frame_buffer(rtc::make_ref_counted<SignalingNV12Buffer>(
+              &cropped_event, codec_width_ + 1, codec_height_ + 1))
+          .set_ntp_time_ms(3)
+          .set_timestamp_ms(3)
+          .set_rotation(kVideoRotation_0)
+          .build());
+  EXPECT_TRUE(cropped_event.Wait(kDefaultTimeoutMs));
+
+  fake_encoder_.ContinueEncode();
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(VideoFrameBuffer::Type::kNV12,
+            fake_encoder_.GetLastInputPixelFormat());
+  EXPECT_EQ(fake_encoder_.config().width, fake_encoder_.GetLastInputWidth());
+  EXPECT_EQ(fake_encoder_.config().height, fake_encoder_.GetLastInputHeight());
+  video_stream_encoder_->Stop();
+}
+
+TEST_F(VideoStreamEncoderTest, PipelinedPreprocessingDropsFramesAfterStop) {
+  test::ScopedFieldTrials field_trials(
+      "WebRTC-Video-PipelinedPreprocessing/Enabled/");
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  video_source_.IncomingCapturedFrame(
+      CreateNV12Frame(1, codec_width_, codec_height_));
+  WaitForEncodedFrame(1);
+
+  // A frame delivered after Stop() is still prepared, but must not reach the
+  // stopped encoder.
+  video_stream_encoder_->Stop();
+  rtc::Event converted_event;
+  rtc::VideoSinkInterface<VideoFrame>* sink = video_stream_encoder_.get();
+  sink->OnFrame(
+      VideoFrame::Builder()
+          .set_video_frame_buffer(rtc::make_ref_counted<SignalingNV12Buffer>(
+              &converted_event, codec_width_, codec_height_))
+          .set_ntp_time_ms(2)
+          .set_timestamp_ms(2)
+          .set_rotation(kVideoRotation_0)
+          .build());
+  video_stream_encoder_->WaitUntilPreprocessingQueueIsIdle();
+  EXPECT_TRUE(converted_event.Wait(0));
+  ExpectDroppedFrame();
+}
+
+TEST_F(VideoStreamEncoderTest, EncodeSchedulerEndsEveryEncodeItBegins) {
+  FakeEncodeScheduler scheduler;
+  video_send_config_.encoder_settings.encode_scheduler = &scheduler;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  EXPECT_TRUE(scheduler.registered());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  WaitForEncodedFrame(1);
+  video_source_.IncomingCapturedFrame(CreateFrame(2, nullptr));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(2, scheduler.begin_encodes());
+  EXPECT_EQ(2, scheduler.end_encodes());
+  EXPECT_EQ(4, fake_encoder_.GetLastNumberOfCores());
+
+  video_stream_encoder_->Stop();
+  EXPECT_FALSE(scheduler.registered());
+}
+
+TEST_F(VideoStreamEncoderTest, EncodeSchedulerReplacesFrameWaitingForSlot) {
+  FakeEncodeScheduler scheduler;
+  video_send_config_.encoder_settings.encode_scheduler = &scheduler;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  scheduler.SetAllowEncodes(false);
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  video_stream_encoder_->WaitUntilTaskQueueIsIdle();
+  video_source_.IncomingCapturedFrame(CreateFrame(2, nullptr));
+  video_stream_encoder_->WaitUntilTaskQueueIsIdle();
+  // The newer frame takes the place of the waiting one, without asking the
+  // scheduler again.
+  EXPECT_EQ(1, scheduler.begin_encodes());
+  EXPECT_EQ(0, scheduler.end_encodes());
+  ExpectDroppedFrame();
+
+  scheduler.AllowQueuedEncode();
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(1, scheduler.end_encodes());
+  video_stream_encoder_->Stop();
+}
+
+TEST_F(VideoStreamEncoderTest, EncodeSchedulerPrioritizesKeyFrames) {
+  FakeEncodeScheduler scheduler;
+  video_send_config_.encoder_settings.encode_scheduler = &scheduler;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  WaitForEncodedFrame(1);
+  EXPECT_EQ(VideoEncodeScheduler::Priority::kKeyFrame,
+            scheduler.last_priority());
+
+  video_source_.IncomingCapturedFrame(CreateFrame(2, nullptr));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(VideoEncodeScheduler::Priority::kLowLatency,
+            scheduler.last_priority());
+
+  video_stream_encoder_->SendKeyFrame();
+  video_source_.IncomingCapturedFrame(CreateFrame(3, nullptr));
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(VideoEncodeScheduler::Priority::kKeyFrame,
+            scheduler.last_priority());
+  video_stream_encoder_->Stop();
+}
+
+TEST_F(VideoStreamEncoderTest, EncodeSchedulerIgnoresEncodeAllowedAfterStop) {
+  FakeEncodeScheduler scheduler;
+  video_send_config_.encoder_settings.encode_scheduler = &scheduler;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  scheduler.SetAllowEncodes(false);
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  video_stream_encoder_->WaitUntilTaskQueueIsIdle();
+  EXPECT_EQ(1, scheduler.begin_encodes());
+
+  // The slot arrives after the stream was released by Stop().
+  video_stream_encoder_->Stop();
+  EXPECT_FALSE(scheduler.registered());
+  scheduler.AllowQueuedEncode();
+  video_stream_encoder_->WaitUntilTaskQueueIsIdle();
+  ExpectDroppedFrame();
+  EXPECT_EQ(0, scheduler.end_encodes());
+}
+
+TEST_F(VideoStreamEncoderTest, EncodeSchedulerCoreShareAppliedAtNextKeyFrame) {
+  FakeEncodeScheduler scheduler;
+  video_send_config_.encoder_settings.encode_scheduler = &scheduler;
+  ConfigureEncoder(video_encoder_config_.Copy());
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  video_source_.IncomingCapturedFrame(CreateFrame(1, nullptr));
+  WaitForEncodedFrame(1);
+  const int initializations = fake_encoder_.GetNumInitializations();
+  EXPECT_EQ(4, fake_encoder_.GetLastNumberOfCores());
+
+  // Another stream joining must not cost this one a key frame.
+  scheduler.SetNumberOfCores(2);
+  video_source_.IncomingCapturedFrame(CreateFrame(2, nullptr));
+  WaitForEncodedFrame(2);
+  EXPECT_EQ(initializations, fake_encoder_.GetNumInitializations());
+  EXPECT_THAT(
+      fake_encoder_.LastFrameTypes(),
+      ::testing::ElementsAre(VideoFrameType{VideoFrameType::kVideoFrameDelta}));
+
+  // The new share is applied when a key frame is sent anyway.
+  video_stream_encoder_->SendKeyFrame();
+  video_source_.IncomingCapturedFrame(CreateFrame(3, nullptr));
+  WaitForEncodedFrame(3);
+  EXPECT_EQ(initializations + 1, fake_encoder_.GetNumInitializations());
+  EXPECT_EQ(2, fake_encoder_.GetLastNumberOfCores());
+  EXPECT_THAT(
+      fake_encoder_.LastFrameTypes(),
+      ::testing::ElementsAre(VideoFrameType{VideoFrameType::kVideoFrameKey}));
+  video_stream_encoder_->Stop();
+}
+
 TEST_F(VideoStreamEncoderTest, NativeFrameGetsDelivered_NoFrameTypePreference) {
   video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
       kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);